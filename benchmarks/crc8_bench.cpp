@@ -0,0 +1,241 @@
+///
+/// @file
+///
+/// Benchmark of the frame CRC against the XOR checksum it replaced. Each check is run over buffers the size of a
+/// request, a temperature reply, the largest history reply, and a 64 KiB block. The CRC is timed both with the sliced
+/// table the host uses and with the byte at a time table the firmware reads from program memory. Also counts the
+/// corrupted frames each check misses, for bursts of up to eight bits, two flipped bits, and two corrupted bytes.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "message_frame.h"
+
+namespace
+{
+    using namespace scottz0r::temperature;
+
+    uint8_t xor_checksum(const uint8_t *data, size_type size)
+    {
+        uint8_t checksum = 0;
+        for (size_type i = 0; i < size; ++i)
+        {
+            checksum ^= data[i];
+        }
+
+        return checksum;
+    }
+
+    /// @brief The firmware's CRC: one table lookup per byte.
+    uint8_t crc8_bytewise(const uint8_t *data, size_type size)
+    {
+        static uint8_t table[256];
+        if (table[1] == 0)
+        {
+            for (unsigned i = 0; i < 256; ++i)
+            {
+                uint8_t b = static_cast<uint8_t>(i);
+                table[i] = crc8(&b, 1);
+            }
+        }
+
+        uint8_t crc = 0;
+        for (size_type i = 0; i < size; ++i)
+        {
+            crc = table[crc ^ data[i]];
+        }
+
+        return crc;
+    }
+
+    uint8_t crc8_sliced(const uint8_t *data, size_type size)
+    {
+        return crc8(data, size);
+    }
+
+    struct Check
+    {
+        const char *name;
+        uint8_t (*function)(const uint8_t *, size_type);
+    };
+
+    const Check checks[] = {
+        {"xor", xor_checksum},
+        {"crc8-bytewise", crc8_bytewise},
+        {"crc8-sliced", crc8_sliced},
+    };
+
+    // Keeps the results from being optimized away.
+    volatile uint8_t sink;
+
+    void run(const Check &check, const std::vector<uint8_t> &data, size_type block_size, double seconds)
+    {
+        using clock = std::chrono::steady_clock;
+
+        const size_type blocks = static_cast<size_type>(data.size() / block_size);
+        uint8_t result = 0;
+        uint64_t bytes = 0;
+
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do
+        {
+            for (size_type i = 0; i < blocks; ++i)
+            {
+                result ^= check.function(data.data() + i * block_size, block_size);
+            }
+
+            bytes += static_cast<uint64_t>(blocks) * block_size;
+            elapsed = clock::now() - start;
+        } while (elapsed < std::chrono::duration<double>(seconds));
+
+        sink = result;
+
+        double s = std::chrono::duration<double>(elapsed).count();
+        std::printf("%-14s %6u %10.1f %10.2f\n", check.name, block_size, bytes / s / 1e6, s * 1e9 / bytes);
+    }
+
+    enum class ErrorKind
+    {
+        Burst,
+        TwoBits,
+        TwoBytes
+    };
+
+    struct Error
+    {
+        const char *name;
+        ErrorKind kind;
+    };
+
+    const Error errors[] = {
+        {"burst<=8", ErrorKind::Burst},
+        {"two-bits", ErrorKind::TwoBits},
+        {"two-bytes", ErrorKind::TwoBytes},
+    };
+
+    void flip_bit(std::vector<uint8_t> &frame, unsigned bit)
+    {
+        // Bits are numbered most significant first, the order the CRC takes them in.
+        frame[bit / 8] ^= static_cast<uint8_t>(0x80 >> (bit % 8));
+    }
+
+    /// @brief Count the corrupted frames that still have a matching check value.
+    unsigned missed_errors(const Check &check, ErrorKind kind, size_type frame_size, unsigned trials, std::mt19937 &rng)
+    {
+        std::vector<uint8_t> frame(frame_size);
+        const unsigned bits = 8 * frame_size;
+        unsigned missed = 0;
+
+        for (unsigned trial = 0; trial < trials; ++trial)
+        {
+            for (auto &b : frame)
+            {
+                b = static_cast<uint8_t>(rng());
+            }
+
+            // The last byte holds the check value of the rest.
+            frame.back() = check.function(frame.data(), frame_size - 1);
+
+            switch (kind)
+            {
+            case ErrorKind::Burst:
+            {
+                // A burst starts and ends with a flipped bit and may flip any of the bits between.
+                const unsigned length = 2 + rng() % 7;
+                const unsigned first = rng() % (bits - length + 1);
+                for (unsigned bit = 0; bit < length; ++bit)
+                {
+                    if (bit == 0 || bit == length - 1 || rng() % 2 == 0)
+                    {
+                        flip_bit(frame, first + bit);
+                    }
+                }
+                break;
+            }
+            case ErrorKind::TwoBits:
+            {
+                const unsigned a = rng() % bits;
+                const unsigned b = (a + 1 + rng() % (bits - 1)) % bits;
+                flip_bit(frame, a);
+                flip_bit(frame, b);
+                break;
+            }
+            case ErrorKind::TwoBytes:
+            {
+                const unsigned a = rng() % frame_size;
+                const unsigned b = (a + 1 + rng() % (frame_size - 1)) % frame_size;
+                frame[a] ^= static_cast<uint8_t>(1 + rng() % 255);
+                frame[b] ^= static_cast<uint8_t>(1 + rng() % 255);
+                break;
+            }
+            }
+
+            if (check.function(frame.data(), frame_size - 1) == frame.back())
+            {
+                ++missed;
+            }
+        }
+
+        return missed;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    double seconds = 0.5;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seconds") == 0)
+        {
+            seconds = std::atof(argv[i + 1]);
+        }
+        else
+        {
+            std::printf("Usage: %s [--seconds S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(1);
+    std::vector<uint8_t> data(1 << 20);
+    for (auto &b : data)
+    {
+        b = static_cast<uint8_t>(rng());
+    }
+
+    // The CRC covers the length and type bytes as well as the payload.
+    const size_type header = FRAME_PAYLOAD_INDEX - FRAME_LENGTH_INDEX;
+    const size_type temperature_payload = 7 + 2 * MAX_SENSOR_COUNT;
+
+    // A request with an ID, a temperature reply with the most sensors, the largest history reply, and a block.
+    const size_type block_sizes[] = {header + 2, header + temperature_payload, header + FRAME_MAX_PAYLOAD, 64 * 1024};
+
+    std::printf("%-14s %6s %10s %10s\n", "check", "bytes", "MB/s", "ns/byte");
+    for (const auto &check : checks)
+    {
+        for (size_type block_size : block_sizes)
+        {
+            run(check, data, block_size, seconds);
+        }
+    }
+
+    // Errors in a temperature reply with the most sensors, from the length byte through the CRC.
+    const unsigned trials = 1000000;
+    const size_type frame_size = header + temperature_payload + 1;
+    std::printf("\n%-14s %10s %10s %10s\n", "check", "error", "frames", "missed");
+    for (const auto &check : checks)
+    {
+        for (const auto &error : errors)
+        {
+            unsigned missed = missed_errors(check, error.kind, frame_size, trials, rng);
+            std::printf("%-14s %10s %10u %10u\n", check.name, error.name, trials, missed);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+///
+/// @file
+///
+/// Benchmark of DevicePool against simulated devices on pseudo-terminals. A responder thread answers temperature
+/// requests on every pseudo-terminal with messages built by the firmware's formatter, and the pool polls them all from
+/// the main thread. Reports the reply rate, latency, and the CPU time used by the pool thread.
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "device_pool.h"
+#include "message_format.h"
+
+namespace
+{
+    struct SimulatedDevice
+    {
+        int master_fd;
+        std::string slave_path;
+
+        // Partly received request.
+        uint8_t request[8];
+        size_t request_size;
+    };
+
+    bool open_simulated_device(SimulatedDevice &device)
+    {
+        device.master_fd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (device.master_fd < 0 || grantpt(device.master_fd) != 0 || unlockpt(device.master_fd) != 0)
+        {
+            return false;
+        }
+
+        const char *name = ptsname(device.master_fd);
+        if (!name)
+        {
+            return false;
+        }
+
+        device.slave_path = name;
+        device.request_size = 0;
+
+        int flags = fcntl(device.master_fd, F_GETFL);
+        return flags >= 0 && fcntl(device.master_fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    /// @brief Answer four byte tagged temperature requests on every device until stopped.
+    void run_responder(std::vector<SimulatedDevice> &devices, std::atomic_bool &is_running)
+    {
+        using namespace scottz0r::temperature;
+
+        int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        for (size_t i = 0; i < devices.size(); ++i)
+        {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = i;
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, devices[i].master_fd, &event);
+        }
+
+        TemperatureVoteResult sample{};
+        for (size_type i = 0; i < TemperatureVoteResult::sensor_count; ++i)
+        {
+            sample.temps[i] = 2250;
+            sample.agreement_bits |= 1 << i;
+        }
+
+        sample.average = 2250;
+
+        MessageBuffer reply;
+        epoll_event events[64];
+
+        while (is_running)
+        {
+            int n = epoll_wait(epoll_fd, events, 64, 10);
+            for (int e = 0; e < n; ++e)
+            {
+                SimulatedDevice &device = devices[events[e].data.u64];
+
+                uint8_t buffer[256];
+                ssize_t size = read(device.master_fd, buffer, sizeof(buffer));
+                for (ssize_t i = 0; i < size; ++i)
+                {
+                    // Requests are [start][2][4][0x80][id][CRC]. Anything else restarts the request.
+                    if (device.request_size == 0 && buffer[i] != FRAME_START)
+                    {
+                        continue;
+                    }
+
+                    device.request[device.request_size] = buffer[i];
+                    ++device.request_size;
+
+                    if (device.request_size == FRAME_OVERHEAD + 2)
+                    {
+                        device.request_size = 0;
+
+                        format_msg_temperature(reply, sample, 0);
+                        format_msg_request_id(reply, device.request[FRAME_PAYLOAD_INDEX + 1]);
+                        if (write(device.master_fd, reply.buffer, reply.message_size) < 0)
+                        {
+                            continue;
+                        }
+                    }
+                }
+            }
+        }
+
+        close(epoll_fd);
+    }
+
+    double thread_cpu_seconds()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t device_count = 500;
+    double seconds = 5.0;
+    long period_ms = 0;
+    size_t max_in_flight = 0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--devices") == 0)
+        {
+            device_count = std::strtoul(argv[i + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--seconds") == 0)
+        {
+            seconds = std::atof(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--period") == 0)
+        {
+            period_ms = std::strtol(argv[i + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--max-in-flight") == 0)
+        {
+            max_in_flight = std::strtoul(argv[i + 1], nullptr, 10);
+        }
+        else
+        {
+            std::printf("Usage: %s [--devices N] [--seconds S] [--period MS] [--max-in-flight N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Each device takes two descriptors.
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    std::vector<SimulatedDevice> devices(device_count);
+    for (auto &device : devices)
+    {
+        if (!open_simulated_device(device))
+        {
+            std::perror("Failed to open pseudo-terminal");
+            return 1;
+        }
+    }
+
+    DevicePool pool;
+    pool.set_max_in_flight(max_in_flight);
+
+    for (auto &device : devices)
+    {
+        if (pool.add_device(device.slave_path, std::chrono::milliseconds(period_ms)) < 0)
+        {
+            std::perror("Failed to open device");
+            return 1;
+        }
+    }
+
+    std::atomic_bool is_running(true);
+    std::thread responder(run_responder, std::ref(devices), std::ref(is_running));
+
+    // Warm up, then measure.
+    pool.run_for(std::chrono::milliseconds(200));
+    pool.reset_stats();
+
+    double cpu_start = thread_cpu_seconds();
+    auto start = DevicePool::clock::now();
+    pool.run_for(std::chrono::duration_cast<DevicePool::clock::duration>(std::chrono::duration<double>(seconds)));
+    double elapsed = std::chrono::duration<double>(DevicePool::clock::now() - start).count();
+    double cpu = thread_cpu_seconds() - cpu_start;
+
+    is_running = false;
+    responder.join();
+
+    DeviceStats total;
+    double worst_mean_us = 0.0;
+    size_t silent_devices = 0;
+    for (size_t i = 0; i < pool.size(); ++i)
+    {
+        const DeviceStats &stats = pool.stats(i);
+        total.requests += stats.requests;
+        total.replies += stats.replies;
+        total.timeouts += stats.timeouts;
+        total.errors += stats.errors;
+        total.discarded_bytes += stats.discarded_bytes;
+        total.latency_total_us += stats.latency_total_us;
+        if (stats.latency_max_us > total.latency_max_us)
+        {
+            total.latency_max_us = stats.latency_max_us;
+        }
+
+        worst_mean_us = stats.latency_mean_us() > worst_mean_us ? stats.latency_mean_us() : worst_mean_us;
+        silent_devices += stats.replies == 0 ? 1 : 0;
+    }
+
+    std::printf("devices            %zu\n", pool.size());
+    std::printf("period             %ld ms\n", period_ms);
+    std::printf("max in flight      %zu\n", max_in_flight);
+    std::printf(
+        "replies            %llu (%.0f per second)\n", (unsigned long long)total.replies, total.replies / elapsed);
+    std::printf("timeouts           %llu\n", (unsigned long long)total.timeouts);
+    std::printf("errors             %llu\n", (unsigned long long)total.errors);
+    std::printf("discarded bytes    %llu\n", (unsigned long long)total.discarded_bytes);
+    std::printf("devices no reply   %zu\n", silent_devices);
+    std::printf("latency mean       %.0f us\n", total.latency_mean_us());
+    std::printf("latency worst mean %.0f us\n", worst_mean_us);
+    std::printf("latency max        %llu us\n", (unsigned long long)total.latency_max_us);
+    std::printf("pool thread cpu    %.1f%%\n", 100.0 * cpu / elapsed);
+
+    for (auto &device : devices)
+    {
+        close(device.master_fd);
+    }
+
+    return 0;
+}
@@ -0,0 +1,246 @@
+///
+/// @file
+///
+/// Benchmark of FrameDecoder on recorded byte streams. By default two streams are generated with the firmware's
+/// formatter: a clean mix of every message the device sends, and the same mix with bytes corrupted, dropped and
+/// inserted. A raw capture from a device can be given instead with --file. Each stream is decoded in chunks of 1, 64
+/// and 4096 bytes, like byte-at-a-time reads, a full USB packet, and one large read of a backlog.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "frame_decoder.h"
+#include "message_format.h"
+
+namespace
+{
+    struct Stream
+    {
+        std::string name;
+        std::vector<uint8_t> bytes;
+    };
+
+    /// @brief Generate about size bytes of messages in the mix a busy device sends.
+    std::vector<uint8_t> generate_clean(size_t size, std::mt19937 &rng)
+    {
+        using namespace scottz0r::temperature;
+
+        std::vector<uint8_t> bytes;
+        bytes.reserve(size + sizeof(MessageBuffer::buffer));
+
+        TemperatureVoteResult sample{};
+        for (size_type i = 0; i < TemperatureVoteResult::sensor_count; ++i)
+        {
+            sample.agreement_bits |= 1 << i;
+        }
+
+        SystemSensorStatus status{};
+        uint8_t history[HISTORY_MSG_MAX_DATA];
+        MessageBuffer message;
+        uint8_t sequence = 0;
+
+        for (unsigned n = 0; bytes.size() < size; ++n)
+        {
+            for (size_type i = 0; i < TemperatureVoteResult::sensor_count; ++i)
+            {
+                sample.temps[i] = static_cast<temperature_type>(2200 + rng() % 100);
+            }
+
+            sample.average = sample.temps[0];
+
+            switch (n % 8)
+            {
+            case 0:
+            case 1:
+            case 2:
+                format_msg_temperature_stream(message, sample, rng() % 300, sequence);
+                ++sequence;
+                break;
+            case 3:
+                format_msg_temperature(message, sample, rng() % 300);
+                break;
+            case 4:
+                format_msg_temperature(message, sample, rng() % 300);
+                format_msg_request_id(message, static_cast<uint8_t>(n));
+                break;
+            case 5:
+                format_msg_system_status(message, status);
+                break;
+            case 6:
+            {
+                for (auto &b : history)
+                {
+                    b = static_cast<uint8_t>(rng());
+                }
+
+                size_type data_size = static_cast<size_type>(rng() % (HISTORY_MSG_MAX_DATA + 1));
+                format_msg_history(
+                    message, static_cast<uint16_t>(n), static_cast<uint16_t>(n + 100), sample, history, data_size);
+                format_msg_request_id(message, static_cast<uint8_t>(n));
+                break;
+            }
+            default:
+                format_msg_error(message, ErrorCode::BadRequest);
+                break;
+            }
+
+            bytes.insert(bytes.end(), message.buffer, message.buffer + message.message_size);
+        }
+
+        return bytes;
+    }
+
+    /// @brief Copy of a stream with about one byte in every 200 flipped, dropped, or followed by a run of garbage.
+    std::vector<uint8_t> add_noise(const std::vector<uint8_t> &clean, std::mt19937 &rng)
+    {
+        std::vector<uint8_t> bytes;
+        bytes.reserve(clean.size() + clean.size() / 50);
+
+        for (uint8_t b : clean)
+        {
+            switch (rng() % 800)
+            {
+            case 0:
+                bytes.push_back(static_cast<uint8_t>(b ^ (1 << (rng() % 8))));
+                break;
+            case 1:
+                break;
+            case 2:
+            case 3:
+            {
+                bytes.push_back(b);
+                for (unsigned i = rng() % 32; i > 0; --i)
+                {
+                    bytes.push_back(static_cast<uint8_t>(rng()));
+                }
+                break;
+            }
+            default:
+                bytes.push_back(b);
+                break;
+            }
+        }
+
+        return bytes;
+    }
+
+    bool read_file(const char *path, std::vector<uint8_t> &bytes)
+    {
+        FILE *file = std::fopen(path, "rb");
+        if (!file)
+        {
+            return false;
+        }
+
+        uint8_t buffer[4096];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            bytes.insert(bytes.end(), buffer, buffer + n);
+        }
+
+        std::fclose(file);
+        return true;
+    }
+
+    // Keeps the decoded frames from being optimized away.
+    volatile uint64_t sink;
+
+    void run(const Stream &stream, size_t chunk_size, double seconds)
+    {
+        using clock = std::chrono::steady_clock;
+
+        FrameDecoder decoder;
+        uint64_t checksum = 0;
+        unsigned passes = 0;
+
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do
+        {
+            decoder.reset();
+            for (size_t i = 0; i < stream.bytes.size(); i += chunk_size)
+            {
+                size_t n = stream.bytes.size() - i < chunk_size ? stream.bytes.size() - i : chunk_size;
+                decoder.push(stream.bytes.data() + i, n, [&](const Frame &frame) {
+                    checksum += frame.data[frame.size - 1];
+                    return true;
+                });
+            }
+
+            ++passes;
+            elapsed = clock::now() - start;
+        } while (elapsed < std::chrono::duration<double>(seconds));
+
+        sink = checksum;
+
+        double s = std::chrono::duration<double>(elapsed).count();
+        double frames = static_cast<double>(decoder.frames()) / passes;
+        double discarded = static_cast<double>(decoder.discarded_bytes()) / passes;
+
+        std::printf(
+            "%-8s %6zu %10.0f %12.0f %8.1f %12.0f\n", stream.name.c_str(), chunk_size, frames, frames * passes / s,
+            stream.bytes.size() * passes / s / 1e6, discarded);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t size = 4 << 20;
+    double seconds = 1.0;
+    const char *file = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--file") == 0)
+        {
+            file = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--size") == 0)
+        {
+            size = std::strtoul(argv[i + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--seconds") == 0)
+        {
+            seconds = std::atof(argv[i + 1]);
+        }
+        else
+        {
+            std::printf("Usage: %s [--file CAPTURE] [--size BYTES] [--seconds S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Stream> streams;
+    if (file)
+    {
+        streams.push_back({file, {}});
+        if (!read_file(file, streams.back().bytes))
+        {
+            std::perror("Failed to read capture");
+            return 1;
+        }
+    }
+    else
+    {
+        std::mt19937 rng(1);
+        streams.push_back({"clean", generate_clean(size, rng)});
+        streams.push_back({"noisy", add_noise(streams.back().bytes, rng)});
+    }
+
+    std::printf("%-8s %6s %10s %12s %8s %12s\n", "stream", "chunk", "frames", "frames/s", "MB/s", "discarded");
+
+    for (const auto &stream : streams)
+    {
+        for (size_t chunk_size : {size_t(1), size_t(64), size_t(4096)})
+        {
+            run(stream, chunk_size, seconds);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,396 @@
+///
+/// @file
+///
+/// Microbenchmarks of the firmware paths that run on every sample or request: the vote, the temperature and system
+/// status message formatters, decoding a request with MessageReader, and reading a temperature with SensorMcp9808.
+/// Each benchmark cycles through inputs generated up front from a fixed seed, shaped like what the board sees, so
+/// runs compare across commits. Reports nanoseconds and operations per second, and with --json writes the results in
+/// Google Benchmark's JSON layout, so its compare.py can diff two runs.
+///
+/// Host timings are not AVR timings, but a change that makes one of these paths slower here is worth a look before it
+/// goes on the board.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Wire.h"
+#include "message_format.h"
+#include "message_reader.h"
+#include "request_mix.h"
+#include "sensor_mcp_9808.h"
+#include "temperature_engine.h"
+
+namespace
+{
+    using namespace scottz0r::temperature;
+
+    /// @brief Inputs per benchmark. A power of two, so the next input is a mask away.
+    constexpr size_t input_count = 4096;
+
+    struct BenchResult
+    {
+        std::string name;
+        uint64_t iterations;
+        double real_ns;
+        double cpu_ns;
+    };
+
+    // Keeps the results from being optimized away.
+    volatile int64_t sink;
+
+    /// @brief Run op on input indexes in batches until at least seconds have passed, after one batch to warm up.
+    template <typename Op> BenchResult measure(const char *name, double seconds, Op op)
+    {
+        using clock = std::chrono::steady_clock;
+        constexpr uint64_t batch = 1024;
+
+        int64_t checksum = 0;
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            checksum += op(i & (input_count - 1));
+        }
+
+        uint64_t iterations = 0;
+        std::clock_t cpu_start = std::clock();
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do
+        {
+            for (uint64_t i = 0; i < batch; ++i)
+            {
+                checksum += op((iterations + i) & (input_count - 1));
+            }
+
+            iterations += batch;
+            elapsed = clock::now() - start;
+        } while (elapsed < std::chrono::duration<double>(seconds));
+
+        double cpu_seconds = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        sink = checksum;
+
+        double real_ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        return {name, iterations, real_ns, cpu_seconds * 1e9 / iterations};
+    }
+
+    /// @brief Readings like a healthy set of sensors near room temperature: a common ambient that wanders, a little
+    /// noise per sensor, and now and then a spike or a failed read, so every vote status turns up.
+    std::vector<TemperatureVoteEngine::result_type> generate_votes(std::mt19937 &rng,
+                                                                   std::vector<TemperatureReading> &readings)
+    {
+        constexpr size_t n = TemperatureVoteEngine::sensor_count;
+        std::normal_distribution<double> noise(0.0, 8.0);
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+        readings.resize(input_count * n);
+        for (size_t i = 0; i < input_count; ++i)
+        {
+            double ambient = 2250.0 + 300.0 * std::sin(i * 0.01);
+            for (size_t s = 0; s < n; ++s)
+            {
+                TemperatureReading &reading = readings[i * n + s];
+                double value = ambient + noise(rng);
+                if (chance(rng) < 0.02)
+                {
+                    value += (rng() & 1) ? 120.0 : -120.0;
+                }
+
+                reading.is_valid = chance(rng) >= 0.01;
+                reading.temperature = reading.is_valid ? static_cast<temperature_type>(std::lround(value)) : 0;
+            }
+        }
+
+        // Vote results for the formatter, from the readings above.
+        TemperatureVoteEngine engine(CFG_TEMPERATURE_TOLERANCE);
+        std::vector<TemperatureVoteEngine::result_type> results(input_count);
+        for (size_t i = 0; i < input_count; ++i)
+        {
+            const TemperatureReading(&set)[n] = *reinterpret_cast<const TemperatureReading(*)[n]>(&readings[i * n]);
+            engine.vote_temperature(set, results[i]);
+        }
+
+        return results;
+    }
+
+    /// @brief Request frames from the shared request mix, without noise. Frames are back to back, with their start
+    /// offsets.
+    std::vector<uint8_t> generate_requests(std::mt19937 &rng, std::vector<size_t> &offsets)
+    {
+        std::vector<uint8_t> bytes;
+        offsets.resize(input_count + 1);
+
+        for (size_t i = 0; i < input_count; ++i)
+        {
+            offsets[i] = bytes.size();
+            append_request(bytes, rng, static_cast<uint8_t>(i), false);
+        }
+
+        offsets[input_count] = bytes.size();
+        return bytes;
+    }
+
+    /// @brief Two-wire stub that answers as an MCP 9808 at any address, with the ambient register taking the next raw
+    /// value each read. Costs next to nothing, so a read_temp measures the driver and its conversion.
+    class RegisterWire : public TwoWireImpl
+    {
+    public:
+        static constexpr uint8_t ADDRESS = 0x18;
+        static constexpr uint8_t REG_AMBIENT_TEMP = 0x05;
+        static constexpr uint8_t REG_MANUF_ID = 0x06;
+        static constexpr uint8_t REG_DEVICE_ID = 0x07;
+
+        explicit RegisterWire(const std::vector<uint16_t> &ambient)
+            : m_ambient(ambient), m_next(0), m_pointer(0), m_is_first(false), m_rx{}, m_rx_index(2)
+        {
+        }
+
+        int available() override
+        {
+            return 2 - m_rx_index;
+        }
+
+        void begin() override
+        {
+        }
+
+        void beginTransmission(uint8_t) override
+        {
+            m_is_first = true;
+        }
+
+        uint8_t endTransmission() override
+        {
+            return 0;
+        }
+
+        int read() override
+        {
+            return m_rx_index < 2 ? m_rx[m_rx_index++] : -1;
+        }
+
+        uint8_t requestFrom(uint8_t, uint8_t count) override
+        {
+            uint16_t value = 0;
+            switch (m_pointer)
+            {
+            case REG_MANUF_ID:
+                value = 0x0054;
+                break;
+            case REG_DEVICE_ID:
+                value = 0x0400;
+                break;
+            case REG_AMBIENT_TEMP:
+                value = m_ambient[m_next++ & (input_count - 1)];
+                break;
+            default:
+                break;
+            }
+
+            m_rx[0] = static_cast<uint8_t>(value >> 8);
+            m_rx[1] = static_cast<uint8_t>(value);
+            m_rx_index = 0;
+            return count < 2 ? count : 2;
+        }
+
+        size_t write(uint8_t value) override
+        {
+            if (m_is_first)
+            {
+                m_pointer = value;
+                m_is_first = false;
+            }
+
+            return 1;
+        }
+
+    private:
+        const std::vector<uint16_t> &m_ambient;
+        size_t m_next;
+        uint8_t m_pointer;
+        bool m_is_first;
+        uint8_t m_rx[2];
+        int m_rx_index;
+    };
+
+    /// @brief Ambient register values across the sensor's range, most near room temperature, with alert flags set on
+    /// some as a sensor with limits configured would.
+    std::vector<uint16_t> generate_ambient(std::mt19937 &rng)
+    {
+        std::normal_distribution<double> room(22.5, 5.0);
+        std::uniform_real_distribution<double> range(-40.0, 125.0);
+
+        std::vector<uint16_t> values(input_count);
+        for (uint16_t &value : values)
+        {
+            double celsius = (rng() % 8 == 0) ? range(rng) : room(rng);
+            int32_t sixteenths = static_cast<int32_t>(std::floor(celsius * 16.0));
+            value = static_cast<uint16_t>(sixteenths & 0x1FFF);
+            value |= static_cast<uint16_t>((rng() % 16 == 0) ? 0x4000 : 0);
+        }
+
+        return values;
+    }
+
+    void write_json(FILE *file, const char *executable, const std::vector<BenchResult> &results)
+    {
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+        std::fprintf(file, "{\n  \"context\": {\n");
+        std::fprintf(file, "    \"date\": \"%s\",\n", date);
+        std::fprintf(file, "    \"executable\": \"%s\",\n", executable);
+        std::fprintf(file, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+        std::fprintf(file, "    \"sensor_count\": %u,\n", static_cast<unsigned>(TemperatureVoteEngine::sensor_count));
+        std::fprintf(file, "    \"inputs\": %zu\n  },\n  \"benchmarks\": [\n", input_count);
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchResult &result = results[i];
+            std::fprintf(file,
+                         "    {\n"
+                         "      \"name\": \"%s\",\n"
+                         "      \"run_name\": \"%s\",\n"
+                         "      \"run_type\": \"iteration\",\n"
+                         "      \"iterations\": %llu,\n"
+                         "      \"real_time\": %.4f,\n"
+                         "      \"cpu_time\": %.4f,\n"
+                         "      \"time_unit\": \"ns\",\n"
+                         "      \"items_per_second\": %.1f\n"
+                         "    }%s\n",
+                         result.name.c_str(), result.name.c_str(), static_cast<unsigned long long>(result.iterations),
+                         result.real_ns, result.cpu_ns, 1e9 / result.real_ns, i + 1 < results.size() ? "," : "");
+        }
+
+        std::fprintf(file, "  ]\n}\n");
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    double seconds = 0.5;
+    const char *json_path = nullptr;
+    const char *filter = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seconds") == 0)
+        {
+            seconds = std::atof(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--json") == 0)
+        {
+            json_path = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0)
+        {
+            filter = argv[i + 1];
+        }
+        else
+        {
+            std::printf("Usage: %s [--seconds S] [--json FILE] [--filter TEXT]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(1);
+    constexpr size_t n = TemperatureVoteEngine::sensor_count;
+
+    std::vector<TemperatureReading> readings;
+    std::vector<TemperatureVoteEngine::result_type> votes = generate_votes(rng, readings);
+
+    std::vector<SystemSensorStatus> statuses(input_count);
+    for (SystemSensorStatus &status : statuses)
+    {
+        status.sensor_good_bits = (rng() % 32 == 0) ? static_cast<uint8_t>(rng() & 0x07) : 0x07;
+        status.system_status = SystemStatus::OK;
+        status.tx_queue_size = static_cast<uint8_t>(rng() % 40);
+        status.tx_queue_peak = static_cast<uint8_t>(status.tx_queue_size + rng() % 24);
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<uint8_t> requests = generate_requests(rng, offsets);
+
+    std::vector<uint16_t> ambient = generate_ambient(rng);
+    RegisterWire wire(ambient);
+    wire_impl = &wire;
+
+    SensorMcp9808 sensor;
+    if (!sensor.begin(RegisterWire::ADDRESS, Mcp9808Resolution::Sixteenth))
+    {
+        std::printf("Sensor did not begin.\n");
+        return 1;
+    }
+
+    TemperatureVoteEngine engine(CFG_TEMPERATURE_TOLERANCE);
+    MessageReader reader(CFG_SERIAL_MESSAGE_TIMEOUT);
+    MessageBuffer buffer;
+
+    std::vector<BenchResult> results;
+    auto run = [&](const char *name, auto op) {
+        if (!filter || std::strstr(name, filter))
+        {
+            results.push_back(measure(name, seconds, op));
+        }
+    };
+
+    run("vote_temperature", [&](size_t i) {
+        TemperatureVoteEngine::result_type result;
+        engine.vote_temperature(*reinterpret_cast<const TemperatureReading(*)[n]>(&readings[i * n]), result);
+        return static_cast<int64_t>(result.average) + static_cast<int64_t>(result.status);
+    });
+
+    run("format_msg_temperature", [&](size_t i) {
+        format_msg_temperature(buffer, votes[i], static_cast<time_type>(i & 0x3FF));
+        return static_cast<int64_t>(buffer.message_size) + buffer.buffer[buffer.message_size - 1];
+    });
+
+    run("format_msg_system_status", [&](size_t i) {
+        format_msg_system_status(buffer, statuses[i]);
+        return static_cast<int64_t>(buffer.message_size) + buffer.buffer[buffer.message_size - 1];
+    });
+
+    run("message_reader_request", [&](size_t i) {
+        reader.process(requests.data() + offsets[i], static_cast<size_type>(offsets[i + 1] - offsets[i]));
+        RequestMessage request;
+        bool is_ok = reader.get_data(request);
+        return static_cast<int64_t>(request.request_id) + request.argument + (is_ok ? 1 : 0);
+    });
+
+    run("sensor_read_temp", [&](size_t) {
+        int16_t result;
+        bool is_ok = sensor.read_temp(result);
+        return static_cast<int64_t>(result) + (is_ok ? 1 : 0);
+    });
+
+    std::printf("%-26s %14s %12s %16s\n", "benchmark", "iterations", "ns/op", "ops/s");
+    for (const BenchResult &result : results)
+    {
+        std::printf("%-26s %14llu %12.2f %16.0f\n", result.name.c_str(),
+                    static_cast<unsigned long long>(result.iterations), result.real_ns, 1e9 / result.real_ns);
+    }
+
+    if (json_path)
+    {
+        FILE *file = std::strcmp(json_path, "-") == 0 ? stdout : std::fopen(json_path, "w");
+        if (!file)
+        {
+            std::printf("Cannot write %s.\n", json_path);
+            return 1;
+        }
+
+        write_json(file, argv[0], results);
+        if (file != stdout)
+        {
+            std::fclose(file);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+///
+/// @file
+///
+/// Benchmark of the firmware's MCP 9808 driver against the register-level sensor model. Three sensors sit on one
+/// simulated bus and are read round-robin, with the clock stepped a millisecond per read so conversions keep finishing.
+/// Reports sensor reads and I2C transactions per second for blocking reads and for the non-blocking steps the sampler
+/// uses.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+
+#include "Arduino.h"
+#include "mcp9808_model.h"
+#include "sensor_mcp_9808.h"
+
+namespace
+{
+    using namespace scottz0r::temperature;
+
+    class StepArduino : public ArduinoImpl
+    {
+    public:
+        unsigned long millis() override
+        {
+            return now;
+        }
+
+        unsigned long now = 0;
+    };
+
+    // Keeps the readings from being optimized away.
+    volatile int64_t sink;
+
+    void run(const char *name, StepArduino &clock_impl, I2cBusModel &bus, SensorMcp9808 *sensors, size_t count,
+             bool is_polled, double seconds)
+    {
+        using clock = std::chrono::steady_clock;
+
+        int64_t checksum = 0;
+        uint64_t reads = 0;
+        uint64_t failures = 0;
+        uint64_t transactions = bus.transactions();
+
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do
+        {
+            for (int batch = 0; batch < 1024; ++batch)
+            {
+                SensorMcp9808 &sensor = sensors[reads % count];
+                int16_t result = 0;
+                bool is_ok;
+
+                if (is_polled)
+                {
+                    sensor.start_read_temp();
+                    SensorReadStatus status;
+                    while ((status = sensor.poll(result)) == SensorReadStatus::Busy)
+                    {
+                    }
+
+                    is_ok = status == SensorReadStatus::Done;
+                }
+                else
+                {
+                    is_ok = sensor.read_temp(result);
+                }
+
+                checksum += result;
+                failures += is_ok ? 0 : 1;
+                ++reads;
+                ++clock_impl.now;
+            }
+
+            elapsed = clock::now() - start;
+        } while (elapsed < std::chrono::duration<double>(seconds));
+
+        sink = checksum;
+
+        double s = std::chrono::duration<double>(elapsed).count();
+        std::printf("%-10s %14.0f %16.0f %10llu\n", name, reads / s, (bus.transactions() - transactions) / s,
+                    static_cast<unsigned long long>(failures));
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    double seconds = 1.0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seconds") == 0)
+        {
+            seconds = std::atof(argv[i + 1]);
+        }
+        else
+        {
+            std::printf("Usage: %s [--seconds S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    StepArduino clock_impl;
+    arduino_impl = &clock_impl;
+
+    I2cBusModel bus;
+    wire_impl = &bus;
+
+    static const uint8_t addresses[] = {0x18, 0x19, 0x1A};
+    constexpr size_t count = sizeof(addresses) / sizeof(addresses[0]);
+
+    std::deque<Mcp9808Model> devices;
+    SensorMcp9808 sensors[count];
+    for (size_t i = 0; i < count; ++i)
+    {
+        devices.emplace_back(addresses[i], 20.0 + i);
+        devices.back().set_temperature_source([i](unsigned long now) { return 20.0 + i + (now % 1000) / 1000.0; });
+        bus.attach(devices.back());
+
+        if (!sensors[i].begin(addresses[i], Mcp9808Resolution::Half))
+        {
+            std::printf("Sensor %zu did not begin.\n", i);
+            return 1;
+        }
+    }
+
+    std::printf("%-10s %14s %16s %10s\n", "read", "reads/s", "transactions/s", "failures");
+    run("blocking", clock_impl, bus, sensors, count, false, seconds);
+    run("polled", clock_impl, bus, sensors, count, true, seconds);
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+///
+/// @file
+///
+/// Benchmark of the firmware's MessageReader on a host. A stream of pipelined requests with some noise between them is
+/// fed one byte at a time through process(int), the way loop() used to read, and in blocks through the batch process.
+/// The clock is a steady clock behind the Arduino mock, so every millis() call costs about what a clock read does, and
+/// the calls are counted. The queue is drained whenever it fills, like loop() answering requests.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Arduino.h"
+#include "message_reader.h"
+#include "request_mix.h"
+
+namespace
+{
+    using namespace scottz0r::temperature;
+
+    class SteadyArduino : public ArduinoImpl
+    {
+    public:
+        unsigned long millis() override
+        {
+            ++calls;
+            auto now = std::chrono::steady_clock::now().time_since_epoch();
+            return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+        }
+
+        uint64_t calls = 0;
+    };
+
+    /// @brief Generate about size bytes of requests, mostly temperature requests with IDs like a pipelining host sends.
+    std::vector<uint8_t> generate(size_t size, std::mt19937 &rng, size_t &request_count)
+    {
+        std::vector<uint8_t> bytes;
+        bytes.reserve(size + MessageReader::buffer_size);
+        request_count = 0;
+
+        for (uint8_t id = 0; bytes.size() < size; ++id)
+        {
+            if (append_request(bytes, rng, id, true))
+            {
+                ++request_count;
+            }
+        }
+
+        return bytes;
+    }
+
+    // Keeps the decoded requests from being optimized away.
+    volatile uint64_t sink;
+
+    /// @brief Take every queued request.
+    uint64_t drain(MessageReader &reader, uint64_t &requests)
+    {
+        uint64_t checksum = 0;
+        RequestMessage request;
+        while (reader.pending() > 0)
+        {
+            reader.get_data(request);
+            checksum += request.request_id + static_cast<uint8_t>(request.type);
+            ++requests;
+        }
+
+        return checksum;
+    }
+
+    /// @brief Decode the stream once.
+    /// @param block_size Bytes per batch, or 0 for one process(int) call per byte.
+    uint64_t decode(MessageReader &reader, const std::vector<uint8_t> &bytes, size_type block_size, uint64_t &requests)
+    {
+        uint64_t checksum = 0;
+        size_t position = 0;
+
+        while (position < bytes.size())
+        {
+            if (block_size == 0)
+            {
+                if (reader.is_full())
+                {
+                    checksum += drain(reader, requests);
+                }
+
+                reader.process(bytes[position]);
+                ++position;
+                continue;
+            }
+
+            size_t n = bytes.size() - position < block_size ? bytes.size() - position : block_size;
+            size_type used = reader.process(bytes.data() + position, static_cast<size_type>(n));
+            position += used;
+
+            if (reader.is_full())
+            {
+                checksum += drain(reader, requests);
+            }
+        }
+
+        return checksum + drain(reader, requests);
+    }
+
+    void run(SteadyArduino &clock_impl, const std::vector<uint8_t> &bytes, size_type block_size, double seconds)
+    {
+        using clock = std::chrono::steady_clock;
+
+        MessageReader reader(CFG_SERIAL_MESSAGE_TIMEOUT);
+        uint64_t checksum = 0;
+        uint64_t requests = 0;
+        uint64_t passes = 0;
+        clock_impl.calls = 0;
+
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do
+        {
+            reader.reset();
+            checksum += decode(reader, bytes, block_size, requests);
+            ++passes;
+            elapsed = clock::now() - start;
+        } while (elapsed < std::chrono::duration<double>(seconds));
+
+        sink = checksum;
+
+        double s = std::chrono::duration<double>(elapsed).count();
+        char name[24];
+        if (block_size == 0)
+        {
+            std::snprintf(name, sizeof(name), "byte");
+        }
+        else
+        {
+            std::snprintf(name, sizeof(name), "batch-%u", block_size);
+        }
+
+        std::printf(
+            "%-10s %10.1f %12.0f %10.2f\n", name, bytes.size() * passes / s / 1e6, requests / s,
+            static_cast<double>(clock_impl.calls) / requests);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t size = 1 << 20;
+    double seconds = 1.0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--size") == 0)
+        {
+            size = std::strtoul(argv[i + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--seconds") == 0)
+        {
+            seconds = std::atof(argv[i + 1]);
+        }
+        else
+        {
+            std::printf("Usage: %s [--size BYTES] [--seconds S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SteadyArduino clock_impl;
+    arduino_impl = &clock_impl;
+
+    std::mt19937 rng(1);
+    size_t request_count;
+    std::vector<uint8_t> bytes = generate(size, rng, request_count);
+    std::printf("%zu bytes, %zu requests\n", bytes.size(), request_count);
+
+    std::printf("%-10s %10s %12s %10s\n", "feed", "MB/s", "requests/s", "millis/req");
+
+    // One byte per call, the capacity loop() reads per block, the serial receive buffer, and a large block.
+    const size_type block_sizes[] = {0, MessageReader::queue_size * FRAME_OVERHEAD, 64, 4096};
+    for (size_type block_size : block_sizes)
+    {
+        run(clock_impl, bytes, block_size, seconds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+///
+/// @file
+///
+/// Request traffic shared by the benchmarks that decode requests, so they measure the same mix.
+#ifndef _SCOTTZ0R_BENCHMARKS_REQUEST_MIX_INCLUDE_GUARD
+#define _SCOTTZ0R_BENCHMARKS_REQUEST_MIX_INCLUDE_GUARD
+
+#include <random>
+#include <vector>
+
+#include "message_reader.h"
+
+/// @brief Append the next piece of a pipelining host's traffic: mostly temperature requests with IDs, some status
+/// requests and the odd history download with an offset. With noise, one draw in eight is a few bytes of line noise
+/// instead of a request.
+/// @param id Request ID for requests that carry one.
+/// @return True if a request was appended, false for noise.
+inline bool append_request(std::vector<uint8_t> &bytes, std::mt19937 &rng, uint8_t id, bool has_noise)
+{
+    using namespace scottz0r::temperature;
+
+    uint8_t frame[MessageReader::buffer_size];
+    frame[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageIdentifier::Request);
+
+    size_type payload_size;
+    switch (rng() % 8)
+    {
+    case 0:
+        frame[FRAME_PAYLOAD_INDEX] = static_cast<uint8_t>(RequestType::SystemStatus);
+        payload_size = 1;
+        break;
+    case 1:
+        frame[FRAME_PAYLOAD_INDEX] = static_cast<uint8_t>(RequestType::HistoryDownload) | MESSAGE_REQUEST_ID_FLAG;
+        frame[FRAME_PAYLOAD_INDEX + 1] = id;
+        frame[FRAME_PAYLOAD_INDEX + 2] = static_cast<uint8_t>(rng());
+        frame[FRAME_PAYLOAD_INDEX + 3] = static_cast<uint8_t>(rng());
+        payload_size = 4;
+        break;
+    case 2:
+        if (has_noise)
+        {
+            for (unsigned i = rng() % 4; i > 0; --i)
+            {
+                bytes.push_back(static_cast<uint8_t>(rng()));
+            }
+
+            return false;
+        }
+        // Fall through.
+    default:
+        frame[FRAME_PAYLOAD_INDEX] = static_cast<uint8_t>(RequestType::Temperature) | MESSAGE_REQUEST_ID_FLAG;
+        frame[FRAME_PAYLOAD_INDEX + 1] = id;
+        payload_size = 2;
+        break;
+    }
+
+    size_type frame_size = frame_seal(frame, payload_size);
+    bytes.insert(bytes.end(), frame, frame + frame_size);
+    return true;
+}
+
+#endif // _SCOTTZ0R_BENCHMARKS_REQUEST_MIX_INCLUDE_GUARD
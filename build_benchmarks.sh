@@ -0,0 +1,53 @@
+#!/bin/sh
+# Builds the host benchmarks into debug/. Set CXX to choose the compiler.
+set -e
+
+root="$(cd "$(dirname "$0")" && pwd)"
+target_dir="$root/debug"
+tt="$root/triple_temperature_uno"
+tester="$root/serial_tester_windows"
+
+mkdir -p "$target_dir"
+
+${CXX:-c++} -std=c++17 -O2 -Wall -pthread \
+    -I "$tt" -I "$tester" \
+    "$root/benchmarks/device_pool_bench.cpp" \
+    "$tester/device_pool.cpp" "$tester/frame_decoder.cpp" "$tester/serial_port_posix.cpp" \
+    "$tt/message_format.cpp" "$tt/message_frame.cpp" \
+    -o "$target_dir/device_pool_bench"
+
+${CXX:-c++} -std=c++17 -O2 -Wall \
+    -I "$tt" -I "$tester" \
+    "$root/benchmarks/frame_decoder_bench.cpp" \
+    "$tester/frame_decoder.cpp" \
+    "$tt/message_format.cpp" "$tt/message_frame.cpp" \
+    -o "$target_dir/frame_decoder_bench"
+
+${CXX:-c++} -std=c++17 -O2 -Wall \
+    -I "$tt" \
+    "$root/benchmarks/crc8_bench.cpp" \
+    "$tt/message_frame.cpp" \
+    -o "$target_dir/crc8_bench"
+
+${CXX:-c++} -std=c++17 -O2 -Wall \
+    -I "$tt" -I "$root/tests/mocks" \
+    "$root/benchmarks/message_reader_bench.cpp" \
+    "$tt/message_reader.cpp" "$tt/message_frame.cpp" "$root/tests/mocks/Arduino.cpp" \
+    -o "$target_dir/message_reader_bench"
+
+${CXX:-c++} -std=c++17 -O2 -Wall \
+    -I "$tt" -I "$root/tests/mocks" \
+    "$root/benchmarks/mcp9808_model_bench.cpp" \
+    "$tt/sensor_mcp_9808.cpp" "$root/tests/mocks/Arduino.cpp" "$root/tests/mocks/Wire.cpp" \
+    "$root/tests/mocks/i2c_bus_model.cpp" "$root/tests/mocks/mcp9808_model.cpp" "$root/tests/mocks/virtual_clock.cpp" \
+    -o "$target_dir/mcp9808_model_bench"
+
+${CXX:-c++} -std=c++17 -O2 -Wall \
+    -I "$tt" -I "$root/tests/mocks" \
+    "$root/benchmarks/hot_path_bench.cpp" \
+    "$tt/message_format.cpp" "$tt/message_frame.cpp" "$tt/message_reader.cpp" "$tt/sensor_mcp_9808.cpp" \
+    "$root/tests/mocks/Arduino.cpp" "$root/tests/mocks/Wire.cpp" \
+    -o "$target_dir/hot_path_bench"
+
+echo "Built device_pool_bench, frame_decoder_bench, crc8_bench, message_reader_bench, mcp9808_model_bench and" \
+    "hot_path_bench in $target_dir"
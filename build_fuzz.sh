@@ -0,0 +1,25 @@
+#!/bin/sh
+# Builds the fuzz targets into debug/. With clang, targets are built for libFuzzer. Other compilers build a standalone
+# driver that runs random inputs, or the files given on the command line, under the address and undefined behavior
+# sanitizers. Set CXX to choose the compiler.
+set -e
+
+root="$(cd "$(dirname "$0")" && pwd)"
+target_dir="$root/debug"
+tester="$root/serial_tester_windows"
+cxx="${CXX:-c++}"
+
+mkdir -p "$target_dir"
+
+if $cxx --version | grep -q clang; then
+    flags="-fsanitize=fuzzer,address,undefined"
+else
+    flags="-fsanitize=address,undefined -DFRAME_DECODER_FUZZ_MAIN"
+fi
+
+$cxx -std=c++17 -O1 -g -Wall -fno-omit-frame-pointer $flags \
+    -I "$root/triple_temperature_uno" -I "$tester" \
+    "$root/fuzz/frame_decoder_fuzz.cpp" "$tester/frame_decoder.cpp" "$root/triple_temperature_uno/message_frame.cpp" \
+    -o "$target_dir/frame_decoder_fuzz"
+
+echo "Built $target_dir/frame_decoder_fuzz"
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Builds the fault-injection scenario runner and the whole-firmware run into debug/. Set CXX to choose the compiler.
+set -e
+
+root="$(cd "$(dirname "$0")" && pwd)"
+target_dir="$root/debug"
+tt="$root/triple_temperature_uno"
+mocks="$root/tests/mocks"
+
+mkdir -p "$target_dir"
+
+${CXX:-c++} -std=c++17 -O2 -Wall \
+    -I "$tt" -I "$mocks" \
+    "$root/scenarios/main.cpp" "$root/scenarios/scenario.cpp" "$root/scenarios/scenario_bus.cpp" \
+    "$root/scenarios/scenario_runner.cpp" \
+    "$tt/sensor_mcp_9808.cpp" "$tt/interval_timer.cpp" "$tt/sample_cache.cpp" "$tt/temperature_sampler.cpp" \
+    "$mocks/Arduino.cpp" "$mocks/Wire.cpp" "$mocks/virtual_clock.cpp" \
+    "$mocks/i2c_bus_model.cpp" "$mocks/i2c_fault_model.cpp" "$mocks/mcp9808_model.cpp" \
+    -o "$target_dir/scenario_runner"
+
+echo "Built $target_dir/scenario_runner"
+
+${CXX:-c++} -std=c++17 -O2 -Wall \
+    -I "$tt" -I "$mocks" \
+    "$root/scenarios/firmware_run.cpp" "$root/scenarios/scenario.cpp" "$root/scenarios/scenario_bus.cpp" \
+    "$tt"/*.cpp \
+    "$mocks"/*.cpp \
+    -o "$target_dir/firmware_run"
+
+echo "Built $target_dir/firmware_run"
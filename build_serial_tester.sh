@@ -0,0 +1,18 @@
+#!/bin/sh
+# Builds the serial tester for Linux into debug/. Set CXX to choose the compiler.
+set -e
+
+root="$(cd "$(dirname "$0")" && pwd)"
+target_dir="$root/debug"
+tester="$root/serial_tester_windows"
+target="serial_tester"
+
+mkdir -p "$target_dir"
+
+${CXX:-c++} -std=c++17 -O2 -Wall \
+    -I "$root/triple_temperature_uno" \
+    "$tester"/*.cpp \
+    "$root/triple_temperature_uno/history_buffer.cpp" "$root/triple_temperature_uno/message_frame.cpp" \
+    -o "$target_dir/$target"
+
+echo "Built $target_dir/$target"
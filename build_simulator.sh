@@ -0,0 +1,19 @@
+#!/bin/sh
+# Builds the host simulator into debug/. Set CXX to choose the compiler.
+set -e
+
+root="$(cd "$(dirname "$0")" && pwd)"
+target_dir="$root/debug"
+tt="$root/triple_temperature_uno"
+target="triple_temperature_sim"
+
+mkdir -p "$target_dir"
+
+${CXX:-c++} -std=c++17 -O2 -Wall \
+    -I "$tt" -I "$root/tests/mocks" \
+    "$tt"/*.cpp \
+    "$root"/tests/mocks/*.cpp \
+    "$root"/simulator/*.cpp \
+    -o "$target_dir/$target"
+
+echo "Built $target_dir/$target"
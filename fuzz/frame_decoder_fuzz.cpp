@@ -0,0 +1,236 @@
+///
+/// @file
+///
+/// Fuzz target for FrameDecoder. Each input is decoded in one push, and again split into chunks at sizes taken from
+/// the first bytes of the input. Both must give the same frames and discard counts, every frame must have a good
+/// CRC, and every input byte must end up in a frame, discarded, or pending.
+///
+/// Built for libFuzzer with clang's -fsanitize=fuzzer. Without it, FRAME_DECODER_FUZZ_MAIN adds a main that runs the
+/// target on files given on the command line, or on random inputs, for use with the address and undefined behavior
+/// sanitizers of any compiler.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "frame_decoder.h"
+
+namespace
+{
+    struct DecodedFrame
+    {
+        std::vector<uint8_t> bytes;
+        uint8_t identifier;
+        bool has_request_id;
+        uint8_t request_id;
+
+        bool operator==(const DecodedFrame &other) const
+        {
+            return bytes == other.bytes && identifier == other.identifier &&
+                   has_request_id == other.has_request_id && request_id == other.request_id;
+        }
+    };
+
+    DecodedFrame copy_frame(const Frame &frame)
+    {
+        return {{frame.data, frame.data + frame.size}, frame.identifier, frame.has_request_id, frame.request_id};
+    }
+
+    void check(bool condition, const char *message)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "Frame decoder invariant failed: %s\n", message);
+            std::abort();
+        }
+    }
+
+    void check_frame(const Frame &frame)
+    {
+        using namespace scottz0r::temperature;
+
+        check(frame.size >= FRAME_OVERHEAD && frame.size <= FrameDecoder::MAX_FRAME_SIZE, "frame size");
+        check(frame.data[0] == FRAME_START, "start byte");
+        check(frame.data[FRAME_LENGTH_INDEX] + FRAME_OVERHEAD == frame.size, "length");
+        check((frame.data[FRAME_TYPE_INDEX] & 0x7F) == frame.identifier, "identifier");
+        check(((frame.data[FRAME_TYPE_INDEX] & 0x80) != 0) == frame.has_request_id, "request ID flag");
+        check(frame.payload == frame.data + FRAME_PAYLOAD_INDEX, "payload");
+
+        // A flagged frame with an empty payload has no room for its request ID, and keeps the whole payload.
+        const bool id_in_payload = frame.has_request_id && frame.data[FRAME_LENGTH_INDEX] > 0;
+        check(frame.payload_size + (id_in_payload ? 1 : 0) == frame.data[FRAME_LENGTH_INDEX], "payload size");
+        check(!id_in_payload || frame.data[frame.size - 2] == frame.request_id, "request ID");
+        check(crc8(frame.data + 1, frame.size - 2) == frame.data[frame.size - 1], "CRC");
+    }
+
+    /// @brief Decode data in chunks. chunk_sizes is used in a cycle, and a chunk size of 0 is taken as 1.
+    size_t decode(
+        FrameDecoder &decoder, const uint8_t *data, size_t size, const uint8_t *chunk_sizes, size_t chunk_count,
+        std::vector<DecodedFrame> &frames)
+    {
+        size_t frame_bytes = 0;
+        size_t position = 0;
+
+        for (size_t chunk = 0; position < size; ++chunk)
+        {
+            size_t n = chunk_count == 0 ? size : chunk_sizes[chunk % chunk_count] + 1;
+            n = n < size - position ? n : size - position;
+
+            size_t consumed = decoder.push(data + position, n, [&](const Frame &frame) {
+                check_frame(frame);
+                frames.push_back(copy_frame(frame));
+                frame_bytes += frame.size;
+                return true;
+            });
+
+            check(consumed == n, "consumed every byte");
+            position += n;
+        }
+
+        return frame_bytes;
+    }
+} // namespace
+
+static uint64_t total_frames = 0;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    // The first byte says how many of the following bytes are chunk sizes.
+    size_t chunk_count = size > 0 ? data[0] % 16 : 0;
+    chunk_count = chunk_count < size ? chunk_count : (size > 0 ? size - 1 : 0);
+    const uint8_t *chunk_sizes = data + (size > 0 ? 1 : 0);
+    const uint8_t *stream = chunk_sizes + chunk_count;
+    const size_t stream_size = size - (stream - data);
+
+    FrameDecoder whole;
+    std::vector<DecodedFrame> whole_frames;
+    size_t whole_bytes = decode(whole, stream, stream_size, nullptr, 0, whole_frames);
+
+    check(whole.frames() == whole_frames.size(), "frame count");
+    total_frames += whole_frames.size();
+    check(whole_bytes + whole.discarded_bytes() + whole.pending() == stream_size, "byte accounting");
+
+    FrameDecoder chunked;
+    std::vector<DecodedFrame> chunked_frames;
+    size_t chunked_bytes = decode(chunked, stream, stream_size, chunk_sizes, chunk_count, chunked_frames);
+
+    check(chunked_frames == whole_frames, "same frames in chunks");
+    check(chunked.discarded_bytes() == whole.discarded_bytes(), "same discards in chunks");
+    check(chunked.pending() == whole.pending(), "same pending in chunks");
+    check(chunked_bytes + chunked.discarded_bytes() + chunked.pending() == stream_size, "byte accounting in chunks");
+
+    // A handler that stops after each frame must see the same frames when the rest is pushed again.
+    FrameDecoder stopping;
+    std::vector<DecodedFrame> stopping_frames;
+    auto stop_after_frame = [&](const Frame &frame) {
+        stopping_frames.push_back(copy_frame(frame));
+        return false;
+    };
+
+    size_t position = 0;
+    while (position < stream_size)
+    {
+        position += stopping.push(stream + position, stream_size - position, stop_after_frame);
+    }
+
+    // Frames still in the pending buffer are returned by later pushes, even empty ones.
+    for (;;)
+    {
+        size_t count = stopping_frames.size();
+        stopping.push(nullptr, 0, stop_after_frame);
+        if (stopping_frames.size() == count)
+        {
+            break;
+        }
+    }
+
+    check(stopping_frames == whole_frames, "same frames when stopping");
+
+    return 0;
+}
+
+#ifdef FRAME_DECODER_FUZZ_MAIN
+static bool run_file(const char *path)
+{
+    FILE *file = std::fopen(path, "rb");
+    if (!file)
+    {
+        std::perror(path);
+        return false;
+    }
+
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+
+    std::fclose(file);
+    LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (!run_file(argv[i]))
+            {
+                return 1;
+            }
+        }
+
+        std::printf("Ran %d inputs\n", argc - 1);
+        return 0;
+    }
+
+    // Random inputs of valid messages mixed with random bytes, so that frames are found as well as discarded.
+    std::srand(1);
+    std::vector<uint8_t> input;
+    const int runs = 200000;
+    for (int run = 0; run < runs; ++run)
+    {
+        input.clear();
+        input.push_back(static_cast<uint8_t>(std::rand()));
+        size_t size = std::rand() % 512;
+        while (input.size() < size)
+        {
+            if (std::rand() % 4 != 0)
+            {
+                input.push_back(static_cast<uint8_t>(std::rand()));
+                continue;
+            }
+
+            using namespace scottz0r::temperature;
+
+            // The decoder only frames messages, so any type and payload will do.
+            uint8_t frame[FrameDecoder::MAX_FRAME_SIZE];
+            const size_type payload_size = std::rand() % (FRAME_MAX_PAYLOAD + 1);
+            frame[FRAME_TYPE_INDEX] = static_cast<uint8_t>(std::rand());
+            for (size_type i = 0; i < payload_size; ++i)
+            {
+                frame[FRAME_PAYLOAD_INDEX + i] = static_cast<uint8_t>(std::rand());
+            }
+
+            const size_t frame_size = frame_seal(frame, payload_size);
+            const size_t begin = input.size();
+            input.insert(input.end(), frame, frame + frame_size);
+
+            // Truncate some, so that frames also start inside other frames.
+            if (std::rand() % 8 == 0)
+            {
+                input.resize(begin + std::rand() % frame_size);
+            }
+        }
+
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+
+    std::printf("Ran %d random inputs, %llu frames\n", runs, static_cast<unsigned long long>(total_frames));
+    return 0;
+}
+#endif
@@ -0,0 +1,247 @@
+///
+/// @file
+///
+/// Runs the whole firmware, setup() and loop() from prj_core, in virtual time against a fault-injection scenario's
+/// sensors, with a host sending a steady mix of requests. The watchdog is emulated on the virtual clock, so a loop
+/// path that would reset the board is caught on the host, with what the pass spent its time on. Exits with 1 if the
+/// watchdog would have expired.
+#include "scenario.h"
+#include "scenario_bus.h"
+
+#include <Arduino.h>
+#include <HardwareSerial.h>
+#include <Wire.h>
+#include <avr/wdt.h>
+#include <message_frame.h>
+#include <message_reader.h>
+#include <virtual_clock.h>
+#include <virtual_serial.h>
+#include <watchdog_emulator.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+void setup();
+void loop();
+
+using namespace scottz0r::scenario;
+using namespace scottz0r::temperature;
+
+namespace
+{
+    struct HostRequest
+    {
+        const char *name;
+        std::vector<uint8_t> frame;
+    };
+
+    void print_usage(const char *name)
+    {
+        std::printf("Usage: %s FILE [options]\n"
+                    "  --duration S      Virtual seconds to run. Overrides the file.\n"
+                    "  --seed N          Random seed. Overrides the file.\n"
+                    "  --interval MS     Virtual milliseconds between host requests. Default 50.\n"
+                    "  --baud RATE       Switch the link to this rate before the other requests.\n",
+                    name);
+    }
+
+    /// @brief Frame a request with no request ID.
+    std::vector<uint8_t> make_request(RequestType type, bool has_argument = false, uint16_t argument = 0)
+    {
+        std::vector<uint8_t> frame(FRAME_PAYLOAD_INDEX);
+        frame.push_back(static_cast<uint8_t>(type));
+        if (has_argument)
+        {
+            frame.push_back(static_cast<uint8_t>(argument));
+            frame.push_back(static_cast<uint8_t>(argument >> 8));
+        }
+
+        size_type payload_size = static_cast<size_type>(frame.size() - FRAME_PAYLOAD_INDEX);
+        frame.push_back(0);
+
+        frame[FRAME_TYPE_INDEX] = 0x04;
+        frame_seal(frame.data(), payload_size);
+        return frame;
+    }
+
+    /// @brief Spend label with the sensor index added to I2C addresses, like "I2C 0x18 (sensor 0) timeout".
+    std::string describe(const std::string &label)
+    {
+        for (size_t i = 0; i < sensor_count; ++i)
+        {
+            char prefix[16];
+            std::snprintf(prefix, sizeof(prefix), "I2C 0x%02X", ScenarioBus::address(i));
+            if (label.compare(0, std::strlen(prefix), prefix) == 0)
+            {
+                return std::string(prefix) + " (sensor " + std::to_string(i) + ")" + label.substr(std::strlen(prefix));
+            }
+        }
+
+        return label;
+    }
+
+    void print_gap(const WatchdogGap &gap)
+    {
+        std::printf("  %.3f ms from %.3f s\n", gap.length / 1000.0, gap.start / 1000000.0);
+
+        for (const std::string &text : gap.notes)
+        {
+            std::printf("  during %s\n", text.c_str());
+        }
+
+        std::vector<std::pair<std::string, uint64_t>> spent = gap.spent;
+        std::stable_sort(spent.begin(), spent.end(),
+                         [](const std::pair<std::string, uint64_t> &a, const std::pair<std::string, uint64_t> &b) {
+                             return a.second > b.second;
+                         });
+
+        for (const auto &item : spent)
+        {
+            std::printf("  %10.3f ms  %s\n", item.second / 1000.0, describe(item.first).c_str());
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || std::strcmp(argv[1], "--help") == 0)
+    {
+        print_usage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+
+    std::ifstream file(argv[1]);
+    if (!file)
+    {
+        std::fprintf(stderr, "Cannot open %s.\n", argv[1]);
+        return 1;
+    }
+
+    Scenario scenario;
+    std::string error;
+    if (!parse_scenario(file, scenario, error))
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+        return 1;
+    }
+
+    unsigned long interval = 50;
+    unsigned long baud = 0;
+
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        const char *arg = argv[i];
+        const char *value = argv[i + 1];
+        if (std::strcmp(arg, "--duration") == 0)
+        {
+            scenario.duration = static_cast<unsigned long>(std::atof(value) * 1000.0);
+        }
+        else if (std::strcmp(arg, "--seed") == 0)
+        {
+            scenario.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }
+        else if (std::strcmp(arg, "--interval") == 0)
+        {
+            interval = std::strtoul(value, nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--baud") == 0)
+        {
+            baud = std::strtoul(value, nullptr, 10);
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (argc % 2 != 0 || interval == 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    VirtualClock clock;
+    clock.set_loop_cost(scenario.loop_time);
+    arduino_impl = &clock;
+
+    VirtualSerial serial(clock);
+    serial_impl = &serial;
+
+    ScenarioBus sensor_bus(scenario, clock);
+    wire_impl = &sensor_bus.bus();
+
+    WatchdogEmulator watchdog(clock);
+    wdt_impl = &watchdog;
+
+    // A history download sends the whole history, one message per loop pass, and is the longest reply.
+    const std::vector<HostRequest> mix = {
+        {"Temperature", make_request(RequestType::Temperature)},
+        {"SystemStatus", make_request(RequestType::SystemStatus)},
+        {"Diagnostics", make_request(RequestType::Diagnostics)},
+        {"HistoryDownload", make_request(RequestType::HistoryDownload, true, 0)},
+    };
+
+    const HostRequest baud_request = {"SetBaudRate",
+                                      make_request(RequestType::SetBaudRate, true, static_cast<uint16_t>(baud / 100))};
+    const size_t first_mix = baud != 0 ? 1 : 0;
+
+    setup();
+
+    // Each request is noted in the gap where its last byte arrives, since the firmware can act on it from then.
+    size_t sent = 0;
+    uint64_t next_send = clock.now();
+    const char *arriving = nullptr;
+    unsigned long loops = 0;
+
+    while (clock.millis() < scenario.duration)
+    {
+        if (clock.now() >= next_send)
+        {
+            const HostRequest &request = sent < first_mix ? baud_request : mix[(sent - first_mix) % mix.size()];
+            serial.send(request.frame);
+            arriving = request.name;
+            next_send = clock.now() + interval * 1000;
+            ++sent;
+        }
+
+        if (arriving && clock.now() >= serial.send_done())
+        {
+            watchdog.note(std::string("request ") + arriving);
+            arriving = nullptr;
+        }
+
+        loop();
+        serial.take_output();
+        clock.end_loop();
+        ++loops;
+    }
+
+    watchdog.finish();
+
+    std::printf("%.0f virtual seconds, %lu loop passes, %zu requests, %llu watchdog resets, %.0f ms timeout.\n",
+                scenario.duration / 1000.0, loops, sent, static_cast<unsigned long long>(watchdog.resets()),
+                watchdog.window() / 1000.0);
+    std::printf("%llu I2C transactions, %llu timed out. %lu serial bytes overrun, %.3f s blocked writing.\n\n",
+                static_cast<unsigned long long>(sensor_bus.bus().transactions()),
+                static_cast<unsigned long long>(sensor_bus.bus().timeouts()), serial.overruns(),
+                serial.blocked_time() / 1000000.0);
+
+    std::printf("Longest gap between watchdog resets:\n");
+    print_gap(watchdog.worst_gap());
+
+    if (watchdog.expiries() == 0)
+    {
+        std::printf("\nNo gap reached the timeout.\n");
+        return 0;
+    }
+
+    std::printf("\n%lu gaps reached the timeout. The first, up to the timeout:\n", watchdog.expiries());
+    print_gap(watchdog.first_expiry());
+    return 1;
+}
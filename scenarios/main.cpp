@@ -0,0 +1,139 @@
+///
+/// @file
+///
+/// Runs a fault-injection scenario against the firmware's sensor driver and vote engine in virtual time, and reports
+/// how often the vote is OK, Disagree and SensorError at each tolerance. Used to tune CFG_TEMPERATURE_TOLERANCE
+/// offline.
+#include "scenario.h"
+#include "scenario_runner.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace scottz0r::scenario;
+
+namespace
+{
+    void print_usage(const char *name)
+    {
+        std::printf(
+            "Usage: %s FILE [options]\n"
+            "  --tolerance LIST  Comma separated vote tolerances in hundredths of a degree. Overrides the file.\n"
+            "  --seed N          Random seed. Overrides the file.\n"
+            "  --duration S      Virtual seconds to run. Overrides the file.\n",
+            name);
+    }
+
+    double percent(unsigned long count, unsigned long total)
+    {
+        return total == 0 ? 0.0 : 100.0 * count / total;
+    }
+
+    void print_report(const Scenario &scenario, const ScenarioReport &report, double seconds)
+    {
+        std::printf("%.0f virtual seconds in %.2f s, %lu samples, %llu I2C transactions, %llu timed out.\n\n",
+                    scenario.duration / 1000.0, seconds, report.samples,
+                    static_cast<unsigned long long>(report.transactions),
+                    static_cast<unsigned long long>(report.timeouts));
+
+        std::printf("%-8s %-8s %10s %10s %12s\n", "sensor", "setup", "invalid", "nacks", "short_reads");
+        for (size_t i = 0; i < sensor_count; ++i)
+        {
+            std::printf("%-8zu %-8s %10lu %10lu %12lu\n", i, report.is_setup_failed[i] ? "failed" : "ok",
+                        report.invalid[i], report.nacks[i], report.short_reads[i]);
+        }
+
+        std::printf("\n%-10s %8s %10s %12s %10s %10s %12s", "tolerance", "ok%", "disagree%", "sensor_err%", "mean_err",
+                    "max_err", "max_outage");
+        for (size_t i = 0; i < sensor_count; ++i)
+        {
+            std::printf("  outvoted%zu%%", i);
+        }
+
+        std::printf("\n");
+
+        for (const ToleranceReport &tolerance : report.tolerances)
+        {
+            using scottz0r::temperature::TemperatureVoteStatus;
+            unsigned long ok = tolerance.status_counts[static_cast<size_t>(TemperatureVoteStatus::OK)];
+            unsigned long disagree = tolerance.status_counts[static_cast<size_t>(TemperatureVoteStatus::Disagree)];
+            unsigned long error = tolerance.status_counts[static_cast<size_t>(TemperatureVoteStatus::SensorError)];
+
+            std::printf("%-10.2f %8.2f %10.2f %12.2f %10.3f %10.3f %11.2fs", tolerance.tolerance / 100.0,
+                        percent(ok, report.samples), percent(disagree, report.samples),
+                        percent(error, report.samples), ok == 0 ? 0.0 : tolerance.error_total / ok,
+                        tolerance.error_max, tolerance.outage_max / 1000.0);
+            for (size_t i = 0; i < sensor_count; ++i)
+            {
+                std::printf("  %10.2f", percent(tolerance.outvoted[i], report.samples));
+            }
+
+            std::printf("\n");
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || std::strcmp(argv[1], "--help") == 0)
+    {
+        print_usage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+
+    std::ifstream file(argv[1]);
+    if (!file)
+    {
+        std::fprintf(stderr, "Cannot open %s.\n", argv[1]);
+        return 1;
+    }
+
+    Scenario scenario;
+    std::string error;
+    if (!parse_scenario(file, scenario, error))
+    {
+        std::fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+        return 1;
+    }
+
+    // Options are parsed as scenario lines, so they take the same values as the file.
+    for (int i = 2; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool is_option = std::strcmp(arg, "--tolerance") == 0 || std::strcmp(arg, "--seed") == 0 ||
+                         std::strcmp(arg, "--duration") == 0;
+        if (!value || !is_option)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        std::string line = std::string(arg + 2) + " " + value;
+        for (char &c : line)
+        {
+            c = c == ',' ? ' ' : c;
+        }
+
+        std::istringstream option(line);
+        if (!parse_scenario(option, scenario, error))
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        ++i;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ScenarioReport report = run_scenario(scenario);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    print_report(scenario, report, seconds);
+    return 0;
+}
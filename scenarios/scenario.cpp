@@ -0,0 +1,244 @@
+#include "scenario.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace scottz0r
+{
+namespace scenario
+{
+    namespace
+    {
+        constexpr double PI = 3.14159265358979323846;
+
+        bool parse_double(const std::string &token, double &result)
+        {
+            char *end = nullptr;
+            result = std::strtod(token.c_str(), &end);
+            return !token.empty() && *end == '\0' && std::isfinite(result);
+        }
+
+        bool parse_seconds(const std::string &token, unsigned long &result)
+        {
+            double seconds;
+            if (!parse_double(token, seconds) || seconds < 0 || seconds > 4294967.0)
+            {
+                return false;
+            }
+
+            result = static_cast<unsigned long>(std::llround(seconds * 1000.0));
+            return true;
+        }
+
+        bool parse_chance(std::string token, double &result)
+        {
+            double scale = 1.0;
+            if (!token.empty() && token.back() == '%')
+            {
+                token.pop_back();
+                scale = 0.01;
+            }
+
+            if (!parse_double(token, result))
+            {
+                return false;
+            }
+
+            result *= scale;
+            return result >= 0.0 && result <= 1.0;
+        }
+
+        bool parse_integer(const std::string &token, long min, long max, long &result)
+        {
+            char *end = nullptr;
+            result = std::strtol(token.c_str(), &end, 10);
+            return !token.empty() && *end == '\0' && result >= min && result <= max;
+        }
+
+        bool parse_window(const std::vector<std::string> &args, size_t first, TimeWindow &result)
+        {
+            return args.size() == first + 2 && parse_seconds(args[first], result.start) &&
+                   parse_seconds(args[first + 1], result.duration);
+        }
+
+        /// @brief Apply one sensor setting. Args start after the sensor index.
+        bool parse_sensor(const std::vector<std::string> &args, SensorFaults &faults)
+        {
+            const std::string &name = args[2];
+            size_t count = args.size() - 3;
+
+            if (name == "offset")
+            {
+                return count == 1 && parse_double(args[3], faults.offset);
+            }
+            else if (name == "noise")
+            {
+                return count == 1 && parse_double(args[3], faults.noise) && faults.noise >= 0;
+            }
+            else if (name == "drift")
+            {
+                return count == 1 && parse_double(args[3], faults.drift);
+            }
+            else if (name == "stuck")
+            {
+                TimeWindow window;
+                if (!parse_window(args, 3, window))
+                {
+                    return false;
+                }
+
+                faults.stuck.push_back(window);
+                return true;
+            }
+            else if (name == "spike")
+            {
+                return count == 2 && parse_chance(args[3], faults.spike_chance) &&
+                       parse_double(args[4], faults.spike_size);
+            }
+            else if (name == "nack")
+            {
+                return count == 1 && parse_chance(args[3], faults.nack_chance);
+            }
+            else if (name == "short_read")
+            {
+                return count == 1 && parse_chance(args[3], faults.short_read_chance);
+            }
+            else if (name == "absent")
+            {
+                faults.is_absent = true;
+                return count == 0;
+            }
+
+            return false;
+        }
+
+        bool parse_line(const std::vector<std::string> &args, Scenario &scenario)
+        {
+            const std::string &name = args[0];
+            size_t count = args.size() - 1;
+
+            if (name == "duration")
+            {
+                return count == 1 && parse_seconds(args[1], scenario.duration);
+            }
+            else if (name == "seed")
+            {
+                long seed;
+                if (count != 1 || !parse_integer(args[1], 0, 0x7FFFFFFF, seed))
+                {
+                    return false;
+                }
+
+                scenario.seed = static_cast<uint32_t>(seed);
+                return true;
+            }
+            else if (name == "loop")
+            {
+                double loop_time;
+                if (count != 1 || !parse_double(args[1], loop_time) || loop_time < 0.001 || loop_time > 1000.0)
+                {
+                    return false;
+                }
+
+                scenario.loop_time = static_cast<uint64_t>(std::llround(loop_time * 1000.0));
+                return true;
+            }
+            else if (name == "ambient")
+            {
+                if (count == 1)
+                {
+                    return parse_double(args[1], scenario.ambient);
+                }
+
+                return count == 3 && parse_double(args[1], scenario.ambient) &&
+                       parse_double(args[2], scenario.swing) && parse_seconds(args[3], scenario.swing_period) &&
+                       scenario.swing_period > 0;
+            }
+            else if (name == "tolerance")
+            {
+                scenario.tolerances.clear();
+                for (size_t i = 1; i < args.size(); ++i)
+                {
+                    long tolerance;
+                    if (!parse_integer(args[i], 0, 0x7FFF, tolerance))
+                    {
+                        return false;
+                    }
+
+                    scenario.tolerances.push_back(static_cast<int16_t>(tolerance));
+                }
+
+                return count > 0;
+            }
+            else if (name == "lockup")
+            {
+                TimeWindow window;
+                if (!parse_window(args, 1, window))
+                {
+                    return false;
+                }
+
+                scenario.lockups.push_back(window);
+                return true;
+            }
+            else if (name == "sensor")
+            {
+                long index;
+                return count >= 2 && parse_integer(args[1], 0, static_cast<long>(sensor_count) - 1, index) &&
+                       parse_sensor(args, scenario.sensors[index]);
+            }
+
+            return false;
+        }
+    } // namespace
+
+    double Scenario::ambient_at(unsigned long now) const
+    {
+        if (swing == 0.0)
+        {
+            return ambient;
+        }
+
+        return ambient + swing * std::sin(2.0 * PI * static_cast<double>(now % swing_period) / swing_period);
+    }
+
+    bool parse_scenario(std::istream &in, Scenario &scenario, std::string &error)
+    {
+        std::string line;
+        int line_number = 0;
+
+        while (std::getline(in, line))
+        {
+            ++line_number;
+
+            size_t comment = line.find('#');
+            if (comment != std::string::npos)
+            {
+                line.erase(comment);
+            }
+
+            std::istringstream tokens(line);
+            std::vector<std::string> args;
+            std::string token;
+            while (tokens >> token)
+            {
+                args.push_back(token);
+            }
+
+            if (args.empty())
+            {
+                continue;
+            }
+
+            if (!parse_line(args, scenario))
+            {
+                error = "Line " + std::to_string(line_number) + ": bad " + args[0] + " setting.";
+                return false;
+            }
+        }
+
+        return true;
+    }
+} // namespace scenario
+} // namespace scottz0r
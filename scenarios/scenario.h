@@ -0,0 +1,115 @@
+///
+/// @file
+///
+/// Fault-injection scenarios for the simulated sensors, and the text format they are written in.
+#ifndef _SCOTTZ0R_SCENARIO_SCENARIO_INCLUDE_GUARD
+#define _SCOTTZ0R_SCENARIO_SCENARIO_INCLUDE_GUARD
+
+#include <temperature_sampler.h>
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace scottz0r
+{
+namespace scenario
+{
+    constexpr size_t sensor_count = temperature::TemperatureSampler::sensor_count;
+
+    /// @brief Span of virtual time. Milliseconds.
+    struct TimeWindow
+    {
+        unsigned long start;
+        unsigned long duration;
+
+        bool contains(unsigned long now) const
+        {
+            return now - start < duration;
+        }
+    };
+
+    /// @brief Faults layered onto one simulated sensor.
+    struct SensorFaults
+    {
+        /// @brief Fixed error added to every conversion. Celsius.
+        double offset = 0.0;
+
+        /// @brief Standard deviation of noise added to each conversion. Celsius.
+        double noise = 0.0;
+
+        /// @brief Error added per hour from the start of the run. Celsius.
+        double drift = 0.0;
+
+        /// @brief Windows where conversions repeat the last value from before the window.
+        std::vector<TimeWindow> stuck;
+
+        /// @brief Chance from 0 to 1 that a conversion is off by spike_size, either way.
+        double spike_chance = 0.0;
+        double spike_size = 0.0;
+
+        /// @brief Chance from 0 to 1 that a transaction is NACKed, or that a read comes back short.
+        double nack_chance = 0.0;
+        double short_read_chance = 0.0;
+
+        /// @brief The sensor is not on the bus.
+        bool is_absent = false;
+    };
+
+    /// @brief Conditions for one run of the sensors and the vote engine.
+    struct Scenario
+    {
+        /// @brief Virtual time to run for. Milliseconds.
+        unsigned long duration = 3600000;
+
+        /// @brief Seed of every random fault, so runs repeat.
+        uint32_t seed = 1;
+
+        /// @brief Virtual time of one firmware loop pass, besides its I2C transaction. Each pass does at most one.
+        /// Microseconds.
+        uint64_t loop_time = 1000;
+
+        /// @brief Temperature every sensor is exposed to, and a sine swing around it. Celsius, and milliseconds.
+        double ambient = 22.5;
+        double swing = 0.0;
+        unsigned long swing_period = 3600000;
+
+        /// @brief Vote tolerances to compare, in hundredths of a degree. Empty runs CFG_TEMPERATURE_TOLERANCE.
+        std::vector<int16_t> tolerances;
+
+        SensorFaults sensors[sensor_count];
+
+        /// @brief Windows where the bus is stuck and every transaction times out.
+        std::vector<TimeWindow> lockups;
+
+        /// @brief Temperature the sensors are exposed to, before faults. Celsius.
+        double ambient_at(unsigned long now) const;
+    };
+
+    /// @brief Read a scenario. Each line is one setting, and # starts a comment. Times are in seconds, except the loop
+    /// time in milliseconds, and may have a fraction. Chances are from 0 to 1, or a percentage when followed by %.
+    /// Settings not given keep their defaults.
+    ///
+    ///     duration SECONDS
+    ///     seed N
+    ///     loop MILLISECONDS
+    ///     ambient CELSIUS [SWING_CELSIUS PERIOD_SECONDS]
+    ///     tolerance HUNDREDTHS [HUNDREDTHS ...]
+    ///     lockup START DURATION
+    ///     sensor I offset CELSIUS
+    ///     sensor I noise CELSIUS
+    ///     sensor I drift CELSIUS_PER_HOUR
+    ///     sensor I stuck START DURATION
+    ///     sensor I spike CHANCE CELSIUS
+    ///     sensor I nack CHANCE
+    ///     sensor I short_read CHANCE
+    ///     sensor I absent
+    ///
+    /// @param error Set to the line number and problem on failure.
+    /// @return False if a line is not understood.
+    bool parse_scenario(std::istream &in, Scenario &scenario, std::string &error);
+} // namespace scenario
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_SCENARIO_SCENARIO_INCLUDE_GUARD
@@ -0,0 +1,93 @@
+#include "scenario_bus.h"
+
+#include <random>
+
+namespace scottz0r
+{
+namespace scenario
+{
+    namespace
+    {
+        /// @brief Temperature source of one sensor model: the ambient temperature with the sensor's faults added.
+        class FaultySource
+        {
+        public:
+            FaultySource(const Scenario &scenario, const SensorFaults &faults, uint32_t seed)
+                : m_scenario(scenario), m_faults(faults), m_random(seed), m_last(scenario.ambient), m_has_last(false)
+            {
+            }
+
+            double operator()(unsigned long now)
+            {
+                // A stuck sensor repeats its last conversion from before the window.
+                for (const TimeWindow &window : m_faults.stuck)
+                {
+                    if (window.contains(now) && m_has_last)
+                    {
+                        return m_last;
+                    }
+                }
+
+                double value = m_scenario.ambient_at(now) + m_faults.offset + m_faults.drift * now / 3600000.0;
+
+                if (m_faults.noise > 0.0)
+                {
+                    value += m_faults.noise * m_normal(m_random);
+                }
+
+                if (m_faults.spike_chance > 0.0 && m_uniform(m_random) < m_faults.spike_chance)
+                {
+                    value += (m_random() & 1) ? m_faults.spike_size : -m_faults.spike_size;
+                }
+
+                m_last = value;
+                m_has_last = true;
+                return value;
+            }
+
+        private:
+            const Scenario &m_scenario;
+            const SensorFaults &m_faults;
+            std::mt19937 m_random;
+            std::normal_distribution<double> m_normal;
+            std::uniform_real_distribution<double> m_uniform;
+            double m_last;
+            bool m_has_last;
+        };
+    } // namespace
+
+    ScenarioBus::ScenarioBus(const Scenario &scenario, VirtualClock &clock)
+    {
+        for (const TimeWindow &lockup : scenario.lockups)
+        {
+            m_bus.add_lockup(lockup.start, lockup.duration);
+        }
+
+        m_bus.set_clock(&clock);
+
+        for (size_t i = 0; i < sensor_count; ++i)
+        {
+            const SensorFaults &faults = scenario.sensors[i];
+            uint32_t seed = scenario.seed + 2 * static_cast<uint32_t>(i);
+
+            m_models.emplace_back(address(i), scenario.ambient);
+            m_models.back().set_temperature_source(FaultySource(scenario, faults, seed));
+
+            m_faults.emplace_back(m_models.back(), seed + 1);
+            m_faults.back().set_nack_chance(faults.nack_chance);
+            m_faults.back().set_short_read_chance(faults.short_read_chance);
+
+            if (!faults.is_absent)
+            {
+                m_bus.attach(m_faults.back());
+            }
+        }
+    }
+
+    uint8_t ScenarioBus::address(size_t sensor)
+    {
+        static const uint8_t addresses[] = CFG_SENSOR_ADDRESSES;
+        return addresses[sensor];
+    }
+} // namespace scenario
+} // namespace scottz0r
@@ -0,0 +1,58 @@
+///
+/// @file
+///
+/// The simulated sensors of a fault-injection scenario.
+#ifndef _SCOTTZ0R_SCENARIO_SCENARIO_BUS_INCLUDE_GUARD
+#define _SCOTTZ0R_SCENARIO_SCENARIO_BUS_INCLUDE_GUARD
+
+#include "scenario.h"
+
+#include <i2c_fault_model.h>
+#include <mcp9808_model.h>
+#include <virtual_clock.h>
+
+#include <deque>
+
+namespace scottz0r
+{
+namespace scenario
+{
+    /// @brief I2C bus with a scenario's sensors on it, at the firmware's sensor addresses. Each sensor model is exposed
+    /// to the scenario's ambient temperature with that sensor's faults added, and sits behind a fault layer for its
+    /// NACKs and short reads. Absent sensors are left off the bus. The bus has the scenario's lockups and spends
+    /// transaction time on the clock.
+    ///
+    /// Each sensor's faults have their own generators, so changing one sensor's faults leaves the others alone.
+    class ScenarioBus
+    {
+    public:
+        /// @param scenario Must outlive this object.
+        /// @param clock Must be arduino_impl already, since the sensor models read millis() when created.
+        ScenarioBus(const Scenario &scenario, VirtualClock &clock);
+
+        ScenarioBus(const ScenarioBus &) = delete;
+
+        ScenarioBus &operator=(const ScenarioBus &) = delete;
+
+        /// @brief I2C address of a sensor.
+        static uint8_t address(size_t sensor);
+
+        I2cBusModel &bus()
+        {
+            return m_bus;
+        }
+
+        const I2cFaultModel &faults(size_t sensor) const
+        {
+            return m_faults[sensor];
+        }
+
+    private:
+        I2cBusModel m_bus;
+        std::deque<Mcp9808Model> m_models;
+        std::deque<I2cFaultModel> m_faults;
+    };
+} // namespace scenario
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_SCENARIO_SCENARIO_BUS_INCLUDE_GUARD
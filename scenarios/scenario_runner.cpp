@@ -0,0 +1,162 @@
+#include "scenario_runner.h"
+#include "scenario_bus.h"
+
+#include <Arduino.h>
+#include <interval_timer.h>
+#include <sample_cache.h>
+#include <sensor_mcp_9808.h>
+#include <temperature_engine.h>
+#include <temperature_sampler.h>
+#include <virtual_clock.h>
+
+#include <cmath>
+
+namespace scottz0r
+{
+namespace scenario
+{
+    namespace
+    {
+        using namespace temperature;
+
+        /// @brief Tally one sample's readings at every tolerance.
+        void tally(const Scenario &scenario, const std::vector<TemperatureVoteEngine> &engines,
+                   const TemperatureReading (&readings)[sensor_count], unsigned long now,
+                   std::vector<unsigned long> &last_ok, ScenarioReport &report)
+        {
+            double ambient = scenario.ambient_at(now);
+
+            for (size_t i = 0; i < engines.size(); ++i)
+            {
+                ToleranceReport &tolerance = report.tolerances[i];
+
+                TemperatureVoteResult result;
+                engines[i].vote_temperature(readings, result);
+                ++tolerance.status_counts[static_cast<size_t>(result.status)];
+
+                for (size_t sensor = 0; sensor < sensor_count; ++sensor)
+                {
+                    if (readings[sensor].is_valid && !result.is_agree(sensor))
+                    {
+                        ++tolerance.outvoted[sensor];
+                    }
+                }
+
+                if (result.status == TemperatureVoteStatus::OK)
+                {
+                    double error = std::fabs(result.average / 100.0 - ambient);
+                    tolerance.error_total += error;
+                    tolerance.error_max = error > tolerance.error_max ? error : tolerance.error_max;
+
+                    unsigned long gap = now - last_ok[i];
+                    tolerance.outage_max = gap > tolerance.outage_max ? gap : tolerance.outage_max;
+                    last_ok[i] = now;
+                }
+            }
+        }
+    } // namespace
+
+    ScenarioReport run_scenario(const Scenario &scenario)
+    {
+        ScenarioReport report;
+
+        std::vector<int16_t> tolerances = scenario.tolerances;
+        if (tolerances.empty())
+        {
+            tolerances.push_back(CFG_TEMPERATURE_TOLERANCE);
+        }
+
+        std::vector<TemperatureVoteEngine> engines;
+        report.tolerances.resize(tolerances.size());
+        for (size_t i = 0; i < tolerances.size(); ++i)
+        {
+            engines.emplace_back(tolerances[i]);
+            report.tolerances[i].tolerance = tolerances[i];
+        }
+
+        // The sensor models time their conversions with millis(), so the clock comes first.
+        ArduinoImpl *previous_arduino = arduino_impl;
+        TwoWireImpl *previous_wire = wire_impl;
+
+        VirtualClock clock;
+        clock.set_loop_cost(scenario.loop_time);
+        arduino_impl = &clock;
+
+        ScenarioBus sensor_bus(scenario, clock);
+        wire_impl = &sensor_bus.bus();
+
+        // Set up like the firmware: begin every sensor, wait a conversion, then take a sample straight away.
+        const Mcp9808Resolution resolution = static_cast<Mcp9808Resolution>(CFG_SENSOR_RESOLUTION);
+        SensorMcp9808 sensors[sensor_count];
+        for (size_t i = 0; i < sensor_count; ++i)
+        {
+            report.is_setup_failed[i] = !sensors[i].begin(ScenarioBus::address(i), resolution);
+        }
+
+        time_type conversion_time = SensorMcp9808::conversion_time(resolution);
+        IntervalTimer sample_timer(CFG_SAMPLE_PERIOD > conversion_time ? CFG_SAMPLE_PERIOD : conversion_time);
+        delay(conversion_time);
+        sample_timer.reset(millis());
+
+        // The firmware's sampler does the reads and publishes at the configured tolerance. Its readings are then voted
+        // again at every tolerance being compared.
+        TemperatureVoteEngine firmware_engine(CFG_TEMPERATURE_TOLERANCE);
+        SampleCache cache;
+        TemperatureSampler sampler(sensors, firmware_engine, cache);
+        sampler.start();
+
+        std::vector<unsigned long> last_ok(engines.size(), clock.millis());
+
+        // One loop pass polls the sampler like the firmware loop. Time passes by the loop cost and by the I2C
+        // transactions.
+        for (; clock.millis() < scenario.duration; clock.end_loop())
+        {
+            time_type now = clock.millis();
+            if (!sampler.busy())
+            {
+                if (!sample_timer.is_due(now))
+                {
+                    continue;
+                }
+
+                sampler.start();
+            }
+
+            size_type sensor = sampler.sensor_index();
+            bool is_published = sampler.poll(now);
+
+            if (sampler.sensor_index() != sensor)
+            {
+                report.invalid[sensor] += sampler.readings()[sensor].is_valid ? 0 : 1;
+            }
+
+            if (is_published)
+            {
+                ++report.samples;
+                tally(scenario, engines, sampler.readings(), clock.millis(), last_ok, report);
+            }
+        }
+
+        // Time without an OK sample at the end of the run counts too.
+        for (size_t i = 0; i < engines.size(); ++i)
+        {
+            unsigned long gap = clock.millis() - last_ok[i];
+            ToleranceReport &tolerance = report.tolerances[i];
+            tolerance.outage_max = gap > tolerance.outage_max ? gap : tolerance.outage_max;
+        }
+
+        for (size_t i = 0; i < sensor_count; ++i)
+        {
+            report.nacks[i] = sensor_bus.faults(i).nacks();
+            report.short_reads[i] = sensor_bus.faults(i).short_reads();
+        }
+
+        report.transactions = sensor_bus.bus().transactions();
+        report.timeouts = sensor_bus.bus().timeouts();
+
+        arduino_impl = previous_arduino;
+        wire_impl = previous_wire;
+        return report;
+    }
+} // namespace scenario
+} // namespace scottz0r
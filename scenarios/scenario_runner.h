@@ -0,0 +1,60 @@
+///
+/// @file
+///
+/// Runs the firmware's sensor driver and vote engine through a fault-injection scenario in virtual time.
+#ifndef _SCOTTZ0R_SCENARIO_SCENARIO_RUNNER_INCLUDE_GUARD
+#define _SCOTTZ0R_SCENARIO_SCENARIO_RUNNER_INCLUDE_GUARD
+
+#include "scenario.h"
+
+namespace scottz0r
+{
+namespace scenario
+{
+    /// @brief Vote outcomes at one tolerance.
+    struct ToleranceReport
+    {
+        int16_t tolerance = 0;
+
+        /// @brief Samples per TemperatureVoteStatus, indexed by its value.
+        unsigned long status_counts[3] = {};
+
+        /// @brief Samples where a sensor read fine but was left out of the average.
+        unsigned long outvoted[sensor_count] = {};
+
+        /// @brief Distance of the average from the ambient temperature, over OK samples. Celsius.
+        double error_total = 0.0;
+        double error_max = 0.0;
+
+        /// @brief Longest time without an OK sample, counting from setup and to the end of the run.
+        /// Milliseconds of virtual time.
+        unsigned long outage_max = 0;
+    };
+
+    /// @brief Results of one scenario run.
+    struct ScenarioReport
+    {
+        unsigned long samples = 0;
+
+        /// @brief Per sensor: reads that failed, and NACKs and short reads injected.
+        unsigned long invalid[sensor_count] = {};
+        unsigned long nacks[sensor_count] = {};
+        unsigned long short_reads[sensor_count] = {};
+
+        /// @brief Sensors whose setup failed. These read as invalid without touching the bus.
+        bool is_setup_failed[sensor_count] = {};
+
+        uint64_t transactions = 0;
+        uint64_t timeouts = 0;
+
+        std::vector<ToleranceReport> tolerances;
+    };
+
+    /// @brief Run a scenario. The sensors are set up and read through the firmware's MCP 9808 driver, one I2C
+    /// transaction per loop pass, and sampled as often as the firmware does. Every sample's readings are voted on at
+    /// each of the scenario's tolerances, so the tolerances are compared on the same readings.
+    ScenarioReport run_scenario(const Scenario &scenario);
+} // namespace scenario
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_SCENARIO_SCENARIO_RUNNER_INCLUDE_GUARD
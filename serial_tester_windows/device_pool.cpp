@@ -0,0 +1,347 @@
+#ifndef _WIN32
+
+#include "device_pool.h"
+
+#include <cerrno>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "serial_port.h"
+
+using namespace scottz0r::temperature;
+
+static constexpr uint8_t REQUEST_TYPE_TEMPERATURE = 0;
+
+static constexpr int MAX_EVENTS = 64;
+
+struct DevicePool::Device
+{
+    SerialPort port;
+    std::string path;
+    FrameDecoder decoder;
+    DeviceStats stats;
+
+    clock::duration period{};
+
+    bool is_open = false;
+    bool is_waiting = false;
+    uint8_t request_id = 0;
+    clock::time_point sent_at;
+
+    /// @brief Incremented when the device's timer changes, so older timer entries are ignored.
+    uint32_t timer_generation = 0;
+};
+
+DevicePool::DevicePool()
+    : m_epoll_fd(epoll_create1(EPOLL_CLOEXEC)), m_in_flight(0), m_max_in_flight(0),
+      m_timeout(std::chrono::milliseconds(500))
+{
+}
+
+DevicePool::~DevicePool()
+{
+    if (m_epoll_fd >= 0)
+    {
+        close(m_epoll_fd);
+    }
+}
+
+int DevicePool::add_device(const std::string &path, std::chrono::milliseconds period)
+{
+    if (m_epoll_fd < 0)
+    {
+        return -1;
+    }
+
+    std::unique_ptr<Device> device(new Device());
+    device->path = path;
+    device->period = period;
+
+    if (!device->port.open(std::wstring(path.begin(), path.end())))
+    {
+        return -1;
+    }
+
+    const size_t index = m_devices.size();
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = index;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, device->port.native_handle(), &event) != 0)
+    {
+        return -1;
+    }
+
+    device->is_open = true;
+    m_devices.push_back(std::move(device));
+
+    m_ready.push_back(index);
+    return static_cast<int>(index);
+}
+
+void DevicePool::set_max_in_flight(size_t max_in_flight)
+{
+    m_max_in_flight = max_in_flight;
+}
+
+void DevicePool::set_timeout(std::chrono::milliseconds timeout)
+{
+    m_timeout = timeout;
+}
+
+void DevicePool::on_temperature(TemperatureHandler handler)
+{
+    m_on_temperature = std::move(handler);
+}
+
+bool DevicePool::run_for(clock::duration duration)
+{
+    using namespace std::chrono;
+
+    const clock::time_point end = clock::now() + duration;
+    epoll_event events[MAX_EVENTS];
+
+    for (;;)
+    {
+        clock::time_point now = clock::now();
+        run_timers(now);
+        send_ready(now);
+
+        if (now >= end)
+        {
+            return true;
+        }
+
+        // Sleep until the next timer or the end of the run. Round up so a timer is never checked early.
+        clock::time_point wake = end;
+        if (!m_timers.empty() && m_timers.top().time < wake)
+        {
+            wake = m_timers.top().time;
+        }
+
+        auto wait_us = duration_cast<microseconds>(wake - now).count();
+        int wait_ms = static_cast<int>((wait_us + 999) / 1000);
+
+        int n = epoll_wait(m_epoll_fd, events, MAX_EVENTS, wait_ms);
+        if (n < 0 && errno != EINTR)
+        {
+            return false;
+        }
+
+        now = clock::now();
+        for (int i = 0; i < n; ++i)
+        {
+            read_device(static_cast<size_t>(events[i].data.u64), now);
+        }
+    }
+}
+
+const std::string &DevicePool::path(size_t device) const
+{
+    return m_devices[device]->path;
+}
+
+const DeviceStats &DevicePool::stats(size_t device) const
+{
+    return m_devices[device]->stats;
+}
+
+void DevicePool::reset_stats()
+{
+    for (auto &device : m_devices)
+    {
+        device->stats = DeviceStats();
+    }
+}
+
+void DevicePool::handle_frame(size_t index, const Frame &frame, clock::time_point now)
+{
+    Device &device = *m_devices[index];
+
+    // Only replies to the request in flight count. Anything else is a stream message or a late reply.
+    if (!device.is_waiting || !frame.has_request_id || frame.request_id != device.request_id)
+    {
+        return;
+    }
+
+    device.is_waiting = false;
+    --m_in_flight;
+
+    if (frame.identifier == static_cast<uint8_t>(MessageIdentifier::Temperature))
+    {
+        uint64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(now - device.sent_at).count();
+
+        DeviceStats &stats = device.stats;
+        ++stats.replies;
+        stats.latency_total_us += latency_us;
+        stats.latency_min_us = latency_us < stats.latency_min_us ? latency_us : stats.latency_min_us;
+        stats.latency_max_us = latency_us > stats.latency_max_us ? latency_us : stats.latency_max_us;
+
+        TemperatureResult temperature;
+        if (m_on_temperature && decode_temperature_message(frame.payload, frame.payload_size, temperature))
+        {
+            m_on_temperature(index, temperature);
+        }
+    }
+    else
+    {
+        ++device.stats.errors;
+    }
+
+    schedule(index, device.sent_at + device.period, now);
+}
+
+void DevicePool::read_device(size_t index, clock::time_point now)
+{
+    Device &device = *m_devices[index];
+    if (!device.is_open)
+    {
+        return;
+    }
+
+    uint64_t discarded = device.decoder.discarded_bytes();
+
+    uint8_t buffer[256];
+    for (;;)
+    {
+        ssize_t n = read(device.port.native_handle(), buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (n < 0 && errno == EAGAIN)
+        {
+            break;
+        }
+
+        if (n <= 0)
+        {
+            // Hang up or a port error. Leaving the port registered would wake epoll forever.
+            device.stats.discarded_bytes += device.decoder.discarded_bytes() - discarded;
+            fail_device(index);
+            return;
+        }
+
+        device.decoder.push(buffer, static_cast<size_t>(n), [&](const Frame &frame) {
+            handle_frame(index, frame, now);
+            return true;
+        });
+
+        if (static_cast<size_t>(n) < sizeof(buffer))
+        {
+            break;
+        }
+    }
+
+    // The decoder counts from when the port was opened, and stats can be reset since.
+    device.stats.discarded_bytes += device.decoder.discarded_bytes() - discarded;
+}
+
+void DevicePool::run_timers(clock::time_point now)
+{
+    while (!m_timers.empty() && m_timers.top().time <= now)
+    {
+        Timer timer = m_timers.top();
+        m_timers.pop();
+
+        Device &device = *m_devices[timer.device];
+        if (timer.generation != device.timer_generation || !device.is_open)
+        {
+            continue;
+        }
+
+        if (device.is_waiting)
+        {
+            ++device.stats.timeouts;
+            device.is_waiting = false;
+            --m_in_flight;
+
+            // Drop any partial reply so the next one starts clean.
+            device.decoder.reset();
+            schedule(timer.device, device.sent_at + device.period, now);
+        }
+        else
+        {
+            m_ready.push_back(timer.device);
+        }
+    }
+}
+
+void DevicePool::schedule(size_t index, clock::time_point due, clock::time_point now)
+{
+    Device &device = *m_devices[index];
+    ++device.timer_generation;
+
+    if (due <= now)
+    {
+        m_ready.push_back(index);
+    }
+    else
+    {
+        set_timer(index, due);
+    }
+}
+
+void DevicePool::send_ready(clock::time_point now)
+{
+    while (!m_ready.empty() && (m_max_in_flight == 0 || m_in_flight < m_max_in_flight))
+    {
+        size_t index = m_ready.front();
+        m_ready.pop_front();
+
+        Device &device = *m_devices[index];
+        if (!device.is_open)
+        {
+            continue;
+        }
+
+        ++device.request_id;
+
+        uint8_t request[FRAME_OVERHEAD + 2];
+        request[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageIdentifier::Request);
+        request[FRAME_PAYLOAD_INDEX] = REQUEST_TYPE_TEMPERATURE | MESSAGE_REQUEST_ID_FLAG;
+        request[FRAME_PAYLOAD_INDEX + 1] = device.request_id;
+        size_type request_size = frame_seal(request, 2);
+
+        // A request always fits in an idle port's output buffer, so a short write is an error.
+        ssize_t n = write(device.port.native_handle(), request, request_size);
+        if (n != static_cast<ssize_t>(request_size))
+        {
+            ++device.stats.errors;
+            schedule(index, now + m_timeout, now);
+            continue;
+        }
+
+        ++device.stats.requests;
+        device.is_waiting = true;
+        device.sent_at = now;
+        ++m_in_flight;
+
+        ++device.timer_generation;
+        set_timer(index, now + m_timeout);
+    }
+}
+
+void DevicePool::set_timer(size_t index, clock::time_point time)
+{
+    m_timers.push(Timer{time, index, m_devices[index]->timer_generation});
+}
+
+void DevicePool::fail_device(size_t index)
+{
+    Device &device = *m_devices[index];
+
+    ++device.stats.errors;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, device.port.native_handle(), nullptr);
+    device.port.close();
+    device.is_open = false;
+
+    if (device.is_waiting)
+    {
+        device.is_waiting = false;
+        --m_in_flight;
+    }
+}
+
+#endif // _WIN32
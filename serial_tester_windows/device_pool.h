@@ -0,0 +1,134 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "frame_decoder.h"
+#include "triple_temperature.h"
+
+/// @brief Request and reply counters for one device in a DevicePool.
+struct DeviceStats
+{
+    uint64_t requests = 0;
+    uint64_t replies = 0;
+    uint64_t timeouts = 0;
+
+    /// @brief Error replies, failed writes and port errors.
+    uint64_t errors = 0;
+
+    /// @brief Bytes from the device that were not part of a good message.
+    uint64_t discarded_bytes = 0;
+
+    /// @brief Time from sending a request to decoding its reply, for replies that arrived before the timeout.
+    uint64_t latency_total_us = 0;
+    uint64_t latency_min_us = UINT64_MAX;
+    uint64_t latency_max_us = 0;
+
+    double latency_mean_us() const
+    {
+        return replies > 0 ? double(latency_total_us) / double(replies) : 0.0;
+    }
+};
+
+/// @brief Polls many devices for temperatures from one thread. Every port is non-blocking and registered with a single
+/// epoll instance, and reply bytes are decoded as they arrive, so one core can serve hundreds of devices. Each device
+/// has at most one request in flight, tagged with a request ID so a reply that arrives after its timeout is not
+/// mistaken for the next one. POSIX only.
+class DevicePool
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// @brief Called for every temperature reply, with the index of the device.
+    using TemperatureHandler = std::function<void(size_t device, const TemperatureResult &temperature)>;
+
+    DevicePool();
+
+    ~DevicePool();
+
+    DevicePool(const DevicePool &) = delete;
+
+    DevicePool &operator=(const DevicePool &) = delete;
+
+    /// @brief Open a device and start polling it.
+    /// @param path Serial port path.
+    /// @param period Time from one request to the next for this device. Zero sends the next request as soon as the
+    /// reply arrives.
+    /// @return Index of the device, or -1 if the port could not be opened.
+    int add_device(const std::string &path, std::chrono::milliseconds period);
+
+    /// @brief Most requests in flight across all devices. Devices that are due while the limit is reached wait their
+    /// turn round-robin. Zero is no limit, which is the default.
+    void set_max_in_flight(size_t max_in_flight);
+
+    /// @brief Time to wait for a reply before counting a timeout. Default 500ms.
+    void set_timeout(std::chrono::milliseconds timeout);
+
+    void on_temperature(TemperatureHandler handler);
+
+    /// @brief Run the event loop for a while. Requests and replies are only handled while this runs.
+    /// @return False if waiting for events failed.
+    bool run_for(clock::duration duration);
+
+    size_t size() const
+    {
+        return m_devices.size();
+    }
+
+    const std::string &path(size_t device) const;
+
+    const DeviceStats &stats(size_t device) const;
+
+    void reset_stats();
+
+private:
+    struct Device;
+
+    struct Timer
+    {
+        clock::time_point time;
+        size_t device;
+        uint32_t generation;
+
+        bool operator>(const Timer &other) const
+        {
+            return time > other.time;
+        }
+    };
+
+    void handle_frame(size_t index, const Frame &frame, clock::time_point now);
+
+    void read_device(size_t index, clock::time_point now);
+
+    void run_timers(clock::time_point now);
+
+    /// @brief Queue a device for its next request at the given time.
+    void schedule(size_t index, clock::time_point due, clock::time_point now);
+
+    void send_ready(clock::time_point now);
+
+    void set_timer(size_t index, clock::time_point time);
+
+    /// @brief Close a device that failed. It is not polled again.
+    void fail_device(size_t index);
+
+    std::vector<std::unique_ptr<Device>> m_devices;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_timers;
+    std::deque<size_t> m_ready;
+
+    int m_epoll_fd;
+    size_t m_in_flight;
+    size_t m_max_in_flight;
+    clock::duration m_timeout;
+    TemperatureHandler m_on_temperature;
+};
+
+#endif // _WIN32
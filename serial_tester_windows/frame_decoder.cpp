@@ -0,0 +1,96 @@
+#include "frame_decoder.h"
+
+FrameDecoder::FrameDecoder() : m_pending{}, m_pending_begin(0), m_pending_end(0), m_discarded_bytes(0), m_frames(0)
+{
+}
+
+void FrameDecoder::reset()
+{
+    m_pending_begin = 0;
+    m_pending_end = 0;
+}
+
+FrameDecoder::ParseResult FrameDecoder::parse(const uint8_t *data, size_t size)
+{
+    using namespace scottz0r::temperature;
+
+    // frame_parse counts in size_type, and never needs more than one frame of bytes.
+    const size_type limited_size = size < MAX_FRAME_SIZE ? static_cast<size_type>(size) : MAX_FRAME_SIZE;
+
+    size_type frame_size;
+    switch (frame_parse(data, limited_size, FRAME_MAX_PAYLOAD, frame_size))
+    {
+    case FrameStatus::Complete:
+        return {Status::Frame, frame_size};
+    case FrameStatus::Incomplete:
+        return {Status::NeedMore, frame_size};
+    default:
+        return {Status::Discard, 0};
+    }
+}
+
+Frame FrameDecoder::make_frame(const uint8_t *data, size_t size)
+{
+    using namespace scottz0r::temperature;
+
+    Frame frame;
+    frame.identifier = data[FRAME_TYPE_INDEX] & ~MESSAGE_REQUEST_ID_FLAG;
+    frame.has_request_id = (data[FRAME_TYPE_INDEX] & MESSAGE_REQUEST_ID_FLAG) != 0;
+    frame.data = data;
+    frame.size = size;
+    frame.payload = data + FRAME_PAYLOAD_INDEX;
+    frame.payload_size = size - FRAME_OVERHEAD;
+
+    // A reply with a request ID carries it as the last payload byte. An empty payload cannot hold one, so the frame is
+    // passed on without an ID for the caller to reject.
+    frame.request_id = 0;
+    if (frame.has_request_id && frame.payload_size > 0)
+    {
+        --frame.payload_size;
+        frame.request_id = frame.payload[frame.payload_size];
+    }
+
+    return frame;
+}
+
+void FrameDecoder::compact_pending()
+{
+    if (m_pending_begin == 0)
+    {
+        return;
+    }
+
+    size_t size = m_pending_end - m_pending_begin;
+    for (size_t i = 0; i < size; ++i)
+    {
+        m_pending[i] = m_pending[m_pending_begin + i];
+    }
+
+    m_pending_begin = 0;
+    m_pending_end = size;
+}
+
+bool decode_temperature_message(const uint8_t *payload, size_t payload_size, TemperatureResult &dest)
+{
+    const size_t sensor_count = payload_size > 0 ? payload[0] : 0;
+    if (sensor_count < 1 || sensor_count > MAX_SENSOR_COUNT || payload_size < 7 + 2 * sensor_count)
+    {
+        return false;
+    }
+
+    dest.sensor_count = static_cast<unsigned>(sensor_count);
+
+    const size_t agreement_index = 2 + 2 * sensor_count;
+    for (size_t i = 0; i < sensor_count; ++i)
+    {
+        int16_t temp = payload[2 + 2 * i] | (payload[3 + 2 * i] << 8);
+        dest.temps[i] = temp / 100.0;
+        dest.temps_ok[i] = bool(payload[agreement_index] & (1 << i));
+    }
+
+    int16_t average_temp = payload[agreement_index + 1] | (payload[agreement_index + 2] << 8);
+    dest.average = average_temp / 100.0;
+
+    dest.sample_age_ms = payload[agreement_index + 3] | (payload[agreement_index + 4] << 8);
+    return true;
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "message_frame.h"
+#include "triple_temperature.h"
+
+/// @brief A complete message from the device, with a good CRC.
+struct Frame
+{
+    /// @brief Message type without the request ID flag.
+    uint8_t identifier;
+
+    bool has_request_id;
+    uint8_t request_id;
+
+    /// @brief The whole frame, from the start byte through the CRC. Points into the bytes given to push, or into the
+    /// decoder for a message split across pushes, and is valid until the next push.
+    const uint8_t *data;
+    size_t size;
+
+    /// @brief Message fields, without the request ID.
+    const uint8_t *payload;
+    size_t payload_size;
+};
+
+/// @brief Streaming decoder for messages from the device. Bytes are pushed in chunks of any size, such as everything
+/// returned by one large read, and messages are parsed where they lie. Only the start of a message that continues past
+/// the end of a chunk is copied, to be completed by the next push.
+///
+/// Frames are described in message_frame.h. Each candidate frame is checked against its CRC. When a candidate fails,
+/// one byte is discarded and decoding restarts at the next start byte, so the decoder resynchronizes after noise,
+/// dropped bytes or a connection made mid-message.
+class FrameDecoder
+{
+public:
+    static constexpr size_t MAX_FRAME_SIZE =
+        scottz0r::temperature::FRAME_OVERHEAD + scottz0r::temperature::FRAME_MAX_PAYLOAD;
+
+    FrameDecoder();
+
+    /// @brief Decode bytes received from the device.
+    /// @param data Received bytes.
+    /// @param size Number of bytes.
+    /// @param on_frame Called with each complete message, as bool(const Frame &). Return false to stop after this
+    /// message, leaving the rest of the bytes for a later push.
+    /// @return Bytes consumed. Less than size only if on_frame returned false.
+    template <class Handler> size_t push(const uint8_t *data, size_t size, Handler &&on_frame);
+
+    /// @brief Bytes skipped while looking for a message.
+    uint64_t discarded_bytes() const
+    {
+        return m_discarded_bytes;
+    }
+
+    /// @brief Messages decoded.
+    uint64_t frames() const
+    {
+        return m_frames;
+    }
+
+    /// @brief Bytes of a partial message held for the next push.
+    size_t pending() const
+    {
+        return m_pending_end - m_pending_begin;
+    }
+
+    /// @brief Drop a partial message.
+    void reset();
+
+private:
+    enum class Status
+    {
+        Frame,
+        Discard,
+        NeedMore
+    };
+
+    struct ParseResult
+    {
+        Status status;
+
+        /// @brief Frame size, or for NeedMore the fewest bytes that must be added before trying again.
+        size_t size;
+    };
+
+    /// @brief Try to parse a message at the start of the bytes.
+    static ParseResult parse(const uint8_t *data, size_t size);
+
+    static Frame make_frame(const uint8_t *data, size_t size);
+
+    /// @brief Move pending bytes to the front of the pending buffer. Not done while a frame in the buffer may still be
+    /// in use, which is until the next push.
+    void compact_pending();
+
+    uint8_t m_pending[MAX_FRAME_SIZE];
+    size_t m_pending_begin;
+    size_t m_pending_end;
+    uint64_t m_discarded_bytes;
+    uint64_t m_frames;
+};
+
+template <class Handler> size_t FrameDecoder::push(const uint8_t *data, size_t size, Handler &&on_frame)
+{
+    size_t consumed = 0;
+
+    // Finish a message started in an earlier push. Only the bytes it needs are copied.
+    while (m_pending_begin < m_pending_end)
+    {
+        ParseResult result = parse(m_pending + m_pending_begin, m_pending_end - m_pending_begin);
+        if (result.status == Status::NeedMore)
+        {
+            if (consumed == size)
+            {
+                return consumed;
+            }
+
+            compact_pending();
+
+            size_t n = result.size < size - consumed ? result.size : size - consumed;
+            for (size_t i = 0; i < n; ++i)
+            {
+                m_pending[m_pending_end + i] = data[consumed + i];
+            }
+
+            m_pending_end += n;
+            consumed += n;
+        }
+        else if (result.status == Status::Discard)
+        {
+            ++m_discarded_bytes;
+            ++m_pending_begin;
+        }
+        else
+        {
+            ++m_frames;
+            const uint8_t *frame = m_pending + m_pending_begin;
+            m_pending_begin += result.size;
+
+            // Bytes still pending are decoded first by the next push.
+            if (!on_frame(make_frame(frame, result.size)))
+            {
+                return consumed;
+            }
+        }
+    }
+
+    m_pending_begin = 0;
+    m_pending_end = 0;
+
+    // Messages wholly inside the chunk are decoded in place.
+    while (consumed < size)
+    {
+        ParseResult result = parse(data + consumed, size - consumed);
+        if (result.status == Status::NeedMore)
+        {
+            // A need for more bytes means the rest is shorter than one message, so it fits.
+            for (size_t i = consumed; i < size; ++i)
+            {
+                m_pending[m_pending_end] = data[i];
+                ++m_pending_end;
+            }
+
+            return size;
+        }
+
+        if (result.status == Status::Discard)
+        {
+            ++m_discarded_bytes;
+            ++consumed;
+            continue;
+        }
+
+        ++m_frames;
+        const uint8_t *frame = data + consumed;
+        consumed += result.size;
+
+        if (!on_frame(make_frame(frame, result.size)))
+        {
+            return consumed;
+        }
+    }
+
+    return consumed;
+}
+
+/// @brief Decode the fields of a temperature or temperature stream message.
+/// @param payload Message payload, starting with the sensor count.
+/// @param payload_size Payload size, without a request ID. A stream message has one more byte, which is ignored.
+/// @return False if the payload is too small for its sensor count.
+bool decode_temperature_message(const uint8_t *payload, size_t payload_size, TemperatureResult &dest);
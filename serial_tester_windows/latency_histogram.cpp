@@ -0,0 +1,137 @@
+#include "latency_histogram.h"
+
+/// @brief Values below this have a bucket each.
+static constexpr uint64_t LINEAR_LIMIT = 128;
+
+/// @brief Buckets per power of two above LINEAR_LIMIT.
+static constexpr size_t SUB_BUCKETS = LINEAR_LIMIT / 2;
+
+/// @brief Power of two ranges tracked above LINEAR_LIMIT, up to 2^32 us.
+static constexpr size_t RANGES = 25;
+
+static constexpr size_t BUCKET_COUNT = LINEAR_LIMIT + RANGES * SUB_BUCKETS;
+
+LatencyHistogram::LatencyHistogram() : m_buckets(BUCKET_COUNT), m_count(0), m_total(0), m_min(UINT64_MAX), m_max(0)
+{
+}
+
+void LatencyHistogram::record(uint64_t value_us)
+{
+    ++m_buckets[bucket_index(value_us)];
+    ++m_count;
+    m_total += value_us;
+    m_min = value_us < m_min ? value_us : m_min;
+    m_max = value_us > m_max ? value_us : m_max;
+}
+
+void LatencyHistogram::add(const LatencyHistogram &other)
+{
+    for (size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        m_buckets[i] += other.m_buckets[i];
+    }
+
+    m_count += other.m_count;
+    m_total += other.m_total;
+    m_min = other.m_min < m_min ? other.m_min : m_min;
+    m_max = other.m_max > m_max ? other.m_max : m_max;
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.assign(BUCKET_COUNT, 0);
+    m_count = 0;
+    m_total = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the value the percentile falls on, from 1 to count.
+    uint64_t rank = uint64_t(percent / 100.0 * double(m_count) + 0.5);
+    rank = rank < 1 ? 1 : (rank > m_count ? m_count : rank);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+        {
+            uint64_t highest = bucket_highest(i);
+            return highest < m_max ? highest : m_max;
+        }
+    }
+
+    return m_max;
+}
+
+void LatencyHistogram::write_csv(std::ostream &os) const
+{
+    os << "lowest_us,highest_us,count\n";
+
+    for (size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        if (m_buckets[i] > 0)
+        {
+            os << bucket_lowest(i) << ',' << bucket_highest(i) << ',' << m_buckets[i] << '\n';
+        }
+    }
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t value)
+{
+    if (value < LINEAR_LIMIT)
+    {
+        return size_t(value);
+    }
+
+    // Shift the value down until it is in [SUB_BUCKETS, LINEAR_LIMIT). The number of shifts picks the power of two
+    // range, and what is left picks the bucket within it.
+    size_t shift = 0;
+    while (value >= LINEAR_LIMIT)
+    {
+        value >>= 1;
+        ++shift;
+    }
+
+    if (shift > RANGES)
+    {
+        return BUCKET_COUNT - 1;
+    }
+
+    return size_t(LINEAR_LIMIT + (shift - 1) * SUB_BUCKETS + (value - SUB_BUCKETS));
+}
+
+uint64_t LatencyHistogram::bucket_lowest(size_t index)
+{
+    if (index < LINEAR_LIMIT)
+    {
+        return index;
+    }
+
+    size_t shift = (index - LINEAR_LIMIT) / SUB_BUCKETS + 1;
+    uint64_t top = SUB_BUCKETS + (index - LINEAR_LIMIT) % SUB_BUCKETS;
+    return top << shift;
+}
+
+uint64_t LatencyHistogram::bucket_highest(size_t index)
+{
+    if (index < LINEAR_LIMIT)
+    {
+        return index;
+    }
+
+    if (index == BUCKET_COUNT - 1)
+    {
+        return UINT64_MAX;
+    }
+
+    size_t shift = (index - LINEAR_LIMIT) / SUB_BUCKETS + 1;
+    return bucket_lowest(index) + (uint64_t(1) << shift) - 1;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/// @brief Histogram of latencies in microseconds with a fixed relative error, in the style of HdrHistogram.
+///
+/// Values below 128 us each have their own bucket. Above that, every power of two range is split into 64 equal
+/// buckets, so a value is counted in a bucket no wider than 1/64 of its value (about 1.6%). Recording takes a few
+/// shifts and an increment, and the size is fixed no matter how many values are recorded. Values above about 71 minutes
+/// are counted in the last bucket. The minimum, maximum and mean are kept exactly.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value_us);
+
+    /// @brief Add all values recorded in another histogram.
+    void add(const LatencyHistogram &other);
+
+    void reset();
+
+    uint64_t count() const
+    {
+        return m_count;
+    }
+
+    /// @brief Smallest value recorded, or 0 if empty.
+    uint64_t min() const
+    {
+        return m_count > 0 ? m_min : 0;
+    }
+
+    /// @brief Largest value recorded, or 0 if empty.
+    uint64_t max() const
+    {
+        return m_max;
+    }
+
+    double mean() const
+    {
+        return m_count > 0 ? double(m_total) / double(m_count) : 0.0;
+    }
+
+    /// @brief Value that the given percent of recorded values are at or below. Reports the top of the bucket the
+    /// percentile falls in, but never more than the maximum.
+    /// @param percent 0 to 100.
+    /// @return Microseconds, or 0 if empty.
+    uint64_t percentile(double percent) const;
+
+    /// @brief Write every non-empty bucket as a CSV line of lowest value, highest value and count, after a header line.
+    /// Histograms written by different runs can be compared bucket for bucket.
+    void write_csv(std::ostream &os) const;
+
+private:
+    static size_t bucket_index(uint64_t value);
+
+    static uint64_t bucket_lowest(size_t index);
+
+    static uint64_t bucket_highest(size_t index);
+
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_count;
+    uint64_t m_total;
+    uint64_t m_min;
+    uint64_t m_max;
+};
@@ -0,0 +1,135 @@
+#include "poll_scheduler.h"
+
+#include <thread>
+
+/// @brief Longest single sleep, so an interrupt is noticed while waiting for a slow schedule.
+static constexpr std::chrono::milliseconds MAX_SLEEP(50);
+
+PollScheduler::PollScheduler() : m_spin_time(std::chrono::milliseconds(1)), m_is_started(false)
+{
+}
+
+size_t PollScheduler::add(clock::duration period, Action action, clock::duration offset)
+{
+    Schedule schedule;
+    schedule.period = period;
+    schedule.offset = offset;
+    schedule.deadline = clock::time_point();
+    schedule.action = std::move(action);
+
+    m_schedules.push_back(std::move(schedule));
+    return m_schedules.size() - 1;
+}
+
+void PollScheduler::start(clock::time_point now)
+{
+    for (auto &schedule : m_schedules)
+    {
+        schedule.deadline = now + schedule.offset;
+    }
+
+    m_is_started = true;
+}
+
+void PollScheduler::set_spin_time(clock::duration spin_time)
+{
+    m_spin_time = spin_time;
+}
+
+bool PollScheduler::run_next(const std::atomic_bool &interrupt)
+{
+    if (m_schedules.empty())
+    {
+        return false;
+    }
+
+    if (!m_is_started)
+    {
+        start(clock::now());
+    }
+
+    Schedule *next = &m_schedules[0];
+    for (auto &schedule : m_schedules)
+    {
+        if (schedule.deadline < next->deadline)
+        {
+            next = &schedule;
+        }
+    }
+
+    if (!wait_until(next->deadline, interrupt))
+    {
+        return false;
+    }
+
+    // Skip deadlines that another has already followed. The run goes to the latest deadline that has passed, keeping
+    // the schedule on its grid.
+    clock::time_point started = clock::now();
+    if (next->period > clock::duration::zero() && started - next->deadline >= next->period)
+    {
+        uint64_t skipped = static_cast<uint64_t>((started - next->deadline) / next->period);
+        next->stats.missed += skipped;
+        next->deadline += next->period * static_cast<clock::rep>(skipped);
+    }
+
+    clock::duration lateness = started - next->deadline;
+    next->stats.lateness_total += lateness;
+    next->stats.lateness_max = lateness > next->stats.lateness_max ? lateness : next->stats.lateness_max;
+    ++next->stats.runs;
+
+    next->action();
+
+    // A schedule with no period is due again once it finishes, behind anything that came due while it ran.
+    clock::time_point finished = clock::now();
+    if (next->period == clock::duration::zero())
+    {
+        next->deadline = finished;
+        return true;
+    }
+
+    next->deadline += next->period;
+    if (finished > next->deadline)
+    {
+        ++next->stats.overruns;
+    }
+
+    return true;
+}
+
+const ScheduleStats &PollScheduler::stats(size_t schedule) const
+{
+    return m_schedules[schedule].stats;
+}
+
+void PollScheduler::reset_stats()
+{
+    for (auto &schedule : m_schedules)
+    {
+        schedule.stats = ScheduleStats();
+    }
+}
+
+bool PollScheduler::wait_until(clock::time_point time, const std::atomic_bool &interrupt) const
+{
+    for (;;)
+    {
+        if (interrupt)
+        {
+            return false;
+        }
+
+        clock::time_point now = clock::now();
+        if (now >= time)
+        {
+            return true;
+        }
+
+        // Sleeping can overshoot by a scheduler tick, so the last stretch is spent checking the clock.
+        clock::duration remaining = time - now;
+        if (remaining > m_spin_time)
+        {
+            clock::duration sleep = remaining - m_spin_time;
+            std::this_thread::sleep_for(sleep < MAX_SLEEP ? sleep : clock::duration(MAX_SLEEP));
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/// @brief Counters for one schedule of a PollScheduler.
+struct ScheduleStats
+{
+    /// @brief Times the action ran.
+    uint64_t runs = 0;
+
+    /// @brief Deadlines skipped because the loop was still busy when the following deadline came.
+    uint64_t missed = 0;
+
+    /// @brief Runs that finished after the schedule's next deadline.
+    uint64_t overruns = 0;
+
+    /// @brief Time from a deadline to the start of its run.
+    std::chrono::steady_clock::duration lateness_total{};
+    std::chrono::steady_clock::duration lateness_max{};
+};
+
+/// @brief Runs actions at fixed rates from one thread. Every schedule has its own period, and its deadlines are
+/// whole periods from the start time, so the rate holds no matter how long each action takes. When the loop falls
+/// behind, deadlines that have already been followed by another are counted as missed and skipped, so a slow reply
+/// does not set off a burst of catch-up requests.
+///
+/// Waiting sleeps until shortly before a deadline and spins on the clock for the rest, so runs start within
+/// microseconds of their deadline instead of within the scheduler tick of the operating system.
+class PollScheduler
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    using Action = std::function<void()>;
+
+    PollScheduler();
+
+    /// @brief Add a schedule.
+    /// @param period Time between deadlines. Zero runs the action whenever nothing else is due.
+    /// @param action Called at each deadline.
+    /// @param offset Time from the start to the first deadline.
+    /// @return Index of the schedule.
+    size_t add(clock::duration period, Action action, clock::duration offset = clock::duration::zero());
+
+    /// @brief Set every schedule's first deadline from the start time. Called by run_next if not called before.
+    void start(clock::time_point now);
+
+    /// @brief Time before a deadline to stop sleeping and spin. Zero only sleeps. Default 1ms.
+    void set_spin_time(clock::duration spin_time);
+
+    /// @brief Wait for the earliest deadline and run its action. When several schedules are due at once, the one
+    /// added first runs first.
+    /// @param interrupt Checked while waiting. Waiting stops early if it is set.
+    /// @return False if interrupted or there are no schedules.
+    bool run_next(const std::atomic_bool &interrupt);
+
+    const ScheduleStats &stats(size_t schedule) const;
+
+    void reset_stats();
+
+private:
+    struct Schedule
+    {
+        clock::duration period;
+        clock::duration offset;
+        clock::time_point deadline;
+        Action action;
+        ScheduleStats stats;
+    };
+
+    /// @brief Wait until a time.
+    /// @return False if interrupted.
+    bool wait_until(clock::time_point time, const std::atomic_bool &interrupt) const;
+
+    std::vector<Schedule> m_schedules;
+    clock::duration m_spin_time;
+    bool m_is_started;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/// @brief Serial port opened raw at 115200 baud, 8N1, that can switch to other rates. The Win32 backend uses COM
+/// timeouts. The POSIX backend uses termios with a non-blocking descriptor and waits on epoll. Reads return as soon as
+/// any bytes arrive, so one read can take many messages.
+class SerialPort
+{
+public:
+    /// @brief Longest time a read or write waits for the device.
+    static constexpr int TIMEOUT_MS = 500;
+
+    /// @brief Outcome of a read.
+    enum class ReadStatus
+    {
+        OK,
+        Timeout,
+        Failed
+    };
+
+    /// @brief Rate ports are opened at.
+    static constexpr unsigned long DEFAULT_BAUD_RATE = 115200;
+
+    SerialPort();
+
+    ~SerialPort();
+
+    SerialPort(const SerialPort &) = delete;
+
+    SerialPort &operator=(const SerialPort &) = delete;
+
+    /// @brief Open a port, for example \\.\COM3 on Windows or /dev/ttyACM0 on Linux. Bytes already waiting in the
+    /// port are discarded.
+    bool open(const std::wstring &port);
+
+    bool close();
+
+    bool is_open() const;
+
+    /// @brief Change the baud rate once bytes already written have been sent. Bytes received at the old rate are
+    /// discarded.
+    /// @return False if the rate is not supported by the port.
+    bool set_baud_rate(unsigned long baud);
+
+    /// @brief Write every byte, or fail.
+    bool write(const uint8_t *buf, size_t size);
+
+    /// @brief Read whatever has arrived, waiting up to TIMEOUT_MS for the first byte.
+    /// @param buf Buffer for received bytes.
+    /// @param max_size Size of the buffer.
+    /// @param bytes_read Number of bytes read. At least one on success.
+    /// @return Timeout if nothing arrived in time, Failed on a port error.
+    ReadStatus read_some(uint8_t *buf, size_t max_size, size_t &bytes_read);
+
+#ifndef _WIN32
+    /// @brief Non-blocking file descriptor of the open port, for use with another event loop.
+    int native_handle() const
+    {
+        return m_fd;
+    }
+#endif
+
+private:
+#ifdef _WIN32
+    HANDLE m_handle;
+#else
+    /// @brief Wait for the events on the port, or until the timeout passes.
+    /// @return False on timeout or error. errno is ETIMEDOUT after a timeout.
+    bool wait(uint32_t events, int timeout_ms);
+
+    int m_fd;
+    int m_epoll_fd;
+#endif
+};
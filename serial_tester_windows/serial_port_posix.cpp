@@ -0,0 +1,290 @@
+#ifndef _WIN32
+
+#include "serial_port.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+// glibc's termios.h and the kernel's asm/termbits.h cannot both be included, so the kernel's termios2 is declared here.
+// It sets rates that have no B constant.
+struct termios2
+{
+    tcflag_t c_iflag;
+    tcflag_t c_oflag;
+    tcflag_t c_cflag;
+    tcflag_t c_lflag;
+    cc_t c_line;
+    cc_t c_cc[19];
+    speed_t c_ispeed;
+    speed_t c_ospeed;
+};
+
+/// @brief BOTHER from asm/termbits.h. Speed bits meaning the rate is in c_ispeed and c_ospeed.
+static constexpr tcflag_t BOTHER_SPEED = 0010000;
+
+/// @brief Milliseconds until a deadline, or zero if it has passed.
+static int remaining_ms(std::chrono::steady_clock::time_point deadline)
+{
+    using namespace std::chrono;
+
+    auto remaining = duration_cast<milliseconds>(deadline - steady_clock::now()).count();
+    return remaining > 0 ? static_cast<int>(remaining) : 0;
+}
+
+SerialPort::SerialPort() : m_fd(-1), m_epoll_fd(-1)
+{
+}
+
+SerialPort::~SerialPort()
+{
+    close();
+}
+
+bool SerialPort::open(const std::wstring &port)
+{
+    // Device paths are plain ASCII, so narrow with the C locale.
+    std::string path(port.size() * MB_CUR_MAX + 1, '\0');
+    size_t path_size = std::wcstombs(&path[0], port.c_str(), path.size());
+    if (path_size == static_cast<size_t>(-1))
+    {
+        return false;
+    }
+
+    path.resize(path_size);
+
+    m_fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    termios tio;
+    if (tcgetattr(m_fd, &tio) != 0)
+    {
+        close();
+        return false;
+    }
+
+    // Raw 8N1 with no flow control. VMIN and VTIME are zero because reads never block, epoll does the waiting.
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+
+    if (tcsetattr(m_fd, TCSANOW, &tio) != 0)
+    {
+        close();
+        return false;
+    }
+
+    tcflush(m_fd, TCIOFLUSH);
+    return true;
+}
+
+bool SerialPort::set_baud_rate(unsigned long baud)
+{
+    speed_t speed;
+    switch (baud)
+    {
+    case 115200:
+        speed = B115200;
+        break;
+    case 230400:
+        speed = B230400;
+        break;
+    case 500000:
+        speed = B500000;
+        break;
+    case 1000000:
+        speed = B1000000;
+        break;
+    default:
+        speed = B0;
+        break;
+    }
+
+    // Written bytes drain at the old rate first.
+    if (speed != B0)
+    {
+        termios tio;
+        if (tcgetattr(m_fd, &tio) != 0)
+        {
+            return false;
+        }
+
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        if (tcsetattr(m_fd, TCSADRAIN, &tio) != 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        termios2 tio;
+        if (ioctl(m_fd, TCGETS2, &tio) != 0)
+        {
+            return false;
+        }
+
+        tio.c_cflag = (tio.c_cflag & ~CBAUD) | BOTHER_SPEED;
+        tio.c_ispeed = static_cast<speed_t>(baud);
+        tio.c_ospeed = static_cast<speed_t>(baud);
+        if (ioctl(m_fd, TCSETSW2, &tio) != 0)
+        {
+            return false;
+        }
+    }
+
+    tcflush(m_fd, TCIFLUSH);
+    return true;
+}
+
+bool SerialPort::close()
+{
+    if (m_epoll_fd >= 0)
+    {
+        ::close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
+
+    if (m_fd >= 0)
+    {
+        int rc = ::close(m_fd);
+        m_fd = -1;
+        return rc == 0;
+    }
+
+    return false;
+}
+
+bool SerialPort::is_open() const
+{
+    return m_fd >= 0;
+}
+
+bool SerialPort::write(const uint8_t *buf, size_t size)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TIMEOUT_MS);
+
+    size_t written = 0;
+    while (written < size)
+    {
+        ssize_t n = ::write(m_fd, buf + written, size - written);
+        if (n > 0)
+        {
+            written += static_cast<size_t>(n);
+        }
+        else if (n < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            return false;
+        }
+        else if (!wait(EPOLLOUT, remaining_ms(deadline)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+SerialPort::ReadStatus SerialPort::read_some(uint8_t *buf, size_t max_size, size_t &bytes_read)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TIMEOUT_MS);
+
+    bytes_read = 0;
+    bool is_ready = false;
+    for (;;)
+    {
+        ssize_t n = ::read(m_fd, buf, max_size);
+        if (n > 0)
+        {
+            bytes_read = static_cast<size_t>(n);
+            return ReadStatus::OK;
+        }
+
+        // With VMIN and VTIME zero, a read with nothing waiting also returns zero. Zero after epoll reported the port
+        // ready is a hang up, which epoll keeps reporting, so waiting again would spin until the deadline.
+        if (n == 0 && is_ready)
+        {
+            return ReadStatus::Failed;
+        }
+
+        if (n < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            return ReadStatus::Failed;
+        }
+
+        if (!wait(EPOLLIN, remaining_ms(deadline)))
+        {
+            return errno == ETIMEDOUT ? ReadStatus::Timeout : ReadStatus::Failed;
+        }
+
+        is_ready = true;
+    }
+}
+
+bool SerialPort::wait(uint32_t events, int timeout_ms)
+{
+    if (timeout_ms <= 0)
+    {
+        errno = ETIMEDOUT;
+        return false;
+    }
+
+    // Created on first use, so ports driven by another event loop through native_handle() do not need one each.
+    if (m_epoll_fd < 0)
+    {
+        m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = m_fd;
+        if (m_epoll_fd < 0 || epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_fd, &event) != 0)
+        {
+            return false;
+        }
+    }
+
+    // The port is registered for input. Writes only wait when the output buffer is full, which is rare, so output
+    // interest is added just for that wait.
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = m_fd;
+    if (events != EPOLLIN && epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, m_fd, &event) != 0)
+    {
+        return false;
+    }
+
+    epoll_event ready;
+    int n;
+    do
+    {
+        n = epoll_wait(m_epoll_fd, &ready, 1, timeout_ms);
+    } while (n < 0 && errno == EINTR);
+
+    if (events != EPOLLIN)
+    {
+        event.events = EPOLLIN;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, m_fd, &event);
+    }
+
+    if (n == 0)
+    {
+        errno = ETIMEDOUT;
+    }
+
+    // Hang up and errors also wake the wait. The next read or write reports them.
+    return n > 0;
+}
+
+#endif // _WIN32
@@ -0,0 +1,125 @@
+#ifdef _WIN32
+
+#include "serial_port.h"
+
+SerialPort::SerialPort() : m_handle(INVALID_HANDLE_VALUE)
+{
+}
+
+SerialPort::~SerialPort()
+{
+    close();
+}
+
+bool SerialPort::open(const std::wstring &port)
+{
+    BOOL rc;
+
+    m_handle = CreateFileW(port.c_str(), GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+
+    if (m_handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    DCB serial_params{};
+    serial_params.DCBlength = sizeof(serial_params);
+
+    serial_params.BaudRate = DEFAULT_BAUD_RATE;
+    serial_params.ByteSize = 8;
+    serial_params.StopBits = ONESTOPBIT;
+    serial_params.Parity = NOPARITY;
+    serial_params.fBinary = TRUE;
+
+    rc = SetCommState(m_handle, &serial_params);
+    if (!rc)
+    {
+        close();
+        return false;
+    }
+
+    // With both read values at MAXDWORD, ReadFile returns as soon as any bytes arrive, or after the constant.
+    COMMTIMEOUTS timeout = {0};
+    timeout.ReadIntervalTimeout = MAXDWORD;
+    timeout.ReadTotalTimeoutConstant = TIMEOUT_MS;
+    timeout.ReadTotalTimeoutMultiplier = MAXDWORD;
+    timeout.WriteTotalTimeoutConstant = TIMEOUT_MS;
+    timeout.WriteTotalTimeoutMultiplier = 0;
+
+    rc = SetCommTimeouts(m_handle, &timeout);
+    if (!rc)
+    {
+        close();
+        return false;
+    }
+
+    PurgeComm(m_handle, PURGE_RXCLEAR | PURGE_TXCLEAR);
+    return true;
+}
+
+bool SerialPort::set_baud_rate(unsigned long baud)
+{
+    // Wait for written bytes to go out at the old rate.
+    FlushFileBuffers(m_handle);
+
+    DCB serial_params{};
+    serial_params.DCBlength = sizeof(serial_params);
+    if (!GetCommState(m_handle, &serial_params))
+    {
+        return false;
+    }
+
+    // The CBR_ constants are only the traditional rates. Drivers take any rate they support.
+    serial_params.BaudRate = static_cast<DWORD>(baud);
+    if (!SetCommState(m_handle, &serial_params))
+    {
+        return false;
+    }
+
+    PurgeComm(m_handle, PURGE_RXCLEAR);
+    return true;
+}
+
+bool SerialPort::close()
+{
+    if (m_handle != INVALID_HANDLE_VALUE)
+    {
+        BOOL rc = CloseHandle(m_handle);
+        if (rc)
+        {
+            m_handle = INVALID_HANDLE_VALUE;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SerialPort::is_open() const
+{
+    return m_handle != INVALID_HANDLE_VALUE;
+}
+
+bool SerialPort::write(const uint8_t *buf, size_t size)
+{
+    DWORD bytes_written;
+    BOOL rc = WriteFile(m_handle, buf, static_cast<DWORD>(size), &bytes_written, nullptr);
+    return rc && bytes_written == size;
+}
+
+SerialPort::ReadStatus SerialPort::read_some(uint8_t *buf, size_t max_size, size_t &bytes_read)
+{
+    DWORD n = 0;
+    BOOL rc = ReadFile(m_handle, buf, static_cast<DWORD>(max_size), &n, nullptr);
+    bytes_read = n;
+
+    // A read that reaches the COM timeout succeeds with no bytes.
+    if (!rc)
+    {
+        return ReadStatus::Failed;
+    }
+
+    return n > 0 ? ReadStatus::OK : ReadStatus::Timeout;
+}
+
+#endif // _WIN32
@@ -1,9 +1,15 @@
 #include <atomic>
 #include <chrono>
 #include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
-#include <thread>
+#include <vector>
 
+#include "latency_histogram.h"
+#include "poll_scheduler.h"
 #include "triple_temperature.h"
 
 std::atomic_bool is_signaled_interrupt;
@@ -12,16 +18,30 @@ TripleTemperature tt;
 
 static const char *error_not_open = "Error: Device not connected. Use \"open\" to open device.";
 
+void baud_bench();
+void get_diagnostics();
+void get_history();
 void get_status();
 void get_temperature();
 void open_device();
 void close_device();
+void pipeline();
 void poll();
+void print_latency_report(const wchar_t *label, const LatencyHistogram &latency, unsigned long long errors,
+                          std::chrono::steady_clock::duration elapsed);
+void print_schedule_stats(const wchar_t *label, const ScheduleStats &stats);
+void set_baud_rate();
 void show_help();
+void stream(bool on_change);
+bool write_histogram(const LatencyHistogram &latency, const std::wstring &path);
 
 void signal_handler(int signal);
 
+#ifdef _WIN32
 int wmain(int argc, const wchar_t **argv)
+#else
+int main(int argc, const char **argv)
+#endif
 {
     std::signal(SIGINT, signal_handler);
 
@@ -51,10 +71,38 @@ int wmain(int argc, const wchar_t **argv)
         {
             close_device();
         }
+        else if (command == L"pipeline")
+        {
+            pipeline();
+        }
         else if (command == L"poll" || command == L"p")
         {
             poll();
         }
+        else if (command == L"stream")
+        {
+            stream(false);
+        }
+        else if (command == L"subscribe")
+        {
+            stream(true);
+        }
+        else if (command == L"history")
+        {
+            get_history();
+        }
+        else if (command == L"baud")
+        {
+            set_baud_rate();
+        }
+        else if (command == L"baudbench")
+        {
+            baud_bench();
+        }
+        else if (command == L"diag")
+        {
+            get_diagnostics();
+        }
         else if (command == L"help")
         {
             show_help();
@@ -75,16 +123,165 @@ void show_help()
     // clang-format off
     std::wcout << "Triple Temperature Serial Tester." << std::endl
         << "Commands: " << std::endl
+        << "baud            Switch the device and port to another baud rate. Device must be opened before using." << std::endl
+        << "baudbench       Measure request latency and pipelined frames per second at each baud rate. Device must be opened before using." << std::endl
         << "close           Close serial device. Shortcut 'c'." << std::endl
+        << "diag            Show the device's loop, sensor and reply timing and serial counters. Device must be opened before using." << std::endl
         << "exit            Exit program." << std::endl
         << "help            Show this help message." << std::endl
+        << "history         Download samples recorded since the last download. Device must be opened before using." << std::endl
         << "open            Open communication with serial device. Shortcut 'o'." << std::endl
-        << "poll            Poll device at a given interval. Device must be opened before using. Shortcut 'p'." << std::endl
+        << "pipeline        Send many temperature requests with several in flight and show the rate. Device must be opened before using." << std::endl
+        << "poll            Poll temperature and status at fixed rates and report latency percentiles every 5 seconds. Device must be opened before using. Shortcut 'p'." << std::endl
         << "status          Send status request. Device must be opened before using. Shortcut 's'." << std::endl
+        << "stream          Start a temperature stream and show messages as they arrive. Device must be opened before using." << std::endl
+        << "subscribe       Like stream, but only changes and heartbeats are sent. Device must be opened before using." << std::endl
         << "temperature     Send temperature request. Device must be opened before using. Shortcut 't'." << std::endl;
     // clang-format on
 }
 
+void set_baud_rate()
+{
+    if (!tt.is_open())
+    {
+        std::wcout << error_not_open << std::endl;
+        return;
+    }
+
+    std::wstring baud;
+    std::wcout << "Enter baud rate (115200, 250000, 500000 or 1000000): ";
+    std::wcin >> baud;
+
+    if (tt.set_baud_rate(std::stoul(baud)))
+    {
+        std::wcout << "Running at " << tt.baud_rate() << " baud." << std::endl;
+    }
+    else
+    {
+        std::wcout << "Failed to change baud rate. Running at " << tt.baud_rate() << " baud." << std::endl;
+    }
+}
+
+void baud_bench()
+{
+    using namespace std::chrono;
+
+    // Single requests show the round trip time, and pipelined requests the most replies the link carries.
+    static const unsigned long rates[] = {115200, 250000, 500000, 1000000};
+    static const size_t latency_count = 200;
+    static const size_t pipeline_count = 2000;
+
+    if (!tt.is_open())
+    {
+        std::wcout << error_not_open << std::endl;
+        return;
+    }
+
+    std::wcout << std::setw(10) << "Baud" << std::setw(12) << "Mean us" << std::setw(12) << "P99 us" << std::setw(12)
+               << "Max us" << std::setw(12) << "Frames/s" << std::endl;
+
+    for (unsigned long rate : rates)
+    {
+        if (!tt.set_baud_rate(rate))
+        {
+            std::wcout << std::setw(10) << rate << "  Failed to change baud rate." << std::endl;
+            continue;
+        }
+
+        LatencyHistogram latency;
+        for (size_t i = 0; i < latency_count; ++i)
+        {
+            steady_clock::time_point start = steady_clock::now();
+            TemperatureResult temperature;
+            if (!tt.get_temperature(temperature))
+            {
+                break;
+            }
+
+            latency.record(duration_cast<microseconds>(steady_clock::now() - start).count());
+        }
+
+        high_resolution_clock::time_point start = high_resolution_clock::now();
+        std::vector<TemperatureResult> temperatures;
+        bool is_pipelined = tt.get_temperatures(temperatures, pipeline_count, MAX_PIPELINE_DEPTH);
+        duration<double> time_span = duration_cast<duration<double>>(high_resolution_clock::now() - start);
+
+        if (latency.count() < latency_count || !is_pipelined)
+        {
+            std::wcout << std::setw(10) << rate << "  Failed to get temperatures." << std::endl;
+            continue;
+        }
+
+        std::wcout << std::setw(10) << rate << std::setw(12) << int(latency.mean()) << std::setw(12)
+                   << latency.percentile(99.0) << std::setw(12) << latency.max() << std::setw(12)
+                   << int(temperatures.size() / time_span.count()) << std::endl;
+    }
+
+    if (!tt.set_baud_rate(115200))
+    {
+        std::wcout << "Failed to return to 115200 baud." << std::endl;
+    }
+}
+
+void get_history()
+{
+    using namespace std::chrono;
+
+    // Resume where the previous download left off, so only new samples are fetched.
+    static uint16_t history_offset = 0xFFFF;
+
+    if (!tt.is_open())
+    {
+        std::wcout << error_not_open << std::endl;
+        return;
+    }
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    std::vector<TemperatureResult> history;
+    if (tt.get_history(history, history_offset))
+    {
+        high_resolution_clock::time_point end = high_resolution_clock::now();
+        duration<double> time_span = duration_cast<duration<double>>(end - start);
+
+        std::wcout << std::fixed << std::setprecision(2);
+        for (const auto &sample : history)
+        {
+            std::wcout << sample.average << " (";
+            for (unsigned i = 0; i < sample.sensor_count; ++i)
+            {
+                std::wcout << (i == 0 ? "" : ", ") << sample.temps[i];
+            }
+
+            std::wcout << ")" << std::endl;
+        }
+
+        std::wcout << history.size() << " samples fetched in " << int(time_span.count() * 1000.0) << "ms" << std::endl;
+    }
+    else
+    {
+        std::wcout << "Failed to get history." << std::endl;
+    }
+}
+
+void get_diagnostics()
+{
+    if (!tt.is_open())
+    {
+        std::wcout << error_not_open << std::endl;
+        return;
+    }
+
+    DiagnosticsResult diagnostics;
+    if (tt.get_diagnostics(diagnostics))
+    {
+        std::wcout << diagnostics;
+    }
+    else
+    {
+        std::wcout << "Failed to get diagnostics." << std::endl;
+    }
+}
+
 void get_status()
 {
     using namespace std::chrono;
@@ -146,12 +343,18 @@ void open_device()
         return;
     }
 
+#ifdef _WIN32
     std::wcout << "Enter Port (Ex COM1): ";
+#else
+    std::wcout << "Enter Port (Ex /dev/ttyACM0): ";
+#endif
     std::wstring port;
     std::wcin >> port;
 
+#ifdef _WIN32
     // Make this like \\.\ for windows to know it's serial device.
     port = L"\\\\.\\" + port;
+#endif
 
     if (tt.connect(port))
     {
@@ -181,10 +384,48 @@ void close_device()
     }
 }
 
+void pipeline()
+{
+    using namespace std::chrono;
+
+    if (!tt.is_open())
+    {
+        std::wcout << error_not_open << std::endl;
+        return;
+    }
+
+    std::wstring count;
+    std::wcout << "Enter request count: ";
+    std::wcin >> count;
+
+    std::wstring depth;
+    std::wcout << "Enter requests in flight (1 to " << MAX_PIPELINE_DEPTH << "): ";
+    std::wcin >> depth;
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    std::vector<TemperatureResult> temperatures;
+    if (tt.get_temperatures(temperatures, std::stoul(count), std::stoul(depth)))
+    {
+        high_resolution_clock::time_point end = high_resolution_clock::now();
+        duration<double> time_span = duration_cast<duration<double>>(end - start);
+
+        std::wcout << temperatures.back();
+        std::wcout << temperatures.size() << " temperatures fetched in " << int(time_span.count() * 1000.0) << "ms ("
+                   << int(temperatures.size() / time_span.count()) << " per second)" << std::endl;
+    }
+    else
+    {
+        std::wcout << "Failed to get temperatures." << std::endl;
+    }
+}
+
 void poll()
 {
     using namespace std::chrono;
 
+    // Latency is summarized once per report period, and for the whole run when polling stops.
+    static const seconds report_period(5);
+
     if (!tt.is_open())
     {
         std::wcout << error_not_open << std::endl;
@@ -192,46 +433,214 @@ void poll()
     }
 
     std::wstring interval;
-    std::wcout << "Enter poll interval (ms): ";
+    std::wcout << "Enter temperature poll interval (ms): ";
     std::wcin >> interval;
     long interval_ms = std::stol(interval);
 
+    std::wstring status_interval;
+    std::wcout << "Enter status poll interval (ms), or 0 for none: ";
+    std::wcin >> status_interval;
+    long status_interval_ms = std::stol(status_interval);
+
+    std::wstring histogram_path;
+    std::wcout << "Enter file to write the latency histogram to when stopped, or - for none: ";
+    std::wcin >> histogram_path;
+
+    LatencyHistogram period_latency;
+    LatencyHistogram total_latency;
+    unsigned long long period_errors = 0;
+    unsigned long long total_errors = 0;
+    TemperatureResult last_temperature{};
+    StatusResult last_status{};
+
+    // Requests go out at fixed deadlines, so the rate does not depend on how long replies take.
+    PollScheduler scheduler;
+    size_t temperature_schedule = scheduler.add(milliseconds(interval_ms), [&]() {
+        steady_clock::time_point start = steady_clock::now();
+        TemperatureResult temperature;
+        if (tt.get_temperature(temperature))
+        {
+            period_latency.record(duration_cast<microseconds>(steady_clock::now() - start).count());
+            last_temperature = temperature;
+        }
+        else
+        {
+            ++period_errors;
+        }
+    });
+
+    // Status requests start half a temperature period in, between temperature requests.
+    size_t status_schedule = SIZE_MAX;
+    if (status_interval_ms > 0)
+    {
+        status_schedule = scheduler.add(
+            milliseconds(status_interval_ms),
+            [&]() {
+                if (!tt.get_status(last_status))
+                {
+                    ++period_errors;
+                }
+            },
+            milliseconds(interval_ms / 2));
+    }
+
+    steady_clock::time_point period_start;
+    scheduler.add(
+        report_period,
+        [&]() {
+            steady_clock::time_point now = steady_clock::now();
+            print_latency_report(L"Last", period_latency, period_errors, now - period_start);
+            print_schedule_stats(L"Temperature", scheduler.stats(temperature_schedule));
+            if (status_schedule != SIZE_MAX)
+            {
+                print_schedule_stats(L"Status", scheduler.stats(status_schedule));
+                std::wcout << "  TX Queue: " << last_status.tx_queue_size << " bytes (peak "
+                           << last_status.tx_queue_peak << ")" << std::endl;
+            }
+
+            std::wcout << "Average: " << last_temperature.average << std::endl;
+
+            total_latency.add(period_latency);
+            total_errors += period_errors;
+            period_latency.reset();
+            period_errors = 0;
+            period_start = now;
+            scheduler.reset_stats();
+        },
+        report_period);
+
     std::wcout << "Starting poll. Press ctrl + c to stop." << std::endl;
 
-    unsigned long long count = 0;
     is_signaled_interrupt = false;
+    steady_clock::time_point poll_start = steady_clock::now();
+    period_start = poll_start;
+    scheduler.start(poll_start);
 
-    for (;;)
+    while (scheduler.run_next(is_signaled_interrupt))
+    {
+    }
+
+    total_latency.add(period_latency);
+    total_errors += period_errors;
+    print_latency_report(L"Total", total_latency, total_errors, steady_clock::now() - poll_start);
+
+    if (histogram_path != L"-")
     {
-        if (is_signaled_interrupt)
+        if (write_histogram(total_latency, histogram_path))
         {
-            break;
+            std::wcout << "Histogram written to " << histogram_path << std::endl;
         }
+        else
+        {
+            std::wcout << "Failed to write histogram." << std::endl;
+        }
+    }
+}
+
+void print_latency_report(const wchar_t *label, const LatencyHistogram &latency, unsigned long long errors,
+                          std::chrono::steady_clock::duration elapsed)
+{
+    double seconds = std::chrono::duration<double>(elapsed).count();
 
-        system("cls");
-        std::wcout << "#" << count << ":" << std::endl;
+    std::wcout << std::fixed << std::setprecision(1);
+    std::wcout << label << " " << seconds << "s: " << latency.count() << " replies (" << latency.count() / seconds
+               << " per second), " << errors << " errors" << std::endl;
 
-        high_resolution_clock::time_point start = high_resolution_clock::now();
+    std::wcout << "  Latency us: p50 " << latency.percentile(50.0) << ", p90 " << latency.percentile(90.0) << ", p99 "
+               << latency.percentile(99.0) << ", p99.9 " << latency.percentile(99.9) << ", max " << latency.max()
+               << std::endl;
+    std::wcout << std::setprecision(2);
+}
+
+void print_schedule_stats(const wchar_t *label, const ScheduleStats &stats)
+{
+    using namespace std::chrono;
+
+    long long lateness_mean_us =
+        stats.runs > 0 ? duration_cast<microseconds>(stats.lateness_total).count() / (long long)stats.runs : 0;
+
+    std::wcout << "  " << label << " schedule: " << stats.runs << " runs, " << stats.missed << " missed, "
+               << stats.overruns << " overruns, lateness mean " << lateness_mean_us << "us, max "
+               << duration_cast<microseconds>(stats.lateness_max).count() << "us" << std::endl;
+}
+
+bool write_histogram(const LatencyHistogram &latency, const std::wstring &path)
+{
+    std::ofstream file;
+#ifdef _WIN32
+    file.open(path);
+#else
+    // Narrow the path with the C locale, as the serial port does.
+    std::string narrow_path(path.size() * MB_CUR_MAX + 1, '\0');
+    size_t path_size = std::wcstombs(&narrow_path[0], path.c_str(), narrow_path.size());
+    if (path_size == static_cast<size_t>(-1))
+    {
+        return false;
+    }
+
+    narrow_path.resize(path_size);
+    file.open(narrow_path);
+#endif
+
+    latency.write_csv(file);
+    return bool(file);
+}
+
+void stream(bool on_change)
+{
+    if (!tt.is_open())
+    {
+        std::wcout << error_not_open << std::endl;
+        return;
+    }
+
+    bool rc = on_change ? tt.subscribe() : tt.start_stream();
+    if (!rc)
+    {
+        std::wcout << "Failed to start stream." << std::endl;
+        return;
+    }
+
+    std::wcout << "Streaming. Press ctrl + c to stop." << std::endl;
+
+    unsigned long long count = 0;
+    unsigned long long dropped = 0;
+    bool has_sequence = false;
+    uint8_t last_sequence = 0;
+    is_signaled_interrupt = false;
+
+    while (!is_signaled_interrupt)
+    {
         TemperatureResult temperature;
-        if (tt.get_temperature(temperature))
+        uint8_t sequence;
+        // A subscription only sends changes, so a quiet line is normal.
+        ReadStatus status = tt.read_stream(temperature, sequence);
+        if (on_change && status == ReadStatus::Timeout)
         {
-            high_resolution_clock::time_point end = high_resolution_clock::now();
-            duration<double> time_span = duration_cast<duration<double>>(end - start);
-
-            std::wcout << temperature;
+            continue;
+        }
 
-            std::wcout << "Fetched in " << int(time_span.count() * 1000.0) << "ms" << std::endl;
+        if (status != ReadStatus::OK)
+        {
+            std::wcout << "Failed to read stream message." << std::endl;
+            continue;
         }
-        else
+
+        // Sequence numbers wrap at 256, so the gap is computed in 8 bits.
+        if (has_sequence)
         {
-            std::wcout << "Failed to get temperature." << std::endl;
+            dropped += uint8_t(sequence - last_sequence - 1);
         }
 
-        std::wcout << std::endl;
+        has_sequence = true;
+        last_sequence = sequence;
         ++count;
 
-        std::this_thread::sleep_for(milliseconds(interval_ms));
+        std::wcout << "#" << count << " (seq " << int(sequence) << ", dropped " << dropped << "):" << std::endl;
+        std::wcout << temperature << std::endl;
     }
+
+    tt.stop_stream();
 }
 
 void signal_handler(int signal)
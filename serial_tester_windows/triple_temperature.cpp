@@ -1,219 +1,552 @@
 #include "triple_temperature.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <deque>
 #include <iomanip>
-#include <windows.h>
+#include <thread>
+
+#include "frame_decoder.h"
+#include "history_buffer.h"
+#include "message_format.h"
+#include "serial_port.h"
 
 struct TripleTemperature::Impl
 {
     enum class RequestType : uint8_t
     {
         Temperature = 0,
-        SystemStatus = 1
+        SystemStatus = 1,
+        StreamStart = 2,
+        StreamStop = 3,
+        Subscribe = 4,
+        HistoryDownload = 5,
+        SetBaudRate = 6,
+        Diagnostics = 7
     };
-    static constexpr uint8_t MAX_REQUEST_TYPE = 1;
+    static constexpr uint8_t MAX_REQUEST_TYPE = 7;
 
     enum class MessageType
     {
         Temperature = 1,
         SystemStatus = 2,
         Error = 3,
-        Request = 4
+        Request = 4,
+        TemperatureStream = 5,
+        HistoryData = 6,
+        BaudRate = 7,
+        Diagnostics = 8
     };
 
-    static constexpr auto MSG_SIZE_TEMPERATURE = 12;
-    static constexpr auto MSG_SIZE_SYSTEM_STATUS = 4;
-    static constexpr auto MSG_SIZE_ERROR = 3;
-    static constexpr auto MSG_SIZE_REQUEST = 3;
+    // Request type, request ID and a two byte argument.
+    static constexpr size_t MAX_REQUEST_PAYLOAD = 4;
 
-    Impl()
+    bool close()
     {
-        m_handle = INVALID_HANDLE_VALUE;
+        return m_port.close();
     }
 
-    ~Impl()
+    bool connect(const std::wstring &port)
     {
-        if (m_handle)
+        m_baud_rate = SerialPort::DEFAULT_BAUD_RATE;
+        return m_port.open(port);
+    }
+
+    bool get_temperature(TemperatureResult &dest)
+    {
+        if (!m_port.is_open())
+        {
+            return false;
+        }
+
+        if (!send_request(RequestType::Temperature))
+        {
+            return false;
+        }
+
+        MessageType message_type;
+        if (!read_reply(message_type) || message_type != MessageType::Temperature)
         {
-            CloseHandle(m_handle);
+            return false;
         }
+
+        return decode_temperature(dest);
     }
 
-    bool close()
+    bool get_temperatures(std::vector<TemperatureResult> &dest, size_t count, unsigned depth)
     {
-        if (m_handle != INVALID_HANDLE_VALUE)
+        if (!m_port.is_open() || depth < 1 || depth > MAX_PIPELINE_DEPTH)
+        {
+            return false;
+        }
+
+        // IDs of requests in flight, oldest first. The device answers requests in order.
+        std::deque<uint8_t> in_flight;
+        size_t sent = 0;
+
+        while (sent < count || !in_flight.empty())
         {
-            BOOL rc = CloseHandle(m_handle);
-            if (rc)
+            while (sent < count && in_flight.size() < depth)
             {
-                m_handle = INVALID_HANDLE_VALUE;
-                return true;
+                uint8_t request_id = m_next_request_id++;
+                if (!send_request_with_id(RequestType::Temperature, request_id))
+                {
+                    return false;
+                }
+
+                in_flight.push_back(request_id);
+                ++sent;
+            }
+
+            MessageType message_type;
+            if (!read_next(message_type))
+            {
+                return false;
+            }
+
+            // Stream messages are not replies. Replies with an unknown ID are left over from an earlier call that
+            // failed part way.
+            if (!m_frame.has_request_id)
+            {
+                if (message_type == MessageType::TemperatureStream)
+                {
+                    continue;
+                }
+
+                return false;
             }
+
+            if (std::find(in_flight.begin(), in_flight.end(), m_frame.request_id) == in_flight.end())
+            {
+                continue;
+            }
+
+            if (m_frame.request_id != in_flight.front() || message_type != MessageType::Temperature)
+            {
+                return false;
+            }
+
+            in_flight.pop_front();
+
+            TemperatureResult result;
+            if (!decode_temperature(result))
+            {
+                return false;
+            }
+
+            dest.push_back(result);
         }
 
-        return false;
+        return true;
     }
 
-    bool connect(const std::wstring &port)
+    bool get_status(StatusResult &dest)
     {
-        BOOL rc;
-
-        m_handle =
-            CreateFileW(port.c_str(), GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        if (!m_port.is_open())
+        {
+            return false;
+        }
 
-        if (m_handle == INVALID_HANDLE_VALUE)
+        if (!send_request(RequestType::SystemStatus))
         {
             return false;
         }
 
-        DCB serial_params{};
-        serial_params.DCBlength = sizeof(serial_params);
+        MessageType message_type;
+        if (!read_reply(message_type) || message_type != MessageType::SystemStatus)
+        {
+            return false;
+        }
 
-        serial_params.BaudRate = CBR_115200;
-        serial_params.ByteSize = 8;
-        serial_params.StopBits = ONESTOPBIT;
-        serial_params.Parity = NOPARITY;
-        serial_params.fBinary = TRUE;
+        return decode_status(dest);
+    }
 
-        rc = SetCommState(m_handle, &serial_params);
-        if (!rc)
+    bool get_diagnostics(DiagnosticsResult &dest)
+    {
+        if (!m_port.is_open())
         {
-            CloseHandle(m_handle);
-            m_handle = INVALID_HANDLE_VALUE;
             return false;
         }
 
-        COMMTIMEOUTS timeout = {0};
-        timeout.ReadIntervalTimeout = 0;
-        timeout.ReadTotalTimeoutConstant = 500;
-        timeout.ReadTotalTimeoutMultiplier = 0;
-        timeout.WriteTotalTimeoutConstant = 500;
-        timeout.WriteTotalTimeoutMultiplier = 0;
+        if (!send_request(RequestType::Diagnostics))
+        {
+            return false;
+        }
 
-        rc = SetCommTimeouts(m_handle, &timeout);
-        if (!rc)
+        MessageType message_type;
+        if (!read_reply(message_type) || message_type != MessageType::Diagnostics)
         {
-            CloseHandle(m_handle);
-            m_handle = INVALID_HANDLE_VALUE;
             return false;
         }
 
-        return true;
+        return decode_diagnostics(dest);
     }
 
-    bool get_temperature(TemperatureResult &dest)
+    bool is_open()
     {
-        if (m_handle == INVALID_HANDLE_VALUE)
+        return m_port.is_open();
+    }
+
+    bool set_baud_rate(unsigned long baud)
+    {
+        if (!m_port.is_open() || baud / 100 > 0xFFFF)
         {
             return false;
         }
 
-        if (!send_request(RequestType::Temperature))
+        if (!send_request(RequestType::SetBaudRate, static_cast<uint16_t>(baud / 100)))
         {
             return false;
         }
 
+        // The device acknowledges at the current rate and switches once the acknowledgement is written. An error
+        // reply means the device does not support the rate and stays where it is. Stream messages and replies left
+        // over from an earlier call that failed part way are skipped.
         MessageType message_type;
-        if (!read_next(message_type) || message_type != MessageType::Temperature)
+        do
+        {
+            if (!read_next(message_type))
+            {
+                return fall_back();
+            }
+
+            if (message_type == MessageType::Error)
+            {
+                return false;
+            }
+        } while (message_type != MessageType::BaudRate);
+
+        if (m_frame.payload_size < 2 ||
+            static_cast<unsigned long>(m_frame.payload[0] | (m_frame.payload[1] << 8)) != baud / 100)
+        {
+            return fall_back();
+        }
+
+        if (!m_port.set_baud_rate(baud))
+        {
+            return fall_back();
+        }
+
+        discard_input();
+
+        // A valid request at the new rate confirms it on the device.
+        StatusResult status;
+        if (!get_status(status))
+        {
+            return fall_back();
+        }
+
+        m_baud_rate = baud;
+        return true;
+    }
+
+    unsigned long baud_rate() const
+    {
+        return m_baud_rate;
+    }
+
+    bool start_stream()
+    {
+        if (!m_port.is_open())
         {
             return false;
         }
 
-        return decode_temperature(dest);
+        return send_request(RequestType::StreamStart);
     }
 
-    bool get_status(StatusResult &dest)
+    bool subscribe()
     {
-        if (m_handle == INVALID_HANDLE_VALUE)
+        if (!m_port.is_open())
         {
             return false;
         }
 
-        if (!send_request(RequestType::SystemStatus))
+        return send_request(RequestType::Subscribe);
+    }
+
+    bool stop_stream()
+    {
+        if (!m_port.is_open())
         {
             return false;
         }
 
-        MessageType message_type;
-        if (!read_next(message_type) || message_type != MessageType::SystemStatus)
+        uint8_t request_id = m_next_request_id++;
+        if (!send_request_with_id(RequestType::StreamStop, request_id))
         {
             return false;
         }
 
-        return decode_status(dest);
+        // The device acknowledges a stop with an ID once it has queued its last stream message, so stream messages
+        // still arriving are taken before the acknowledgement, and none is read as the reply to a later request.
+        for (;;)
+        {
+            MessageType message_type;
+            if (!read_next(message_type))
+            {
+                return false;
+            }
+
+            if (m_frame.has_request_id && m_frame.request_id == request_id)
+            {
+                return message_type == MessageType::SystemStatus;
+            }
+        }
     }
 
-    bool is_open()
+    ReadStatus read_stream(TemperatureResult &dest, uint8_t &sequence)
     {
-        return m_handle != INVALID_HANDLE_VALUE;
+        if (!m_port.is_open())
+        {
+            return ReadStatus::Failed;
+        }
+
+        MessageType message_type;
+        if (!read_next(message_type))
+        {
+            return m_is_timeout ? ReadStatus::Timeout : ReadStatus::Failed;
+        }
+
+        // The sequence number follows the temperature fields.
+        if (message_type != MessageType::TemperatureStream || !decode_temperature(dest))
+        {
+            return ReadStatus::Failed;
+        }
+
+        sequence = m_frame.payload[m_frame.payload_size - 1];
+        return ReadStatus::OK;
     }
 
-    bool send_request(RequestType request_type)
+    bool get_history(std::vector<TemperatureResult> &dest, uint16_t &offset)
     {
-        if (static_cast<uint8_t>(request_type) > MAX_REQUEST_TYPE)
+        using namespace scottz0r::temperature;
+
+        if (!m_port.is_open())
         {
             return false;
         }
 
-        uint8_t buffer[MSG_SIZE_REQUEST];
-        buffer[0] = static_cast<uint8_t>(MessageType::Request);
-        buffer[1] = static_cast<uint8_t>(request_type);
-        buffer[2] = buffer[0] ^ buffer[1];
+        if (!send_request(RequestType::HistoryDownload, offset))
+        {
+            return false;
+        }
 
-        DWORD bytes_written;
-        auto rc = WriteFile(m_handle, buffer, MSG_SIZE_REQUEST, &bytes_written, nullptr);
-        if (!rc || bytes_written != MSG_SIZE_REQUEST)
+        // The device sends history data messages until one reaches the newest record.
+        for (;;)
+        {
+            MessageType message_type;
+            if (!read_next(message_type))
+            {
+                return false;
+            }
+
+            // A stream may be running at the same time. Its messages are not part of the download.
+            if (message_type == MessageType::TemperatureStream)
+            {
+                continue;
+            }
+
+            if (message_type != MessageType::HistoryData)
+            {
+                return false;
+            }
+
+            // The history record format depends on the sensor count.
+            const uint8_t *payload = m_frame.payload;
+            const size_t sensor_count = m_frame.payload_size > 0 ? payload[0] : 0;
+            if (sensor_count != TemperatureVoteResult::sensor_count || m_frame.payload_size < HISTORY_PAYLOAD_HEADER_SIZE)
+            {
+                return false;
+            }
+
+            const size_t data_size = payload[HISTORY_PAYLOAD_HEADER_SIZE - 1];
+            if (HISTORY_PAYLOAD_HEADER_SIZE + data_size != m_frame.payload_size)
+            {
+                return false;
+            }
+
+            uint16_t message_offset = payload[1] | (payload[2] << 8);
+            uint16_t end_offset = payload[3] | (payload[4] << 8);
+
+            // A message without records before the end would be sent again forever.
+            if (data_size == 0 && message_offset != end_offset)
+            {
+                return false;
+            }
+
+            TemperatureVoteResult sample{};
+            size_t index = 5;
+            for (size_t i = 0; i < sensor_count; ++i, index += 2)
+            {
+                sample.temps[i] = payload[index] | (payload[index + 1] << 8);
+            }
+
+            sample.average = payload[index] | (payload[index + 1] << 8);
+
+            size_t position = 0;
+            while (position < data_size)
+            {
+                const uint8_t *record = payload + HISTORY_PAYLOAD_HEADER_SIZE + position;
+                size_type consumed = history_decode(sample, record, static_cast<size_type>(data_size - position));
+                if (consumed == 0)
+                {
+                    return false;
+                }
+
+                position += consumed;
+
+                TemperatureResult result{};
+                result.sensor_count = static_cast<unsigned>(sensor_count);
+                for (size_t i = 0; i < sensor_count; ++i)
+                {
+                    result.temps[i] = sample.temps[i] / 100.0;
+                    result.temps_ok[i] = sample.is_agree(i);
+                }
+
+                result.average = sample.average / 100.0;
+                result.sample_age_ms = 0;
+                dest.push_back(result);
+            }
+
+            offset = static_cast<uint16_t>(message_offset + data_size);
+            if (offset == end_offset)
+            {
+                return true;
+            }
+        }
+    }
+
+    bool send_request(RequestType request_type, uint16_t argument)
+    {
+        if (static_cast<uint8_t>(request_type) > MAX_REQUEST_TYPE)
         {
             return false;
         }
 
-        return true;
+        const uint8_t payload[] = {
+            static_cast<uint8_t>(request_type), static_cast<uint8_t>(argument), static_cast<uint8_t>(argument >> 8)};
+        return write_request(payload, sizeof(payload));
     }
 
-    bool read_next(MessageType &message_type)
+    bool send_request_with_id(RequestType request_type, uint8_t request_id)
     {
-        BOOL rc;
-        DWORD bytes_read;
+        using namespace scottz0r::temperature;
 
-        // Read first byte to know which message there is.
-        rc = ReadFile(m_handle, m_buffer, 1, &bytes_read, nullptr);
-        if (!rc || bytes_read != 1)
+        if (static_cast<uint8_t>(request_type) > MAX_REQUEST_TYPE)
         {
             return false;
         }
 
-        DWORD message_bytes = 0;
+        const uint8_t payload[] = {
+            static_cast<uint8_t>(static_cast<uint8_t>(request_type) | MESSAGE_REQUEST_ID_FLAG), request_id};
+        return write_request(payload, sizeof(payload));
+    }
 
-        switch (m_buffer[0])
+    bool send_request(RequestType request_type)
+    {
+        if (static_cast<uint8_t>(request_type) > MAX_REQUEST_TYPE)
         {
-        case 1:
-            message_bytes = MSG_SIZE_TEMPERATURE;
-            message_type = MessageType::Temperature;
-            break;
-        case 2:
-            message_bytes = MSG_SIZE_SYSTEM_STATUS;
-            message_type = MessageType::SystemStatus;
-            break;
-        case 3:
-            message_bytes = MSG_SIZE_ERROR;
-            message_type = MessageType::Error;
-            break;
-        default:
             return false;
         }
 
-        // Read next set of bytes and preserve the first spot in the buffer. The bytes to read will be one less than
-        // the message size because byte 1 has been read.
-        message_bytes -= 1;
-        rc = ReadFile(m_handle, m_buffer + 1, message_bytes, &bytes_read, nullptr);
-        if (!rc || bytes_read != message_bytes)
+        const uint8_t payload[] = {static_cast<uint8_t>(request_type)};
+        return write_request(payload, sizeof(payload));
+    }
+
+    bool write_request(const uint8_t *payload, size_t payload_size)
+    {
+        using namespace scottz0r::temperature;
+
+        uint8_t frame[FRAME_OVERHEAD + MAX_REQUEST_PAYLOAD];
+        frame[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageType::Request);
+        std::copy(payload, payload + payload_size, frame + FRAME_PAYLOAD_INDEX);
+
+        size_type frame_size = frame_seal(frame, static_cast<size_type>(payload_size));
+        return m_port.write(frame, frame_size);
+    }
+
+    /// @brief Wait for the next message from the device. It is available in m_frame until the next call. On failure,
+    /// m_is_timeout tells whether no message arrived in time or the port failed.
+    bool read_next(MessageType &message_type)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SerialPort::TIMEOUT_MS);
+        m_is_timeout = false;
+
+        for (;;)
         {
-            return false;
+            // Decode from the bytes already read before reading more. The frame points into m_rx, or into the
+            // decoder if it was split across reads.
+            bool has_frame = false;
+            m_rx_begin += m_decoder.push(m_rx + m_rx_begin, m_rx_end - m_rx_begin, [&](const Frame &frame) {
+                m_frame = frame;
+                has_frame = true;
+                return false;
+            });
+
+            if (has_frame)
+            {
+                message_type = static_cast<MessageType>(m_frame.identifier);
+                return true;
+            }
+
+            // Noise alone must not keep the caller waiting forever.
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                m_is_timeout = true;
+                return false;
+            }
+
+            m_rx_begin = 0;
+            m_rx_end = 0;
+            SerialPort::ReadStatus status = m_port.read_some(m_rx, sizeof(m_rx), m_rx_end);
+            if (status != SerialPort::ReadStatus::OK)
+            {
+                m_is_timeout = status == SerialPort::ReadStatus::Timeout;
+                return false;
+            }
         }
+    }
+
+    /// @brief Wait for the next message that is not part of a stream. A stream may be running, or may have sent
+    /// messages before it was stopped.
+    bool read_reply(MessageType &message_type)
+    {
+        do
+        {
+            if (!read_next(message_type))
+            {
+                return false;
+            }
+        } while (message_type == MessageType::TemperatureStream);
 
         return true;
     }
 
+    /// @brief Return the port to the default rate after a failed change, and wait until the device has fallen back
+    /// too. The device falls back when no valid request arrives within its confirm timeout.
+    /// @return Always false, for the caller to return.
+    bool fall_back()
+    {
+        using namespace std::chrono;
+
+        std::this_thread::sleep_for(milliseconds(CFG_BAUD_CONFIRM_TIMEOUT));
+
+        m_port.set_baud_rate(SerialPort::DEFAULT_BAUD_RATE);
+        m_baud_rate = SerialPort::DEFAULT_BAUD_RATE;
+        discard_input();
+        return false;
+    }
+
+    /// @brief Forget bytes read but not decoded, such as bytes received at the wrong rate.
+    void discard_input()
+    {
+        m_rx_begin = 0;
+        m_rx_end = 0;
+        m_decoder.reset();
+    }
+
     void decode_error()
     {
         // TODO?
@@ -221,47 +554,82 @@ struct TripleTemperature::Impl
 
     bool decode_status(StatusResult &dest)
     {
-        dest.system_status = (int)m_buffer[1];
-        dest.sensor_0_ok = bool(m_buffer[2] & 0x01);
-        dest.sensor_1_ok = bool(m_buffer[2] & 0x01);
-        dest.sensor_2_ok = bool(m_buffer[2] & 0x01);
+        // Older firmware sends the first three bytes only.
+        const uint8_t *payload = m_frame.payload;
+        if (m_frame.payload_size < 3)
+        {
+            return false;
+        }
 
-        uint8_t checksum = 0;
-        checksum ^= m_buffer[0];
-        checksum ^= m_buffer[1];
-        checksum ^= m_buffer[2];
+        dest.sensor_count = payload[0] <= MAX_SENSOR_COUNT ? payload[0] : MAX_SENSOR_COUNT;
+        dest.system_status = (int)payload[1];
+        for (unsigned i = 0; i < MAX_SENSOR_COUNT; ++i)
+        {
+            dest.sensors_ok[i] = bool(payload[2] & (1 << i));
+        }
+
+        const bool has_tx_queue = m_frame.payload_size >= scottz0r::temperature::SYSTEM_STATUS_PAYLOAD_SIZE;
+        dest.tx_queue_size = has_tx_queue ? payload[3] : 0;
+        dest.tx_queue_peak = has_tx_queue ? payload[4] : 0;
 
-        return checksum == m_buffer[3];
+        return true;
     }
 
-    bool decode_temperature(TemperatureResult &dest)
+    bool decode_diagnostics(DiagnosticsResult &dest)
     {
-        int16_t temp0 = m_buffer[2] | (m_buffer[3] << 8);
-        dest.temp0 = temp0 / 100.0;
-        dest.temp0_ok = bool(m_buffer[8] & 0x01);
+        // Sensor count, then the loop times, one set of time stats per sensor, the reply latency and the byte counts.
+        const uint8_t *payload = m_frame.payload;
+        if (m_frame.payload_size < 1)
+        {
+            return false;
+        }
 
-        int16_t temp1 = m_buffer[4] | (m_buffer[5] << 8);
-        dest.temp1 = temp1 / 100.0;
-        dest.temp1_ok = bool(m_buffer[8] & 0x02);
+        const unsigned sensor_count = payload[0];
+        if (sensor_count > MAX_SENSOR_COUNT || m_frame.payload_size < 19 + 6 * sensor_count)
+        {
+            return false;
+        }
 
-        int16_t temp2 = m_buffer[6] | (m_buffer[7] << 8);
-        dest.temp2 = temp2 / 100.0;
-        dest.temp2_ok = bool(m_buffer[8] & 0x04);
+        auto read_uint16 = [&](size_t index) { return unsigned(payload[index] | (payload[index + 1] << 8)); };
+        auto read_stats = [&](size_t index) {
+            return TimeStatsResult{read_uint16(index), read_uint16(index + 2), read_uint16(index + 4)};
+        };
 
-        int16_t average_temp = m_buffer[9] | (m_buffer[10] << 8);
-        dest.average = average_temp / 100.0;
+        dest.sensor_count = sensor_count;
+        dest.loop_rate = read_uint16(1);
+        dest.loop_time_max = read_uint16(3);
 
-        uint8_t checksum = 0;
-        for (size_t i = 0; i < 11; ++i)
+        size_t index = 5;
+        for (unsigned i = 0; i < sensor_count; ++i, index += 6)
         {
-            checksum ^= m_buffer[i];
+            dest.sensor_times[i] = read_stats(index);
         }
 
-        return checksum == m_buffer[11];
+        dest.reply_latency = read_stats(index);
+        dest.bytes_received = read_uint16(index + 6) | (static_cast<unsigned long>(read_uint16(index + 8)) << 16);
+        dest.bytes_discarded = read_uint16(index + 10);
+        dest.crc_failures = read_uint16(index + 12);
+
+        return true;
+    }
+
+    /// @brief Decode the temperature fields shared by the temperature and temperature stream messages.
+    bool decode_temperature(TemperatureResult &dest)
+    {
+        return decode_temperature_message(m_frame.payload, m_frame.payload_size, dest);
     }
 
-    uint8_t m_buffer[16];
-    HANDLE m_handle;
+    // Bytes read from the port that have not been decoded yet. One read can hold many messages.
+    uint8_t m_rx[1024];
+    size_t m_rx_begin = 0;
+    size_t m_rx_end = 0;
+
+    FrameDecoder m_decoder;
+    Frame m_frame{};
+    bool m_is_timeout = false;
+    uint8_t m_next_request_id = 0;
+    unsigned long m_baud_rate = SerialPort::DEFAULT_BAUD_RATE;
+    SerialPort m_port;
 };
 
 TripleTemperature::TripleTemperature()
@@ -289,23 +657,97 @@ bool TripleTemperature::get_temperature(TemperatureResult &dest)
     return p_impl->get_temperature(dest);
 }
 
+bool TripleTemperature::get_temperatures(std::vector<TemperatureResult> &dest, size_t count, unsigned depth)
+{
+    return p_impl->get_temperatures(dest, count, depth);
+}
+
 bool TripleTemperature::get_status(StatusResult &dest)
 {
     return p_impl->get_status(dest);
 }
 
+bool TripleTemperature::get_diagnostics(DiagnosticsResult &dest)
+{
+    return p_impl->get_diagnostics(dest);
+}
+
+bool TripleTemperature::set_baud_rate(unsigned long baud)
+{
+    return p_impl->set_baud_rate(baud);
+}
+
+unsigned long TripleTemperature::baud_rate() const
+{
+    return p_impl->baud_rate();
+}
+
 bool TripleTemperature::is_open()
 {
     return p_impl->is_open();
 }
 
+bool TripleTemperature::start_stream()
+{
+    return p_impl->start_stream();
+}
+
+bool TripleTemperature::subscribe()
+{
+    return p_impl->subscribe();
+}
+
+bool TripleTemperature::stop_stream()
+{
+    return p_impl->stop_stream();
+}
+
+ReadStatus TripleTemperature::read_stream(TemperatureResult &dest, uint8_t &sequence)
+{
+    return p_impl->read_stream(dest, sequence);
+}
+
+bool TripleTemperature::get_history(std::vector<TemperatureResult> &dest, uint16_t &offset)
+{
+    return p_impl->get_history(dest, offset);
+}
+
 std::wostream &operator<<(std::wostream &os, const StatusResult &status)
 {
     os << "Sensor Status:" << std::endl;
-    os << "Sensor 0: " << status.sensor_0_ok << std::endl;
-    os << "Sensor 1: " << status.sensor_1_ok << std::endl;
-    os << "Sensor 2: " << status.sensor_2_ok << std::endl;
+    for (unsigned i = 0; i < status.sensor_count; ++i)
+    {
+        os << "Sensor " << i << ": " << status.sensors_ok[i] << std::endl;
+    }
+
     os << "System: " << status.system_status << " (0 = OK)" << std::endl;
+    os << "TX Queue: " << status.tx_queue_size << " bytes (peak " << status.tx_queue_peak << ")" << std::endl;
+
+    return os;
+}
+
+std::wostream &operator<<(std::wostream &os, const DiagnosticsResult &diagnostics)
+{
+    auto write_stats = [&](const TimeStatsResult &stats) -> std::wostream & {
+        return os << stats.min << " / " << stats.average << " / " << stats.max << " us (min / avg / max)";
+    };
+
+    os << "Diagnostics:" << std::endl;
+    os << "Loop Rate: " << diagnostics.loop_rate << " passes/s" << std::endl;
+    os << "Loop Time Max: " << diagnostics.loop_time_max << " us" << std::endl;
+
+    for (unsigned i = 0; i < diagnostics.sensor_count; ++i)
+    {
+        os << "Sensor " << i << " Step: ";
+        write_stats(diagnostics.sensor_times[i]) << std::endl;
+    }
+
+    os << "Reply Latency: ";
+    write_stats(diagnostics.reply_latency) << std::endl;
+
+    os << "Bytes Received: " << diagnostics.bytes_received << std::endl;
+    os << "Bytes Discarded: " << diagnostics.bytes_discarded << std::endl;
+    os << "CRC Failures: " << diagnostics.crc_failures << std::endl;
 
     return os;
 }
@@ -316,16 +758,14 @@ std::wostream &operator<<(std::wostream &os, const TemperatureResult &temperatur
 
     os << "Temperature:" << std::endl;
 
-    os << "Temp0: " << temperature.temp0 << std::endl;
-    os << "Temp0 Good: " << temperature.temp0_ok << std::endl;
-
-    os << "Temp1: " << temperature.temp1 << std::endl;
-    os << "Temp0 Good: " << temperature.temp1_ok << std::endl;
-
-    os << "Temp2: " << temperature.temp2 << std::endl;
-    os << "Temp0 Good: " << temperature.temp2_ok << std::endl;
+    for (unsigned i = 0; i < temperature.sensor_count; ++i)
+    {
+        os << "Temp" << i << ": " << temperature.temps[i] << std::endl;
+        os << "Temp" << i << " Good: " << temperature.temps_ok[i] << std::endl;
+    }
 
     os << "Average: " << temperature.average << std::endl;
+    os << "Sample Age: " << temperature.sample_age_ms << "ms" << std::endl;
 
     return os;
 }
@@ -3,24 +3,72 @@
 #include <cstdint>
 #include <iostream>
 #include <string>
+#include <vector>
+
+/// @brief Most sensors a device can report.
+static constexpr unsigned MAX_SENSOR_COUNT = 8;
+
+/// @brief Most requests get_temperatures keeps in flight. The device queues four requests and holds more in its 64 byte
+/// serial receive buffer.
+static constexpr unsigned MAX_PIPELINE_DEPTH = 8;
+
+/// @brief Outcome of waiting for a message the device sends on its own.
+enum class ReadStatus
+{
+    OK,
+
+    // Nothing arrived within the read timeout. A subscribed stream is quiet while the temperature is stable.
+    Timeout,
+
+    // The port failed, or the message could not be decoded.
+    Failed
+};
 
 struct TemperatureResult
 {
     double average;
-    double temp0;
-    double temp1;
-    double temp2;
-    bool temp0_ok;
-    bool temp1_ok;
-    bool temp2_ok;
+    unsigned sensor_count;
+    double temps[MAX_SENSOR_COUNT];
+    bool temps_ok[MAX_SENSOR_COUNT];
+    unsigned sample_age_ms;
 };
 
 struct StatusResult
 {
     int system_status;
-    bool sensor_0_ok;
-    bool sensor_1_ok;
-    bool sensor_2_ok;
+    unsigned sensor_count;
+    bool sensors_ok[MAX_SENSOR_COUNT];
+
+    // Bytes waiting in the device's transmit queue, and the most since boot. Zero from older firmware.
+    unsigned tx_queue_size;
+    unsigned tx_queue_peak;
+};
+
+/// @brief Minimum, average and maximum of a time, in microseconds. All zero if nothing was timed.
+struct TimeStatsResult
+{
+    unsigned min;
+    unsigned average;
+    unsigned max;
+};
+
+struct DiagnosticsResult
+{
+    unsigned sensor_count;
+
+    // Main loop passes in the last full second, and the longest pass since boot.
+    unsigned loop_rate;
+    unsigned loop_time_max;
+
+    // Time of a sampler step per sensor.
+    TimeStatsResult sensor_times[MAX_SENSOR_COUNT];
+
+    // Time from receiving a request to sending the first byte of its reply.
+    TimeStatsResult reply_latency;
+
+    unsigned long bytes_received;
+    unsigned bytes_discarded;
+    unsigned crc_failures;
 };
 
 class TripleTemperature
@@ -38,14 +86,55 @@ public:
 
     bool get_temperature(TemperatureResult &dest);
 
+    /// @brief Request several temperatures without waiting for each reply before sending the next request. Requests
+    /// carry an ID, and replies are matched to requests by ID.
+    /// @param dest Results are appended in request order.
+    /// @param count Number of temperature requests.
+    /// @param depth Requests in flight at once, 1 to MAX_PIPELINE_DEPTH.
+    bool get_temperatures(std::vector<TemperatureResult> &dest, size_t count, unsigned depth);
+
     bool get_status(StatusResult &dest);
 
+    /// @brief Read the device's performance counters. Fails if the firmware was built without them.
+    bool get_diagnostics(DiagnosticsResult &dest);
+
     bool is_open();
 
+    /// @brief Switch the device and the port to another baud rate. The device acknowledges at the current rate and
+    /// switches, then a status request at the new rate confirms it. If the change fails, the port and the device both
+    /// fall back to 115200, which takes the device's confirm timeout.
+    /// @param baud 115200, 250000, 500000 or 1000000.
+    bool set_baud_rate(unsigned long baud);
+
+    /// @brief Rate the port runs at. 115200 after connect.
+    unsigned long baud_rate() const;
+
+    bool start_stream();
+
+    /// @brief Start a change-triggered stream. Messages are read with read_stream() and stopped with stop_stream().
+    bool subscribe();
+
+    /// @brief Stop a stream, and drop the stream messages still arriving. Waits for the device to acknowledge the stop.
+    bool stop_stream();
+
+    /// @brief Wait for the next unsolicited temperature stream message.
+    /// @param dest Decoded temperature.
+    /// @param sequence Stream sequence number. Increments by one per message, so a gap means messages were dropped.
+    ReadStatus read_stream(TemperatureResult &dest, uint8_t &sequence);
+
+    /// @brief Download the sample history recorded on the device, oldest first. History samples have no sample age.
+    /// Only devices with the same sensor count as the firmware this tester is built with can be decoded.
+    /// @param dest Downloaded samples are appended.
+    /// @param offset Offset to resume from, or 0xFFFF for the oldest sample. Updated to the offset to resume from
+    /// next time. If the first sample's offset moved forward, the device dropped samples the host had not read.
+    bool get_history(std::vector<TemperatureResult> &dest, uint16_t &offset);
+
 private:
     Impl *p_impl;
 };
 
 std::wostream &operator<<(std::wostream &os, const StatusResult &status);
 
+std::wostream &operator<<(std::wostream &os, const DiagnosticsResult &diagnostics);
+
 std::wostream &operator<<(std::wostream &os, const TemperatureResult &temperature);
@@ -0,0 +1,216 @@
+///
+/// @file
+///
+/// Runs the Triple Temperature firmware on a Linux host. The serial port is a pseudo-terminal and the sensors are
+/// simulated, so host programs can be tested without a board.
+#include "sim_pty_serial.h"
+
+#include <Arduino.h>
+#include <mcp9808_model.h>
+#include <prj_config.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+
+// Defined by prj_core.cpp.
+void setup();
+void loop();
+
+using namespace scottz0r::simulator;
+
+namespace
+{
+    /// @brief Arduino timing from the host steady clock. millis() starts at zero like on the board.
+    class HostArduino : public ArduinoImpl
+    {
+    public:
+        HostArduino() : m_start(std::chrono::steady_clock::now())
+        {
+        }
+
+        unsigned long millis() override
+        {
+            auto elapsed = std::chrono::steady_clock::now() - m_start;
+            return static_cast<unsigned long>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+        }
+
+        unsigned long micros() override
+        {
+            auto elapsed = std::chrono::steady_clock::now() - m_start;
+            return static_cast<unsigned long>(
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        }
+
+        void delay(unsigned long ms) override
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    volatile std::sig_atomic_t is_running = 1;
+
+    void on_signal(int)
+    {
+        is_running = 0;
+    }
+
+    void print_usage(const char *name)
+    {
+        std::printf(
+            "Usage: %s [options]\n"
+            "  --link PATH     Create a symbolic link to the serial port at PATH.\n"
+            "  --temp C        Temperature of every sensor in Celsius. Default 22.5.\n"
+            "  --offset I:C    Add C Celsius to sensor I.\n"
+            "  --noise C       Standard deviation of noise added to each conversion. Default 0.\n"
+            "  --fail I        Sensor I does not respond on the bus. May be repeated.\n"
+            "  --seed N        Noise random seed. Default 1.\n",
+            name);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    static const uint8_t sensor_addresses[] = CFG_SENSOR_ADDRESSES;
+    constexpr int sensor_count = sizeof(sensor_addresses) / sizeof(sensor_addresses[0]);
+
+    std::string link_path;
+    double temperature = 22.5;
+    double noise = 0.0;
+    double offsets[sensor_count] = {};
+    bool is_failed[sensor_count] = {};
+    unsigned seed = 1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0)
+        {
+            print_usage(argv[0]);
+            return 0;
+        }
+
+        if (!value)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        ++i;
+        if (std::strcmp(arg, "--link") == 0)
+        {
+            link_path = value;
+        }
+        else if (std::strcmp(arg, "--temp") == 0)
+        {
+            temperature = std::atof(value);
+        }
+        else if (std::strcmp(arg, "--noise") == 0)
+        {
+            noise = std::atof(value);
+        }
+        else if (std::strcmp(arg, "--seed") == 0)
+        {
+            seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        }
+        else if (std::strcmp(arg, "--offset") == 0 || std::strcmp(arg, "--fail") == 0)
+        {
+            char *end = nullptr;
+            long index = std::strtol(value, &end, 10);
+            if (index < 0 || index >= sensor_count)
+            {
+                std::fprintf(stderr, "Sensor index must be 0 to %d.\n", sensor_count - 1);
+                return 1;
+            }
+
+            if (arg[2] == 'f')
+            {
+                is_failed[index] = true;
+            }
+            else if (*end == ':')
+            {
+                offsets[index] = std::atof(end + 1);
+            }
+            else
+            {
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    SimPtySerial serial;
+    if (!serial.open(link_path))
+    {
+        std::perror("Failed to open pseudo-terminal");
+        return 1;
+    }
+
+    // The sensor models time their conversions with millis(), so the clock comes first.
+    HostArduino arduino;
+    arduino_impl = &arduino;
+
+    // Failed sensors are left off the bus, so they NACK.
+    I2cBusModel bus;
+    std::deque<Mcp9808Model> sensors;
+    std::mt19937 random(seed);
+    for (int i = 0; i < sensor_count; ++i)
+    {
+        sensors.emplace_back(sensor_addresses[i], temperature + offsets[i]);
+        if (noise > 0)
+        {
+            double mean = temperature + offsets[i];
+            sensors.back().set_temperature_source([&random, mean, noise](unsigned long) {
+                std::normal_distribution<double> distribution(mean, noise);
+                return distribution(random);
+            });
+        }
+
+        if (!is_failed[i])
+        {
+            bus.attach(sensors.back());
+        }
+    }
+
+    wire_impl = &bus;
+    serial_impl = &serial;
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::printf("Simulated device on %s\n", serial.slave_path().c_str());
+    std::fflush(stdout);
+
+    setup();
+    while (is_running)
+    {
+        loop();
+
+        // The firmware polls, so sleep briefly between passes instead of spinning a core.
+        serial.wait_input(1);
+    }
+
+    if (serial.dropped_bytes() > 0)
+    {
+        std::printf("Dropped %lu bytes with no host reading.\n", serial.dropped_bytes());
+    }
+
+    return 0;
+}
@@ -0,0 +1,272 @@
+#include "sim_pty_serial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace scottz0r
+{
+namespace simulator
+{
+    SimPtySerial::SimPtySerial()
+        : m_master_fd(-1), m_slave_fd(-1), m_dropped_bytes(0), m_byte_time(std::chrono::nanoseconds(86806)),
+          m_rx{}, m_rx_size(0), m_rx_index(0), m_tx{}, m_tx_size(0)
+    {
+    }
+
+    SimPtySerial::~SimPtySerial()
+    {
+        if (!m_link_path.empty())
+        {
+            unlink(m_link_path.c_str());
+        }
+
+        if (m_slave_fd >= 0)
+        {
+            close(m_slave_fd);
+        }
+
+        if (m_master_fd >= 0)
+        {
+            close(m_master_fd);
+        }
+    }
+
+    bool SimPtySerial::open(const std::string &link_path)
+    {
+        m_master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (m_master_fd < 0)
+        {
+            return false;
+        }
+
+        if (grantpt(m_master_fd) != 0 || unlockpt(m_master_fd) != 0)
+        {
+            return false;
+        }
+
+        const char *name = ptsname(m_master_fd);
+        if (!name)
+        {
+            return false;
+        }
+
+        m_slave_path = name;
+
+        // Hold the slave open so that reads on the master do not fail with EIO while no host has the port open.
+        m_slave_fd = ::open(name, O_RDWR | O_NOCTTY);
+        if (m_slave_fd < 0)
+        {
+            return false;
+        }
+
+        // The protocol is binary, so turn off echo, line editing and newline translation.
+        termios tio;
+        if (tcgetattr(m_slave_fd, &tio) != 0)
+        {
+            return false;
+        }
+
+        cfmakeraw(&tio);
+        if (tcsetattr(m_slave_fd, TCSANOW, &tio) != 0)
+        {
+            return false;
+        }
+
+        int flags = fcntl(m_master_fd, F_GETFL);
+        if (flags < 0 || fcntl(m_master_fd, F_SETFL, flags | O_NONBLOCK) != 0)
+        {
+            return false;
+        }
+
+        if (!link_path.empty())
+        {
+            unlink(link_path.c_str());
+            if (symlink(name, link_path.c_str()) != 0)
+            {
+                return false;
+            }
+
+            m_link_path = link_path;
+        }
+
+        return true;
+    }
+
+    void SimPtySerial::wait_input(int timeout_ms)
+    {
+        if (available() > 0)
+        {
+            return;
+        }
+
+        Clock::time_point now = Clock::now();
+        Clock::time_point deadline = now + std::chrono::milliseconds(timeout_ms);
+
+        // Wake when half the transmit buffer has gone out, so the firmware can refill it before the line goes idle.
+        if (m_tx_size > 0)
+        {
+            deadline = std::min(deadline, m_tx_start + m_byte_time * static_cast<long>((m_tx_size + 1) / 2));
+        }
+
+        // Input that has not had time to arrive would wake poll right away, so wait for the time instead.
+        pollfd pfd{m_master_fd, POLLIN, 0};
+        if (m_rx_index < m_rx_size)
+        {
+            deadline = std::min(deadline, m_rx_ready);
+            pfd.events = 0;
+        }
+
+        if (deadline <= now)
+        {
+            return;
+        }
+
+        auto wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+        timespec timeout{static_cast<time_t>(wait_ns / 1000000000), static_cast<long>(wait_ns % 1000000000)};
+        ppoll(&pfd, 1, &timeout, nullptr);
+    }
+
+    void SimPtySerial::begin(unsigned long baud)
+    {
+        // 8N1 is ten bits per byte.
+        m_byte_time = std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(10000000000ull / baud));
+    }
+
+    int SimPtySerial::available()
+    {
+        fill();
+        if (Clock::now() < m_rx_ready)
+        {
+            return 0;
+        }
+
+        return static_cast<int>(m_rx_size - m_rx_index);
+    }
+
+    int SimPtySerial::read()
+    {
+        if (available() == 0)
+        {
+            return -1;
+        }
+
+        return m_rx[m_rx_index++];
+    }
+
+    int SimPtySerial::availableForWrite()
+    {
+        // One byte of the Uno's transmit buffer is never used.
+        drain();
+        return static_cast<int>(sizeof(m_tx) - 1 - m_tx_size);
+    }
+
+    void SimPtySerial::write(const uint8_t *buf, size_t size)
+    {
+        // Like the Uno, blocks while the transmit buffer is full.
+        while (size > 0)
+        {
+            int room = availableForWrite();
+            if (room == 0)
+            {
+                std::this_thread::sleep_until(m_tx_start + m_byte_time);
+                continue;
+            }
+
+            if (m_tx_size == 0)
+            {
+                m_tx_start = Clock::now();
+            }
+
+            size_t n = std::min(size, static_cast<size_t>(room));
+            memcpy(m_tx + m_tx_size, buf, n);
+            m_tx_size += n;
+            buf += n;
+            size -= n;
+        }
+    }
+
+    void SimPtySerial::flush()
+    {
+        while (m_tx_size > 0)
+        {
+            std::this_thread::sleep_until(m_tx_start + m_byte_time * static_cast<long>(m_tx_size));
+            drain();
+        }
+    }
+
+    void SimPtySerial::fill()
+    {
+        if (m_rx_index < m_rx_size)
+        {
+            return;
+        }
+
+        ssize_t n = ::read(m_master_fd, m_rx, sizeof(m_rx));
+        if (n <= 0)
+        {
+            return;
+        }
+
+        // Bytes read together were written together, usually one whole frame, and are taken once the last of them has
+        // had time to arrive. They follow the previous bytes if those were still arriving. Taking a frame whole means
+        // the firmware's message timeout cannot expire part way through one while the host scheduler holds up the
+        // simulator.
+        Clock::time_point start = std::max(Clock::now(), m_rx_ready);
+        m_rx_ready = start + m_byte_time * n;
+        m_rx_size = static_cast<size_t>(n);
+        m_rx_index = 0;
+    }
+
+    void SimPtySerial::drain()
+    {
+        if (m_tx_size == 0)
+        {
+            return;
+        }
+
+        size_t sent = static_cast<size_t>((Clock::now() - m_tx_start) / m_byte_time);
+        if (sent == 0)
+        {
+            return;
+        }
+
+        sent = std::min(sent, m_tx_size);
+        write_pty(m_tx, sent);
+
+        memmove(m_tx, m_tx + sent, m_tx_size - sent);
+        m_tx_size -= sent;
+        m_tx_start += m_byte_time * static_cast<long>(sent);
+    }
+
+    void SimPtySerial::write_pty(const uint8_t *buf, size_t size)
+    {
+        size_t written = 0;
+        while (written < size)
+        {
+            ssize_t n = ::write(m_master_fd, buf + written, size - written);
+            if (n > 0)
+            {
+                written += static_cast<size_t>(n);
+            }
+            else if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else
+            {
+                // The USB serial bridge on the Uno keeps sending when nothing reads the port, so drop the rest.
+                m_dropped_bytes += size - written;
+                return;
+            }
+        }
+    }
+} // namespace simulator
+} // namespace scottz0r
@@ -0,0 +1,101 @@
+///
+/// @file
+///
+/// Serial port for the host simulator, backed by a Linux pseudo-terminal.
+#ifndef _SCOTTZ0R_SIMULATOR_SIM_PTY_SERIAL_INCLUDE_GUARD
+#define _SCOTTZ0R_SIMULATOR_SIM_PTY_SERIAL_INCLUDE_GUARD
+
+#include <HardwareSerial.h>
+
+#include <chrono>
+#include <string>
+
+namespace scottz0r
+{
+namespace simulator
+{
+    /// @brief HardwareSerialImpl that reads and writes the master side of a pseudo-terminal. A host program opens the
+    /// slave path like any other serial port.
+    ///
+    /// A pseudo-terminal has no line rate, so the rate set with begin() is emulated. Written bytes wait in a 64 byte
+    /// transmit buffer like the Uno's and go to the pseudo-terminal one byte time apart, ten bits per byte. Received
+    /// bytes are available once they have had time to arrive at the same rate. The host's port rate is not checked.
+    class SimPtySerial : public HardwareSerialImpl
+    {
+    public:
+        SimPtySerial();
+
+        ~SimPtySerial();
+
+        SimPtySerial(const SimPtySerial &) = delete;
+
+        SimPtySerial &operator=(const SimPtySerial &) = delete;
+
+        /// @brief Create the pseudo-terminal in raw mode.
+        /// @param link_path If not empty, a symbolic link to the slave path is created here.
+        /// @return True on success.
+        bool open(const std::string &link_path);
+
+        /// @brief Path of the slave side, for example /dev/pts/3.
+        const std::string &slave_path() const
+        {
+            return m_slave_path;
+        }
+
+        /// @brief Wait for input, for room in the transmit buffer, or until the timeout passes.
+        void wait_input(int timeout_ms);
+
+        /// @brief Bytes dropped because no host was reading and the pseudo-terminal buffer was full.
+        unsigned long dropped_bytes() const
+        {
+            return m_dropped_bytes;
+        }
+
+        void begin(unsigned long baud) override;
+
+        int available() override;
+
+        int read() override;
+
+        int availableForWrite() override;
+
+        void write(const uint8_t *buf, size_t size) override;
+
+        void flush() override;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief Read the next received bytes from the pseudo-terminal once the previous ones are taken.
+        void fill();
+
+        /// @brief Send the transmit buffer bytes that have had time to go out.
+        void drain();
+
+        /// @brief Write to the pseudo-terminal, dropping what does not fit.
+        void write_pty(const uint8_t *buf, size_t size);
+
+        int m_master_fd;
+        int m_slave_fd;
+        std::string m_slave_path;
+        std::string m_link_path;
+        unsigned long m_dropped_bytes;
+
+        // Time to send one byte at the rate set with begin(). 115200 baud until then.
+        Clock::duration m_byte_time;
+
+        // Mirrors the 64 byte receive buffer of the Uno. Received bytes are not available until m_rx_ready.
+        uint8_t m_rx[64];
+        size_t m_rx_size;
+        size_t m_rx_index;
+        Clock::time_point m_rx_ready;
+
+        // Mirrors the 64 byte transmit buffer of the Uno. The first byte finishes one byte time after m_tx_start.
+        uint8_t m_tx[64];
+        size_t m_tx_size;
+        Clock::time_point m_tx_start;
+    };
+} // namespace simulator
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_SIMULATOR_SIM_PTY_SERIAL_INCLUDE_GUARD
@@ -12,3 +12,21 @@ unsigned long millis()
 
     return 0;
 }
+
+unsigned long micros()
+{
+    if (arduino_impl)
+    {
+        return arduino_impl->micros();
+    }
+
+    return 0;
+}
+
+void delay(unsigned long ms)
+{
+    if (arduino_impl)
+    {
+        arduino_impl->delay(ms);
+    }
+}
@@ -8,6 +8,10 @@ extern "C"
 
     unsigned long millis();
 
+    unsigned long micros();
+
+    void delay(unsigned long ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,6 +20,16 @@ class ArduinoImpl
 {
 public:
     virtual unsigned long millis() = 0;
+
+    /// @brief Microsecond clock. Follows millis() unless an implementation has a finer clock.
+    virtual unsigned long micros()
+    {
+        return millis() * 1000;
+    }
+
+    virtual void delay(unsigned long)
+    {
+    }
 };
 
 extern ArduinoImpl *arduino_impl;
@@ -2,23 +2,58 @@
 
 // extern declared in HardwareSerial.h
 HardwareSerial Serial;
+HardwareSerialImpl *serial_impl;
 
 void HardwareSerial::begin(unsigned long baud)
 {
-
+    if (serial_impl)
+    {
+        serial_impl->begin(baud);
+    }
 }
 
 int HardwareSerial::available()
 {
+    if (serial_impl)
+    {
+        return serial_impl->available();
+    }
+
     return 0;
 }
 
 int HardwareSerial::read()
 {
+    if (serial_impl)
+    {
+        return serial_impl->read();
+    }
+
+    return 0;
+}
+
+int HardwareSerial::availableForWrite()
+{
+    if (serial_impl)
+    {
+        return serial_impl->availableForWrite();
+    }
+
     return 0;
 }
 
-void HardwareSerial::write(uint8_t *buf, size_t size)
+void HardwareSerial::write(const uint8_t *buf, size_t size)
 {
+    if (serial_impl)
+    {
+        serial_impl->write(buf, size);
+    }
+}
 
+void HardwareSerial::flush()
+{
+    if (serial_impl)
+    {
+        serial_impl->flush();
+    }
 }
@@ -2,6 +2,7 @@
 #define _SCOTTZ0R_MOCKS_HARDWARE_SERIAL_INCLUDE_GUARD
 
 #include <inttypes.h>
+#include <stddef.h>
 
 class HardwareSerial
 {
@@ -12,7 +13,11 @@ public:
 
     int read();
 
-    void write(uint8_t* buf, size_t size);
+    int availableForWrite();
+
+    void write(const uint8_t *buf, size_t size);
+
+    void flush();
 
     operator bool()
     {
@@ -20,6 +25,25 @@ public:
     }
 };
 
+/// @brief Serial behaviour for host builds. Without an implementation, Serial has no input and discards output.
+class HardwareSerialImpl
+{
+public:
+    virtual void begin(unsigned long baud) = 0;
+
+    virtual int available() = 0;
+
+    virtual int read() = 0;
+
+    virtual int availableForWrite() = 0;
+
+    virtual void write(const uint8_t *buf, size_t size) = 0;
+
+    /// @brief Wait until every written byte has been sent.
+    virtual void flush() = 0;
+};
+
 extern HardwareSerial Serial;
+extern HardwareSerialImpl *serial_impl;
 
 #endif // _SCOTTZ0R_MOCKS_HARDWARE_SERIAL_INCLUDE_GUARD
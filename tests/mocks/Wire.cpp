@@ -1,5 +1,5 @@
 #include "Wire.h"
-#include <exception>
+#include <stdexcept>
 
 static constexpr auto IMPL_IS_NULL = "Wire impl is null";
 
@@ -15,7 +15,7 @@ int TwoWire::available()
     }
     else
     {
-        throw std::exception(IMPL_IS_NULL);
+        throw std::runtime_error(IMPL_IS_NULL);
     }
 }
 
@@ -27,7 +27,7 @@ void TwoWire::begin()
     }
     else
     {
-        throw std::exception(IMPL_IS_NULL);
+        throw std::runtime_error(IMPL_IS_NULL);
     }
 }
 
@@ -39,7 +39,7 @@ void TwoWire::beginTransmission(uint8_t val)
     }
     else
     {
-        throw std::exception(IMPL_IS_NULL);
+        throw std::runtime_error(IMPL_IS_NULL);
     }
 }
 
@@ -51,7 +51,7 @@ uint8_t TwoWire::endTransmission()
     }
     else
     {
-        throw std::exception(IMPL_IS_NULL);
+        throw std::runtime_error(IMPL_IS_NULL);
     }
 }
 
@@ -63,7 +63,7 @@ int TwoWire::read()
     }
     else
     {
-        throw std::exception(IMPL_IS_NULL);
+        throw std::runtime_error(IMPL_IS_NULL);
     }
 }
 
@@ -75,7 +75,7 @@ uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t cmd)
     }
     else
     {
-        throw std::exception(IMPL_IS_NULL);
+        throw std::runtime_error(IMPL_IS_NULL);
     }
 }
 
@@ -87,6 +87,6 @@ size_t TwoWire::write(uint8_t val)
     }
     else
     {
-        throw std::exception(IMPL_IS_NULL);
+        throw std::runtime_error(IMPL_IS_NULL);
     }
 }
@@ -2,6 +2,7 @@
 #define _SCOTTZ0R_MOCKS_WIRE_INCLUDE_GUARD
 
 #include <inttypes.h>
+#include <stddef.h>
 
 class TwoWire
 {
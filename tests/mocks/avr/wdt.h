@@ -1,6 +1,8 @@
 #ifndef _SCOTTZ0R_TESTS_MOCKS_AVR_WDT_INCLUDE_GUARD
 #define _SCOTTZ0R_TESTS_MOCKS_AVR_WDT_INCLUDE_GUARD
 
+#include <inttypes.h>
+
 #define WDTO_15MS   0
 #define WDTO_30MS   1
 #define WDTO_60MS   2
@@ -10,9 +12,24 @@
 #define WDTO_1S     6
 #define WDTO_2S     7
 
-// TODO: Probably would want these to be functions to test loop/setup for read.
-#define wdt_enable(timeout)
-#define wdt_disable()
-#define wdt_reset()
+void wdt_enable(uint8_t timeout);
+
+void wdt_disable();
+
+void wdt_reset();
+
+/// @brief Watchdog behaviour for host builds. Without an implementation, the watchdog does nothing.
+class WdtImpl
+{
+public:
+    /// @param timeout One of the WDTO_ values.
+    virtual void enable(uint8_t timeout) = 0;
+
+    virtual void disable() = 0;
+
+    virtual void reset() = 0;
+};
+
+extern WdtImpl *wdt_impl;
 
 #endif // _SCOTTZ0R_TESTS_MOCKS_AVR_WDT_INCLUDE_GUARD
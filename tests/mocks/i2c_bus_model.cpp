@@ -0,0 +1,164 @@
+#include "i2c_bus_model.h"
+
+#include "Arduino.h"
+
+#include <stdio.h>
+
+/// @brief Clock label for time spent on a transaction with a device.
+static std::string spend_label(uint8_t address)
+{
+    char label[16];
+    snprintf(label, sizeof(label), "I2C 0x%02X", address);
+    return label;
+}
+
+I2cBusModel::I2cBusModel()
+    : m_devices{}, m_tx_address(0), m_tx{}, m_tx_size(0), m_rx{}, m_rx_size(0), m_rx_index(0), m_transactions(0),
+      m_timeouts(0), m_clock(nullptr), m_clock_rate(100000)
+{
+}
+
+void I2cBusModel::attach(I2cDeviceModel &device)
+{
+    m_devices[device.address() & 0x7F] = &device;
+}
+
+void I2cBusModel::detach(uint8_t address)
+{
+    m_devices[address & 0x7F] = nullptr;
+}
+
+I2cDeviceModel *I2cBusModel::find(uint8_t address) const
+{
+    return m_devices[address & 0x7F];
+}
+
+void I2cBusModel::set_clock(VirtualClock *clock, unsigned long clock_rate)
+{
+    m_clock = clock;
+    m_clock_rate = clock_rate;
+}
+
+void I2cBusModel::add_lockup(unsigned long start, unsigned long duration)
+{
+    m_lockups.push_back({start, duration});
+}
+
+bool I2cBusModel::is_locked(unsigned long now) const
+{
+    for (const Lockup &lockup : m_lockups)
+    {
+        if (now - lockup.start < lockup.duration)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int I2cBusModel::available()
+{
+    return static_cast<int>(m_rx_size - m_rx_index);
+}
+
+void I2cBusModel::begin()
+{
+}
+
+void I2cBusModel::beginTransmission(uint8_t address)
+{
+    m_tx_address = address;
+    m_tx_size = 0;
+}
+
+uint8_t I2cBusModel::endTransmission()
+{
+    if (!begin_transaction(m_tx_address))
+    {
+        return STATUS_TIMEOUT;
+    }
+
+    I2cDeviceModel *device = find(m_tx_address);
+    if (!device)
+    {
+        spend(m_tx_address, 0);
+        return STATUS_ADDRESS_NACK;
+    }
+
+    bool is_ack = device->write(m_tx, m_tx_size);
+    spend(m_tx_address, is_ack ? m_tx_size : 1);
+    return is_ack ? STATUS_OK : STATUS_DATA_NACK;
+}
+
+int I2cBusModel::read()
+{
+    if (m_rx_index >= m_rx_size)
+    {
+        return -1;
+    }
+
+    return m_rx[m_rx_index++];
+}
+
+uint8_t I2cBusModel::requestFrom(uint8_t address, uint8_t count)
+{
+    m_rx_size = 0;
+    m_rx_index = 0;
+
+    if (!begin_transaction(address))
+    {
+        return 0;
+    }
+
+    I2cDeviceModel *device = find(address);
+    if (!device)
+    {
+        spend(address, 0);
+        return 0;
+    }
+
+    size_t limit = count < BUFFER_SIZE ? count : BUFFER_SIZE;
+    m_rx_size = device->read(m_rx, limit);
+    spend(address, m_rx_size);
+    return static_cast<uint8_t>(m_rx_size);
+}
+
+size_t I2cBusModel::write(uint8_t value)
+{
+    // Like the Wire library, bytes past the end of the buffer are dropped.
+    if (m_tx_size >= BUFFER_SIZE)
+    {
+        return 0;
+    }
+
+    m_tx[m_tx_size++] = value;
+    return 1;
+}
+
+bool I2cBusModel::begin_transaction(uint8_t address)
+{
+    ++m_transactions;
+
+    if (!m_lockups.empty() && is_locked(millis()))
+    {
+        ++m_timeouts;
+        if (m_clock)
+        {
+            m_clock->advance(LOCKUP_TIMEOUT, spend_label(address) + " timeout");
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+void I2cBusModel::spend(uint8_t address, size_t bytes)
+{
+    if (m_clock)
+    {
+        uint64_t bits = (bytes + 1) * 9 + 2;
+        m_clock->advance(bits * 1000000 / m_clock_rate, spend_label(address));
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef _SCOTTZ0R_MOCKS_I2C_BUS_MODEL_INCLUDE_GUARD
+#define _SCOTTZ0R_MOCKS_I2C_BUS_MODEL_INCLUDE_GUARD
+
+#include "Wire.h"
+#include "virtual_clock.h"
+
+#include <stdint.h>
+#include <vector>
+
+/// @brief A device on an I2cBusModel. The bus hands it whole transactions.
+class I2cDeviceModel
+{
+public:
+    virtual ~I2cDeviceModel() = default;
+
+    virtual uint8_t address() const = 0;
+
+    /// @brief Bytes written by the master in one transaction.
+    /// @return False to NACK the data.
+    virtual bool write(const uint8_t *data, size_t size) = 0;
+
+    /// @brief Bytes requested by the master in one transaction.
+    /// @return Bytes put in dest, at most count.
+    virtual size_t read(uint8_t *dest, size_t count) = 0;
+};
+
+/// @brief TwoWireImpl that routes transactions to device models by address, so tests and the simulator talk to
+/// behavioural devices instead of scripting each Wire call. Addresses without a device NACK, like an empty bus.
+class I2cBusModel : public TwoWireImpl
+{
+public:
+    /// @brief Transmit and receive buffer size of the Arduino Wire library.
+    static constexpr size_t BUFFER_SIZE = 32;
+
+    /// @brief endTransmission results, as returned by the Arduino Wire library.
+    static constexpr uint8_t STATUS_OK = 0;
+    static constexpr uint8_t STATUS_ADDRESS_NACK = 2;
+    static constexpr uint8_t STATUS_DATA_NACK = 3;
+    static constexpr uint8_t STATUS_TIMEOUT = 5;
+
+    /// @brief Time a transaction on a locked bus takes to time out, the default of the Wire library's
+    /// setWireTimeout(). Microseconds.
+    static constexpr uint64_t LOCKUP_TIMEOUT = 25000;
+
+    I2cBusModel();
+
+    /// @brief Spend clock time on each transaction: nine bits per byte, address included, and two for the start and
+    /// stop. The time is labeled with the address, for example "I2C 0x18". Null spends none, which is the default.
+    /// @param clock_rate Bus clock. Hertz.
+    void set_clock(VirtualClock *clock, unsigned long clock_rate = 100000);
+
+    /// @brief Put a device on the bus, replacing any device at its address. The device is not owned, and must be
+    /// detached before it is destroyed.
+    void attach(I2cDeviceModel &device);
+
+    void detach(uint8_t address);
+
+    I2cDeviceModel *find(uint8_t address) const;
+
+    /// @brief Hold the bus stuck, as a device holding SDA low would, for duration milliseconds of millis() from start.
+    /// Transactions in the window time out without reaching any device.
+    void add_lockup(unsigned long start, unsigned long duration);
+
+    bool is_locked(unsigned long now) const;
+
+    /// @brief Write and read transactions addressed, acknowledged or not.
+    uint64_t transactions() const
+    {
+        return m_transactions;
+    }
+
+    /// @brief Transactions that timed out on a locked bus.
+    uint64_t timeouts() const
+    {
+        return m_timeouts;
+    }
+
+    int available() override;
+
+    void begin() override;
+
+    void beginTransmission(uint8_t address) override;
+
+    uint8_t endTransmission() override;
+
+    int read() override;
+
+    uint8_t requestFrom(uint8_t address, uint8_t count) override;
+
+    size_t write(uint8_t value) override;
+
+private:
+    struct Lockup
+    {
+        unsigned long start;
+        unsigned long duration;
+    };
+
+    /// @brief Count a transaction. False if it times out on a locked bus.
+    bool begin_transaction(uint8_t address);
+
+    /// @brief Spend the time of a transaction that moved a number of bytes after the address.
+    void spend(uint8_t address, size_t bytes);
+
+    I2cDeviceModel *m_devices[128];
+    std::vector<Lockup> m_lockups;
+
+    uint8_t m_tx_address;
+    uint8_t m_tx[BUFFER_SIZE];
+    size_t m_tx_size;
+
+    uint8_t m_rx[BUFFER_SIZE];
+    size_t m_rx_size;
+    size_t m_rx_index;
+
+    uint64_t m_transactions;
+    uint64_t m_timeouts;
+
+    VirtualClock *m_clock;
+    unsigned long m_clock_rate;
+};
+
+#endif // _SCOTTZ0R_MOCKS_I2C_BUS_MODEL_INCLUDE_GUARD
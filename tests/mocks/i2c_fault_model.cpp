@@ -0,0 +1,43 @@
+#include "i2c_fault_model.h"
+
+I2cFaultModel::I2cFaultModel(I2cDeviceModel &device, uint32_t seed)
+    : m_device(device), m_random(seed), m_uniform(0.0, 1.0), m_nack_chance(0.0), m_short_read_chance(0.0), m_nacks(0),
+      m_short_reads(0)
+{
+}
+
+bool I2cFaultModel::write(const uint8_t *data, size_t size)
+{
+    if (roll(m_nack_chance))
+    {
+        ++m_nacks;
+        return false;
+    }
+
+    return m_device.write(data, size);
+}
+
+size_t I2cFaultModel::read(uint8_t *dest, size_t count)
+{
+    if (roll(m_nack_chance))
+    {
+        ++m_nacks;
+        return 0;
+    }
+
+    size_t size = m_device.read(dest, count);
+
+    // Drop at least the last byte, as if the master saw the bus go idle early.
+    if (size > 0 && roll(m_short_read_chance))
+    {
+        ++m_short_reads;
+        return size - 1 - static_cast<size_t>(m_random() % size);
+    }
+
+    return size;
+}
+
+bool I2cFaultModel::roll(double chance)
+{
+    return chance > 0.0 && m_uniform(m_random) < chance;
+}
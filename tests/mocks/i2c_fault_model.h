@@ -0,0 +1,64 @@
+#ifndef _SCOTTZ0R_MOCKS_I2C_FAULT_MODEL_INCLUDE_GUARD
+#define _SCOTTZ0R_MOCKS_I2C_FAULT_MODEL_INCLUDE_GUARD
+
+#include "i2c_bus_model.h"
+
+#include <random>
+
+/// @brief Wraps a device model and makes some of its transactions fail, for fault-injection runs. Attach this to the
+/// bus in place of the device. A NACKed transaction does not reach the device, and a NACKed read returns no data. A
+/// short read returns fewer bytes than asked for, after the device has been read. Faults are drawn from a seeded
+/// generator, so runs repeat.
+class I2cFaultModel : public I2cDeviceModel
+{
+public:
+    /// @param device Device that transactions pass through to. Must outlive this object.
+    /// @param seed Seed of the fault generator.
+    I2cFaultModel(I2cDeviceModel &device, uint32_t seed = 0);
+
+    /// @brief Chance from 0 to 1 that a write or read transaction is NACKed.
+    void set_nack_chance(double chance)
+    {
+        m_nack_chance = chance;
+    }
+
+    /// @brief Chance from 0 to 1 that a read transaction comes back short.
+    void set_short_read_chance(double chance)
+    {
+        m_short_read_chance = chance;
+    }
+
+    unsigned long nacks() const
+    {
+        return m_nacks;
+    }
+
+    unsigned long short_reads() const
+    {
+        return m_short_reads;
+    }
+
+    uint8_t address() const override
+    {
+        return m_device.address();
+    }
+
+    bool write(const uint8_t *data, size_t size) override;
+
+    size_t read(uint8_t *dest, size_t count) override;
+
+private:
+    bool roll(double chance);
+
+    I2cDeviceModel &m_device;
+    std::mt19937 m_random;
+    std::uniform_real_distribution<double> m_uniform;
+
+    double m_nack_chance;
+    double m_short_read_chance;
+
+    unsigned long m_nacks;
+    unsigned long m_short_reads;
+};
+
+#endif // _SCOTTZ0R_MOCKS_I2C_FAULT_MODEL_INCLUDE_GUARD
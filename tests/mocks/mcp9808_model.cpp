@@ -0,0 +1,248 @@
+#include "mcp9808_model.h"
+
+#include "Arduino.h"
+
+#include <cmath>
+
+/// @brief Writable configuration bits. The rest read as zero.
+static constexpr uint16_t CONFIG_MASK = 0x07FF;
+
+/// @brief Alert limits keep a sign and 0.25 C steps.
+static constexpr uint16_t LIMIT_MASK = 0x1FFC;
+
+/// @brief Temperature bits of the ambient register.
+static constexpr uint16_t TEMPERATURE_MASK = 0x1FFF;
+
+/// @brief Sign extend 13 bit register temperature bits.
+static int16_t to_signed(uint16_t value)
+{
+    int16_t result = static_cast<int16_t>(value & TEMPERATURE_MASK);
+    return (result & 0x1000) ? static_cast<int16_t>(result - 0x2000) : result;
+}
+
+Mcp9808Model::Mcp9808Model(uint8_t address, double temperature)
+    : m_address(address), m_temperature(temperature), m_pointer(0), m_config(0), m_t_upper(0), m_t_lower(0),
+      m_t_crit(0), m_ambient(0), m_resolution(0x03), m_conversion_start(0), m_conversions(0)
+{
+    reset();
+}
+
+void Mcp9808Model::reset()
+{
+    m_pointer = REG_AMBIENT_TEMP;
+    m_config = 0;
+    m_t_upper = 0;
+    m_t_lower = 0;
+    m_t_crit = 0;
+    m_resolution = 0x03;
+    m_conversions = 0;
+
+    m_conversion_start = millis();
+    convert(m_conversion_start);
+}
+
+void Mcp9808Model::set_temperature(double celsius)
+{
+    m_temperature = celsius;
+    m_source = nullptr;
+}
+
+void Mcp9808Model::set_temperature_source(TemperatureSource source)
+{
+    m_source = std::move(source);
+}
+
+uint16_t Mcp9808Model::register_value(uint8_t reg)
+{
+    switch (reg)
+    {
+    case REG_CONFIG:
+        return m_config;
+    case REG_T_UPPER:
+        return m_t_upper;
+    case REG_T_LOWER:
+        return m_t_lower;
+    case REG_T_CRIT:
+        return m_t_crit;
+    case REG_AMBIENT_TEMP:
+        update(millis());
+        return m_ambient;
+    case REG_MANUF_ID:
+        return MANUFACTURER_ID;
+    case REG_DEVICE_ID:
+        return DEVICE_ID;
+    case REG_RESOLUTION:
+        return m_resolution;
+    default:
+        return 0;
+    }
+}
+
+unsigned long Mcp9808Model::conversion_time(uint8_t resolution)
+{
+    // Typical conversion times from the datasheet.
+    static const unsigned long times[] = {30, 65, 130, 250};
+    return times[resolution & 0x03];
+}
+
+uint16_t Mcp9808Model::encode_temperature(double celsius, uint8_t resolution)
+{
+    double sixteenths = std::floor(celsius * 16.0);
+    sixteenths = sixteenths < -4096.0 ? -4096.0 : (sixteenths > 4095.0 ? 4095.0 : sixteenths);
+
+    // Coarser resolutions leave the low fraction bits clear.
+    int32_t raw = static_cast<int32_t>(sixteenths);
+    raw &= ~((1 << (3 - (resolution & 0x03))) - 1);
+
+    return static_cast<uint16_t>(raw & TEMPERATURE_MASK);
+}
+
+bool Mcp9808Model::write(const uint8_t *data, size_t size)
+{
+    // An address-only write is a probe.
+    if (size == 0)
+    {
+        return true;
+    }
+
+    // The first byte sets the register pointer. Following bytes write the register, most significant byte first.
+    m_pointer = data[0] & 0x0F;
+
+    if (m_pointer == REG_RESOLUTION && size >= 2)
+    {
+        write_register(m_pointer, data[1]);
+    }
+    else if (size >= 3)
+    {
+        write_register(m_pointer, static_cast<uint16_t>((data[1] << 8) | data[2]));
+    }
+
+    return true;
+}
+
+size_t Mcp9808Model::read(uint8_t *dest, size_t count)
+{
+    uint16_t value = register_value(m_pointer);
+
+    // The resolution register is the only 8 bit register.
+    if (m_pointer == REG_RESOLUTION)
+    {
+        if (count < 1)
+        {
+            return 0;
+        }
+
+        dest[0] = static_cast<uint8_t>(value);
+        return 1;
+    }
+
+    size_t size = count < 2 ? count : 2;
+    if (size > 0)
+    {
+        dest[0] = static_cast<uint8_t>(value >> 8);
+    }
+
+    if (size > 1)
+    {
+        dest[1] = static_cast<uint8_t>(value);
+    }
+
+    return size;
+}
+
+void Mcp9808Model::update(unsigned long now)
+{
+    if (m_config & CONFIG_SHUTDOWN)
+    {
+        return;
+    }
+
+    unsigned long period = conversion_time(m_resolution);
+    unsigned long elapsed = now - m_conversion_start;
+    if (elapsed < period)
+    {
+        return;
+    }
+
+    // Only the last finished conversion is visible, so the ones before it are skipped.
+    unsigned long finished = elapsed / period;
+    m_conversion_start += finished * period;
+    m_conversions += finished;
+    convert(m_conversion_start);
+}
+
+void Mcp9808Model::convert(unsigned long now)
+{
+    double temperature = m_source ? m_source(now) : m_temperature;
+    uint16_t ambient = encode_temperature(temperature, m_resolution);
+
+    int16_t value = to_signed(ambient);
+    if (value >= to_signed(m_t_crit))
+    {
+        ambient |= AMBIENT_CRIT;
+    }
+
+    if (value > to_signed(m_t_upper))
+    {
+        ambient |= AMBIENT_UPPER;
+    }
+
+    if (value < to_signed(m_t_lower))
+    {
+        ambient |= AMBIENT_LOWER;
+    }
+
+    m_ambient = ambient;
+}
+
+void Mcp9808Model::write_register(uint8_t reg, uint16_t value)
+{
+    switch (reg)
+    {
+    case REG_CONFIG: {
+        // Lock bits stay set until reset.
+        uint16_t locks = m_config & (CONFIG_CRIT_LOCK | CONFIG_WINDOW_LOCK);
+        uint16_t config = static_cast<uint16_t>((value & CONFIG_MASK) | locks);
+
+        // Conversions restart when leaving shutdown, and the ones due before entering it finish first.
+        if ((config & CONFIG_SHUTDOWN) && !(m_config & CONFIG_SHUTDOWN))
+        {
+            update(millis());
+        }
+        else if (!(config & CONFIG_SHUTDOWN) && (m_config & CONFIG_SHUTDOWN))
+        {
+            m_conversion_start = millis();
+        }
+
+        m_config = config;
+        break;
+    }
+    case REG_T_UPPER:
+        if (!(m_config & CONFIG_WINDOW_LOCK))
+        {
+            m_t_upper = value & LIMIT_MASK;
+        }
+        break;
+    case REG_T_LOWER:
+        if (!(m_config & CONFIG_WINDOW_LOCK))
+        {
+            m_t_lower = value & LIMIT_MASK;
+        }
+        break;
+    case REG_T_CRIT:
+        if (!(m_config & CONFIG_CRIT_LOCK))
+        {
+            m_t_crit = value & LIMIT_MASK;
+        }
+        break;
+    case REG_RESOLUTION: {
+        // Conversions due at the old resolution finish first.
+        update(millis());
+        m_resolution = value & 0x03;
+        break;
+    }
+    default:
+        // Read-only or unused register.
+        break;
+    }
+}
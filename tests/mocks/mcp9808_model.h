@@ -0,0 +1,109 @@
+#ifndef _SCOTTZ0R_MOCKS_MCP9808_MODEL_INCLUDE_GUARD
+#define _SCOTTZ0R_MOCKS_MCP9808_MODEL_INCLUDE_GUARD
+
+#include "i2c_bus_model.h"
+
+#include <functional>
+
+/// @brief Register-level model of an MCP 9808 temperature sensor, from the datasheet.
+///
+/// Covers the register pointer, the configuration, alert limit, ambient temperature, ID and resolution registers. The
+/// ambient register holds the last finished conversion. A conversion finishes every conversion time for the current
+/// resolution, counted with millis() from reset, and samples the temperature the sensor is exposed to at that moment.
+/// The conversion at reset is treated as already finished, so the register is valid straight away. Conversions stop in
+/// shutdown. The alert output pin is not modeled, but the alert flags in the ambient register are.
+class Mcp9808Model : public I2cDeviceModel
+{
+public:
+    /// @brief Temperature the sensor is exposed to at a time from millis(). Celsius.
+    using TemperatureSource = std::function<double(unsigned long now)>;
+
+    static constexpr uint8_t REG_CONFIG = 0x01;
+    static constexpr uint8_t REG_T_UPPER = 0x02;
+    static constexpr uint8_t REG_T_LOWER = 0x03;
+    static constexpr uint8_t REG_T_CRIT = 0x04;
+    static constexpr uint8_t REG_AMBIENT_TEMP = 0x05;
+    static constexpr uint8_t REG_MANUF_ID = 0x06;
+    static constexpr uint8_t REG_DEVICE_ID = 0x07;
+    static constexpr uint8_t REG_RESOLUTION = 0x08;
+
+    static constexpr uint16_t MANUFACTURER_ID = 0x0054;
+    static constexpr uint16_t DEVICE_ID = 0x0400;
+
+    static constexpr uint16_t CONFIG_SHUTDOWN = 0x0100;
+    static constexpr uint16_t CONFIG_CRIT_LOCK = 0x0080;
+    static constexpr uint16_t CONFIG_WINDOW_LOCK = 0x0040;
+
+    /// @brief Ambient register flags: at or above T_CRIT, above T_UPPER and below T_LOWER.
+    static constexpr uint16_t AMBIENT_CRIT = 0x8000;
+    static constexpr uint16_t AMBIENT_UPPER = 0x4000;
+    static constexpr uint16_t AMBIENT_LOWER = 0x2000;
+
+    /// @param address I2C address, 0x18 to 0x1F on a real part.
+    /// @param temperature Temperature the sensor is exposed to. Celsius.
+    explicit Mcp9808Model(uint8_t address, double temperature = 25.0);
+
+    /// @brief Power-on reset. Registers return to their defaults and the conversion timer restarts.
+    void reset();
+
+    /// @brief Expose the sensor to a fixed temperature. Seen from the next conversion.
+    void set_temperature(double celsius);
+
+    /// @brief Expose the sensor to a temperature that changes over time. Called once per conversion.
+    void set_temperature_source(TemperatureSource source);
+
+    /// @brief Register value as the next read would return it, without moving the pointer.
+    uint16_t register_value(uint8_t reg);
+
+    uint8_t pointer() const
+    {
+        return m_pointer;
+    }
+
+    /// @brief Conversions finished since reset, not counting the one at reset.
+    unsigned long conversions() const
+    {
+        return m_conversions;
+    }
+
+    /// @brief Conversion time at a resolution register value. Milliseconds.
+    static unsigned long conversion_time(uint8_t resolution);
+
+    /// @brief Ambient register temperature bits: 13 bit two's complement in 1/16 C, with the fraction bits below the
+    /// resolution clear. Out of range temperatures are clamped.
+    static uint16_t encode_temperature(double celsius, uint8_t resolution);
+
+    uint8_t address() const override
+    {
+        return m_address;
+    }
+
+    bool write(const uint8_t *data, size_t size) override;
+
+    size_t read(uint8_t *dest, size_t count) override;
+
+private:
+    /// @brief Finish the conversions due by now.
+    void update(unsigned long now);
+
+    void convert(unsigned long now);
+
+    void write_register(uint8_t reg, uint16_t value);
+
+    uint8_t m_address;
+    double m_temperature;
+    TemperatureSource m_source;
+
+    uint8_t m_pointer;
+    uint16_t m_config;
+    uint16_t m_t_upper;
+    uint16_t m_t_lower;
+    uint16_t m_t_crit;
+    uint16_t m_ambient;
+    uint8_t m_resolution;
+
+    unsigned long m_conversion_start;
+    unsigned long m_conversions;
+};
+
+#endif // _SCOTTZ0R_MOCKS_MCP9808_MODEL_INCLUDE_GUARD
@@ -0,0 +1,93 @@
+#include "virtual_clock.h"
+
+#include <algorithm>
+
+namespace
+{
+    /// @brief Heap order that puts the earliest event, and the first scheduled of a tie, at the front.
+    template <class T> bool is_later(const T &a, const T &b)
+    {
+        return a.time != b.time ? a.time > b.time : a.sequence > b.sequence;
+    }
+} // namespace
+
+VirtualClock::VirtualClock(uint64_t start) : m_now(start), m_observer(), m_loop_cost(0), m_loops(0), m_sequence(0)
+{
+}
+
+void VirtualClock::advance(uint64_t micros, const std::string &label)
+{
+    if (m_observer && !label.empty())
+    {
+        m_observer(label, micros);
+    }
+
+    advance_to(m_now + micros);
+}
+
+void VirtualClock::advance_to(uint64_t time)
+{
+    if (time < m_now)
+    {
+        time = m_now;
+    }
+
+    run_events(time);
+    m_now = std::max(m_now, time);
+}
+
+void VirtualClock::schedule(uint64_t time, Event fn)
+{
+    m_events.push_back({time, m_sequence++, std::move(fn)});
+    std::push_heap(m_events.begin(), m_events.end(), is_later<ScheduledEvent>);
+}
+
+bool VirtualClock::advance_to_next_event()
+{
+    if (m_events.empty())
+    {
+        return false;
+    }
+
+    advance_to(m_events.front().time);
+    return true;
+}
+
+void VirtualClock::end_loop()
+{
+    ++m_loops;
+    advance(m_loop_cost, "loop");
+}
+
+unsigned long VirtualClock::millis()
+{
+    return static_cast<unsigned long>(m_now / 1000);
+}
+
+unsigned long VirtualClock::micros()
+{
+    return static_cast<unsigned long>(m_now);
+}
+
+void VirtualClock::delay(unsigned long ms)
+{
+    advance(static_cast<uint64_t>(ms) * 1000, "delay");
+}
+
+void VirtualClock::run_events(uint64_t time)
+{
+    // Events may schedule more events, or advance the clock themselves, so the heap is checked again after each one.
+    while (!m_events.empty() && m_events.front().time <= time)
+    {
+        std::pop_heap(m_events.begin(), m_events.end(), is_later<ScheduledEvent>);
+        ScheduledEvent event = std::move(m_events.back());
+        m_events.pop_back();
+
+        if (event.time > m_now)
+        {
+            m_now = event.time;
+        }
+
+        event.fn();
+    }
+}
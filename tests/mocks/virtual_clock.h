@@ -0,0 +1,101 @@
+#ifndef _SCOTTZ0R_MOCKS_VIRTUAL_CLOCK_INCLUDE_GUARD
+#define _SCOTTZ0R_MOCKS_VIRTUAL_CLOCK_INCLUDE_GUARD
+
+#include "Arduino.h"
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// @brief ArduinoImpl whose time only moves when something spends it, so host runs are faster than real time and repeat
+/// bit for bit. Time is kept in microseconds and is spent by the things that take time on the board: delay(), a loop
+/// pass, serial bytes arriving or going out, and I2C transactions, each modeled by the mock that does it.
+///
+/// Time spent can carry a label naming what spent it, such as an I2C address, and an observer is told of every labeled
+/// spend. Events can be scheduled for a time. They run in time order as time passes them, at their own time, and events
+/// for the same time run in the order they were scheduled. A run with nothing to do can jump to the next event.
+class VirtualClock : public ArduinoImpl
+{
+public:
+    using Event = std::function<void()>;
+
+    /// @brief Told the label and length of each labeled spend, before the time passes.
+    using SpendObserver = std::function<void(const std::string &label, uint64_t micros)>;
+
+    /// @param start Time to start at. Microseconds.
+    explicit VirtualClock(uint64_t start = 0);
+
+    /// @brief Current time. Microseconds.
+    uint64_t now() const
+    {
+        return m_now;
+    }
+
+    /// @brief Move time forward, running the events due on the way.
+    /// @param label What spent the time. Empty for time that is only waited out, like a host pause.
+    void advance(uint64_t micros, const std::string &label = std::string());
+
+    /// @brief Move time forward to a time. Does nothing if it has passed.
+    void advance_to(uint64_t time);
+
+    /// @brief Run fn at a time. An event for a time that has passed runs at the next advance.
+    void schedule(uint64_t time, Event fn);
+
+    /// @brief Move time to the next event and run it, with any others due at the same time.
+    /// @return False if there are no events.
+    bool advance_to_next_event();
+
+    size_t pending_events() const
+    {
+        return m_events.size();
+    }
+
+    void set_observer(SpendObserver observer)
+    {
+        m_observer = std::move(observer);
+    }
+
+    /// @brief Time one loop pass takes, spent by end_loop(). Microseconds. Default 0.
+    void set_loop_cost(uint64_t micros)
+    {
+        m_loop_cost = micros;
+    }
+
+    /// @brief Spend the loop cost, and count the pass.
+    void end_loop();
+
+    /// @brief Loop passes ended.
+    uint64_t loops() const
+    {
+        return m_loops;
+    }
+
+    unsigned long millis() override;
+
+    unsigned long micros() override;
+
+    void delay(unsigned long ms) override;
+
+private:
+    struct ScheduledEvent
+    {
+        uint64_t time;
+        uint64_t sequence;
+        Event fn;
+    };
+
+    /// @brief Run the events due by time, in order, moving the clock to each one's time.
+    void run_events(uint64_t time);
+
+    uint64_t m_now;
+    SpendObserver m_observer;
+    uint64_t m_loop_cost;
+    uint64_t m_loops;
+
+    // Min-heap on time, then sequence.
+    std::vector<ScheduledEvent> m_events;
+    uint64_t m_sequence;
+};
+
+#endif // _SCOTTZ0R_MOCKS_VIRTUAL_CLOCK_INCLUDE_GUARD
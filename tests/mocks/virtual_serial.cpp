@@ -0,0 +1,130 @@
+#include "virtual_serial.h"
+
+#include <algorithm>
+
+VirtualSerial::VirtualSerial(VirtualClock &clock)
+    : m_clock(clock), m_byte_time(86), m_rx_next(0), m_overruns(0), m_tx_start(0), m_blocked_time(0)
+{
+}
+
+void VirtualSerial::send(const uint8_t *data, size_t size)
+{
+    uint64_t time = std::max(m_clock.now(), m_rx_next);
+    for (size_t i = 0; i < size; ++i)
+    {
+        time += m_byte_time;
+        m_arriving.push_back({time, data[i]});
+    }
+
+    m_rx_next = time;
+}
+
+std::vector<uint8_t> VirtualSerial::take_output()
+{
+    drain();
+
+    std::vector<uint8_t> output;
+    output.swap(m_output);
+    return output;
+}
+
+void VirtualSerial::begin(unsigned long baud)
+{
+    // 8N1 is ten bits per byte.
+    m_byte_time = 10000000ull / baud;
+}
+
+int VirtualSerial::available()
+{
+    receive();
+    return static_cast<int>(m_rx.size());
+}
+
+int VirtualSerial::read()
+{
+    if (available() == 0)
+    {
+        return -1;
+    }
+
+    uint8_t value = m_rx.front();
+    m_rx.pop_front();
+    return value;
+}
+
+int VirtualSerial::availableForWrite()
+{
+    // One byte of the Uno's transmit buffer is never used.
+    drain();
+    return static_cast<int>(BUFFER_SIZE - 1 - m_tx.size());
+}
+
+void VirtualSerial::write(const uint8_t *buf, size_t size)
+{
+    // Like the Uno, blocks while the transmit buffer is full.
+    uint64_t start = m_clock.now();
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (availableForWrite() == 0)
+        {
+            m_clock.advance(m_tx_start + m_byte_time - m_clock.now(), "Serial.write");
+            drain();
+        }
+
+        if (m_tx.empty())
+        {
+            m_tx_start = m_clock.now();
+        }
+
+        m_tx.push_back(buf[i]);
+    }
+
+    m_blocked_time += m_clock.now() - start;
+}
+
+void VirtualSerial::flush()
+{
+    uint64_t start = m_clock.now();
+    drain();
+    if (!m_tx.empty())
+    {
+        m_clock.advance(m_tx_start + m_byte_time * m_tx.size() - m_clock.now(), "Serial.flush");
+        drain();
+    }
+
+
+    m_blocked_time += m_clock.now() - start;
+}
+
+void VirtualSerial::receive()
+{
+    while (!m_arriving.empty() && m_arriving.front().time <= m_clock.now())
+    {
+        // One byte of the Uno's receive buffer is never used either.
+        if (m_rx.size() < BUFFER_SIZE - 1)
+        {
+            m_rx.push_back(m_arriving.front().value);
+        }
+        else
+        {
+            ++m_overruns;
+        }
+
+        m_arriving.pop_front();
+    }
+}
+
+void VirtualSerial::drain()
+{
+    if (m_tx.empty())
+    {
+        return;
+    }
+
+    uint64_t sent = (m_clock.now() - m_tx_start) / m_byte_time;
+    sent = std::min<uint64_t>(sent, m_tx.size());
+
+    m_output.insert(m_output.end(), m_tx.begin(), m_tx.begin() + static_cast<long>(sent));
+    m_tx.erase(m_tx.begin(), m_tx.begin() + static_cast<long>(sent));
+    m_tx_start += m_byte_time * sent;
+}
@@ -0,0 +1,100 @@
+#ifndef _SCOTTZ0R_MOCKS_VIRTUAL_SERIAL_INCLUDE_GUARD
+#define _SCOTTZ0R_MOCKS_VIRTUAL_SERIAL_INCLUDE_GUARD
+
+#include "HardwareSerial.h"
+#include "virtual_clock.h"
+
+#include <deque>
+#include <vector>
+
+/// @brief HardwareSerialImpl on a VirtualClock, with the Uno's buffers and line rate. The host side is this class's
+/// send() and take_output().
+///
+/// Bytes from the host arrive one byte time apart, ten bits per byte at the rate set with begin(), and wait in a 64
+/// byte receive buffer. Bytes that arrive while it is full are dropped. The rate is 115200 baud until begin() is
+/// called. Written bytes wait in a 64 byte transmit buffer that drains at the same rate, and write() and flush() spend
+/// clock time while they wait for room, like the board.
+class VirtualSerial : public HardwareSerialImpl
+{
+public:
+    static constexpr size_t BUFFER_SIZE = 64;
+
+    /// @param clock Clock to time bytes with. Must outlive this object.
+    explicit VirtualSerial(VirtualClock &clock);
+
+    /// @brief Time to send one byte at the current rate. Microseconds.
+    uint64_t byte_time() const
+    {
+        return m_byte_time;
+    }
+
+    /// @brief Send bytes from the host. They start arriving now, or after the bytes still arriving.
+    void send(const uint8_t *data, size_t size);
+
+    void send(const std::vector<uint8_t> &data)
+    {
+        send(data.data(), data.size());
+    }
+
+    /// @brief Time the last byte sent by the host arrives. Microseconds.
+    uint64_t send_done() const
+    {
+        return m_rx_next;
+    }
+
+    /// @brief Bytes that have finished going out to the host, oldest first. Taking them clears the list.
+    std::vector<uint8_t> take_output();
+
+    /// @brief Received bytes dropped because the receive buffer was full.
+    unsigned long overruns() const
+    {
+        return m_overruns;
+    }
+
+    /// @brief Clock time spent inside write() and flush() waiting for the transmit buffer. Microseconds.
+    uint64_t blocked_time() const
+    {
+        return m_blocked_time;
+    }
+
+    void begin(unsigned long baud) override;
+
+    int available() override;
+
+    int read() override;
+
+    int availableForWrite() override;
+
+    void write(const uint8_t *buf, size_t size) override;
+
+    void flush() override;
+
+private:
+    struct Arrival
+    {
+        uint64_t time;
+        uint8_t value;
+    };
+
+    /// @brief Move bytes that have arrived into the receive buffer.
+    void receive();
+
+    /// @brief Move bytes that have gone out from the transmit buffer to the output.
+    void drain();
+
+    VirtualClock &m_clock;
+    uint64_t m_byte_time;
+
+    std::deque<Arrival> m_arriving;
+    uint64_t m_rx_next;
+    std::deque<uint8_t> m_rx;
+    unsigned long m_overruns;
+
+    // The first byte of m_tx finishes one byte time after m_tx_start.
+    std::deque<uint8_t> m_tx;
+    uint64_t m_tx_start;
+    std::vector<uint8_t> m_output;
+    uint64_t m_blocked_time;
+};
+
+#endif // _SCOTTZ0R_MOCKS_VIRTUAL_SERIAL_INCLUDE_GUARD
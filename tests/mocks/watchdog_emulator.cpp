@@ -0,0 +1,133 @@
+#include "watchdog_emulator.h"
+
+WatchdogEmulator::WatchdogEmulator(VirtualClock &clock)
+    : m_clock(clock), m_alive(std::make_shared<bool>(true)), m_is_enabled(false), m_window(0), m_generation(0),
+      m_resets(0), m_expiries(0)
+{
+    m_clock.set_observer([this](const std::string &label, uint64_t micros) { on_spend(label, micros); });
+}
+
+WatchdogEmulator::~WatchdogEmulator()
+{
+    m_clock.set_observer(nullptr);
+}
+
+uint64_t WatchdogEmulator::timeout_micros(uint8_t timeout)
+{
+    // Nominal timeouts of the WDTO_ values.
+    static const uint64_t times[] = {15000, 30000, 60000, 120000, 250000, 500000, 1000000, 2000000};
+    return times[timeout & 0x07];
+}
+
+void WatchdogEmulator::note(const std::string &text)
+{
+    if (m_gap.notes.empty() || m_gap.notes.back() != text)
+    {
+        m_gap.notes.push_back(text);
+    }
+}
+
+void WatchdogEmulator::finish()
+{
+    if (m_is_enabled)
+    {
+        close_gap();
+    }
+}
+
+void WatchdogEmulator::enable(uint8_t timeout)
+{
+    // Enabling restarts the count, like a reset, but the time before it was not watched.
+    m_is_enabled = true;
+    m_window = timeout_micros(timeout);
+    m_gap = WatchdogGap();
+    m_gap.start = m_clock.now();
+    arm();
+}
+
+void WatchdogEmulator::disable()
+{
+    finish();
+    m_is_enabled = false;
+    ++m_generation;
+}
+
+void WatchdogEmulator::reset()
+{
+    // Resets while disabled do nothing on the board either.
+    if (!m_is_enabled)
+    {
+        return;
+    }
+
+    ++m_resets;
+    close_gap();
+}
+
+void WatchdogEmulator::on_spend(const std::string &label, uint64_t micros)
+{
+    if (!m_is_enabled)
+    {
+        return;
+    }
+
+    for (auto &spent : m_gap.spent)
+    {
+        if (spent.first == label)
+        {
+            spent.second += micros;
+            return;
+        }
+    }
+
+    m_gap.spent.emplace_back(label, micros);
+}
+
+void WatchdogEmulator::close_gap()
+{
+    m_gap.length = m_clock.now() - m_gap.start;
+    if (m_gap.length > m_worst_gap.length)
+    {
+        m_worst_gap = m_gap;
+    }
+
+    m_gap = WatchdogGap();
+    m_gap.start = m_clock.now();
+    arm();
+}
+
+void WatchdogEmulator::arm()
+{
+    uint64_t generation = ++m_generation;
+    std::weak_ptr<bool> alive = m_alive;
+
+    // A gap of exactly the timeout is allowed.
+    m_clock.schedule(m_gap.start + m_window + 1, [this, alive, generation]() {
+        if (!alive.expired())
+        {
+            expire(generation);
+        }
+    });
+}
+
+void WatchdogEmulator::expire(uint64_t generation)
+{
+    if (generation != m_generation)
+    {
+        return;
+    }
+
+    ++m_expiries;
+
+    WatchdogGap gap = m_gap;
+    gap.length = m_clock.now() - gap.start;
+    if (m_expiries == 1)
+    {
+        m_first_expiry = gap;
+    }
+
+    if (m_expiry_handler)
+    {
+        m_expiry_handler(gap);
+    }
+}
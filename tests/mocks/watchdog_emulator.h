@@ -0,0 +1,135 @@
+#ifndef _SCOTTZ0R_MOCKS_WATCHDOG_EMULATOR_INCLUDE_GUARD
+#define _SCOTTZ0R_MOCKS_WATCHDOG_EMULATOR_INCLUDE_GUARD
+
+#include "avr/wdt.h"
+#include "virtual_clock.h"
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Time between two watchdog resets, and what it went on.
+struct WatchdogGap
+{
+    /// @brief Clock time of the reset that opened the gap, and the gap's length. Microseconds.
+    uint64_t start = 0;
+    uint64_t length = 0;
+
+    /// @brief Notes made during the gap, in order, such as the request being handled.
+    std::vector<std::string> notes;
+
+    /// @brief Labeled clock time spent during the gap, per label, in the order each label was first spent.
+    std::vector<std::pair<std::string, uint64_t>> spent;
+};
+
+/// @brief WdtImpl that times the gaps between resets on a VirtualClock and checks them against the enabled timeout, so
+/// a host run can catch a path that would reset the board.
+///
+/// Each gap keeps the clock's labeled spends, like "I2C 0x18" or "Serial.write", and any notes added with note(), so
+/// the longest gap can be traced to what the loop pass did. A gap that runs past the timeout is an expiry. It is caught
+/// when the clock passes the timeout, so the expiry shows the path as far as it had got, including the spend that
+/// crossed the timeout. The board would reset there; the emulator counts the expiry and carries on.
+class WatchdogEmulator : public WdtImpl
+{
+public:
+    using ExpiryHandler = std::function<void(const WatchdogGap &gap)>;
+
+    /// @param clock Clock to time gaps with. Its spend observer is replaced until this object is destroyed. Must
+    /// outlive this object.
+    explicit WatchdogEmulator(VirtualClock &clock);
+
+    ~WatchdogEmulator();
+
+    WatchdogEmulator(const WatchdogEmulator &) = delete;
+
+    WatchdogEmulator &operator=(const WatchdogEmulator &) = delete;
+
+    /// @brief Timeout of a WDTO_ value. Microseconds.
+    static uint64_t timeout_micros(uint8_t timeout);
+
+    /// @brief Add a note to the gap in progress. A note the same as the last one is not repeated.
+    void note(const std::string &text);
+
+    /// @brief Called with the gap in progress when it expires. Throwing from the handler stops a run at the expiry.
+    void set_expiry_handler(ExpiryHandler handler)
+    {
+        m_expiry_handler = std::move(handler);
+    }
+
+    /// @brief End the gap in progress as if reset, so time since the last reset at the end of a run counts too.
+    void finish();
+
+    bool is_enabled() const
+    {
+        return m_is_enabled;
+    }
+
+    /// @brief Enabled timeout. Microseconds.
+    uint64_t window() const
+    {
+        return m_window;
+    }
+
+    uint64_t resets() const
+    {
+        return m_resets;
+    }
+
+    /// @brief Gaps that ran past the timeout. Each would have reset the board.
+    unsigned long expiries() const
+    {
+        return m_expiries;
+    }
+
+    /// @brief Longest gap that has ended.
+    const WatchdogGap &worst_gap() const
+    {
+        return m_worst_gap;
+    }
+
+    /// @brief First gap to expire, up to the moment it expired. Empty if none has.
+    const WatchdogGap &first_expiry() const
+    {
+        return m_first_expiry;
+    }
+
+    void enable(uint8_t timeout) override;
+
+    void disable() override;
+
+    void reset() override;
+
+private:
+    void on_spend(const std::string &label, uint64_t micros);
+
+    /// @brief End the gap in progress and start the next one now.
+    void close_gap();
+
+    /// @brief Schedule the expiry check of the gap in progress.
+    void arm();
+
+    void expire(uint64_t generation);
+
+    VirtualClock &m_clock;
+    ExpiryHandler m_expiry_handler;
+
+    // Expiry checks left in the clock after this object is destroyed see this expired, and do nothing.
+    std::shared_ptr<bool> m_alive;
+
+    bool m_is_enabled;
+    uint64_t m_window;
+
+    // Expiry checks scheduled before the last reset carry an older generation, and do nothing.
+    uint64_t m_generation;
+
+    uint64_t m_resets;
+    unsigned long m_expiries;
+    WatchdogGap m_gap;
+    WatchdogGap m_worst_gap;
+    WatchdogGap m_first_expiry;
+};
+
+#endif // _SCOTTZ0R_MOCKS_WATCHDOG_EMULATOR_INCLUDE_GUARD
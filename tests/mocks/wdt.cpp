@@ -0,0 +1,28 @@
+#include "avr/wdt.h"
+
+// Extern declared in avr/wdt.h
+WdtImpl *wdt_impl;
+
+void wdt_enable(uint8_t timeout)
+{
+    if (wdt_impl)
+    {
+        wdt_impl->enable(timeout);
+    }
+}
+
+void wdt_disable()
+{
+    if (wdt_impl)
+    {
+        wdt_impl->disable();
+    }
+}
+
+void wdt_reset()
+{
+    if (wdt_impl)
+    {
+        wdt_impl->reset();
+    }
+}
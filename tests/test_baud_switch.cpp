@@ -0,0 +1,95 @@
+#include <boost/test/unit_test.hpp>
+
+// File being tested:
+#include "baud_switch.h"
+
+using namespace scottz0r::temperature;
+
+BOOST_AUTO_TEST_SUITE(baud_switch)
+
+BOOST_AUTO_TEST_CASE(it_should_support_exact_rates)
+{
+    BOOST_TEST(BaudSwitch::is_supported(CFG_SERIAL_BAUD_RATE));
+    BOOST_TEST(BaudSwitch::is_supported(250000));
+    BOOST_TEST(BaudSwitch::is_supported(500000));
+    BOOST_TEST(BaudSwitch::is_supported(1000000));
+
+    BOOST_TEST(!BaudSwitch::is_supported(0));
+    BOOST_TEST(!BaudSwitch::is_supported(9600));
+    BOOST_TEST(!BaudSwitch::is_supported(230400));
+    BOOST_TEST(!BaudSwitch::is_supported(2000000));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_reject_unsupported_rates)
+{
+    BaudSwitch baud_switch(115200, 500);
+
+    BOOST_TEST(!baud_switch.request(230400));
+    BOOST_TEST(!baud_switch.is_busy());
+    BOOST_TEST(baud_switch.poll(0, true) == 0u);
+    BOOST_TEST(baud_switch.baud() == 115200u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_switch_once_transmit_is_idle)
+{
+    BaudSwitch baud_switch(115200, 500);
+
+    BOOST_TEST(baud_switch.request(1000000));
+    BOOST_TEST(baud_switch.is_busy());
+
+    // The acknowledgement is still queued at the old rate.
+    BOOST_TEST(baud_switch.poll(10, false) == 0u);
+    BOOST_TEST(baud_switch.baud() == 115200u);
+
+    BOOST_TEST(baud_switch.poll(11, true) == 1000000u);
+    BOOST_TEST(baud_switch.baud() == 1000000u);
+
+    // Applied once.
+    BOOST_TEST(baud_switch.poll(12, true) == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_keep_confirmed_rate)
+{
+    BaudSwitch baud_switch(115200, 500);
+
+    baud_switch.request(500000);
+    baud_switch.poll(100, true);
+    baud_switch.confirm();
+
+    BOOST_TEST(!baud_switch.is_busy());
+    BOOST_TEST(baud_switch.poll(100000, true) == 0u);
+    BOOST_TEST(baud_switch.baud() == 500000u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_fall_back_without_confirm)
+{
+    BaudSwitch baud_switch(115200, 500);
+
+    baud_switch.request(250000);
+
+    // Requests before the switch were sent at the old rate and do not confirm.
+    baud_switch.confirm();
+    baud_switch.poll(100, true);
+
+    BOOST_TEST(baud_switch.poll(599, true) == 0u);
+    BOOST_TEST(baud_switch.poll(600, true) == 115200u);
+    BOOST_TEST(baud_switch.baud() == 115200u);
+    BOOST_TEST(!baud_switch.is_busy());
+}
+
+BOOST_AUTO_TEST_CASE(it_should_switch_again_from_confirmed_rate)
+{
+    BaudSwitch baud_switch(115200, 500);
+
+    baud_switch.request(1000000);
+    baud_switch.poll(0, true);
+    baud_switch.confirm();
+
+    baud_switch.request(500000);
+    BOOST_TEST(baud_switch.poll(10, true) == 500000u);
+
+    // Falls back to the default rate, not the previous one.
+    BOOST_TEST(baud_switch.poll(510, true) == 115200u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
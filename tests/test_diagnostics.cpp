@@ -0,0 +1,193 @@
+#include "mocks/virtual_clock.h"
+#include "test_utils.h"
+#include <boost/test/unit_test.hpp>
+
+// File being tested:
+#include "diagnostics.h"
+
+using namespace scottz0r::temperature;
+
+BOOST_AUTO_TEST_SUITE(diagnostics)
+
+BOOST_AUTO_TEST_CASE(it_should_report_zero_before_anything_is_timed)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    Diagnostics diagnostics;
+    DiagnosticsReport report;
+    diagnostics.report(report);
+
+    BOOST_TEST(report.loop_rate == 0u);
+    BOOST_TEST(report.loop_time_max == 0u);
+
+    for (size_type i = 0; i < CFG_SENSOR_COUNT; ++i)
+    {
+        BOOST_TEST(report.sensor_times[i].min == 0u);
+        BOOST_TEST(report.sensor_times[i].average == 0u);
+        BOOST_TEST(report.sensor_times[i].max == 0u);
+    }
+
+    BOOST_TEST(report.reply_latency.min == 0u);
+    BOOST_TEST(report.reply_latency.max == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_count_loop_passes_per_second)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    Diagnostics diagnostics;
+    DiagnosticsReport report;
+
+    clock.advance_to(5000);
+    diagnostics.on_loop();
+
+    // One slow pass among 1 millisecond passes.
+    for (int i = 0; i < 997; ++i)
+    {
+        clock.advance(i == 500 ? 3000 : 1000);
+        diagnostics.on_loop();
+    }
+
+    // Rate is not known until a full second has passed.
+    diagnostics.report(report);
+    BOOST_TEST(report.loop_rate == 0u);
+    BOOST_TEST(report.loop_time_max == 3000u);
+
+    clock.advance(1000);
+    diagnostics.on_loop();
+
+    diagnostics.report(report);
+    BOOST_TEST(report.loop_rate == 998u);
+    BOOST_TEST(report.loop_time_max == 3000u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_time_sampler_steps_per_sensor)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    Diagnostics diagnostics;
+    DiagnosticsReport report;
+
+    auto step = [&](size_type sensor, unsigned long time) {
+        diagnostics.begin_sampler_step();
+        clock.advance(time);
+        diagnostics.end_sampler_step(sensor);
+        clock.advance(100);
+    };
+
+    step(0, 400);
+    step(0, 800);
+    step(0, 240);
+
+    // Out of range sensors are ignored.
+    step(CFG_SENSOR_COUNT, 9000);
+
+    diagnostics.report(report);
+    BOOST_TEST(report.sensor_times[0].min == 240u);
+    BOOST_TEST(report.sensor_times[0].max == 800u);
+
+    // 400, then 400 + 400 / 8 = 450, then 450 - 210 / 8 = 424.
+    BOOST_TEST(report.sensor_times[0].average == 424u);
+
+    BOOST_TEST(report.sensor_times[1].max == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_saturate_long_times)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    Diagnostics diagnostics;
+    DiagnosticsReport report;
+
+    diagnostics.on_loop();
+    clock.advance(200000);
+    diagnostics.on_loop();
+
+    diagnostics.begin_sampler_step();
+    clock.advance(70000);
+    diagnostics.end_sampler_step(0);
+
+    diagnostics.report(report);
+    BOOST_TEST(report.loop_time_max == 0xFFFFu);
+    BOOST_TEST(report.sensor_times[0].max == 0xFFFFu);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_time_reply_from_receive_to_first_byte)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    Diagnostics diagnostics;
+    DiagnosticsReport report;
+
+    clock.advance_to(1000);
+    diagnostics.on_requests_received(1);
+
+    // Reply goes out behind 10 bytes of a stream message.
+    clock.advance_to(1200);
+    diagnostics.on_request_handled(10, 25);
+
+    clock.advance_to(1500);
+    diagnostics.on_bytes_written(10);
+    diagnostics.report(report);
+    BOOST_TEST(report.reply_latency.max == 0u);
+
+    clock.advance_to(1700);
+    diagnostics.on_bytes_written(15);
+    diagnostics.report(report);
+    BOOST_TEST(report.reply_latency.min == 700u);
+    BOOST_TEST(report.reply_latency.average == 700u);
+    BOOST_TEST(report.reply_latency.max == 700u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_match_replies_to_requests_received_together)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    Diagnostics diagnostics;
+    DiagnosticsReport report;
+
+    // Two requests in one read. The first queues nothing, the second replies.
+    clock.advance_to(2000);
+    diagnostics.on_requests_received(2);
+
+    clock.advance_to(2100);
+    diagnostics.on_request_handled(0, 0);
+    diagnostics.on_bytes_written(5);
+
+    clock.advance_to(2300);
+    diagnostics.on_request_handled(0, 6);
+
+    clock.advance_to(2400);
+    diagnostics.on_bytes_written(6);
+
+    diagnostics.report(report);
+    BOOST_TEST(report.reply_latency.max == 400u);
+
+    // Handling with nothing received does not time a reply.
+    diagnostics.on_request_handled(0, 6);
+    clock.advance_to(9000);
+    diagnostics.on_bytes_written(6);
+
+    diagnostics.report(report);
+    BOOST_TEST(report.reply_latency.max == 400u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
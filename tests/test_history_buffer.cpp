@@ -0,0 +1,379 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+// File being tested:
+#include "history_buffer.h"
+
+using namespace scottz0r::temperature;
+
+/// @brief Size of the temperature message that would otherwise carry each sample. Excludes the sample age, which
+/// has no meaning for history.
+static constexpr size_type TEMPERATURE_FRAME_SIZE = 12;
+
+static TemperatureVoteResult make_sample(
+    temperature_type temp0, temperature_type temp1, temperature_type temp2,
+    TemperatureVoteStatus status = TemperatureVoteStatus::OK)
+{
+    TemperatureVoteResult sample{};
+    sample.status = status;
+    sample.agreement_bits = status == TemperatureVoteStatus::OK ? 0x07 : 0x03;
+    sample.temps[0] = temp0;
+    sample.temps[1] = temp1;
+    sample.temps[2] = temp2;
+    sample.average = static_cast<temperature_type>((temp0 + temp1 + temp2) / 3);
+    return sample;
+}
+
+static void check_equal(const TemperatureVoteResult &actual, const TemperatureVoteResult &expected)
+{
+    BOOST_CHECK(actual.status == expected.status);
+    BOOST_TEST(actual.agreement_bits == expected.agreement_bits);
+    BOOST_TEST(actual.temps[0] == expected.temps[0]);
+    BOOST_TEST(actual.temps[1] == expected.temps[1]);
+    BOOST_TEST(actual.temps[2] == expected.temps[2]);
+    BOOST_TEST(actual.average == expected.average);
+}
+
+/// @brief Decode every record in a block of bytes, starting from base.
+static std::vector<TemperatureVoteResult> decode_all(TemperatureVoteResult base, const uint8_t *data, size_type size)
+{
+    std::vector<TemperatureVoteResult> result;
+    size_type position = 0;
+    while (position < size)
+    {
+        size_type consumed = history_decode(base, data + position, size - position);
+        BOOST_REQUIRE(consumed > 0);
+        position += consumed;
+        result.push_back(base);
+    }
+
+    return result;
+}
+
+/// @brief Slowly drifting room temperature with a little sensor noise, sampled in 0.0625 C steps.
+static std::vector<TemperatureVoteResult> make_drift_samples(size_type count)
+{
+    std::vector<TemperatureVoteResult> samples;
+    std::srand(1);
+
+    temperature_type base = 2200;
+    for (size_type i = 0; i < count; ++i)
+    {
+        if (i % 8 == 0)
+        {
+            base += static_cast<temperature_type>((std::rand() % 3 - 1) * 6);
+        }
+
+        temperature_type noise[3];
+        for (auto &n : noise)
+        {
+            n = static_cast<temperature_type>((std::rand() % 3 - 1) * 6);
+        }
+
+        samples.push_back(make_sample(base + noise[0], base + noise[1], base + noise[2]));
+    }
+
+    return samples;
+}
+
+BOOST_AUTO_TEST_SUITE(history_buffer)
+
+BOOST_AUTO_TEST_CASE(it_should_encode_unchanged_sample_as_header)
+{
+    auto sample = make_sample(2000, 2001, 2002);
+    uint8_t record[HISTORY_RECORD_MAX_SIZE];
+
+    BOOST_TEST(history_encode(sample, sample, record) == 1u);
+
+    TemperatureVoteResult decoded = sample;
+    BOOST_TEST(history_decode(decoded, record, 1) == 1u);
+    check_equal(decoded, sample);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_encode_small_deltas_in_two_bytes)
+{
+    auto prev = make_sample(2000, 2000, 2000);
+    auto sample = make_sample(2015, 1984, 2006);
+    uint8_t record[HISTORY_RECORD_MAX_SIZE];
+
+    BOOST_TEST(history_encode(prev, sample, record) == 3u);
+
+    TemperatureVoteResult decoded = prev;
+    BOOST_TEST(history_decode(decoded, record, 3) == 3u);
+    check_equal(decoded, sample);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_encode_large_deltas_as_varints)
+{
+    auto prev = make_sample(2000, 2000, 2000);
+    auto sample = make_sample(2008, 1900, 2000, TemperatureVoteStatus::Disagree);
+    uint8_t record[HISTORY_RECORD_MAX_SIZE];
+
+    size_type size = history_encode(prev, sample, record);
+    BOOST_TEST(size > 3u);
+
+    TemperatureVoteResult decoded = prev;
+    BOOST_TEST(history_decode(decoded, record, size) == size);
+    check_equal(decoded, sample);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_round_trip_extreme_temperatures)
+{
+    const auto low = std::numeric_limits<temperature_type>::min();
+    const auto high = std::numeric_limits<temperature_type>::max();
+
+    TemperatureVoteResult prev = make_sample(low, high, 0, TemperatureVoteStatus::SensorError);
+    TemperatureVoteResult sample = make_sample(high, low, low, TemperatureVoteStatus::_Unknown);
+    sample.average = high;
+    uint8_t record[HISTORY_RECORD_MAX_SIZE];
+
+    size_type size = history_encode(prev, sample, record);
+    BOOST_TEST(size <= HISTORY_RECORD_MAX_SIZE);
+
+    TemperatureVoteResult decoded = prev;
+    BOOST_TEST(history_decode(decoded, record, size) == size);
+    check_equal(decoded, sample);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_store_average_residual)
+{
+    auto prev = make_sample(2000, 2000, 2000);
+
+    // Average that does not match the agreeing sensors, as if computed elsewhere.
+    auto sample = make_sample(2000, 2000, 2000);
+    sample.average = 1500;
+    uint8_t record[HISTORY_RECORD_MAX_SIZE];
+
+    size_type size = history_encode(prev, sample, record);
+    BOOST_TEST(size > 1u);
+
+    TemperatureVoteResult decoded = prev;
+    BOOST_TEST(history_decode(decoded, record, size) == size);
+    check_equal(decoded, sample);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_reject_truncated_record)
+{
+    auto prev = make_sample(2000, 2000, 2000);
+    auto sample = make_sample(3000, 1000, 2000);
+    uint8_t record[HISTORY_RECORD_MAX_SIZE];
+
+    size_type size = history_encode(prev, sample, record);
+
+    for (size_type i = 0; i < size; ++i)
+    {
+        TemperatureVoteResult decoded = prev;
+        BOOST_TEST(history_decode(decoded, record, i) == 0u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(it_should_read_all_pushed_samples)
+{
+    uint8_t storage[128];
+    HistoryBuffer history(storage, sizeof(storage));
+
+    auto samples = make_drift_samples(20);
+    for (const auto &sample : samples)
+    {
+        history.push(sample);
+    }
+
+    BOOST_TEST(history.record_count() == 20u);
+
+    uint16_t offset = HISTORY_OFFSET_OLDEST;
+    uint8_t data[128];
+    TemperatureVoteResult base;
+    size_type size = history.read(offset, data, sizeof(data), base);
+
+    BOOST_TEST(offset == history.start_offset());
+    BOOST_TEST(size == history.size());
+
+    auto decoded = decode_all(base, data, size);
+    BOOST_REQUIRE(decoded.size() == samples.size());
+    for (size_type i = 0; i < samples.size(); ++i)
+    {
+        check_equal(decoded[i], samples[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(it_should_resume_from_offset_in_small_reads)
+{
+    uint8_t storage[256];
+    HistoryBuffer history(storage, sizeof(storage));
+
+    auto samples = make_drift_samples(30);
+    for (const auto &sample : samples)
+    {
+        history.push(sample);
+    }
+
+    std::vector<TemperatureVoteResult> decoded;
+    uint16_t offset = HISTORY_OFFSET_OLDEST;
+    while (offset != history.end_offset())
+    {
+        uint8_t data[16];
+        TemperatureVoteResult base;
+        uint16_t requested = offset;
+        size_type size = history.read(offset, data, sizeof(data), base);
+
+        // Only whole records are returned, and the offset is kept once the first read has settled it.
+        BOOST_REQUIRE(size > 0u);
+        if (requested != HISTORY_OFFSET_OLDEST)
+        {
+            BOOST_TEST(offset == requested);
+        }
+
+        auto block = decode_all(base, data, size);
+        decoded.insert(decoded.end(), block.begin(), block.end());
+        offset += size;
+    }
+
+    BOOST_REQUIRE(decoded.size() == samples.size());
+    for (size_type i = 0; i < samples.size(); ++i)
+    {
+        check_equal(decoded[i], samples[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(it_should_drop_oldest_when_full)
+{
+    uint8_t storage[32];
+    HistoryBuffer history(storage, sizeof(storage));
+
+    // Every sample needs a varint record, so the buffer wraps many times.
+    std::vector<TemperatureVoteResult> samples;
+    for (temperature_type i = 0; i < 100; ++i)
+    {
+        samples.push_back(make_sample(2000 + i * 100, 2000 - i * 100, 2000 + i * 50));
+        history.push(samples.back());
+        BOOST_TEST(history.size() <= sizeof(storage));
+    }
+
+    BOOST_TEST(history.start_offset() > 0u);
+
+    uint16_t offset = HISTORY_OFFSET_OLDEST;
+    uint8_t data[32];
+    TemperatureVoteResult base;
+    size_type size = history.read(offset, data, sizeof(data), base);
+
+    // The newest records survive, decoded from the base carried over from dropped records.
+    auto decoded = decode_all(base, data, size);
+    BOOST_REQUIRE(decoded.size() == history.record_count());
+    size_type first = samples.size() - decoded.size();
+    for (size_type i = 0; i < decoded.size(); ++i)
+    {
+        check_equal(decoded[i], samples[first + i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(it_should_restart_stale_offset_at_oldest)
+{
+    uint8_t storage[32];
+    HistoryBuffer history(storage, sizeof(storage));
+
+    for (temperature_type i = 0; i < 100; ++i)
+    {
+        history.push(make_sample(2000 + i * 100, 2000, 2000));
+    }
+
+    uint8_t data[32];
+    TemperatureVoteResult base;
+
+    // Offset of a record that has been dropped.
+    uint16_t offset = static_cast<uint16_t>(history.start_offset() - 1);
+    history.read(offset, data, sizeof(data), base);
+    BOOST_TEST(offset == history.start_offset());
+
+    // Offset in the middle of a record.
+    offset = static_cast<uint16_t>(history.start_offset() + 1);
+    history.read(offset, data, sizeof(data), base);
+    BOOST_TEST(offset == history.start_offset());
+
+    // Offset at the end reads nothing.
+    offset = history.end_offset();
+    BOOST_TEST(history.read(offset, data, sizeof(data), base) == 0u);
+    BOOST_TEST(offset == history.end_offset());
+}
+
+BOOST_AUTO_TEST_CASE(it_should_resume_download_while_samples_are_pushed)
+{
+    uint8_t storage[64];
+    HistoryBuffer history(storage, sizeof(storage));
+
+    std::vector<TemperatureVoteResult> samples;
+    for (temperature_type i = 0; i < 10; ++i)
+    {
+        samples.push_back(make_sample(2000 + i * 100, 2000 - i * 100, 2000 + i * 50));
+        history.push(samples.back());
+    }
+
+    // Read part of the history, then push a sample that does not drop the next record to read.
+    uint8_t data[16];
+    TemperatureVoteResult base;
+    uint16_t offset = HISTORY_OFFSET_OLDEST;
+    size_type size = history.read(offset, data, sizeof(data), base);
+    BOOST_REQUIRE(size > 0u);
+    size_type first = samples.size() - history.record_count();
+    auto decoded = decode_all(base, data, size);
+    uint16_t next = static_cast<uint16_t>(offset + size);
+
+    samples.push_back(make_sample(2500, 2500, 2500));
+    history.push(samples.back());
+    BOOST_REQUIRE(static_cast<uint16_t>(next - history.start_offset()) <= history.size());
+
+    // The next read continues from where the last one stopped.
+    offset = next;
+    size = history.read(offset, data, sizeof(data), base);
+    BOOST_TEST(offset == next);
+    auto block = decode_all(base, data, size);
+    BOOST_REQUIRE(first + decoded.size() + block.size() <= samples.size());
+    for (size_type i = 0; i < block.size(); ++i)
+    {
+        check_equal(block[i], samples[first + decoded.size() + i]);
+    }
+
+    // Push until the record at the read position has been dropped. The download restarts at the oldest record.
+    next = static_cast<uint16_t>(offset + size);
+    while (static_cast<uint16_t>(next - history.start_offset()) <= history.size())
+    {
+        samples.push_back(make_sample(static_cast<temperature_type>(3000 + samples.size() * 100), 2000, 2000));
+        history.push(samples.back());
+    }
+
+    offset = next;
+    size = history.read(offset, data, sizeof(data), base);
+    BOOST_TEST(offset == history.start_offset());
+    block = decode_all(base, data, size);
+    first = samples.size() - history.record_count();
+    for (size_type i = 0; i < block.size(); ++i)
+    {
+        check_equal(block[i], samples[first + i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(it_should_use_fewer_bytes_per_sample_than_temperature_frame)
+{
+    const size_type sample_count = 1000;
+    auto samples = make_drift_samples(sample_count);
+
+    TemperatureVoteResult prev{};
+    size_type total = 0;
+    for (const auto &sample : samples)
+    {
+        uint8_t record[HISTORY_RECORD_MAX_SIZE];
+        total += history_encode(prev, sample, record);
+        prev = sample;
+    }
+
+    double bytes_per_sample = static_cast<double>(total) / sample_count;
+    BOOST_TEST_MESSAGE(
+        "History: " << bytes_per_sample << " bytes per sample, temperature frame: " << TEMPERATURE_FRAME_SIZE
+                    << " bytes per sample");
+
+    // Sensor noise of one step mostly fits the small encoding, so expect at least a 3x saving.
+    BOOST_TEST(bytes_per_sample * 3 < TEMPERATURE_FRAME_SIZE);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,120 @@
+#include "mocks/virtual_clock.h"
+#include "mocks/i2c_fault_model.h"
+#include "mocks/mcp9808_model.h"
+#include "test_utils.h"
+#include <boost/test/unit_test.hpp>
+
+/// @brief Point the sensor at the ambient register. Returns the endTransmission status.
+static uint8_t write_pointer(I2cBusModel &bus, uint8_t addr)
+{
+    bus.beginTransmission(addr);
+    bus.write(Mcp9808Model::REG_AMBIENT_TEMP);
+    return bus.endTransmission();
+}
+
+BOOST_AUTO_TEST_SUITE(i2c_fault_model)
+
+BOOST_AUTO_TEST_CASE(it_should_pass_through_without_faults)
+{
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18, 20.0);
+    I2cFaultModel faults(sensor);
+    bus.attach(faults);
+
+    BOOST_TEST(faults.address() == 0x18);
+    BOOST_TEST(write_pointer(bus, 0x18) == I2cBusModel::STATUS_OK);
+    BOOST_TEST(bus.requestFrom(0x18, 2) == 2);
+    BOOST_TEST((bus.read() & 0x1F) == 0x01);
+    BOOST_TEST(bus.read() == 0x40);
+
+    BOOST_TEST(faults.nacks() == 0u);
+    BOOST_TEST(faults.short_reads() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_nack_writes_and_reads)
+{
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18);
+    I2cFaultModel faults(sensor);
+    bus.attach(faults);
+
+    // The pointer write is dropped, so the sensor keeps its pointer.
+    faults.set_nack_chance(1.0);
+    bus.beginTransmission(0x18);
+    bus.write(Mcp9808Model::REG_CONFIG);
+    BOOST_TEST(bus.endTransmission() == I2cBusModel::STATUS_DATA_NACK);
+    BOOST_TEST(sensor.pointer() == Mcp9808Model::REG_AMBIENT_TEMP);
+
+    BOOST_TEST(bus.requestFrom(0x18, 2) == 0);
+    BOOST_TEST(bus.read() == -1);
+    BOOST_TEST(faults.nacks() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_return_short_reads)
+{
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18);
+    I2cFaultModel faults(sensor, 7);
+    bus.attach(faults);
+
+    faults.set_short_read_chance(1.0);
+    for (int i = 0; i < 20; ++i)
+    {
+        BOOST_TEST(bus.requestFrom(0x18, 2) < 2);
+    }
+
+    BOOST_TEST(faults.short_reads() == 20u);
+    BOOST_TEST(faults.nacks() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_repeat_faults_for_a_seed)
+{
+    Mcp9808Model sensor(0x18);
+    I2cFaultModel first(sensor, 42);
+    I2cFaultModel second(sensor, 42);
+    first.set_nack_chance(0.5);
+    second.set_nack_chance(0.5);
+
+    uint8_t pointer = Mcp9808Model::REG_AMBIENT_TEMP;
+    int differences = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        differences += first.write(&pointer, 1) != second.write(&pointer, 1) ? 1 : 0;
+    }
+
+    BOOST_TEST(differences == 0);
+    BOOST_TEST(first.nacks() == second.nacks());
+    BOOST_TEST(first.nacks() > 25u);
+    BOOST_TEST(first.nacks() < 75u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_time_out_on_a_locked_bus)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18);
+    bus.attach(sensor);
+    bus.add_lockup(100, 50);
+
+    clock.advance_to(99 * 1000);
+    BOOST_TEST(!bus.is_locked(99));
+    BOOST_TEST(bus.requestFrom(0x18, 2) == 2);
+
+    // Data from before the lockup is not left to read.
+    clock.advance_to(100 * 1000);
+    BOOST_TEST(bus.is_locked(100));
+    BOOST_TEST(write_pointer(bus, 0x18) == I2cBusModel::STATUS_TIMEOUT);
+    BOOST_TEST(bus.requestFrom(0x18, 2) == 0);
+    BOOST_TEST(bus.read() == -1);
+
+    clock.advance_to(150 * 1000);
+    BOOST_TEST(write_pointer(bus, 0x18) == I2cBusModel::STATUS_OK);
+    BOOST_TEST(bus.timeouts() == 2u);
+    BOOST_TEST(bus.transactions() == 4u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,45 @@
+#include <boost/test/unit_test.hpp>
+#include <limits>
+
+// File being tested:
+#include "interval_timer.h"
+
+using namespace scottz0r::temperature;
+
+BOOST_AUTO_TEST_SUITE(interval_timer)
+
+BOOST_AUTO_TEST_CASE(it_should_fire_after_interval)
+{
+    IntervalTimer timer(250);
+    timer.reset(1000);
+
+    BOOST_TEST(!timer.is_due(1000));
+    BOOST_TEST(!timer.is_due(1249));
+    BOOST_TEST(timer.is_due(1250));
+
+    // Re-armed after firing.
+    BOOST_TEST(!timer.is_due(1251));
+    BOOST_TEST(timer.is_due(1500));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_not_burst_after_falling_behind)
+{
+    IntervalTimer timer(100);
+    timer.reset(0);
+
+    // Several intervals missed. Fire once, then wait a full interval from now.
+    BOOST_TEST(timer.is_due(550));
+    BOOST_TEST(!timer.is_due(600));
+    BOOST_TEST(timer.is_due(650));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_handle_millis_roll)
+{
+    IntervalTimer timer(10);
+    timer.reset(std::numeric_limits<unsigned long>::max() - 4);
+
+    BOOST_TEST(!timer.is_due(2));
+    BOOST_TEST(timer.is_due(5));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
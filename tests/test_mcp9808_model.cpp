@@ -0,0 +1,223 @@
+#include "mocks/virtual_clock.h"
+#include "mocks/mcp9808_model.h"
+#include "test_utils.h"
+#include <boost/test/unit_test.hpp>
+
+/// @brief Read a 16 bit register through the bus, pointer write first.
+static uint16_t read_register(I2cBusModel &bus, uint8_t addr, uint8_t reg)
+{
+    bus.beginTransmission(addr);
+    bus.write(reg);
+    bus.endTransmission();
+
+    bus.requestFrom(addr, 2);
+    uint16_t msb = static_cast<uint16_t>(bus.read());
+    uint16_t lsb = static_cast<uint16_t>(bus.read());
+    return static_cast<uint16_t>((msb << 8) | lsb);
+}
+
+/// @brief Write a 16 bit register through the bus.
+static uint8_t write_register(I2cBusModel &bus, uint8_t addr, uint8_t reg, uint16_t value)
+{
+    bus.beginTransmission(addr);
+    bus.write(reg);
+    bus.write(static_cast<uint8_t>(value >> 8));
+    bus.write(static_cast<uint8_t>(value));
+    return bus.endTransmission();
+}
+
+BOOST_AUTO_TEST_SUITE(mcp9808_model)
+
+BOOST_AUTO_TEST_CASE(it_should_answer_ids_and_power_up_defaults)
+{
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18);
+    bus.attach(sensor);
+
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_MANUF_ID) == 0x0054);
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_DEVICE_ID) == 0x0400);
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_CONFIG) == 0x0000);
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_T_CRIT) == 0x0000);
+
+    // Resolution is the only 8 bit register.
+    bus.beginTransmission(0x18);
+    bus.write(Mcp9808Model::REG_RESOLUTION);
+    bus.endTransmission();
+    BOOST_TEST(bus.requestFrom(0x18, 2) == 1);
+    BOOST_TEST(bus.read() == 0x03);
+    BOOST_TEST(bus.read() == -1);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_route_by_address)
+{
+    I2cBusModel bus;
+    Mcp9808Model low(0x18, 20.0);
+    Mcp9808Model high(0x1F, -20.0);
+    bus.attach(low);
+    bus.attach(high);
+
+    BOOST_TEST((read_register(bus, 0x18, Mcp9808Model::REG_AMBIENT_TEMP) & 0x1FFF) == 0x0140);
+    BOOST_TEST((read_register(bus, 0x1F, Mcp9808Model::REG_AMBIENT_TEMP) & 0x1FFF) == 0x1EC0);
+
+    // Empty addresses NACK and return no data.
+    bus.beginTransmission(0x19);
+    bus.write(Mcp9808Model::REG_AMBIENT_TEMP);
+    BOOST_TEST(bus.endTransmission() == I2cBusModel::STATUS_ADDRESS_NACK);
+    BOOST_TEST(bus.requestFrom(0x19, 2) == 0);
+    BOOST_TEST(bus.available() == 0);
+
+    bus.detach(0x1F);
+    bus.beginTransmission(0x1F);
+    BOOST_TEST(bus.endTransmission() == I2cBusModel::STATUS_ADDRESS_NACK);
+    BOOST_TEST(bus.transactions() == 7u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_encode_13_bit_temperatures)
+{
+    BOOST_TEST(Mcp9808Model::encode_temperature(25.0, 3) == 0x0190);
+    BOOST_TEST(Mcp9808Model::encode_temperature(25.0625, 3) == 0x0191);
+    BOOST_TEST(Mcp9808Model::encode_temperature(-0.0625, 3) == 0x1FFF);
+    BOOST_TEST(Mcp9808Model::encode_temperature(-40.0, 3) == 0x1D80);
+
+    // Coarser resolutions clear fraction bits. 25.3 C is 404.8 sixteenths.
+    BOOST_TEST(Mcp9808Model::encode_temperature(25.3, 2) == 0x0194);
+    BOOST_TEST(Mcp9808Model::encode_temperature(25.3, 1) == 0x0194);
+    BOOST_TEST(Mcp9808Model::encode_temperature(25.3, 0) == 0x0190);
+
+    // Clamped to the register range.
+    BOOST_TEST(Mcp9808Model::encode_temperature(300.0, 3) == 0x0FFF);
+    BOOST_TEST(Mcp9808Model::encode_temperature(-300.0, 3) == 0x1000);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_update_ambient_once_per_conversion)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18, 20.0);
+    bus.attach(sensor);
+
+    // Half degree resolution converts every 30 milliseconds.
+    bus.beginTransmission(0x18);
+    bus.write(Mcp9808Model::REG_RESOLUTION);
+    bus.write(0x00);
+    bus.endTransmission();
+
+    sensor.set_temperature(21.0);
+
+    clock.advance_to(29 * 1000);
+    BOOST_TEST((sensor.register_value(Mcp9808Model::REG_AMBIENT_TEMP) & 0x1FFF) == 0x0140);
+    BOOST_TEST(sensor.conversions() == 0u);
+
+    clock.advance_to(30 * 1000);
+    BOOST_TEST((sensor.register_value(Mcp9808Model::REG_AMBIENT_TEMP) & 0x1FFF) == 0x0150);
+    BOOST_TEST(sensor.conversions() == 1u);
+
+    // Conversions between reads are not seen, but are counted.
+    clock.advance_to(100 * 1000);
+    sensor.register_value(Mcp9808Model::REG_AMBIENT_TEMP);
+    BOOST_TEST(sensor.conversions() == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_sample_source_at_conversion_time)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    Mcp9808Model sensor(0x18);
+
+    // One degree per second, seen at the 250 millisecond conversions.
+    sensor.set_temperature_source([](unsigned long now) { return now / 1000.0; });
+
+    clock.advance_to(1100 * 1000);
+    BOOST_TEST((sensor.register_value(Mcp9808Model::REG_AMBIENT_TEMP) & 0x1FFF) == 0x0010);
+
+    clock.advance_to(1600 * 1000);
+    BOOST_TEST((sensor.register_value(Mcp9808Model::REG_AMBIENT_TEMP) & 0x1FFF) == 0x0018);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_flag_alert_limits)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18, 35.0);
+    bus.attach(sensor);
+
+    // Limits have 0.25 C steps. Fraction bits below that are dropped.
+    write_register(bus, 0x18, Mcp9808Model::REG_T_UPPER, 0x01E3);
+    write_register(bus, 0x18, Mcp9808Model::REG_T_LOWER, 0x00A0);
+    write_register(bus, 0x18, Mcp9808Model::REG_T_CRIT, 0x0280);
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_T_UPPER) == 0x01E0);
+
+    clock.advance_to(250 * 1000);
+    BOOST_TEST(sensor.register_value(Mcp9808Model::REG_AMBIENT_TEMP) == (Mcp9808Model::AMBIENT_UPPER | 0x0230));
+
+    sensor.set_temperature(40.0);
+    clock.advance_to(500 * 1000);
+    BOOST_TEST(sensor.register_value(Mcp9808Model::REG_AMBIENT_TEMP) ==
+               (Mcp9808Model::AMBIENT_CRIT | Mcp9808Model::AMBIENT_UPPER | 0x0280));
+
+    sensor.set_temperature(-5.0);
+    clock.advance_to(750 * 1000);
+    BOOST_TEST(sensor.register_value(Mcp9808Model::REG_AMBIENT_TEMP) == (Mcp9808Model::AMBIENT_LOWER | 0x1FB0));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_lock_limits_until_reset)
+{
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18);
+    bus.attach(sensor);
+
+    write_register(bus, 0x18, Mcp9808Model::REG_T_CRIT, 0x0280);
+    write_register(bus, 0x18, Mcp9808Model::REG_CONFIG, Mcp9808Model::CONFIG_CRIT_LOCK);
+
+    // Neither the limit nor the lock can be changed.
+    write_register(bus, 0x18, Mcp9808Model::REG_T_CRIT, 0x0100);
+    write_register(bus, 0x18, Mcp9808Model::REG_CONFIG, 0);
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_T_CRIT) == 0x0280);
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_CONFIG) == Mcp9808Model::CONFIG_CRIT_LOCK);
+
+    // The window lock is separate.
+    write_register(bus, 0x18, Mcp9808Model::REG_T_UPPER, 0x0100);
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_T_UPPER) == 0x0100);
+
+    sensor.reset();
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_CONFIG) == 0x0000);
+    BOOST_TEST(read_register(bus, 0x18, Mcp9808Model::REG_T_CRIT) == 0x0000);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_stop_converting_in_shutdown)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18, 20.0);
+    bus.attach(sensor);
+
+    write_register(bus, 0x18, Mcp9808Model::REG_CONFIG, Mcp9808Model::CONFIG_SHUTDOWN);
+    sensor.set_temperature(30.0);
+
+    clock.advance_to(1000 * 1000);
+    BOOST_TEST((read_register(bus, 0x18, Mcp9808Model::REG_AMBIENT_TEMP) & 0x1FFF) == 0x0140);
+
+    // Leaving shutdown starts a new conversion.
+    write_register(bus, 0x18, Mcp9808Model::REG_CONFIG, 0);
+    clock.advance_to(1249 * 1000);
+    BOOST_TEST((read_register(bus, 0x18, Mcp9808Model::REG_AMBIENT_TEMP) & 0x1FFF) == 0x0140);
+    clock.advance_to(1250 * 1000);
+    BOOST_TEST((read_register(bus, 0x18, Mcp9808Model::REG_AMBIENT_TEMP) & 0x1FFF) == 0x01E0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -29,45 +29,54 @@ BOOST_AUTO_TEST_CASE(it_should_format_temperature_positive)
     temp2.value = boost::endian::native_to_little(995);
     average.value = boost::endian::native_to_little(1007);
 
-    vote.temp0 = temp0.value;
-    vote.temp1 = temp1.value;
-    vote.temp2 = temp2.value;
+    vote.temps[0] = temp0.value;
+    vote.temps[1] = temp1.value;
+    vote.temps[2] = temp2.value;
     vote.average = average.value;
 
-    vote.is_temp0_agree = true;
-    vote.is_temp1_agree = true;
-    vote.is_temp2_agree = true;
+    vote.agreement_bits = 0x07;
 
     vote.status = TemperatureVoteStatus::OK;
 
-    format_msg_temperature(buffer, vote);
-
-    BOOST_TEST(buffer.buffer[0] == 1);
-    BOOST_TEST(buffer.buffer[1] == 0);
-    BOOST_TEST(buffer.buffer[2] == temp0.split.b0);
-    BOOST_TEST(buffer.buffer[3] == temp0.split.b1);
-    BOOST_TEST(buffer.buffer[4] == temp1.split.b0);
-    BOOST_TEST(buffer.buffer[5] == temp1.split.b1);
-    BOOST_TEST(buffer.buffer[6] == temp2.split.b0);
-    BOOST_TEST(buffer.buffer[7] == temp2.split.b1);
-    BOOST_TEST(buffer.buffer[8] == 7);
-    BOOST_TEST(buffer.buffer[9] == average.split.b0);
-    BOOST_TEST(buffer.buffer[10] == average.split.b1);
-
-    uint8_t checksum = 0;
-    checksum ^= 1;
-    checksum ^= 0;
-    checksum ^= temp0.split.b0;
-    checksum ^= temp0.split.b1;
-    checksum ^= temp1.split.b0;
-    checksum ^= temp1.split.b1;
-    checksum ^= temp2.split.b0;
-    checksum ^= temp2.split.b1;
-    checksum ^= 7;
-    checksum ^= average.split.b0;
-    checksum ^= average.split.b1;
-
-    BOOST_TEST(buffer.buffer[11] == checksum);
+    format_msg_temperature(buffer, vote, 0);
+
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 13);
+    BOOST_TEST(buffer.buffer[2] == 1);
+    BOOST_TEST(buffer.buffer[3] == 3);
+    BOOST_TEST(buffer.buffer[4] == 0);
+    BOOST_TEST(buffer.buffer[5] == temp0.split.b0);
+    BOOST_TEST(buffer.buffer[6] == temp0.split.b1);
+    BOOST_TEST(buffer.buffer[7] == temp1.split.b0);
+    BOOST_TEST(buffer.buffer[8] == temp1.split.b1);
+    BOOST_TEST(buffer.buffer[9] == temp2.split.b0);
+    BOOST_TEST(buffer.buffer[10] == temp2.split.b1);
+    BOOST_TEST(buffer.buffer[11] == 7);
+    BOOST_TEST(buffer.buffer[12] == average.split.b0);
+    BOOST_TEST(buffer.buffer[13] == average.split.b1);
+    BOOST_TEST(buffer.buffer[14] == 0);
+    BOOST_TEST(buffer.buffer[15] == 0);
+
+    // The CRC covers the length, type and payload.
+    const uint8_t framed[] = {13,
+                              1,
+                              3,
+                              0,
+                              temp0.split.b0,
+                              temp0.split.b1,
+                              temp1.split.b0,
+                              temp1.split.b1,
+                              temp2.split.b0,
+                              temp2.split.b1,
+                              7,
+                              average.split.b0,
+                              average.split.b1,
+                              0,
+                              0};
+
+    BOOST_TEST(buffer.message_size == 17);
+    BOOST_TEST(buffer.message_size == FRAME_OVERHEAD + TEMPERATURE_PAYLOAD_SIZE);
+    BOOST_TEST(buffer.buffer[16] == crc8(framed, sizeof(framed)));
 }
 
 BOOST_AUTO_TEST_CASE(it_should_format_temperature_negative)
@@ -81,45 +90,53 @@ BOOST_AUTO_TEST_CASE(it_should_format_temperature_negative)
     temp2.value = boost::endian::native_to_little(1000);
     average.value = boost::endian::native_to_little(-3825);
 
-    vote.temp0 = temp0.value;
-    vote.temp1 = temp1.value;
-    vote.temp2 = temp2.value;
+    vote.temps[0] = temp0.value;
+    vote.temps[1] = temp1.value;
+    vote.temps[2] = temp2.value;
     vote.average = average.value;
 
-    vote.is_temp0_agree = true;
-    vote.is_temp1_agree = true;
-    vote.is_temp2_agree = false;
+    vote.agreement_bits = 0x03;
 
     vote.status = TemperatureVoteStatus::Disagree;
 
-    format_msg_temperature(buffer, vote);
-
-    BOOST_TEST(buffer.buffer[0] == 1);
-    BOOST_TEST(buffer.buffer[1] == 2);
-    BOOST_TEST(buffer.buffer[2] == temp0.split.b0);
-    BOOST_TEST(buffer.buffer[3] == temp0.split.b1);
-    BOOST_TEST(buffer.buffer[4] == temp1.split.b0);
-    BOOST_TEST(buffer.buffer[5] == temp1.split.b1);
-    BOOST_TEST(buffer.buffer[6] == temp2.split.b0);
-    BOOST_TEST(buffer.buffer[7] == temp2.split.b1);
-    BOOST_TEST(buffer.buffer[8] == 3);
-    BOOST_TEST(buffer.buffer[9] == average.split.b0);
-    BOOST_TEST(buffer.buffer[10] == average.split.b1);
-
-    uint8_t checksum = 0;
-    checksum ^= 1;
-    checksum ^= 2;
-    checksum ^= temp0.split.b0;
-    checksum ^= temp0.split.b1;
-    checksum ^= temp1.split.b0;
-    checksum ^= temp1.split.b1;
-    checksum ^= temp2.split.b0;
-    checksum ^= temp2.split.b1;
-    checksum ^= 3;
-    checksum ^= average.split.b0;
-    checksum ^= average.split.b1;
-
-    BOOST_TEST(buffer.buffer[11] == checksum);
+    // Sample age of 300ms.
+    format_msg_temperature(buffer, vote, 300);
+
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 13);
+    BOOST_TEST(buffer.buffer[2] == 1);
+    BOOST_TEST(buffer.buffer[3] == 3);
+    BOOST_TEST(buffer.buffer[4] == 2);
+    BOOST_TEST(buffer.buffer[5] == temp0.split.b0);
+    BOOST_TEST(buffer.buffer[6] == temp0.split.b1);
+    BOOST_TEST(buffer.buffer[7] == temp1.split.b0);
+    BOOST_TEST(buffer.buffer[8] == temp1.split.b1);
+    BOOST_TEST(buffer.buffer[9] == temp2.split.b0);
+    BOOST_TEST(buffer.buffer[10] == temp2.split.b1);
+    BOOST_TEST(buffer.buffer[11] == 3);
+    BOOST_TEST(buffer.buffer[12] == average.split.b0);
+    BOOST_TEST(buffer.buffer[13] == average.split.b1);
+    BOOST_TEST(buffer.buffer[14] == 0x2C);
+    BOOST_TEST(buffer.buffer[15] == 0x01);
+
+    const uint8_t framed[] = {13,
+                              1,
+                              3,
+                              2,
+                              temp0.split.b0,
+                              temp0.split.b1,
+                              temp1.split.b0,
+                              temp1.split.b1,
+                              temp2.split.b0,
+                              temp2.split.b1,
+                              3,
+                              average.split.b0,
+                              average.split.b1,
+                              0x2C,
+                              0x01};
+
+    BOOST_TEST(buffer.message_size == 17);
+    BOOST_TEST(buffer.buffer[16] == crc8(framed, sizeof(framed)));
 }
 
 BOOST_AUTO_TEST_CASE(it_should_format_temperature_bad_status_enum)
@@ -129,20 +146,72 @@ BOOST_AUTO_TEST_CASE(it_should_format_temperature_bad_status_enum)
 
     vote.status = static_cast<TemperatureVoteStatus>(120);
 
-    format_msg_temperature(buffer, vote);
+    format_msg_temperature(buffer, vote, 0);
 
-    BOOST_TEST(buffer.buffer[0] == 1);
-    BOOST_TEST(buffer.buffer[1] == 3);
-    BOOST_TEST(buffer.buffer[2] == 0);
-    BOOST_TEST(buffer.buffer[3] == 0);
-    BOOST_TEST(buffer.buffer[4] == 0);
+    BOOST_TEST(buffer.buffer[2] == 1);
+    BOOST_TEST(buffer.buffer[3] == 3);
+    BOOST_TEST(buffer.buffer[4] == 3);
     BOOST_TEST(buffer.buffer[5] == 0);
     BOOST_TEST(buffer.buffer[6] == 0);
     BOOST_TEST(buffer.buffer[7] == 0);
     BOOST_TEST(buffer.buffer[8] == 0);
     BOOST_TEST(buffer.buffer[9] == 0);
     BOOST_TEST(buffer.buffer[10] == 0);
-    BOOST_TEST(buffer.buffer[11] == (1 ^ 3));
+    BOOST_TEST(buffer.buffer[11] == 0);
+    BOOST_TEST(buffer.buffer[12] == 0);
+    BOOST_TEST(buffer.buffer[13] == 0);
+    BOOST_TEST(buffer.buffer[14] == 0);
+    BOOST_TEST(buffer.buffer[15] == 0);
+    BOOST_TEST(buffer.buffer[16] == crc8(buffer.buffer + 1, 15));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_format_temperature_saturate_sample_age)
+{
+    MessageBuffer buffer;
+    TemperatureVoteResult vote{};
+
+    vote.status = TemperatureVoteStatus::OK;
+
+    // Age larger than two bytes can hold.
+    format_msg_temperature(buffer, vote, 70000);
+
+    BOOST_TEST(buffer.message_size == 17);
+    BOOST_TEST(buffer.buffer[14] == 0xFF);
+    BOOST_TEST(buffer.buffer[15] == 0xFF);
+    BOOST_TEST(buffer.buffer[16] == crc8(buffer.buffer + 1, 15));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_format_temperature_stream)
+{
+    MessageBuffer buffer;
+    TemperatureVoteResult vote{};
+
+    vote.temps[0] = 1000;
+    vote.temps[1] = 1025;
+    vote.temps[2] = 995;
+    vote.average = 1006;
+    vote.agreement_bits = 0x07;
+    vote.status = TemperatureVoteStatus::OK;
+
+    // Same fields as the temperature message, with a different identifier and a sequence number.
+    MessageBuffer expected;
+    format_msg_temperature(expected, vote, 300);
+
+    format_msg_temperature_stream(buffer, vote, 300, 0xA5);
+
+    BOOST_TEST(buffer.message_size == 18);
+    BOOST_TEST(buffer.message_size == FRAME_OVERHEAD + TEMPERATURE_STREAM_PAYLOAD_SIZE);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 14);
+    BOOST_TEST(buffer.buffer[2] == 5);
+    for (int i = 3; i <= 15; ++i)
+    {
+        BOOST_TEST(buffer.buffer[i] == expected.buffer[i]);
+    }
+
+    BOOST_TEST(buffer.buffer[16] == 0xA5);
+
+    BOOST_TEST(buffer.buffer[17] == crc8(buffer.buffer + 1, 16));
 }
 
 BOOST_AUTO_TEST_CASE(it_should_format_system_status)
@@ -150,31 +219,41 @@ BOOST_AUTO_TEST_CASE(it_should_format_system_status)
     MessageBuffer buffer;
     SystemSensorStatus status;
 
-    status.is_sensor_0_good = true;
-    status.is_sensor_1_good = false;
-    status.is_sensor_2_good = true;
+    status.sensor_good_bits = 0x05;
     status.system_status = SystemStatus::OK;
+    status.tx_queue_size = 12;
+    status.tx_queue_peak = 96;
 
     format_msg_system_status(buffer, status);
 
-    BOOST_TEST(buffer.message_size == 4);
-    BOOST_TEST(buffer.buffer[0] == 2);
-    BOOST_TEST(buffer.buffer[1] == 0);
-    BOOST_TEST(buffer.buffer[2] == 5);
-    BOOST_TEST(buffer.buffer[3] == (2 ^ 0 ^ 5));
+    BOOST_TEST(buffer.message_size == 9);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 5);
+    BOOST_TEST(buffer.buffer[2] == 2);
+    BOOST_TEST(buffer.buffer[3] == 3);
+    BOOST_TEST(buffer.buffer[4] == 0);
+    BOOST_TEST(buffer.buffer[5] == 5);
+    BOOST_TEST(buffer.buffer[6] == 12);
+    BOOST_TEST(buffer.buffer[7] == 96);
+    BOOST_TEST(buffer.buffer[8] == crc8(buffer.buffer + 1, 7));
 
-    status.is_sensor_0_good = false;
-    status.is_sensor_1_good = true;
-    status.is_sensor_2_good = false;
+    status.sensor_good_bits = 0x02;
     status.system_status = SystemStatus::SetupError;
+    status.tx_queue_size = 0;
+    status.tx_queue_peak = 0;
 
     format_msg_system_status(buffer, status);
 
-    BOOST_TEST(buffer.message_size == 4);
-    BOOST_TEST(buffer.buffer[0] == 2);
-    BOOST_TEST(buffer.buffer[1] == 1);
+    BOOST_TEST(buffer.message_size == 9);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 5);
     BOOST_TEST(buffer.buffer[2] == 2);
-    BOOST_TEST(buffer.buffer[3] == (2 ^ 1 ^ 2));
+    BOOST_TEST(buffer.buffer[3] == 3);
+    BOOST_TEST(buffer.buffer[4] == 1);
+    BOOST_TEST(buffer.buffer[5] == 2);
+    BOOST_TEST(buffer.buffer[6] == 0);
+    BOOST_TEST(buffer.buffer[7] == 0);
+    BOOST_TEST(buffer.buffer[8] == crc8(buffer.buffer + 1, 7));
 }
 
 BOOST_AUTO_TEST_CASE(it_should_format_system_status_bad_status_enum)
@@ -182,20 +261,25 @@ BOOST_AUTO_TEST_CASE(it_should_format_system_status_bad_status_enum)
     MessageBuffer buffer;
     SystemSensorStatus status;
 
-    status.is_sensor_0_good = true;
-    status.is_sensor_1_good = true;
-    status.is_sensor_2_good = true;
+    status.sensor_good_bits = 0x07;
+    status.tx_queue_size = 0;
+    status.tx_queue_peak = 0;
 
     // Forced bad enumeration.
     status.system_status = static_cast<SystemStatus>(42);
 
     format_msg_system_status(buffer, status);
 
-    BOOST_TEST(buffer.message_size == 4);
-    BOOST_TEST(buffer.buffer[0] == 2);
-    BOOST_TEST(buffer.buffer[1] == 3);
-    BOOST_TEST(buffer.buffer[2] == 7);
-    BOOST_TEST(buffer.buffer[3] == (2 ^ 3 ^ 7));
+    BOOST_TEST(buffer.message_size == 9);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 5);
+    BOOST_TEST(buffer.buffer[2] == 2);
+    BOOST_TEST(buffer.buffer[3] == 3);
+    BOOST_TEST(buffer.buffer[4] == 3);
+    BOOST_TEST(buffer.buffer[5] == 7);
+    BOOST_TEST(buffer.buffer[6] == 0);
+    BOOST_TEST(buffer.buffer[7] == 0);
+    BOOST_TEST(buffer.buffer[8] == crc8(buffer.buffer + 1, 7));
 }
 
 BOOST_AUTO_TEST_CASE(it_should_format_error_msg)
@@ -207,19 +291,23 @@ BOOST_AUTO_TEST_CASE(it_should_format_error_msg)
 
     format_msg_error(buffer, error_code);
 
-    BOOST_TEST(buffer.message_size == 3);
-    BOOST_TEST(buffer.buffer[0] == 3);
+    BOOST_TEST(buffer.message_size == 5);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
     BOOST_TEST(buffer.buffer[1] == 1);
-    BOOST_TEST(buffer.buffer[2] == (3 ^ 1));
+    BOOST_TEST(buffer.buffer[2] == 3);
+    BOOST_TEST(buffer.buffer[3] == 1);
+    BOOST_TEST(buffer.buffer[4] == crc8(buffer.buffer + 1, 3));
 
     error_code = ErrorCode::BadRequest;
 
     format_msg_error(buffer, error_code);
 
-    BOOST_TEST(buffer.message_size == 3);
-    BOOST_TEST(buffer.buffer[0] == 3);
-    BOOST_TEST(buffer.buffer[1] == 0);
-    BOOST_TEST(buffer.buffer[2] == (3 ^ 0));
+    BOOST_TEST(buffer.message_size == 5);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 1);
+    BOOST_TEST(buffer.buffer[2] == 3);
+    BOOST_TEST(buffer.buffer[3] == 0);
+    BOOST_TEST(buffer.buffer[4] == crc8(buffer.buffer + 1, 3));
 }
 
 BOOST_AUTO_TEST_CASE(it_should_format_error_msg_bad_error_enum)
@@ -231,10 +319,148 @@ BOOST_AUTO_TEST_CASE(it_should_format_error_msg_bad_error_enum)
 
     format_msg_error(buffer, error_code);
 
-    BOOST_TEST(buffer.message_size == 3);
-    BOOST_TEST(buffer.buffer[0] == 3);
+    BOOST_TEST(buffer.message_size == 5);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 1);
+    BOOST_TEST(buffer.buffer[2] == 3);
+    BOOST_TEST(buffer.buffer[3] == 2);
+    BOOST_TEST(buffer.buffer[4] == crc8(buffer.buffer + 1, 3));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_format_baud_rate_msg)
+{
+    MessageBuffer buffer;
+
+    // Hundreds of baud, little endian.
+    format_msg_baud_rate(buffer, 1000000);
+
+    BOOST_TEST(buffer.message_size == 6);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 2);
+    BOOST_TEST(buffer.buffer[2] == 7);
+    BOOST_TEST(buffer.buffer[3] == 0x10);
+    BOOST_TEST(buffer.buffer[4] == 0x27);
+    BOOST_TEST(buffer.buffer[5] == crc8(buffer.buffer + 1, 4));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_format_diagnostics_msg)
+{
+    MessageBuffer buffer;
+    DiagnosticsReport report{};
+    report.loop_rate = 0x0102;
+    report.loop_time_max = 0x0304;
+    report.sensor_times[0] = {0x1011, 0x1213, 0x1415};
+    report.sensor_times[1] = {0x2021, 0x2223, 0x2425};
+    report.sensor_times[2] = {0x3031, 0x3233, 0x3435};
+    report.reply_latency = {0x4041, 0x4243, 0x4445};
+    report.bytes_received = 0x05060708;
+    report.bytes_discarded = 0x090A;
+    report.crc_failures = 0x0B0C;
+
+    format_msg_diagnostics(buffer, report);
+
+    const uint8_t expected_payload[] = {
+        3,                                                  // Sensor count.
+        0x02, 0x01, 0x04, 0x03,                             // Loop rate and maximum loop time.
+        0x11, 0x10, 0x13, 0x12, 0x15, 0x14,                 // Sensor 0 min, average, max.
+        0x21, 0x20, 0x23, 0x22, 0x25, 0x24,                 // Sensor 1.
+        0x31, 0x30, 0x33, 0x32, 0x35, 0x34,                 // Sensor 2.
+        0x41, 0x40, 0x43, 0x42, 0x45, 0x44,                 // Reply latency.
+        0x08, 0x07, 0x06, 0x05, 0x0A, 0x09, 0x0C, 0x0B,     // Bytes received, discarded, CRC failures.
+    };
+
+    BOOST_TEST(buffer.message_size == sizeof(expected_payload) + 4);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == sizeof(expected_payload));
+    BOOST_TEST(buffer.buffer[2] == 8);
+
+    for (size_t i = 0; i < sizeof(expected_payload); ++i)
+    {
+        BOOST_TEST(buffer.buffer[3 + i] == expected_payload[i]);
+    }
+
+    BOOST_TEST(buffer.buffer[buffer.message_size - 1] == crc8(buffer.buffer + 1, buffer.message_size - 2));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_format_history_msg)
+{
+    MessageBuffer buffer;
+    TemperatureVoteResult base{};
+    base.temps[0] = 0x0102;
+    base.temps[1] = 0x0304;
+    base.temps[2] = 0x0506;
+    base.average = 0x0708;
+
+    uint8_t data[] = {0xA1, 0xA2, 0xA3};
+
+    format_msg_history(buffer, 0x1234, 0x5678, base, data, sizeof(data));
+
+    BOOST_TEST(buffer.message_size == 21);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
+    BOOST_TEST(buffer.buffer[1] == 17);
+    BOOST_TEST(buffer.buffer[2] == 6);
+    BOOST_TEST(buffer.buffer[3] == 3);
+    BOOST_TEST(buffer.buffer[4] == 0x34);
+    BOOST_TEST(buffer.buffer[5] == 0x12);
+    BOOST_TEST(buffer.buffer[6] == 0x78);
+    BOOST_TEST(buffer.buffer[7] == 0x56);
+    BOOST_TEST(buffer.buffer[8] == 0x02);
+    BOOST_TEST(buffer.buffer[9] == 0x01);
+    BOOST_TEST(buffer.buffer[10] == 0x04);
+    BOOST_TEST(buffer.buffer[11] == 0x03);
+    BOOST_TEST(buffer.buffer[12] == 0x06);
+    BOOST_TEST(buffer.buffer[13] == 0x05);
+    BOOST_TEST(buffer.buffer[14] == 0x08);
+    BOOST_TEST(buffer.buffer[15] == 0x07);
+    BOOST_TEST(buffer.buffer[16] == 3);
+    BOOST_TEST(buffer.buffer[17] == 0xA1);
+    BOOST_TEST(buffer.buffer[18] == 0xA2);
+    BOOST_TEST(buffer.buffer[19] == 0xA3);
+
+    BOOST_TEST(buffer.buffer[20] == crc8(buffer.buffer + 1, 19));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_truncate_history_msg_data)
+{
+    MessageBuffer buffer;
+    TemperatureVoteResult base{};
+    uint8_t data[HISTORY_MSG_MAX_DATA + 4] = {};
+
+    format_msg_history(buffer, 0, 0, base, data, sizeof(data));
+
+    BOOST_TEST(buffer.message_size == 18 + HISTORY_MSG_MAX_DATA);
+    BOOST_TEST(buffer.message_size <= sizeof(buffer.buffer));
+    BOOST_TEST(buffer.buffer[16] == HISTORY_MSG_MAX_DATA);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_format_request_id)
+{
+    MessageBuffer buffer;
+
+    format_msg_error(buffer, ErrorCode::BadRequest);
+    format_msg_request_id(buffer, 0x5A);
+
+    BOOST_TEST(buffer.message_size == 6u);
+    BOOST_TEST(buffer.buffer[0] == 0xA5);
     BOOST_TEST(buffer.buffer[1] == 2);
-    BOOST_TEST(buffer.buffer[2] == (3 ^ 2));
+    BOOST_TEST(buffer.buffer[2] == (0x03 | 0x80));
+    BOOST_TEST(buffer.buffer[3] == 0x00);
+    BOOST_TEST(buffer.buffer[4] == 0x5A);
+    BOOST_TEST(buffer.buffer[5] == crc8(buffer.buffer + 1, 4));
+
+    // The ID is the last payload byte of the largest message too.
+    TemperatureVoteResult base{};
+    uint8_t data[HISTORY_MSG_MAX_DATA] = {};
+    format_msg_history(buffer, 0, 0, base, data, HISTORY_MSG_MAX_DATA);
+    format_msg_request_id(buffer, 0xA5);
+
+    BOOST_TEST(buffer.message_size == FRAME_OVERHEAD + HISTORY_PAYLOAD_HEADER_SIZE + HISTORY_MSG_MAX_DATA + 1);
+    BOOST_TEST(buffer.message_size <= sizeof(buffer.buffer));
+    BOOST_TEST(buffer.buffer[2] == (0x06 | 0x80));
+    BOOST_TEST(buffer.buffer[buffer.message_size - 2] == 0xA5);
+
+    BOOST_TEST(buffer.buffer[1] == buffer.message_size - FRAME_OVERHEAD);
+    BOOST_TEST(buffer.buffer[buffer.message_size - 1] == crc8(buffer.buffer + 1, buffer.message_size - 2));
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <vector>
+
+// File being tested:
+#include "message_frame.h"
+
+using namespace scottz0r::temperature;
+
+/// @brief CRC-8 one bit at a time, straight from the polynomial.
+static uint8_t reference_crc8(const uint8_t *data, size_t size)
+{
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = static_cast<uint8_t>((crc & 0x80) != 0 ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+BOOST_AUTO_TEST_SUITE(message_frame)
+
+BOOST_AUTO_TEST_CASE(it_should_compute_crc8_check_value)
+{
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    BOOST_TEST(crc8(check, sizeof(check)) == 0xF4);
+    BOOST_TEST(crc8(check, 0) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_match_reference_crc8)
+{
+    std::srand(7);
+
+    // Sizes around the eight byte steps of the sliced table.
+    uint8_t data[100];
+    for (size_type size = 0; size < sizeof(data); ++size)
+    {
+        for (auto &b : data)
+        {
+            b = static_cast<uint8_t>(std::rand());
+        }
+
+        BOOST_REQUIRE(crc8(data, size) == reference_crc8(data, size));
+
+        // Continuing a CRC gives the CRC of the whole.
+        size_type split = size / 3;
+        BOOST_REQUIRE(crc8(data + split, size - split, crc8(data, split)) == crc8(data, size));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(it_should_seal_frame)
+{
+    uint8_t frame[8] = {0, 0, 0x03, 0x01, 0x5A};
+
+    BOOST_TEST(frame_seal(frame, 2) == 6u);
+    BOOST_TEST(frame[0] == FRAME_START);
+    BOOST_TEST(frame[1] == 2);
+    BOOST_TEST(frame[5] == reference_crc8(frame + 1, 4));
+
+    // An empty payload still has a type.
+    BOOST_TEST(frame_seal(frame, 0) == 4u);
+    BOOST_TEST(frame[1] == 0);
+    BOOST_TEST(frame[3] == reference_crc8(frame + 1, 2));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_parse_frame)
+{
+    uint8_t frame[8] = {0, 0, 0x02, 0x03, 0x00, 0x07};
+    size_type frame_size = frame_seal(frame, 3);
+
+    size_type size = 0;
+    BOOST_CHECK(frame_parse(frame, frame_size, FRAME_MAX_PAYLOAD, size) == FrameStatus::Complete);
+    BOOST_TEST(size == frame_size);
+
+    // Until the length byte arrives, one more byte is needed. After, the rest of the frame is.
+    BOOST_CHECK(frame_parse(frame, 0, FRAME_MAX_PAYLOAD, size) == FrameStatus::Incomplete);
+    BOOST_TEST(size == 1u);
+    BOOST_CHECK(frame_parse(frame, 1, FRAME_MAX_PAYLOAD, size) == FrameStatus::Incomplete);
+    BOOST_TEST(size == 1u);
+    BOOST_CHECK(frame_parse(frame, 2, FRAME_MAX_PAYLOAD, size) == FrameStatus::Incomplete);
+    BOOST_TEST(size == frame_size - 2);
+    BOOST_CHECK(frame_parse(frame, frame_size - 1, FRAME_MAX_PAYLOAD, size) == FrameStatus::Incomplete);
+    BOOST_TEST(size == 1u);
+
+    // The payload limit is the caller's.
+    BOOST_CHECK(frame_parse(frame, frame_size, 2, size) == FrameStatus::BadLength);
+
+    BOOST_CHECK(frame_parse(frame + 1, frame_size - 1, FRAME_MAX_PAYLOAD, size) == FrameStatus::BadStart);
+
+    frame[4] ^= 0x01;
+    BOOST_CHECK(frame_parse(frame, frame_size, FRAME_MAX_PAYLOAD, size) == FrameStatus::BadCrc);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_detect_errors_xor_misses)
+{
+    // Every error of two flipped bits in the type, payload and CRC of a temperature sized frame. XOR misses every pair
+    // in the same bit position of different bytes, and CRC-8 misses none.
+    std::vector<uint8_t> frame(17);
+    for (size_t i = 0; i < frame.size(); ++i)
+    {
+        frame[i] = static_cast<uint8_t>(i * 37);
+    }
+
+    frame[FRAME_TYPE_INDEX] = 0x01;
+    frame_seal(frame.data(), static_cast<size_type>(frame.size() - FRAME_OVERHEAD));
+
+    const size_t bits = 8 * frame.size();
+    unsigned missed = 0;
+    for (size_t a = 8 * FRAME_TYPE_INDEX; a < bits; ++a)
+    {
+        for (size_t b = a + 1; b < bits; ++b)
+        {
+            std::vector<uint8_t> corrupt = frame;
+            corrupt[a / 8] ^= static_cast<uint8_t>(1 << (a % 8));
+            corrupt[b / 8] ^= static_cast<uint8_t>(1 << (b % 8));
+
+            size_type size;
+            if (frame_parse(corrupt.data(), static_cast<size_type>(corrupt.size()), FRAME_MAX_PAYLOAD, size) ==
+                FrameStatus::Complete)
+            {
+                ++missed;
+            }
+        }
+    }
+
+    BOOST_TEST(missed == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,7 +1,9 @@
 #include "mocks/Arduino.h"
+#include "mocks/virtual_serial.h"
 #include "test_utils.h"
 #include <boost/test/unit_test.hpp>
 #include <limits>
+#include <vector>
 
 // File being tested:
 #include "message_reader.h"
@@ -19,6 +21,51 @@ public:
     unsigned long next_millis = 0;
 };
 
+/// @brief Frame a request message.
+/// @param payload Request type, then the request ID and argument if any.
+static std::vector<uint8_t> make_request(std::initializer_list<uint8_t> payload)
+{
+    std::vector<uint8_t> frame(FRAME_PAYLOAD_INDEX);
+    frame.insert(frame.end(), payload);
+    frame.push_back(0);
+
+    frame[FRAME_TYPE_INDEX] = 0x04;
+    frame_seal(frame.data(), static_cast<size_type>(payload.size()));
+    return frame;
+}
+
+/// @brief Give the reader what has arrived on the serial port once per loop pass, like the firmware loop, until a time.
+static void run_reader(VirtualClock &clock, VirtualSerial &serial, MessageReader &reader, uint64_t until)
+{
+    while (clock.now() < until)
+    {
+        uint8_t batch[MessageReader::buffer_size * MessageReader::queue_size];
+        int available = serial.available();
+        size_type n = reader.batch_capacity() < static_cast<size_type>(available) ? reader.batch_capacity()
+                                                                                   : static_cast<size_type>(available);
+        for (size_type i = 0; i < n; ++i)
+        {
+            batch[i] = static_cast<uint8_t>(serial.read());
+        }
+
+        reader.process(batch, n);
+        clock.end_loop();
+    }
+}
+
+/// @brief Send all bytes of a frame.
+/// @return Result of processing the last byte.
+static bool send_frame(MessageReader &reader, const std::vector<uint8_t> &frame)
+{
+    bool rc = false;
+    for (uint8_t c : frame)
+    {
+        rc = reader.process(c);
+    }
+
+    return rc;
+}
+
 /// @brief Sends a good request to a MessageReader object.
 /// @param reader MessageReader object to send messages to.
 /// @return True if every part of request reading was successful.
@@ -26,22 +73,19 @@ bool try_send_good_request(MessageReader &reader)
 {
     bool rc;
 
-    // Send message ID byte.
-    rc = reader.process(0x04);
-    if (rc)
+    // Send every byte before the CRC of a Temperature request.
+    auto request = make_request({0x00});
+    for (size_t i = 0; i + 1 < request.size(); ++i)
     {
-        return false;
-    }
-
-    // Send request type of Temperature.
-    rc = reader.process(0x00);
-    if (rc)
-    {
-        return false;
+        rc = reader.process(request[i]);
+        if (rc)
+        {
+            return false;
+        }
     }
 
-    // Send checksum of 0x04 ^ 0x00 = 0x04
-    rc = reader.process(0x04);
+    // Send the CRC.
+    rc = reader.process(request.back());
     if (!rc)
     {
         return false;
@@ -75,19 +119,28 @@ BOOST_AUTO_TEST_CASE(it_should_process_good_request)
     MessageReader reader(10);
     bool rc = false;
 
-    // Send message ID byte.
+    // Temperature request: start, length, type, request type, CRC.
+    auto request = make_request({0x00});
+    BOOST_TEST(request.size() == 5u);
+
     mock.next_millis = 10;
-    rc = reader.process(0x04);
+    rc = reader.process(request[0]);
+    BOOST_TEST(!rc);
+
+    mock.next_millis = 11;
+    rc = reader.process(request[1]);
     BOOST_TEST(!rc);
 
-    // Send request type of Temperature.
     mock.next_millis = 11;
-    rc = reader.process(0x00);
+    rc = reader.process(request[2]);
+    BOOST_TEST(!rc);
+
+    mock.next_millis = 12;
+    rc = reader.process(request[3]);
     BOOST_TEST(!rc);
 
-    // Send checksum of 0x04 ^ 0x00 = 0x04
     mock.next_millis = 13;
-    rc = reader.process(0x04);
+    rc = reader.process(request[4]);
     BOOST_TEST(rc);
 
     RequestType actual = RequestType::_Unknown;
@@ -107,9 +160,11 @@ BOOST_AUTO_TEST_CASE(it_should_manually_rest)
     MessageReader reader(10);
     bool rc = false;
 
-    // Send message ID byte.
+    // Send the start of a request.
     mock.next_millis = 10;
-    rc = reader.process(0x04);
+    rc = reader.process(FRAME_START);
+    BOOST_TEST(!rc);
+    rc = reader.process(1);
     BOOST_TEST(!rc);
 
     // Rest state.
@@ -131,21 +186,21 @@ BOOST_AUTO_TEST_CASE(it_should_reset_timeout)
     MessageReader reader(25);
     bool rc = false;
 
-    // Send message ID byte.
+    auto request = make_request({0x00});
+
+    // Send the start byte.
     mock.next_millis = 10;
-    rc = reader.process(0x04);
+    rc = reader.process(request[0]);
     BOOST_TEST(!rc);
 
-    // Send request type of Temperature.
+    // Send the rest. This would end a valid message, but should return false because of the timeout between byte 0
+    // and byte 1.
     mock.next_millis = 500;
-    rc = reader.process(0x00);
-    BOOST_TEST(!rc);
-
-    // Send checksum of 0x04 ^ 0x00 = 0x04. This would end a valid message, but should return false because of
-    // the timeout between byte 0 and byte 1.
-    mock.next_millis = 501;
-    rc = reader.process(0x04);
-    BOOST_TEST(!rc);
+    for (size_t i = 1; i < request.size(); ++i)
+    {
+        rc = reader.process(request[i]);
+        BOOST_TEST(!rc);
+    }
 
     // Send another message to make sure collection state is good after a timeout reset with various bytes.
     // Mimic a normal situation where some time would pass between the prior message and the next.
@@ -154,7 +209,7 @@ BOOST_AUTO_TEST_CASE(it_should_reset_timeout)
     BOOST_TEST(sent_good_msg);
 }
 
-BOOST_AUTO_TEST_CASE(it_should_return_false_get_data_invalid_checksum)
+BOOST_AUTO_TEST_CASE(it_should_return_false_get_data_invalid_crc)
 {
     auto _always = make_always([&]() { arduino_impl = nullptr; });
 
@@ -165,25 +220,26 @@ BOOST_AUTO_TEST_CASE(it_should_return_false_get_data_invalid_checksum)
     MessageReader reader(10);
     bool rc = false;
 
-    // Send message ID byte.
-    mock.next_millis = 10;
-    rc = reader.process(0x04);
-    BOOST_TEST(!rc);
-
-    // Send request type of Temperature.
-    mock.next_millis = 11;
-    rc = reader.process(0x00);
-    BOOST_TEST(!rc);
+    // Bad CRC byte.
+    auto request = make_request({0x00});
+    request.back() ^= 0x55;
 
-    // Bad checksum byte.
-    mock.next_millis = 12;
-    rc = reader.process(0x55);
+    mock.next_millis = 10;
+    rc = send_frame(reader, request);
     BOOST_TEST(rc);
 
     RequestType actual = RequestType::Temperature;
     rc = reader.get_data(actual);
     BOOST_TEST(!rc);
     BOOST_CHECK(actual == RequestType::_Unknown);
+
+    // A burst that an XOR checksum would miss: the same bit flipped in two bytes.
+    request = make_request({0x00});
+    request[2] ^= 0x10;
+    request[3] ^= 0x10;
+
+    BOOST_TEST(send_frame(reader, request));
+    BOOST_TEST(!reader.get_data(actual));
 }
 
 BOOST_AUTO_TEST_CASE(it_should_return_false_get_data_bad_request_value)
@@ -197,25 +253,26 @@ BOOST_AUTO_TEST_CASE(it_should_return_false_get_data_bad_request_value)
     MessageReader reader(10);
     bool rc = false;
 
-    // Send message ID byte.
+    // Send invalid request type with a good CRC.
     mock.next_millis = 10;
-    rc = reader.process(0x04);
-    BOOST_TEST(!rc);
-
-    // Send invalid request type.
-    mock.next_millis = 11;
-    rc = reader.process(0x7A);
-    BOOST_TEST(!rc);
-
-    // Good Checksum
-    mock.next_millis = 12;
-    rc = reader.process((0x04 ^ 0x7A));
+    rc = send_frame(reader, make_request({0x7A}));
     BOOST_TEST(rc);
 
     RequestType actual = RequestType::Temperature;
     rc = reader.get_data(actual);
     BOOST_TEST(!rc);
     BOOST_CHECK(actual == RequestType::_Unknown);
+
+    // A frame that is not a request.
+    auto frame = make_request({0x00});
+    frame[FRAME_TYPE_INDEX] = 0x01;
+    frame_seal(frame.data(), 1);
+    BOOST_TEST(send_frame(reader, frame));
+    BOOST_TEST(!reader.get_data(actual));
+
+    // A payload that does not match the request type.
+    BOOST_TEST(send_frame(reader, make_request({0x00, 0x00})));
+    BOOST_TEST(!reader.get_data(actual));
 }
 
 BOOST_AUTO_TEST_CASE(it_should_process_millis_roll)
@@ -229,19 +286,22 @@ BOOST_AUTO_TEST_CASE(it_should_process_millis_roll)
     MessageReader reader(10);
     bool rc = false;
 
-    // Send message ID byte. Timer is about to rollover.
-    mock.next_millis = std::numeric_limits<unsigned long>::max() - 2;
-    rc = reader.process(0x04);
-    BOOST_TEST(!rc);
+    auto request = make_request({0x00});
 
-    // Send request type of Temperature. This is after millis rolls over.
-    mock.next_millis = 1;
-    rc = reader.process(0x00);
+    // Send start byte. Timer is about to rollover.
+    mock.next_millis = std::numeric_limits<unsigned long>::max() - 2;
+    rc = reader.process(request[0]);
     BOOST_TEST(!rc);
 
-    // Send checksum of 0x04 ^ 0x00 = 0x04
+    // Send the rest of the request. This is after millis rolls over.
     mock.next_millis = 2;
-    rc = reader.process(0x04);
+    for (size_t i = 1; i + 1 < request.size(); ++i)
+    {
+        rc = reader.process(request[i]);
+        BOOST_TEST(!rc);
+    }
+
+    rc = reader.process(request.back());
     BOOST_TEST(rc);
 
     // Should get valid message even with rollover.
@@ -250,4 +310,482 @@ BOOST_AUTO_TEST_CASE(it_should_process_millis_roll)
     BOOST_CHECK(actual == RequestType::Temperature);
 }
 
+BOOST_AUTO_TEST_CASE(it_should_skip_bytes_outside_of_frames)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    RequestType actual = RequestType::_Unknown;
+
+    // Noise before a request is skipped.
+    for (uint8_t c : {0x00, 0x04, 0x13, 0xFF})
+    {
+        BOOST_TEST(!reader.process(c));
+    }
+
+    BOOST_TEST(send_frame(reader, make_request({0x01})));
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual == RequestType::SystemStatus);
+
+    // A length too long for a request drops the frame without a reply, and the next request is read.
+    BOOST_TEST(!reader.process(FRAME_START));
+    BOOST_TEST(!reader.process(0x40));
+    BOOST_TEST(reader.pending() == 0u);
+
+    BOOST_TEST(send_frame(reader, make_request({0x00})));
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual == RequestType::Temperature);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_process_stream_requests)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    RequestType actual = RequestType::_Unknown;
+
+    // Stream start.
+    BOOST_TEST(send_frame(reader, make_request({0x02})));
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual == RequestType::StreamStart);
+
+    // Stream stop.
+    BOOST_TEST(send_frame(reader, make_request({0x03})));
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual == RequestType::StreamStop);
+
+    // Subscribe.
+    BOOST_TEST(send_frame(reader, make_request({0x04})));
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual == RequestType::Subscribe);
+
+    // First value past the known request types.
+    BOOST_TEST(send_frame(reader, make_request({0x06})));
+    BOOST_TEST(!reader.get_data(actual));
+    BOOST_CHECK(actual == RequestType::_Unknown);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_process_history_download_with_offset)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    RequestMessage actual;
+
+    // History download carries a two byte offset, which the length byte accounts for.
+    auto request = make_request({0x05, 0x34, 0x12});
+    BOOST_TEST(request.size() == 7u);
+    for (size_t i = 0; i + 1 < request.size(); ++i)
+    {
+        BOOST_TEST(!reader.process(request[i]));
+    }
+
+    BOOST_TEST(reader.process(request.back()));
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::HistoryDownload);
+    BOOST_TEST(actual.argument == 0x1234);
+
+    // Bad CRC.
+    request.back() ^= 0x01;
+    BOOST_TEST(send_frame(reader, request));
+    BOOST_TEST(!reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::_Unknown);
+
+    // Set baud rate carries the rate in hundreds of baud.
+    BOOST_TEST(send_frame(reader, make_request({0x06, 0x10, 0x27})));
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::SetBaudRate);
+    BOOST_TEST(actual.argument == 10000);
+
+    // Requests without an argument report zero.
+    BOOST_TEST(send_frame(reader, make_request({0x00})));
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::Temperature);
+    BOOST_TEST(actual.argument == 0);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_process_request_id)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    RequestMessage actual;
+
+    // The flag in the request type byte adds an ID byte after the request type.
+    BOOST_TEST(send_frame(reader, make_request({0x80, 0x2A})));
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::Temperature);
+    BOOST_TEST(actual.has_request_id);
+    BOOST_TEST(actual.request_id == 0x2A);
+
+    // The argument follows the ID.
+    BOOST_TEST(send_frame(reader, make_request({0x85, 0x07, 0x34, 0x12})));
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::HistoryDownload);
+    BOOST_TEST(actual.request_id == 0x07);
+    BOOST_TEST(actual.argument == 0x1234);
+
+    // An unknown request type with a good CRC keeps its ID so the error reply can echo it.
+    BOOST_TEST(send_frame(reader, make_request({0xFA, 0x09})));
+
+    BOOST_TEST(!reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::_Unknown);
+    BOOST_TEST(actual.has_request_id);
+    BOOST_TEST(actual.request_id == 0x09);
+
+    // Requests without the flag have no ID.
+    BOOST_TEST(send_frame(reader, make_request({0x01})));
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::SystemStatus);
+    BOOST_TEST(!actual.has_request_id);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_queue_back_to_back_requests)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    RequestMessage actual;
+
+    auto bad_crc = make_request({0x80, 0x03});
+    bad_crc.back() ^= 0xFF;
+
+    const std::vector<uint8_t> requests[] = {
+        make_request({0x80, 0x01}), // Temperature, ID 1
+        make_request({0x81, 0x02}), // System status, ID 2
+        bad_crc,                    // Temperature, ID 3, bad CRC
+        make_request({0x80, 0x04}), // Temperature, ID 4
+    };
+
+    for (const auto &request : requests)
+    {
+        send_frame(reader, request);
+    }
+
+    BOOST_TEST(reader.pending() == 4u);
+    BOOST_TEST(reader.is_full());
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::Temperature);
+    BOOST_TEST(actual.request_id == 1);
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::SystemStatus);
+    BOOST_TEST(actual.request_id == 2);
+
+    BOOST_TEST(!reader.get_data(actual));
+    BOOST_TEST(!actual.has_request_id);
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_TEST(actual.request_id == 4);
+
+    BOOST_TEST(reader.pending() == 0u);
+    BOOST_TEST(!reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::_Unknown);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_drop_requests_when_queue_is_full)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    RequestMessage actual;
+
+    for (size_type i = 0; i < MessageReader::queue_size; ++i)
+    {
+        BOOST_TEST(send_frame(reader, make_request({0x01})));
+    }
+
+    BOOST_TEST(reader.is_full());
+
+    // One more request does not fit.
+    BOOST_TEST(!send_frame(reader, make_request({0x00})));
+    BOOST_TEST(reader.pending() == MessageReader::queue_size);
+
+    // Queued requests are kept, and a request fits again once one is read.
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::SystemStatus);
+
+    BOOST_TEST(send_frame(reader, make_request({0x00})));
+
+    // Reset clears the queue.
+    reader.reset();
+    BOOST_TEST(reader.pending() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_process_batch)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    RequestMessage actual;
+
+    // Noise, two requests, and the start of a third.
+    std::vector<uint8_t> bytes = {0x00, 0x55};
+    for (const auto &request : {make_request({0x80, 0x01}), make_request({0x85, 0x02, 0x34, 0x12})})
+    {
+        bytes.insert(bytes.end(), request.begin(), request.end());
+    }
+
+    auto third = make_request({0x81, 0x03});
+    bytes.insert(bytes.end(), third.begin(), third.begin() + 2);
+
+    BOOST_TEST(reader.process(bytes.data(), static_cast<size_type>(bytes.size())) == bytes.size());
+    BOOST_TEST(reader.pending() == 2u);
+
+    // The third request completes in the next block.
+    BOOST_TEST(reader.process(third.data() + 2, static_cast<size_type>(third.size() - 2)) == third.size() - 2);
+    BOOST_TEST(reader.pending() == 3u);
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::Temperature);
+    BOOST_TEST(actual.request_id == 1);
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::HistoryDownload);
+    BOOST_TEST(actual.request_id == 2);
+    BOOST_TEST(actual.argument == 0x1234);
+
+    BOOST_TEST(reader.get_data(actual));
+    BOOST_CHECK(actual.type == RequestType::SystemStatus);
+    BOOST_TEST(actual.request_id == 3);
+
+    BOOST_TEST(reader.process(bytes.data(), 0) == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_stop_batch_when_queue_is_full)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    RequestMessage actual;
+
+    const auto request = make_request({0x00});
+    std::vector<uint8_t> bytes;
+    for (size_type i = 0; i < MessageReader::queue_size + 2; ++i)
+    {
+        bytes.insert(bytes.end(), request.begin(), request.end());
+    }
+
+    // Processing stops at the last byte of the first request that does not fit.
+    size_type used = reader.process(bytes.data(), static_cast<size_type>(bytes.size()));
+    BOOST_TEST(used == (MessageReader::queue_size + 1) * request.size() - 1);
+    BOOST_TEST(reader.is_full());
+    BOOST_TEST(reader.batch_capacity() == 0u);
+
+    // It is not used until there is room.
+    BOOST_TEST(reader.process(bytes.data() + used, static_cast<size_type>(bytes.size() - used)) == 0u);
+
+    // The rest is taken once there is room.
+    while (reader.get_data(actual))
+    {
+    }
+
+    BOOST_TEST(reader.batch_capacity() == MessageReader::queue_size * FRAME_OVERHEAD);
+    BOOST_TEST(reader.process(bytes.data() + used, static_cast<size_type>(bytes.size() - used)) == bytes.size() - used);
+    BOOST_TEST(reader.pending() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_use_batch_capacity)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    RequestMessage actual;
+
+    // Blocks of batch_capacity() bytes are always used whole, whatever the split of the requests.
+    std::vector<uint8_t> bytes;
+    for (uint8_t i = 0; i < 12; ++i)
+    {
+        auto request = make_request({0x80, i});
+        bytes.insert(bytes.end(), request.begin(), request.end());
+    }
+
+    size_t position = 0;
+    uint8_t expected_id = 0;
+    while (position < bytes.size())
+    {
+        size_type n = reader.batch_capacity();
+        n = bytes.size() - position < n ? static_cast<size_type>(bytes.size() - position) : n;
+        BOOST_REQUIRE(reader.process(bytes.data() + position, n) == n);
+        position += n;
+
+        // Like loop(), answer one request per pass.
+        if (reader.get_data(actual))
+        {
+            BOOST_TEST(actual.request_id == expected_id);
+            ++expected_id;
+        }
+    }
+
+    while (reader.get_data(actual))
+    {
+        BOOST_TEST(actual.request_id == expected_id);
+        ++expected_id;
+    }
+
+    BOOST_TEST(expected_id == 12);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_check_timeout_per_batch)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(25);
+    const auto request = make_request({0x00});
+    const auto size = static_cast<size_type>(request.size());
+
+    // A request split across blocks within the timeout is kept.
+    mock.next_millis = 10;
+    reader.process(request.data(), 2);
+    mock.next_millis = 30;
+    reader.process(request.data() + 2, size - 2);
+    BOOST_TEST(reader.pending() == 1u);
+
+    // One that is not is dropped, and its end is skipped as noise.
+    mock.next_millis = 100;
+    reader.process(request.data(), 2);
+    mock.next_millis = 200;
+    reader.process(request.data() + 2, size - 2);
+    BOOST_TEST(reader.pending() == 1u);
+
+    // Bytes of one block are never timed out against each other.
+    reader.process(request.data(), size);
+    BOOST_TEST(reader.pending() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_count_received_and_discarded_bytes)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    MockArduino mock;
+    arduino_impl = &mock;
+
+    MessageReader reader(10);
+    const auto request = make_request({0x00});
+    const auto size = static_cast<size_type>(request.size());
+
+    // Noise, then a good request.
+    const uint8_t noise[] = {0x00, 0x13, 0xFF};
+    reader.process(noise, sizeof(noise));
+    reader.process(request.data(), size);
+    BOOST_TEST(reader.bytes_received() == 3u + size);
+    BOOST_TEST(reader.bytes_discarded() == 3u);
+    BOOST_TEST(reader.crc_failures() == 0u);
+
+    // A bad CRC is queued to be answered, but its bytes are discarded.
+    auto bad_crc = request;
+    bad_crc.back() ^= 0x01;
+    reader.process(bad_crc.data(), size);
+    BOOST_TEST(reader.bytes_discarded() == 3u + size);
+    BOOST_TEST(reader.crc_failures() == 1u);
+
+    // So are the bytes of a request that timed out.
+    reader.process(request.data(), 2);
+    mock.next_millis = 100;
+    reader.process(request.data() + 2, size - 2);
+    BOOST_TEST(reader.bytes_discarded() == 3u + size + size);
+
+    // Bytes left for the caller to give again are not counted until they are used.
+    while (!reader.is_full())
+    {
+        reader.process(request.data(), size);
+    }
+
+    uint32_t received = reader.bytes_received();
+    BOOST_TEST(reader.process(request.data(), size) == size - 1);
+    BOOST_TEST(reader.bytes_received() == received + size - 1);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_take_the_largest_request_within_the_timeout_at_9600_baud)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    clock.set_loop_cost(100);
+    arduino_impl = &clock;
+
+    VirtualSerial serial(clock);
+    serial.begin(9600);
+
+    // Request ID and a two byte argument: eight bytes, 8.3 milliseconds on the line.
+    MessageReader reader(CFG_SERIAL_MESSAGE_TIMEOUT);
+    const auto request = make_request({0x86, 0x01, 0x10, 0x27});
+    BOOST_TEST(request.size() == MessageReader::buffer_size);
+
+    serial.send(request);
+    uint64_t done = serial.send_done();
+    BOOST_TEST(done - clock.now() < CFG_SERIAL_MESSAGE_TIMEOUT * 1000u);
+
+    run_reader(clock, serial, reader, done);
+    BOOST_TEST(reader.pending() == 0u);
+
+    // Queued on the first loop pass after the last byte arrives.
+    run_reader(clock, serial, reader, done + 100);
+    BOOST_TEST(reader.pending() == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_time_out_requests_slower_than_the_timeout)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    clock.set_loop_cost(100);
+    arduino_impl = &clock;
+
+    VirtualSerial serial(clock);
+    MessageReader reader(CFG_SERIAL_MESSAGE_TIMEOUT);
+    const auto request = make_request({0x86, 0x01, 0x10, 0x27});
+
+    // At 4800 baud the same request takes 16.7 milliseconds, so its start is dropped and the rest is noise.
+    serial.begin(4800);
+    serial.send(request);
+    run_reader(clock, serial, reader, serial.send_done() + 1000);
+    BOOST_TEST(reader.pending() == 0u);
+    BOOST_TEST(reader.bytes_discarded() == request.size());
+
+    // A host that stalls part way through a request at 115200 baud loses it too.
+    serial.begin(115200);
+    serial.send(request.data(), 3);
+    run_reader(clock, serial, reader, clock.now() + CFG_SERIAL_MESSAGE_TIMEOUT * 1000u);
+    serial.send(request.data() + 3, request.size() - 3);
+    serial.send(request);
+    run_reader(clock, serial, reader, serial.send_done() + 1000);
+    BOOST_TEST(reader.pending() == 1u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
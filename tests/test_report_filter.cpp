@@ -0,0 +1,111 @@
+#include "test_utils.h"
+#include <boost/test/unit_test.hpp>
+#include <limits>
+
+// File being tested:
+#include "report_filter.h"
+
+using namespace scottz0r::temperature;
+
+BOOST_AUTO_TEST_SUITE(report_filter)
+
+BOOST_AUTO_TEST_CASE(it_should_report_first_sample)
+{
+    ReportFilter filter(10, 60000);
+
+    BOOST_TEST(filter.is_due(make_sample(2000), 0));
+    filter.mark_reported(make_sample(2000), 0);
+    BOOST_TEST(!filter.is_due(make_sample(2000), 1));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_check_without_recording)
+{
+    ReportFilter filter(10, 60000);
+    filter.mark_reported(make_sample(2000), 0);
+
+    BOOST_TEST(filter.is_due(make_sample(2011), 1));
+    BOOST_TEST(filter.is_due(make_sample(2011), 2));
+    BOOST_TEST(!filter.is_due(make_sample(2010), 3));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_report_outside_deadband)
+{
+    ReportFilter filter(10, 60000);
+    filter.mark_reported(make_sample(2000), 0);
+
+    // Within the deadband, in both directions.
+    BOOST_TEST(!filter.is_due(make_sample(2010), 1));
+    BOOST_TEST(!filter.is_due(make_sample(1990), 2));
+
+    // Outside. The reported sample becomes the reference.
+    BOOST_TEST(filter.is_due(make_sample(1989), 3));
+    filter.mark_reported(make_sample(1989), 3);
+    BOOST_TEST(!filter.is_due(make_sample(1995), 4));
+    BOOST_TEST(filter.is_due(make_sample(2000), 5));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_report_slow_drift)
+{
+    ReportFilter filter(10, 60000);
+    filter.mark_reported(make_sample(2000), 0);
+
+    // Each step is inside the deadband, but the total change is measured from the last report.
+    int reports = 0;
+    for (temperature_type t = 2001; t <= 2030; ++t)
+    {
+        if (filter.is_due(make_sample(t), t))
+        {
+            filter.mark_reported(make_sample(t), t);
+            ++reports;
+        }
+    }
+
+    BOOST_TEST(reports == 2);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_report_status_and_agreement_changes)
+{
+    ReportFilter filter(10, 60000);
+    filter.mark_reported(make_sample(2000), 0);
+
+    TemperatureVoteResult sample = make_sample(2000);
+    sample.agreement_bits = 0x05;
+    BOOST_TEST(filter.is_due(sample, 1));
+    filter.mark_reported(sample, 1);
+    BOOST_TEST(!filter.is_due(sample, 2));
+
+    sample.status = TemperatureVoteStatus::Disagree;
+    BOOST_TEST(filter.is_due(sample, 3));
+    filter.mark_reported(sample, 3);
+    BOOST_TEST(!filter.is_due(sample, 4));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_report_heartbeat)
+{
+    ReportFilter filter(10, 1000);
+    filter.mark_reported(make_sample(2000), 500);
+
+    BOOST_TEST(!filter.is_due(make_sample(2000), 1499));
+    BOOST_TEST(filter.is_due(make_sample(2000), 1500));
+    filter.mark_reported(make_sample(2000), 1500);
+    BOOST_TEST(!filter.is_due(make_sample(2000), 2000));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_report_heartbeat_millis_roll)
+{
+    ReportFilter filter(10, 1000);
+    filter.mark_reported(make_sample(2000), std::numeric_limits<unsigned long>::max() - 499);
+
+    BOOST_TEST(!filter.is_due(make_sample(2000), 499));
+    BOOST_TEST(filter.is_due(make_sample(2000), 500));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_not_overflow_extreme_change)
+{
+    ReportFilter filter(10, 60000);
+    filter.mark_reported(make_sample(-32000), 0);
+
+    BOOST_TEST(filter.is_due(make_sample(32000), 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+
+// File being tested:
+#include "sample_cache.h"
+
+using namespace scottz0r::temperature;
+
+BOOST_AUTO_TEST_SUITE(sample_cache)
+
+BOOST_AUTO_TEST_CASE(it_should_construct_without_sample)
+{
+    SampleCache cache;
+
+    BOOST_TEST(!cache.has_sample());
+    BOOST_CHECK(cache.front().status == TemperatureVoteStatus::SensorError);
+    BOOST_TEST(cache.age(1234) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_not_show_back_buffer_until_published)
+{
+    SampleCache cache;
+
+    TemperatureVoteResult &back = cache.back();
+    back.status = TemperatureVoteStatus::OK;
+    back.average = 2415;
+
+    // Written, but not published.
+    BOOST_CHECK(cache.front().status == TemperatureVoteStatus::SensorError);
+
+    cache.publish(100);
+
+    BOOST_TEST(cache.has_sample());
+    BOOST_CHECK(cache.front().status == TemperatureVoteStatus::OK);
+    BOOST_TEST(cache.front().average == 2415);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_swap_buffers_on_publish)
+{
+    SampleCache cache;
+
+    cache.back().average = 1000;
+    cache.publish(100);
+
+    // Next sample goes into the other buffer, leaving the published one alone.
+    TemperatureVoteResult &back = cache.back();
+    BOOST_TEST(&back != &cache.front());
+    back.average = 2000;
+    BOOST_TEST(cache.front().average == 1000);
+
+    cache.publish(200);
+    BOOST_TEST(cache.front().average == 2000);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_report_sample_age)
+{
+    SampleCache cache;
+
+    cache.publish(1000);
+    BOOST_TEST(cache.age(1000) == 0);
+    BOOST_TEST(cache.age(1075) == 75);
+
+    cache.publish(1100);
+    BOOST_TEST(cache.age(1150) == 50);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,6 @@
 #include "fakeit.hpp"
 #include "mocks/Wire.h"
+#include "mocks/mcp9808_model.h"
 #include "test_utils.h"
 #include <boost/endian/conversion.hpp>
 #include <boost/test/unit_test.hpp>
@@ -20,8 +21,9 @@ void configure_mock_begin_happy(Mock<TwoWireImpl> &mock)
     Fake(Method(mock, begin));
     Fake(Method(mock, beginTransmission));
 
-    // Three "good" calls to endTransmission. Two for reading device info, one for writing config.
-    When(Method(mock, endTransmission)).Return(0, 0, 0);
+    // Four "good" calls to endTransmission. Two for reading device info, one for writing config, one for writing
+    // resolution.
+    When(Method(mock, endTransmission)).Return(0, 0, 0, 0);
 
     // Four bytes read for Manufacture id 84 and device id 1024 (big endian).
     When(Method(mock, read)).Return(0x00, 0x54, 0x04, 0x00);
@@ -160,7 +162,7 @@ BOOST_AUTO_TEST_CASE(it_should_not_begin_bad_manuf_id)
     When(Method(mock, available)).Return(2, 2);
     Fake(Method(mock, begin));
     Fake(Method(mock, beginTransmission));
-    When(Method(mock, endTransmission)).Return(0, 0, 0);
+    When(Method(mock, endTransmission)).Return(0, 0, 0, 0);
     Fake(Method(mock, requestFrom));
     When(Method(mock, write)).AlwaysReturn(1);
 
@@ -186,7 +188,7 @@ BOOST_AUTO_TEST_CASE(it_should_not_begin_bad_device_id)
     When(Method(mock, available)).Return(2, 2);
     Fake(Method(mock, begin));
     Fake(Method(mock, beginTransmission));
-    When(Method(mock, endTransmission)).Return(0, 0, 0);
+    When(Method(mock, endTransmission)).Return(0, 0, 0, 0);
     Fake(Method(mock, requestFrom));
     When(Method(mock, write)).AlwaysReturn(1);
 
@@ -331,4 +333,325 @@ BOOST_AUTO_TEST_CASE(it_should_return_false_read_bad_state)
     BOOST_TEST(sensor_reading == 0);
 }
 
+BOOST_AUTO_TEST_CASE(it_should_read_async_one_transaction_per_poll)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    // Setup mock to get setup information from I2C device successfully.
+    Mock<TwoWireImpl> mock;
+    configure_mock_begin_happy(mock);
+    wire_impl = &mock.get();
+
+    SensorMcp9808 sensor;
+    bool rc = sensor.begin(0x18);
+    BOOST_TEST(rc);
+
+    // Setup mock to return 13.37 degrees.
+    mock.Reset();
+    Fake(Method(mock, beginTransmission));
+    Fake(Method(mock, write));
+    When(Method(mock, endTransmission)).Return(0);
+    When(Method(mock, requestFrom)).Return(2);
+    When(Method(mock, available)).Return(2);
+    When(Method(mock, read)).Return(0x00, 0xD6);
+
+    rc = sensor.start_read_temp();
+    BOOST_TEST(rc);
+    BOOST_TEST(sensor.is_reading());
+
+    // Starting a second read while one is in progress is not allowed.
+    BOOST_TEST(!sensor.start_read_temp());
+
+    // First step only writes the register pointer.
+    int16_t temp = 123;
+    SensorReadStatus status = sensor.poll(temp);
+    BOOST_CHECK(status == SensorReadStatus::Busy);
+    Verify(Method(mock, endTransmission)).Once();
+    VerifyNoOtherInvocations(Method(mock, requestFrom));
+
+    // Second step reads the data.
+    status = sensor.poll(temp);
+    BOOST_CHECK(status == SensorReadStatus::Done);
+    BOOST_TEST(temp == 1337);
+    BOOST_TEST(!sensor.is_reading());
+    Verify(Method(mock, requestFrom)).Once();
+}
+
+BOOST_AUTO_TEST_CASE(it_should_read_async_failure)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    // Setup mock to get setup information from I2C device successfully.
+    Mock<TwoWireImpl> mock;
+    configure_mock_begin_happy(mock);
+    wire_impl = &mock.get();
+
+    SensorMcp9808 sensor;
+    bool rc = sensor.begin(0x18);
+    BOOST_TEST(rc);
+
+    // Pointer write fails.
+    mock.Reset();
+    Fake(Method(mock, beginTransmission));
+    Fake(Method(mock, write));
+    When(Method(mock, endTransmission)).Return(1);
+
+    rc = sensor.start_read_temp();
+    BOOST_TEST(rc);
+
+    int16_t temp = 123;
+    SensorReadStatus status = sensor.poll(temp);
+    BOOST_CHECK(status == SensorReadStatus::Error);
+    BOOST_TEST(temp == 0);
+    BOOST_TEST(!sensor.is_reading());
+
+    // Data read comes back short.
+    mock.Reset();
+    Fake(Method(mock, beginTransmission));
+    Fake(Method(mock, write));
+    When(Method(mock, endTransmission)).Return(0);
+    When(Method(mock, requestFrom)).Return(1);
+    When(Method(mock, available)).Return(1);
+
+    rc = sensor.start_read_temp();
+    BOOST_TEST(rc);
+
+    status = sensor.poll(temp);
+    BOOST_CHECK(status == SensorReadStatus::Busy);
+
+    status = sensor.poll(temp);
+    BOOST_CHECK(status == SensorReadStatus::Error);
+    BOOST_TEST(!sensor.is_reading());
+}
+
+BOOST_AUTO_TEST_CASE(it_should_not_read_async_bad_state)
+{
+    SensorMcp9808 sensor;
+
+    // Don't call begin(), which means sensor is in a bad or not configured state.
+    BOOST_TEST(!sensor.start_read_temp());
+
+    // Polling without a started read is an error.
+    int16_t temp = 123;
+    SensorReadStatus status = sensor.poll(temp);
+    BOOST_CHECK(status == SensorReadStatus::Error);
+    BOOST_TEST(temp == 0);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_skip_pointer_write_when_cached)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    // Setup mock to get setup information from I2C device successfully.
+    Mock<TwoWireImpl> mock;
+    configure_mock_begin_happy(mock);
+    wire_impl = &mock.get();
+
+    SensorMcp9808 sensor;
+    bool rc = sensor.begin(0x18);
+    BOOST_TEST(rc);
+
+    mock.Reset();
+    Fake(Method(mock, beginTransmission));
+    Fake(Method(mock, write));
+    When(Method(mock, endTransmission)).AlwaysReturn(0);
+    When(Method(mock, requestFrom)).AlwaysReturn(2);
+    When(Method(mock, available)).AlwaysReturn(2);
+    When(Method(mock, read)).Return(0x00, 0xD6, 0x00, 0xD6, 0x00, 0xD6);
+
+    // Pointer is at the config register after begin(), so the first read must move it.
+    int16_t temp = 0;
+    rc = sensor.read_temp(temp);
+    BOOST_TEST(rc);
+    BOOST_TEST(temp == 1337);
+    Verify(Method(mock, endTransmission)).Once();
+
+    // Pointer is now at ambient temperature. Only the data read goes on the bus.
+    temp = 0;
+    rc = sensor.read_temp(temp);
+    BOOST_TEST(rc);
+    BOOST_TEST(temp == 1337);
+    Verify(Method(mock, endTransmission)).Once();
+    Verify(Method(mock, requestFrom)).Twice();
+
+    // Same for the non-blocking path: the read completes on the first poll.
+    rc = sensor.start_read_temp();
+    BOOST_TEST(rc);
+    SensorReadStatus status = sensor.poll(temp);
+    BOOST_CHECK(status == SensorReadStatus::Done);
+    BOOST_TEST(temp == 1337);
+    Verify(Method(mock, endTransmission)).Once();
+}
+
+BOOST_AUTO_TEST_CASE(it_should_invalidate_pointer_after_failure)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    // Setup mock to get setup information from I2C device successfully.
+    Mock<TwoWireImpl> mock;
+    configure_mock_begin_happy(mock);
+    wire_impl = &mock.get();
+
+    SensorMcp9808 sensor;
+    bool rc = sensor.begin(0x18);
+    BOOST_TEST(rc);
+
+    // Good read to cache the ambient temperature pointer, then a short read.
+    mock.Reset();
+    Fake(Method(mock, beginTransmission));
+    Fake(Method(mock, write));
+    When(Method(mock, endTransmission)).AlwaysReturn(0);
+    When(Method(mock, requestFrom)).AlwaysReturn(2);
+    When(Method(mock, available)).Return(2, 1, 2);
+    When(Method(mock, read)).Return(0x00, 0xD6, 0x00, 0xD6);
+
+    int16_t temp = 0;
+    rc = sensor.read_temp(temp);
+    BOOST_TEST(rc);
+
+    rc = sensor.read_temp(temp);
+    BOOST_TEST(!rc);
+    Verify(Method(mock, endTransmission)).Once();
+
+    // Pointer is written again after the failure.
+    rc = sensor.read_temp(temp);
+    BOOST_TEST(rc);
+    BOOST_TEST(temp == 1337);
+    Verify(Method(mock, endTransmission)).Twice();
+}
+
+BOOST_AUTO_TEST_CASE(it_should_begin_with_resolution)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    Mock<TwoWireImpl> mock;
+    configure_mock_begin_happy(mock);
+    wire_impl = &mock.get();
+
+    SensorMcp9808 sensor;
+
+    // Default resolution before begin.
+    BOOST_CHECK(sensor.resolution() == Mcp9808Resolution::Sixteenth);
+    BOOST_TEST(sensor.conversion_time() == 250);
+
+    bool rc = sensor.begin(0x18, Mcp9808Resolution::Half);
+    BOOST_TEST(rc);
+    BOOST_CHECK(sensor.resolution() == Mcp9808Resolution::Half);
+    BOOST_TEST(sensor.conversion_time() == 30);
+
+    // Resolution register 0x08 written with the resolution value.
+    Verify(Method(mock, write).Using(0x08), Method(mock, write).Using(0x00), Method(mock, endTransmission));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_not_begin_bad_resolution_write)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    SensorMcp9808 sensor;
+
+    Mock<TwoWireImpl> mock;
+    configure_mock_begin_happy(mock);
+
+    // Make 4th call to end transmission fail, which will fail the resolution step.
+    When(Method(mock, endTransmission)).Return(0, 0, 0, 2);
+    wire_impl = &mock.get();
+
+    bool rc = sensor.begin(0x18, Mcp9808Resolution::Quarter);
+    BOOST_TEST(!rc);
+    BOOST_TEST(sensor.bad());
+}
+
+BOOST_AUTO_TEST_CASE(it_should_report_conversion_time)
+{
+    BOOST_TEST(SensorMcp9808::conversion_time(Mcp9808Resolution::Half) == 30);
+    BOOST_TEST(SensorMcp9808::conversion_time(Mcp9808Resolution::Quarter) == 65);
+    BOOST_TEST(SensorMcp9808::conversion_time(Mcp9808Resolution::Eighth) == 130);
+    BOOST_TEST(SensorMcp9808::conversion_time(Mcp9808Resolution::Sixteenth) == 250);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_configure_model_sensor)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    I2cBusModel bus;
+    Mcp9808Model device(0x1A, 22.5);
+    bus.attach(device);
+    wire_impl = &bus;
+
+    // Leave settings behind that begin has to clear.
+    const uint8_t shutdown[] = {Mcp9808Model::REG_CONFIG, 0x01, 0x00};
+    device.write(shutdown, sizeof(shutdown));
+
+    SensorMcp9808 sensor;
+    BOOST_TEST(sensor.begin(0x1A, Mcp9808Resolution::Quarter));
+    BOOST_TEST(device.register_value(Mcp9808Model::REG_CONFIG) == 0x0000);
+    BOOST_TEST(device.register_value(Mcp9808Model::REG_RESOLUTION) == 0x01);
+
+    // No device at the address.
+    SensorMcp9808 missing;
+    BOOST_TEST(!missing.begin(0x18));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_read_model_temperatures)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    I2cBusModel bus;
+    Mcp9808Model device(0x18);
+    bus.attach(device);
+    wire_impl = &bus;
+
+    SensorMcp9808 sensor;
+    BOOST_TEST(sensor.begin(0x18));
+
+    // Alert flags set by the power-up limits of zero are ignored.
+    const double temperatures[] = {22.5, 0.0, -0.0625, -10.25, 100.125};
+    const int16_t expected[] = {2250, 0, -7, -1025, 10012};
+
+    int16_t result;
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i)
+    {
+        device.set_temperature(temperatures[i]);
+        device.reset();
+
+        BOOST_TEST(sensor.read_temp(result));
+        BOOST_TEST(result == expected[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(it_should_keep_model_pointer_between_reads)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    I2cBusModel bus;
+    Mcp9808Model device(0x18, 21.0);
+    bus.attach(device);
+    wire_impl = &bus;
+
+    SensorMcp9808 sensor;
+    BOOST_TEST(sensor.begin(0x18));
+
+    int16_t result;
+    uint64_t transactions = bus.transactions();
+
+    // A pointer write and a read, then reads only.
+    BOOST_TEST(sensor.read_temp(result));
+    BOOST_TEST(bus.transactions() == transactions + 2);
+    BOOST_TEST(device.pointer() == 0x05);
+
+    BOOST_TEST(sensor.start_read_temp());
+    BOOST_CHECK(sensor.poll(result) == SensorReadStatus::Done);
+    BOOST_TEST(bus.transactions() == transactions + 3);
+    BOOST_TEST(result == 2100);
+
+    // A failed read makes the next read write the pointer again.
+    bus.detach(0x18);
+    BOOST_TEST(!sensor.read_temp(result));
+    bus.attach(device);
+
+    transactions = bus.transactions();
+    BOOST_TEST(sensor.read_temp(result));
+    BOOST_TEST(bus.transactions() == transactions + 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
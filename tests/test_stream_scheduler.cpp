@@ -0,0 +1,111 @@
+#include "test_utils.h"
+#include <boost/test/unit_test.hpp>
+
+// File being tested:
+#include "stream_scheduler.h"
+
+using namespace scottz0r::temperature;
+
+BOOST_AUTO_TEST_SUITE(stream_scheduler)
+
+BOOST_AUTO_TEST_CASE(it_should_not_send_when_stopped)
+{
+    StreamScheduler scheduler(1, 10, 1000);
+    TemperatureVoteResult sample = make_sample(2000);
+
+    BOOST_TEST(!scheduler.is_active());
+    BOOST_TEST(!scheduler.on_sample(sample, 0));
+    BOOST_TEST(!scheduler.on_sample(sample, 100));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_send_every_sample)
+{
+    StreamScheduler scheduler(1, 10, 1000);
+    TemperatureVoteResult sample = make_sample(2000);
+    scheduler.start(StreamMode::Periodic, sample, 0);
+
+    BOOST_TEST(scheduler.is_active());
+    BOOST_CHECK(scheduler.mode() == StreamMode::Periodic);
+    BOOST_TEST(scheduler.on_sample(sample, 1));
+    BOOST_TEST(scheduler.on_sample(sample, 2));
+
+    scheduler.stop();
+    BOOST_TEST(!scheduler.is_active());
+    BOOST_TEST(!scheduler.on_sample(sample, 3));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_send_every_nth_sample)
+{
+    StreamScheduler scheduler(3, 10, 1000);
+    TemperatureVoteResult sample = make_sample(2000);
+    scheduler.start(StreamMode::Periodic, sample, 0);
+
+    BOOST_TEST(!scheduler.on_sample(sample, 0));
+    BOOST_TEST(!scheduler.on_sample(sample, 0));
+    BOOST_TEST(scheduler.on_sample(sample, 0));
+    BOOST_TEST(!scheduler.on_sample(sample, 0));
+    BOOST_TEST(!scheduler.on_sample(sample, 0));
+    BOOST_TEST(scheduler.on_sample(sample, 0));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_treat_zero_divider_as_one)
+{
+    StreamScheduler scheduler(0, 10, 1000);
+    TemperatureVoteResult sample = make_sample(2000);
+    scheduler.start(StreamMode::Periodic, sample, 0);
+
+    BOOST_TEST(scheduler.on_sample(sample, 0));
+    BOOST_TEST(scheduler.on_sample(sample, 0));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_send_on_change)
+{
+    StreamScheduler scheduler(1, 10, 1000);
+    scheduler.start(StreamMode::OnChange, make_sample(2000), 0);
+
+    BOOST_CHECK(scheduler.mode() == StreamMode::OnChange);
+
+    // Start sample counts as sent, and small changes stay quiet.
+    BOOST_TEST(!scheduler.on_sample(make_sample(2000), 30));
+    BOOST_TEST(!scheduler.on_sample(make_sample(2010), 60));
+    BOOST_TEST(scheduler.on_sample(make_sample(2011), 90));
+    scheduler.on_sent(make_sample(2011), 90);
+
+    // Heartbeat.
+    BOOST_TEST(!scheduler.on_sample(make_sample(2011), 1089));
+    BOOST_TEST(scheduler.on_sample(make_sample(2011), 1090));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_keep_unsent_change_due)
+{
+    StreamScheduler scheduler(1, 10, 60000);
+    scheduler.start(StreamMode::OnChange, make_sample(2000), 0);
+
+    // The message for the change could not be queued, so the change is offered again with the next sample.
+    BOOST_TEST(scheduler.on_sample(make_sample(2050), 30));
+    BOOST_TEST(scheduler.on_sample(make_sample(2050), 60));
+
+    scheduler.on_sent(make_sample(2050), 60);
+    BOOST_TEST(!scheduler.on_sample(make_sample(2050), 90));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_increment_and_wrap_sequence)
+{
+    StreamScheduler scheduler(1, 10, 1000);
+    TemperatureVoteResult sample = make_sample(2000);
+    scheduler.start(StreamMode::Periodic, sample, 0);
+
+    for (int i = 0; i < 256; ++i)
+    {
+        BOOST_TEST(scheduler.next_sequence() == i);
+    }
+
+    BOOST_TEST(scheduler.next_sequence() == 0);
+    BOOST_TEST(scheduler.next_sequence() == 1);
+
+    // Restarting the stream restarts the sequence.
+    scheduler.start(StreamMode::OnChange, sample, 0);
+    BOOST_TEST(scheduler.next_sequence() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,4 +1,5 @@
 #include <boost/test/unit_test.hpp>
+#include <cstdlib>
 
 // File being tested:
 #include "temperature_engine.h"
@@ -16,15 +17,16 @@ BOOST_AUTO_TEST_CASE(it_should_vote_agreement)
     TemperatureVoteEngine engine(50);
     TemperatureVoteResult result;
 
-    engine.vote_temperature(temp0, temp1, temp2, result);
+    TemperatureReading readings[] = {temp0, temp1, temp2};
+    engine.vote_temperature(readings, result);
 
     BOOST_CHECK(result.status == TemperatureVoteStatus::OK);
-    BOOST_TEST(result.is_temp0_agree);
-    BOOST_TEST(result.is_temp1_agree);
-    BOOST_TEST(result.is_temp2_agree);
-    BOOST_TEST(result.temp0 == 2400);
-    BOOST_TEST(result.temp1 == 2425);
-    BOOST_TEST(result.temp2 == 2420);
+    BOOST_TEST(result.is_agree(0));
+    BOOST_TEST(result.is_agree(1));
+    BOOST_TEST(result.is_agree(2));
+    BOOST_TEST(result.temps[0] == 2400);
+    BOOST_TEST(result.temps[1] == 2425);
+    BOOST_TEST(result.temps[2] == 2420);
     BOOST_TEST(result.average == 2415);
 }
 
@@ -38,7 +40,8 @@ BOOST_AUTO_TEST_CASE(it_should_vote_agreement_round_truncate)
     TemperatureVoteEngine engine(50);
     TemperatureVoteResult result;
 
-    engine.vote_temperature(temp0, temp1, temp2, result);
+    TemperatureReading readings[] = {temp0, temp1, temp2};
+    engine.vote_temperature(readings, result);
 
     BOOST_CHECK(result.status == TemperatureVoteStatus::OK);
     BOOST_TEST(result.average == 2415);
@@ -53,15 +56,16 @@ BOOST_AUTO_TEST_CASE(it_should_vote_one_disagree)
     TemperatureVoteEngine engine(100);
     TemperatureVoteResult result;
 
-    engine.vote_temperature(temp0, temp1, temp2, result);
+    TemperatureReading readings[] = {temp0, temp1, temp2};
+    engine.vote_temperature(readings, result);
 
     BOOST_CHECK(result.status == TemperatureVoteStatus::OK);
-    BOOST_TEST(result.is_temp0_agree);
-    BOOST_TEST(!result.is_temp1_agree);
-    BOOST_TEST(result.is_temp2_agree);
-    BOOST_TEST(result.temp0 == 2400);
-    BOOST_TEST(result.temp1 == 5000);
-    BOOST_TEST(result.temp2 == 2420);
+    BOOST_TEST(result.is_agree(0));
+    BOOST_TEST(!result.is_agree(1));
+    BOOST_TEST(result.is_agree(2));
+    BOOST_TEST(result.temps[0] == 2400);
+    BOOST_TEST(result.temps[1] == 5000);
+    BOOST_TEST(result.temps[2] == 2420);
     BOOST_TEST(result.average == 2410);
 }
 
@@ -74,15 +78,16 @@ BOOST_AUTO_TEST_CASE(it_should_vote_all_disagree)
     TemperatureVoteEngine engine(20);
     TemperatureVoteResult result;
 
-    engine.vote_temperature(temp0, temp1, temp2, result);
+    TemperatureReading readings[] = {temp0, temp1, temp2};
+    engine.vote_temperature(readings, result);
 
     BOOST_CHECK(result.status == TemperatureVoteStatus::Disagree);
-    BOOST_TEST(!result.is_temp0_agree);
-    BOOST_TEST(!result.is_temp1_agree);
-    BOOST_TEST(!result.is_temp2_agree);
-    BOOST_TEST(result.temp0 == 2400);
-    BOOST_TEST(result.temp1 == 2425);
-    BOOST_TEST(result.temp2 == 2375);
+    BOOST_TEST(!result.is_agree(0));
+    BOOST_TEST(!result.is_agree(1));
+    BOOST_TEST(!result.is_agree(2));
+    BOOST_TEST(result.temps[0] == 2400);
+    BOOST_TEST(result.temps[1] == 2425);
+    BOOST_TEST(result.temps[2] == 2375);
     BOOST_TEST(result.average == 0);
 }
 
@@ -95,15 +100,16 @@ BOOST_AUTO_TEST_CASE(it_should_vote_one_invalid)
     TemperatureVoteEngine engine(100);
     TemperatureVoteResult result;
 
-    engine.vote_temperature(temp0, temp1, temp2, result);
+    TemperatureReading readings[] = {temp0, temp1, temp2};
+    engine.vote_temperature(readings, result);
 
     BOOST_CHECK(result.status == TemperatureVoteStatus::OK);
-    BOOST_TEST(result.is_temp0_agree);
-    BOOST_TEST(result.is_temp1_agree);
-    BOOST_TEST(!result.is_temp2_agree);
-    BOOST_TEST(result.temp0 == 2400);
-    BOOST_TEST(result.temp1 == 2424);
-    BOOST_TEST(result.temp2 == 0);
+    BOOST_TEST(result.is_agree(0));
+    BOOST_TEST(result.is_agree(1));
+    BOOST_TEST(!result.is_agree(2));
+    BOOST_TEST(result.temps[0] == 2400);
+    BOOST_TEST(result.temps[1] == 2424);
+    BOOST_TEST(result.temps[2] == 0);
     BOOST_TEST(result.average == 2412);
 }
 
@@ -116,15 +122,16 @@ BOOST_AUTO_TEST_CASE(it_should_vote_two_invalid)
     TemperatureVoteEngine engine(100);
     TemperatureVoteResult result;
 
-    engine.vote_temperature(temp0, temp1, temp2, result);
+    TemperatureReading readings[] = {temp0, temp1, temp2};
+    engine.vote_temperature(readings, result);
 
     BOOST_CHECK(result.status == TemperatureVoteStatus::SensorError);
-    BOOST_TEST(!result.is_temp0_agree);
-    BOOST_TEST(!result.is_temp1_agree);
-    BOOST_TEST(!result.is_temp2_agree);
-    BOOST_TEST(result.temp0 == 2400);
-    BOOST_TEST(result.temp1 == 0);
-    BOOST_TEST(result.temp2 == 0);
+    BOOST_TEST(!result.is_agree(0));
+    BOOST_TEST(!result.is_agree(1));
+    BOOST_TEST(!result.is_agree(2));
+    BOOST_TEST(result.temps[0] == 2400);
+    BOOST_TEST(result.temps[1] == 0);
+    BOOST_TEST(result.temps[2] == 0);
     BOOST_TEST(result.average == 0);
 }
 
@@ -137,15 +144,16 @@ BOOST_AUTO_TEST_CASE(it_should_vote_three_invalid)
     TemperatureVoteEngine engine(100);
     TemperatureVoteResult result;
 
-    engine.vote_temperature(temp0, temp1, temp2, result);
+    TemperatureReading readings[] = {temp0, temp1, temp2};
+    engine.vote_temperature(readings, result);
 
     BOOST_CHECK(result.status == TemperatureVoteStatus::SensorError);
-    BOOST_TEST(!result.is_temp0_agree);
-    BOOST_TEST(!result.is_temp1_agree);
-    BOOST_TEST(!result.is_temp2_agree);
-    BOOST_TEST(result.temp0 == 0);
-    BOOST_TEST(result.temp1 == 0);
-    BOOST_TEST(result.temp2 == 0);
+    BOOST_TEST(!result.is_agree(0));
+    BOOST_TEST(!result.is_agree(1));
+    BOOST_TEST(!result.is_agree(2));
+    BOOST_TEST(result.temps[0] == 0);
+    BOOST_TEST(result.temps[1] == 0);
+    BOOST_TEST(result.temps[2] == 0);
     BOOST_TEST(result.average == 0);
 }
 
@@ -158,15 +166,16 @@ BOOST_AUTO_TEST_CASE(it_should_vote_one_invalid_disagree)
     TemperatureVoteEngine engine(50);
     TemperatureVoteResult result;
 
-    engine.vote_temperature(temp0, temp1, temp2, result);
+    TemperatureReading readings[] = {temp0, temp1, temp2};
+    engine.vote_temperature(readings, result);
 
     BOOST_CHECK(result.status == TemperatureVoteStatus::Disagree);
-    BOOST_TEST(!result.is_temp0_agree);
-    BOOST_TEST(!result.is_temp1_agree);
-    BOOST_TEST(!result.is_temp2_agree);
-    BOOST_TEST(result.temp0 == -250);
-    BOOST_TEST(result.temp1 == 1000);
-    BOOST_TEST(result.temp2 == 0);
+    BOOST_TEST(!result.is_agree(0));
+    BOOST_TEST(!result.is_agree(1));
+    BOOST_TEST(!result.is_agree(2));
+    BOOST_TEST(result.temps[0] == -250);
+    BOOST_TEST(result.temps[1] == 1000);
+    BOOST_TEST(result.temps[2] == 0);
     BOOST_TEST(result.average == 0);
 }
 
@@ -179,16 +188,148 @@ BOOST_AUTO_TEST_CASE(it_should_set_output_default_values)
     TemperatureVoteEngine engine(100);
     TemperatureVoteResult result;
 
-    engine.vote_temperature(temp0, temp1, temp2, result);
+    TemperatureReading readings[] = {temp0, temp1, temp2};
+    engine.vote_temperature(readings, result);
 
     BOOST_CHECK(result.status == TemperatureVoteStatus::SensorError);
-    BOOST_TEST(!result.is_temp0_agree);
-    BOOST_TEST(!result.is_temp1_agree);
-    BOOST_TEST(!result.is_temp2_agree);
-    BOOST_TEST(result.temp0 == 0);
-    BOOST_TEST(result.temp1 == 0);
-    BOOST_TEST(result.temp2 == 0);
+    BOOST_TEST(!result.is_agree(0));
+    BOOST_TEST(!result.is_agree(1));
+    BOOST_TEST(!result.is_agree(2));
+    BOOST_TEST(result.temps[0] == 0);
+    BOOST_TEST(result.temps[1] == 0);
+    BOOST_TEST(result.temps[2] == 0);
     BOOST_TEST(result.average == 0);
 }
 
+BOOST_AUTO_TEST_CASE(it_should_vote_five_sensors)
+{
+    TemperatureReading readings[] = {{true, 2400}, {true, 2410}, {false, 2405}, {true, 3000}, {true, 2420}};
+
+    BasicTemperatureVoteEngine<5> engine(50);
+    BasicTemperatureVoteResult<5> result;
+
+    engine.vote_temperature(readings, result);
+
+    BOOST_CHECK(result.status == TemperatureVoteStatus::OK);
+    BOOST_TEST(result.agreement_bits == 0x13);
+    BOOST_TEST(result.temps[2] == 0);
+    BOOST_TEST(result.temps[3] == 3000);
+    BOOST_TEST(result.average == 2410);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_vote_seven_sensors_without_overflow)
+{
+    // Seven sensors near the top of the MCP 9808 range sum past 16 bits.
+    TemperatureReading readings[7];
+    for (auto &reading : readings)
+    {
+        reading = {true, 12000};
+    }
+
+    readings[6].is_valid = false;
+
+    BasicTemperatureVoteEngine<7> engine(50);
+    BasicTemperatureVoteResult<7> result;
+
+    engine.vote_temperature(readings, result);
+
+    BOOST_CHECK(result.status == TemperatureVoteStatus::OK);
+    BOOST_TEST(result.agreement_bits == 0x3F);
+    BOOST_TEST(result.average == 12000);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_disagree_with_one_valid_sensor_agreeing)
+{
+    TemperatureReading readings[] = {{true, 1000}, {false, 0}, {false, 0}, {true, 2000}, {false, 0}};
+
+    BasicTemperatureVoteEngine<5> engine(50);
+    BasicTemperatureVoteResult<5> result;
+
+    engine.vote_temperature(readings, result);
+
+    BOOST_CHECK(result.status == TemperatureVoteStatus::Disagree);
+    BOOST_TEST(result.agreement_bits == 0);
+    BOOST_TEST(result.average == 0);
+}
+
+/// @brief The three sensor vote as it was written before the engine became a template.
+static void reference_vote(const TemperatureReading (&r)[3], int16_t tolerance, TemperatureVoteResult &out)
+{
+    out = TemperatureVoteResult{};
+    out.status = TemperatureVoteStatus::SensorError;
+
+    short count_valid = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        if (r[i].is_valid)
+        {
+            out.temps[i] = r[i].temperature;
+            ++count_valid;
+        }
+    }
+
+    if (count_valid < 2)
+    {
+        return;
+    }
+
+    short count_agree = 0;
+    short sum_agree = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        bool is_agree = false;
+        for (int j = 0; j < 3; ++j)
+        {
+            short diff = short(std::abs(r[i].temperature - r[j].temperature));
+            if (i != j && r[i].is_valid && r[j].is_valid && diff <= tolerance)
+            {
+                is_agree = true;
+            }
+        }
+
+        if (is_agree)
+        {
+            out.agreement_bits |= 1 << i;
+            sum_agree += r[i].temperature;
+            ++count_agree;
+        }
+    }
+
+    if (count_agree >= 2)
+    {
+        out.average = sum_agree / count_agree;
+    }
+
+    out.status = count_agree >= 2 ? TemperatureVoteStatus::OK : TemperatureVoteStatus::Disagree;
+}
+
+BOOST_AUTO_TEST_CASE(it_should_match_three_sensor_reference)
+{
+    TemperatureVoteEngine engine(50);
+    std::srand(3);
+
+    for (int n = 0; n < 10000; ++n)
+    {
+        TemperatureReading readings[3];
+        for (auto &reading : readings)
+        {
+            reading.is_valid = std::rand() % 8 != 0;
+            reading.temperature = static_cast<temperature_type>(2000 + std::rand() % 200 - 100);
+        }
+
+        TemperatureVoteResult expected;
+        reference_vote(readings, 50, expected);
+
+        TemperatureVoteResult actual;
+        engine.vote_temperature(readings, actual);
+
+        BOOST_REQUIRE(actual.status == expected.status);
+        BOOST_REQUIRE(actual.agreement_bits == expected.agreement_bits);
+        BOOST_REQUIRE(actual.temps[0] == expected.temps[0]);
+        BOOST_REQUIRE(actual.temps[1] == expected.temps[1]);
+        BOOST_REQUIRE(actual.temps[2] == expected.temps[2]);
+        BOOST_REQUIRE(actual.average == expected.average);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,276 @@
+#include "fakeit.hpp"
+#include "mocks/Wire.h"
+#include "test_utils.h"
+#include <boost/test/unit_test.hpp>
+
+// File being tested:
+#include "temperature_sampler.h"
+
+using namespace scottz0r::temperature;
+using namespace fakeit;
+
+/// @brief Begin a sensor against a mock that answers the MCP 9808 setup sequence.
+/// @param mock Mock object that is installed as the Wire implementation.
+/// @param sensor Sensor to begin.
+/// @param addr I2C address of the sensor.
+static bool begin_sensor(Mock<TwoWireImpl> &mock, SensorMcp9808 &sensor, uint8_t addr)
+{
+    mock.Reset();
+    When(Method(mock, available)).Return(2, 2);
+    Fake(Method(mock, begin));
+    Fake(Method(mock, beginTransmission));
+    When(Method(mock, endTransmission)).Return(0, 0, 0, 0);
+    When(Method(mock, read)).Return(0x00, 0x54, 0x04, 0x00);
+    Fake(Method(mock, requestFrom));
+    When(Method(mock, write)).AlwaysReturn(1);
+
+    return sensor.begin(addr);
+}
+
+/// @brief Configure the mock so every temperature read returns 0x0101, which is 16.06 degrees.
+static void configure_mock_temperature(Mock<TwoWireImpl> &mock)
+{
+    mock.Reset();
+    Fake(Method(mock, beginTransmission));
+    Fake(Method(mock, write));
+    When(Method(mock, endTransmission)).AlwaysReturn(0);
+    When(Method(mock, requestFrom)).AlwaysReturn(2);
+    When(Method(mock, available)).AlwaysReturn(2);
+    When(Method(mock, read)).AlwaysReturn(0x01);
+}
+
+/// @brief Wire implementation that answers like a bus of MCP 9808 sensors and counts bus traffic. Each
+/// endTransmission() or requestFrom() is one addressed transaction. Bytes include the address byte.
+class CountingWire : public TwoWireImpl
+{
+public:
+    int available() override
+    {
+        return m_rx_count - m_rx_index;
+    }
+
+    void begin() override
+    {
+    }
+
+    void beginTransmission(uint8_t addr) override
+    {
+        m_addr = addr;
+        m_tx_count = 0;
+    }
+
+    uint8_t endTransmission() override
+    {
+        ++transactions;
+        bytes += 1 + m_tx_count;
+
+        // First byte written is the register pointer, which the device keeps between transactions.
+        if (m_tx_count > 0)
+        {
+            m_pointer[m_addr & 0x07] = m_tx[0];
+        }
+
+        return 0;
+    }
+
+    int read() override
+    {
+        return m_rx[m_rx_index++];
+    }
+
+    uint8_t requestFrom(uint8_t addr, uint8_t count) override
+    {
+        ++transactions;
+        bytes += 1 + count;
+
+        uint16_t value = 0;
+        switch (m_pointer[addr & 0x07])
+        {
+        case 0x05:
+            value = 0x01AC; // 26.75 C
+            break;
+        case 0x06:
+            value = 0x0054;
+            break;
+        case 0x07:
+            value = 0x0400;
+            break;
+        }
+
+        m_rx[0] = value >> 8;
+        m_rx[1] = value & 0xFF;
+        m_rx_index = 0;
+        m_rx_count = count;
+        return count;
+    }
+
+    size_t write(uint8_t val) override
+    {
+        if (m_tx_count < sizeof(m_tx))
+        {
+            m_tx[m_tx_count++] = val;
+        }
+
+        return 1;
+    }
+
+    unsigned long transactions = 0;
+    unsigned long bytes = 0;
+
+private:
+    uint8_t m_addr = 0;
+    uint8_t m_pointer[8] = {};
+    uint8_t m_tx[4] = {};
+    uint8_t m_tx_count = 0;
+    uint8_t m_rx[2] = {};
+    int m_rx_index = 0;
+    int m_rx_count = 0;
+};
+
+BOOST_AUTO_TEST_SUITE(temperature_sampler)
+
+BOOST_AUTO_TEST_CASE(it_should_sample_all_sensors_one_step_per_poll)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    Mock<TwoWireImpl> mock;
+    wire_impl = &mock.get();
+
+    SensorMcp9808 sensors[3];
+    BOOST_TEST(begin_sensor(mock, sensors[0], 0x18));
+    BOOST_TEST(begin_sensor(mock, sensors[1], 0x19));
+    BOOST_TEST(begin_sensor(mock, sensors[2], 0x1A));
+
+    TemperatureVoteEngine engine(50);
+    SampleCache cache;
+    TemperatureSampler sampler(sensors, engine, cache);
+
+    configure_mock_temperature(mock);
+
+    BOOST_TEST(!sampler.busy());
+    BOOST_TEST(sampler.start());
+    BOOST_TEST(sampler.busy());
+    BOOST_TEST(!sampler.start());
+
+    // Two bus transactions per sensor: pointer write, then data read.
+    for (int i = 0; i < 5; ++i)
+    {
+        BOOST_TEST(!sampler.poll(100));
+        BOOST_TEST(!cache.has_sample());
+    }
+
+    BOOST_TEST(sampler.poll(100));
+    BOOST_TEST(!sampler.busy());
+    BOOST_TEST(cache.has_sample());
+    BOOST_CHECK(cache.front().status == TemperatureVoteStatus::OK);
+    BOOST_TEST(cache.front().temps[0] == 1606);
+    BOOST_TEST(cache.front().temps[1] == 1606);
+    BOOST_TEST(cache.front().temps[2] == 1606);
+    BOOST_TEST(cache.front().average == 1606);
+    BOOST_TEST(cache.age(150) == 50);
+
+    Verify(Method(mock, endTransmission)).Exactly(3);
+    Verify(Method(mock, requestFrom)).Exactly(3);
+
+    // Polling while idle does nothing.
+    BOOST_TEST(!sampler.poll(200));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_skip_bad_sensor_without_bus_access)
+{
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    Mock<TwoWireImpl> mock;
+    wire_impl = &mock.get();
+
+    // Sensor 1 never started.
+    SensorMcp9808 sensors[3];
+    BOOST_TEST(begin_sensor(mock, sensors[0], 0x18));
+    BOOST_TEST(begin_sensor(mock, sensors[2], 0x1A));
+
+    TemperatureVoteEngine engine(50);
+    SampleCache cache;
+    TemperatureSampler sampler(sensors, engine, cache);
+
+    configure_mock_temperature(mock);
+
+    BOOST_TEST(sampler.start());
+
+    // Two transactions each for sensors 0 and 2, one step to skip sensor 1.
+    for (int i = 0; i < 4; ++i)
+    {
+        BOOST_TEST(!sampler.poll(0));
+    }
+
+    BOOST_TEST(sampler.poll(0));
+    BOOST_CHECK(cache.front().status == TemperatureVoteStatus::OK);
+    BOOST_TEST(cache.front().temps[1] == 0);
+    BOOST_TEST(!cache.front().is_agree(1));
+
+    // The readings behind the sample stay available.
+    BOOST_TEST(sampler.readings()[0].is_valid);
+    BOOST_TEST(sampler.readings()[0].temperature == 1606);
+    BOOST_TEST(!sampler.readings()[1].is_valid);
+    BOOST_TEST(sampler.readings()[2].is_valid);
+    Verify(Method(mock, requestFrom)).Exactly(2);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_halve_bus_transactions_with_cached_pointer)
+{
+    // Bus traffic benchmark for one vote cycle. The first cycle after begin() must move every sensor's pointer from the
+    // config register, which is what every cycle cost before the pointer was cached.
+    auto always = make_always([&]() { wire_impl = nullptr; });
+
+    CountingWire wire;
+    wire_impl = &wire;
+
+    SensorMcp9808 sensors[3];
+    BOOST_TEST(sensors[0].begin(0x18));
+    BOOST_TEST(sensors[1].begin(0x19));
+    BOOST_TEST(sensors[2].begin(0x1A));
+
+    TemperatureVoteEngine engine(50);
+    SampleCache cache;
+    TemperatureSampler sampler(sensors, engine, cache);
+
+    auto run_cycle = [&]() {
+        wire.transactions = 0;
+        wire.bytes = 0;
+
+        sampler.start();
+        while (sampler.busy())
+        {
+            sampler.poll(0);
+        }
+    };
+
+    run_cycle();
+    unsigned long uncached_transactions = wire.transactions;
+    unsigned long uncached_bytes = wire.bytes;
+    BOOST_TEST(cache.front().average == 2675);
+
+    const int cycles = 1000;
+    unsigned long cached_transactions = 0;
+    unsigned long cached_bytes = 0;
+    for (int i = 0; i < cycles; ++i)
+    {
+        run_cycle();
+        cached_transactions += wire.transactions;
+        cached_bytes += wire.bytes;
+    }
+
+    BOOST_TEST(cache.front().average == 2675);
+
+    BOOST_TEST_MESSAGE(
+        "Per vote cycle: pointer write every read " << uncached_transactions << " transactions / " << uncached_bytes
+                                                    << " bytes, cached pointer " << cached_transactions / cycles
+                                                    << " transactions / " << cached_bytes / cycles << " bytes");
+
+    // Pointer write (address + register) plus data read (address + 2 bytes) per sensor, against data read only.
+    BOOST_TEST(uncached_transactions == 6);
+    BOOST_TEST(uncached_bytes == 15);
+    BOOST_TEST(cached_transactions == 3 * cycles);
+    BOOST_TEST(cached_bytes == 9 * cycles);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
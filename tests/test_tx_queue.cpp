@@ -0,0 +1,115 @@
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+// File being tested:
+#include "tx_queue.h"
+
+using namespace scottz0r::temperature;
+
+/// @brief Take up to max_size bytes from the front of the queue, across the wrap if needed.
+static std::vector<uint8_t> take(TxQueue &queue, size_type max_size)
+{
+    std::vector<uint8_t> bytes;
+    while (bytes.size() < max_size && !queue.empty())
+    {
+        const uint8_t *data;
+        size_type size = queue.front(data);
+        if (size > max_size - bytes.size())
+        {
+            size = static_cast<size_type>(max_size - bytes.size());
+        }
+
+        bytes.insert(bytes.end(), data, data + size);
+        queue.pop(size);
+    }
+
+    return bytes;
+}
+
+BOOST_AUTO_TEST_SUITE(tx_queue)
+
+BOOST_AUTO_TEST_CASE(it_should_queue_messages_in_order)
+{
+    uint8_t storage[16];
+    TxQueue queue(storage, sizeof(storage));
+
+    BOOST_TEST(queue.empty());
+    BOOST_TEST(queue.capacity() == 16u);
+
+    const uint8_t first[] = {1, 2, 3};
+    const uint8_t second[] = {4, 5};
+    BOOST_TEST(queue.push(first, sizeof(first)));
+    BOOST_TEST(queue.push(second, sizeof(second)));
+    BOOST_TEST(queue.size() == 5u);
+    BOOST_TEST(queue.free_space() == 11u);
+
+    // Written in pieces, as the serial transmit buffer has room.
+    BOOST_TEST(take(queue, 2) == std::vector<uint8_t>({1, 2}));
+    BOOST_TEST(take(queue, 10) == std::vector<uint8_t>({3, 4, 5}));
+    BOOST_TEST(queue.empty());
+
+    const uint8_t *data;
+    BOOST_TEST(queue.front(data) == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_wrap)
+{
+    uint8_t storage[8];
+    TxQueue queue(storage, sizeof(storage));
+
+    const uint8_t message[] = {1, 2, 3, 4, 5};
+    for (int i = 0; i < 10; ++i)
+    {
+        BOOST_REQUIRE(queue.push(message, sizeof(message)));
+
+        // The front stops at the end of storage, and the rest follows from the start.
+        const uint8_t *data;
+        size_type size = queue.front(data);
+        BOOST_TEST(size >= 1u);
+        BOOST_TEST(size <= sizeof(message));
+
+        BOOST_REQUIRE(take(queue, sizeof(message)) == std::vector<uint8_t>(message, message + sizeof(message)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(it_should_drop_messages_that_do_not_fit)
+{
+    uint8_t storage[8];
+    TxQueue queue(storage, sizeof(storage));
+
+    const uint8_t message[] = {1, 2, 3, 4, 5};
+    BOOST_TEST(queue.push(message, sizeof(message)));
+
+    // Never part of a message.
+    BOOST_TEST(!queue.push(message, sizeof(message)));
+    BOOST_TEST(queue.size() == 5u);
+    BOOST_TEST(queue.dropped() == 1u);
+
+    // A message that fits exactly is taken.
+    BOOST_TEST(queue.push(message, 3));
+    BOOST_TEST(queue.free_space() == 0u);
+
+    BOOST_TEST(take(queue, 8) == std::vector<uint8_t>({1, 2, 3, 4, 5, 1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(it_should_track_peak)
+{
+    uint8_t storage[16];
+    TxQueue queue(storage, sizeof(storage));
+
+    const uint8_t message[] = {1, 2, 3, 4, 5, 6};
+    queue.push(message, sizeof(message));
+    queue.push(message, sizeof(message));
+    take(queue, 10);
+    queue.push(message, 4);
+
+    BOOST_TEST(queue.size() == 6u);
+    BOOST_TEST(queue.peak() == 12u);
+
+    // Popping more than is queued empties the queue.
+    queue.pop(100);
+    BOOST_TEST(queue.empty());
+    BOOST_TEST(queue.peak() == 12u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
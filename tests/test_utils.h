@@ -1,6 +1,8 @@
 #ifndef SCOTTZ0R_TEMPERATURE_TESTS_UTILS
 #define SCOTTZ0R_TEMPERATURE_TESTS_UTILS
 
+#include "temperature_types.h"
+
 template <class T> class DoAlways
 {
 public:
@@ -22,4 +24,21 @@ template <class T> DoAlways<T> make_always(T val)
     return DoAlways<T>(val);
 }
 
+/// @brief Make an OK sample with the given average, every sensor reading it and agreeing.
+inline scottz0r::temperature::TemperatureVoteResult make_sample(scottz0r::temperature::temperature_type average)
+{
+    using scottz0r::temperature::TemperatureVoteResult;
+
+    TemperatureVoteResult sample{};
+    sample.status = scottz0r::temperature::TemperatureVoteStatus::OK;
+    sample.agreement_bits = static_cast<uint8_t>((1u << TemperatureVoteResult::sensor_count) - 1);
+    for (auto &temp : sample.temps)
+    {
+        temp = average;
+    }
+
+    sample.average = average;
+    return sample;
+}
+
 #endif // SCOTTZ0R_TEMPERATURE_TESTS_UTILS
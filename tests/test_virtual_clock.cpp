@@ -0,0 +1,144 @@
+#include "mocks/i2c_bus_model.h"
+#include "mocks/mcp9808_model.h"
+#include "mocks/virtual_clock.h"
+#include "mocks/virtual_serial.h"
+#include "test_utils.h"
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(virtual_clock)
+
+BOOST_AUTO_TEST_CASE(it_should_only_move_when_time_is_spent)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock(1500);
+    arduino_impl = &clock;
+
+    BOOST_TEST(millis() == 1u);
+    BOOST_TEST(micros() == 1500u);
+    BOOST_TEST(millis() == 1u);
+
+    delay(10);
+    BOOST_TEST(micros() == 11500u);
+
+    clock.set_loop_cost(250);
+    clock.end_loop();
+    clock.end_loop();
+    BOOST_TEST(clock.now() == 12000u);
+    BOOST_TEST(clock.loops() == 2u);
+
+    // Time never goes back.
+    clock.advance_to(100);
+    BOOST_TEST(clock.now() == 12000u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_run_events_in_time_order)
+{
+    VirtualClock clock;
+    std::vector<int> order;
+    std::vector<uint64_t> times;
+
+    auto record = [&](int id) {
+        return [&, id]() {
+            order.push_back(id);
+            times.push_back(clock.now());
+        };
+    };
+
+    clock.schedule(300, record(1));
+    clock.schedule(100, record(2));
+    clock.schedule(300, record(3));
+    clock.schedule(200, [&]() { clock.schedule(250, record(4)); });
+
+    clock.advance(260);
+    BOOST_TEST(order == std::vector<int>({2, 4}));
+    BOOST_TEST(times == std::vector<uint64_t>({100, 250}));
+    BOOST_TEST(clock.now() == 260u);
+
+    // Ties run in the order they were scheduled.
+    BOOST_TEST(clock.advance_to_next_event());
+    BOOST_TEST(order == std::vector<int>({2, 4, 1, 3}));
+    BOOST_TEST(clock.now() == 300u);
+    BOOST_TEST(!clock.advance_to_next_event());
+}
+
+BOOST_AUTO_TEST_CASE(it_should_time_received_bytes_at_the_line_rate)
+{
+    VirtualClock clock;
+    VirtualSerial serial(clock);
+    serial.begin(9600);
+    BOOST_TEST(serial.byte_time() == 1041u);
+
+    const uint8_t data[] = {1, 2, 3};
+    serial.send(data, sizeof(data));
+    BOOST_TEST(serial.available() == 0);
+
+    clock.advance(1041);
+    BOOST_TEST(serial.available() == 1);
+    BOOST_TEST(serial.read() == 1);
+
+    clock.advance_to(serial.send_done());
+    BOOST_TEST(serial.available() == 2);
+
+    // The receive buffer holds 63 bytes, and the rest are lost.
+    std::vector<uint8_t> burst(70, 0x55);
+    serial.send(burst);
+    clock.advance_to(serial.send_done());
+    BOOST_TEST(serial.available() == 63);
+    BOOST_TEST(serial.overruns() == 9u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_block_writes_on_a_full_transmit_buffer)
+{
+    VirtualClock clock;
+    VirtualSerial serial(clock);
+    serial.begin(9600);
+
+    // 63 bytes fit. The writer waits for the other 37 to find room.
+    std::vector<uint8_t> data(100, 0xAA);
+    serial.write(data.data(), data.size());
+    BOOST_TEST(clock.now() == 37u * 1041u);
+    BOOST_TEST(serial.blocked_time() == 37u * 1041u);
+    BOOST_TEST(serial.availableForWrite() == 0);
+    BOOST_TEST(serial.take_output().size() == 37u);
+
+    serial.flush();
+    BOOST_TEST(clock.now() == 100u * 1041u);
+    BOOST_TEST(serial.take_output().size() == 63u);
+    BOOST_TEST(serial.availableForWrite() == 63);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_spend_i2c_transaction_time)
+{
+    auto _always = make_always([&]() { arduino_impl = nullptr; });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18);
+    bus.attach(sensor);
+    bus.set_clock(&clock);
+
+    // Address and pointer: 2 bytes of 9 bits, plus start and stop, at 100 kHz.
+    bus.beginTransmission(0x18);
+    bus.write(Mcp9808Model::REG_AMBIENT_TEMP);
+    bus.endTransmission();
+    BOOST_TEST(clock.now() == 200u);
+
+    // Address and two data bytes.
+    bus.requestFrom(0x18, 2);
+    BOOST_TEST(clock.now() == 490u);
+
+    // A NACKed address stops after the address.
+    bus.requestFrom(0x19, 2);
+    BOOST_TEST(clock.now() == 600u);
+
+    // A locked bus takes the Wire timeout.
+    bus.add_lockup(0, 1000);
+    bus.requestFrom(0x18, 2);
+    BOOST_TEST(clock.now() == 600u + I2cBusModel::LOCKUP_TIMEOUT);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
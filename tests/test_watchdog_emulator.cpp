@@ -0,0 +1,160 @@
+#include "mocks/i2c_bus_model.h"
+#include "mocks/mcp9808_model.h"
+#include "mocks/virtual_serial.h"
+#include "mocks/watchdog_emulator.h"
+#include "test_utils.h"
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include <vector>
+
+/// @brief Clock time a gap spent on a label, or zero.
+static uint64_t spent_on(const WatchdogGap &gap, const std::string &label)
+{
+    for (const auto &spent : gap.spent)
+    {
+        if (spent.first == label)
+        {
+            return spent.second;
+        }
+    }
+
+    return 0;
+}
+
+BOOST_AUTO_TEST_SUITE(watchdog_emulator)
+
+BOOST_AUTO_TEST_CASE(it_should_only_watch_while_enabled)
+{
+    auto _always = make_always([&]() { wdt_impl = nullptr; });
+
+    // Without an emulator the calls do nothing.
+    wdt_enable(WDTO_60MS);
+    wdt_reset();
+    wdt_disable();
+
+    VirtualClock clock;
+    WatchdogEmulator watchdog(clock);
+    wdt_impl = &watchdog;
+
+    clock.advance(100000, "setup");
+    wdt_reset();
+    BOOST_TEST(watchdog.resets() == 0u);
+    BOOST_TEST(watchdog.expiries() == 0u);
+
+    wdt_enable(WDTO_60MS);
+    BOOST_TEST(watchdog.is_enabled());
+    BOOST_TEST(watchdog.window() == 60000u);
+
+    clock.advance(100000, "idle");
+    BOOST_TEST(watchdog.expiries() == 1u);
+
+    // Time after disabling is not watched.
+    wdt_disable();
+    clock.advance(100000, "idle");
+    BOOST_TEST(watchdog.expiries() == 1u);
+    BOOST_TEST(watchdog.worst_gap().length == 100000u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_trace_the_worst_gap)
+{
+    auto _always = make_always([&]() { wdt_impl = nullptr; });
+
+    VirtualClock clock;
+    clock.set_loop_cost(200);
+    WatchdogEmulator watchdog(clock);
+    wdt_impl = &watchdog;
+    wdt_enable(WDTO_60MS);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        if (i == 4)
+        {
+            watchdog.note("request Temperature");
+            clock.advance(3000, "I2C 0x18");
+            clock.advance(5000, "Serial.write");
+            watchdog.note("request Temperature");
+        }
+
+        clock.end_loop();
+        wdt_reset();
+    }
+
+    const WatchdogGap &worst = watchdog.worst_gap();
+    BOOST_TEST(watchdog.resets() == 10u);
+    BOOST_TEST(worst.start == 4u * 200u);
+    BOOST_TEST(worst.length == 8200u);
+    BOOST_TEST(worst.notes == std::vector<std::string>({"request Temperature"}));
+    BOOST_TEST(worst.spent.size() == 3u);
+    BOOST_TEST(spent_on(worst, "Serial.write") == 5000u);
+    BOOST_TEST(spent_on(worst, "loop") == 200u);
+    BOOST_TEST(watchdog.expiries() == 0u);
+
+    // A gap of exactly the timeout does not expire.
+    clock.advance(60000, "loop");
+    wdt_reset();
+    BOOST_TEST(watchdog.expiries() == 0u);
+    BOOST_TEST(watchdog.worst_gap().length == 60000u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_expire_on_timed_out_sensor_reads_and_a_blocked_write)
+{
+    auto _always = make_always([&]() {
+        arduino_impl = nullptr;
+        wdt_impl = nullptr;
+    });
+
+    VirtualClock clock;
+    arduino_impl = &clock;
+
+    I2cBusModel bus;
+    Mcp9808Model sensor(0x18);
+    bus.attach(sensor);
+    bus.set_clock(&clock);
+    bus.add_lockup(0, 1000);
+
+    VirtualSerial serial(clock);
+    serial.begin(9600);
+
+    WatchdogEmulator watchdog(clock);
+    wdt_impl = &watchdog;
+    wdt_enable(WDTO_60MS);
+
+    // Two reads time out on the stuck bus, then a reply waits 20 byte times for room: 50 + 20.8 milliseconds.
+    watchdog.note("sample");
+    bus.requestFrom(0x18, 2);
+    bus.requestFrom(0x18, 2);
+    BOOST_TEST(watchdog.expiries() == 0u);
+
+    std::vector<uint8_t> reply(83, 0x55);
+    serial.write(reply.data(), reply.size());
+    BOOST_TEST(watchdog.expiries() == 1u);
+
+    // Caught when the clock passed the timeout, during the write.
+    const WatchdogGap &expiry = watchdog.first_expiry();
+    BOOST_TEST(expiry.length == 60001u);
+    BOOST_TEST(expiry.notes == std::vector<std::string>({"sample"}));
+    BOOST_TEST(spent_on(expiry, "I2C 0x18 timeout") == 2u * I2cBusModel::LOCKUP_TIMEOUT);
+    BOOST_TEST(spent_on(expiry, "Serial.write") > 0u);
+
+    // A run that has not reset since still counts its last gap.
+    watchdog.finish();
+    BOOST_TEST(watchdog.worst_gap().length == 50000u + 20u * 1041u);
+}
+
+BOOST_AUTO_TEST_CASE(it_should_stop_a_run_from_the_expiry_handler)
+{
+    auto _always = make_always([&]() { wdt_impl = nullptr; });
+
+    VirtualClock clock;
+    WatchdogEmulator watchdog(clock);
+    watchdog.set_expiry_handler([](const WatchdogGap &) { throw std::runtime_error("watchdog expired"); });
+    wdt_impl = &watchdog;
+    wdt_enable(WDTO_15MS);
+
+    clock.advance(15000, "loop");
+    wdt_reset();
+    BOOST_CHECK_THROW(clock.advance(15001, "loop"), std::runtime_error);
+    BOOST_TEST(clock.now() == 30001u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
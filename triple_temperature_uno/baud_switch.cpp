@@ -0,0 +1,62 @@
+#include "baud_switch.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    BaudSwitch::BaudSwitch(unsigned long default_baud, time_type confirm_timeout)
+        : m_default(default_baud), m_current(default_baud), m_target(default_baud), m_confirm_timeout(confirm_timeout),
+          m_switch_time(0), m_state(State::Idle)
+    {
+    }
+
+    bool BaudSwitch::is_supported(unsigned long baud)
+    {
+        // With double speed the UART divides 16 MHz by 8 * (UBRR + 1), which gives these rates with no error. The
+        // USB serial bridge on the Uno runs from the same clock, so both ends of the link agree.
+        return baud == CFG_SERIAL_BAUD_RATE || baud == 250000 || baud == 500000 || baud == 1000000;
+    }
+
+    bool BaudSwitch::request(unsigned long baud)
+    {
+        if (!is_supported(baud))
+        {
+            return false;
+        }
+
+        m_target = baud;
+        m_state = State::Pending;
+        return true;
+    }
+
+    void BaudSwitch::confirm()
+    {
+        // Requests decoded before the switch were sent at the old rate, so they say nothing about the new one.
+        if (m_state == State::Confirming)
+        {
+            m_state = State::Idle;
+        }
+    }
+
+    unsigned long BaudSwitch::poll(time_type now, bool tx_idle)
+    {
+        if (m_state == State::Pending && tx_idle)
+        {
+            m_current = m_target;
+            m_switch_time = now;
+            m_state = State::Confirming;
+            return m_current;
+        }
+
+        if (m_state == State::Confirming && now - m_switch_time >= m_confirm_timeout)
+        {
+            m_current = m_default;
+            m_target = m_default;
+            m_state = State::Idle;
+            return m_current;
+        }
+
+        return 0;
+    }
+} // namespace temperature
+} // namespace scottz0r
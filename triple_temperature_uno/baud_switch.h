@@ -0,0 +1,71 @@
+///
+/// @file
+///
+/// Runtime serial baud rate changes requested by the host.
+///
+/// The acknowledgement is sent at the old rate, and the port switches once it has been written. The host then sends
+/// a request at the new rate. If no valid request arrives within the confirm timeout, the host never switched or the
+/// link does not work at the new rate, and the port falls back to the default rate.
+#ifndef _SCOTTZ0R_TEMPERATURE_BAUD_SWITCH_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_BAUD_SWITCH_INCLUDE_GUARD
+
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    /// @brief Tracks a baud rate change from the request until the host confirms it at the new rate.
+    class BaudSwitch
+    {
+        enum class State : uint8_t
+        {
+            Idle,
+            Pending,
+            Confirming
+        };
+
+    public:
+        /// @param default_baud Rate the port starts at, and falls back to.
+        /// @param confirm_timeout Time the host has to send a valid request at the new rate. Milliseconds.
+        BaudSwitch(unsigned long default_baud, time_type confirm_timeout);
+
+        /// @brief True for the default rate, and for rates the UART can make exactly from a 16 MHz clock.
+        static bool is_supported(unsigned long baud);
+
+        /// @brief Start a change. The caller queues the acknowledgement at the current rate.
+        /// @return False if the rate is not supported, in which case nothing changes.
+        bool request(unsigned long baud);
+
+        /// @brief Call for every valid request. After a switch, this confirms the new rate.
+        void confirm();
+
+        /// @brief Call once per loop pass, after output is written.
+        /// @param tx_idle True when every queued byte has been handed to the serial port.
+        /// @return Rate to restart the serial port at, or zero to leave it alone.
+        unsigned long poll(time_type now, bool tx_idle);
+
+        /// @brief Rate the serial port runs at. A pending change is not applied until poll returns it.
+        unsigned long baud() const
+        {
+            return m_current;
+        }
+
+        /// @brief True from the request until the new rate is confirmed or abandoned.
+        bool is_busy() const
+        {
+            return m_state != State::Idle;
+        }
+
+    private:
+        unsigned long m_default;
+        unsigned long m_current;
+        unsigned long m_target;
+        time_type m_confirm_timeout;
+        time_type m_switch_time;
+        State m_state;
+    };
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_BAUD_SWITCH_INCLUDE_GUARD
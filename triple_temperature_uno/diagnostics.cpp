@@ -0,0 +1,192 @@
+#include "diagnostics.h"
+
+#include <Arduino.h>
+
+#if CFG_DIAGNOSTICS
+
+/// @brief Minimum of a TimeStats that has no times recorded.
+static constexpr uint16_t NO_MIN = 0xFFFF;
+
+/// @brief Length of a loop rate window. Microseconds.
+static constexpr unsigned long RATE_WINDOW = 1000000;
+
+namespace scottz0r
+{
+namespace temperature
+{
+    Diagnostics::Diagnostics()
+        : m_has_loop(false), m_last_loop(0), m_window_time(0), m_window_passes(0), m_loop_rate(0), m_loop_time_max(0),
+          m_step_start(0), m_received{}, m_received_head(0), m_received_count(0), m_is_timing_reply(false),
+          m_reply_start(0), m_reply_bytes_ahead(0)
+    {
+        for (size_type i = 0; i < CFG_SENSOR_COUNT; ++i)
+        {
+            m_sensor_times[i] = {NO_MIN, 0, 0};
+        }
+
+        m_reply_latency = {NO_MIN, 0, 0};
+    }
+
+    void Diagnostics::on_loop()
+    {
+        unsigned long now = micros();
+
+        // The first pass has nothing to measure from.
+        if (!m_has_loop)
+        {
+            m_has_loop = true;
+            m_last_loop = now;
+            return;
+        }
+
+        unsigned long elapsed = now - m_last_loop;
+        m_last_loop = now;
+
+        uint16_t loop_time = elapsed > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(elapsed);
+        if (loop_time > m_loop_time_max)
+        {
+            m_loop_time_max = loop_time;
+        }
+
+        if (m_window_passes < 0xFFFF)
+        {
+            ++m_window_passes;
+        }
+
+        m_window_time += elapsed;
+        if (m_window_time >= RATE_WINDOW)
+        {
+            m_loop_rate = m_window_passes;
+            m_window_passes = 0;
+            m_window_time = 0;
+        }
+    }
+
+    void Diagnostics::begin_sampler_step()
+    {
+        m_step_start = micros();
+    }
+
+    void Diagnostics::end_sampler_step(size_type sensor)
+    {
+        if (sensor < CFG_SENSOR_COUNT)
+        {
+            record(m_sensor_times[sensor], micros() - m_step_start);
+        }
+    }
+
+    void Diagnostics::on_requests_received(size_type count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        // Requests completed by the same input were received together.
+        unsigned long now = micros();
+        for (; count > 0 && m_received_count < MessageReader::queue_size; --count)
+        {
+            size_type tail = m_received_head + m_received_count;
+            if (tail >= MessageReader::queue_size)
+            {
+                tail -= MessageReader::queue_size;
+            }
+
+            m_received[tail] = now;
+            ++m_received_count;
+        }
+    }
+
+    void Diagnostics::on_request_handled(size_type queued_before, size_type queued_after)
+    {
+        if (m_received_count == 0)
+        {
+            return;
+        }
+
+        unsigned long received = m_received[m_received_head];
+        ++m_received_head;
+        if (m_received_head >= MessageReader::queue_size)
+        {
+            m_received_head = 0;
+        }
+
+        --m_received_count;
+
+        // The reply goes out after the bytes already queued.
+        if (!m_is_timing_reply && queued_after > queued_before)
+        {
+            m_is_timing_reply = true;
+            m_reply_start = received;
+            m_reply_bytes_ahead = queued_before;
+        }
+    }
+
+    void Diagnostics::on_bytes_written(size_type count)
+    {
+        if (!m_is_timing_reply)
+        {
+            return;
+        }
+
+        if (count > m_reply_bytes_ahead)
+        {
+            record(m_reply_latency, micros() - m_reply_start);
+            m_is_timing_reply = false;
+        }
+        else
+        {
+            m_reply_bytes_ahead -= count;
+        }
+    }
+
+    void Diagnostics::report(DiagnosticsReport &dest) const
+    {
+        dest.loop_rate = m_loop_rate;
+        dest.loop_time_max = m_loop_time_max;
+
+        for (size_type i = 0; i < CFG_SENSOR_COUNT; ++i)
+        {
+            report_stats(m_sensor_times[i], dest.sensor_times[i]);
+        }
+
+        report_stats(m_reply_latency, dest.reply_latency);
+    }
+
+    void Diagnostics::record(TimeStats &stats, unsigned long elapsed)
+    {
+        uint16_t time = elapsed > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(elapsed);
+
+        if (stats.min == NO_MIN && stats.max == 0)
+        {
+            stats.average = time;
+        }
+        else
+        {
+            // Moving average over about the last eight times. Shifts and adds only, as the AVR has no divider.
+            stats.average = static_cast<uint16_t>(stats.average + (static_cast<int32_t>(time) - stats.average) / 8);
+        }
+
+        if (time < stats.min)
+        {
+            stats.min = time;
+        }
+
+        if (time > stats.max)
+        {
+            stats.max = time;
+        }
+    }
+
+    void Diagnostics::report_stats(const TimeStats &stats, TimeStats &dest)
+    {
+        dest = stats;
+        if (dest.min == NO_MIN)
+        {
+            dest.min = 0;
+        }
+    }
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // CFG_DIAGNOSTICS
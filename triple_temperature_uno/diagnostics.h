@@ -0,0 +1,109 @@
+///
+/// @file
+///
+/// Performance counters for the Diagnostics request.
+///
+/// The main loop calls a hook at each point of interest. A hook reads the microsecond clock at most once and updates a
+/// few counters. With CFG_DIAGNOSTICS set to 0 the hooks are empty inline functions and the counters take no SRAM.
+#ifndef _SCOTTZ0R_TEMPERATURE_DIAGNOSTICS_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_DIAGNOSTICS_INCLUDE_GUARD
+
+#include "message_reader.h"
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+#if CFG_DIAGNOSTICS
+    /// @brief Loop, sensor and reply timing. Times are in microseconds from micros().
+    class Diagnostics
+    {
+    public:
+        Diagnostics();
+
+        /// @brief Call at the start of every loop pass.
+        void on_loop();
+
+        /// @brief Call before a sampler poll that works on a sensor.
+        void begin_sampler_step();
+
+        /// @brief Call after the sampler poll.
+        /// @param sensor Index of the sensor the step worked on.
+        void end_sampler_step(size_type sensor);
+
+        /// @brief Call after giving serial input to the request reader.
+        /// @param count Number of requests the input completed.
+        void on_requests_received(size_type count);
+
+        /// @brief Call after handling the oldest request. A reply queued by the handler is timed until its first byte
+        /// is written. One reply is timed at a time, and replies queued while one is timed are not.
+        /// @param queued_before Transmit queue size before the request was handled.
+        /// @param queued_after Transmit queue size after.
+        void on_request_handled(size_type queued_before, size_type queued_after);
+
+        /// @brief Call after writing bytes from the transmit queue to the serial port.
+        void on_bytes_written(size_type count);
+
+        /// @brief Fill in the counters kept here. Request reader counts are left for the caller.
+        void report(DiagnosticsReport &dest) const;
+
+    private:
+        static void record(TimeStats &stats, unsigned long elapsed);
+
+        static void report_stats(const TimeStats &stats, TimeStats &dest);
+
+        bool m_has_loop;
+        unsigned long m_last_loop;
+        unsigned long m_window_time;
+        uint16_t m_window_passes;
+        uint16_t m_loop_rate;
+        uint16_t m_loop_time_max;
+
+        unsigned long m_step_start;
+        TimeStats m_sensor_times[CFG_SENSOR_COUNT];
+
+        // Times the requests in the request queue were received, oldest first.
+        unsigned long m_received[MessageReader::queue_size];
+        size_type m_received_head;
+        size_type m_received_count;
+
+        bool m_is_timing_reply;
+        unsigned long m_reply_start;
+        size_type m_reply_bytes_ahead;
+        TimeStats m_reply_latency;
+    };
+#else
+    /// @brief Counters compiled out. Every hook does nothing.
+    class Diagnostics
+    {
+    public:
+        void on_loop()
+        {
+        }
+
+        void begin_sampler_step()
+        {
+        }
+
+        void end_sampler_step(size_type)
+        {
+        }
+
+        void on_requests_received(size_type)
+        {
+        }
+
+        void on_request_handled(size_type, size_type)
+        {
+        }
+
+        void on_bytes_written(size_type)
+        {
+        }
+    };
+#endif
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_DIAGNOSTICS_INCLUDE_GUARD
@@ -0,0 +1,434 @@
+#include "history_buffer.h"
+
+#include "temperature_engine.h"
+
+#define HISTORY_STATUS_MASK 0x03
+#define HISTORY_AGREE_SHIFT 2
+#define HISTORY_AGREE_MASK 0x1C
+#define HISTORY_MODE_SHIFT 5
+#define HISTORY_MODE_MASK 0x60
+#define HISTORY_AVERAGE_FLAG 0x80
+
+#define HISTORY_MODE_UNCHANGED 0
+#define HISTORY_MODE_SMALL 1
+#define HISTORY_MODE_VARINTS 2
+
+#define HISTORY_SMALL_LIMIT 0x20
+#define HISTORY_SMALL_BITS 5
+#define HISTORY_VARINT_MAX_SIZE 3
+
+namespace scottz0r
+{
+namespace temperature
+{
+    static constexpr size_type sensor_count = TemperatureVoteResult::sensor_count;
+
+    // Up to three agreement bits fit in the header. More sensors need a separate agreement byte.
+    static constexpr bool has_agreement_byte = sensor_count > 3;
+
+    static constexpr size_type small_size = (sensor_count * HISTORY_SMALL_BITS + 7) / 8;
+    /// @brief Map a signed delta to an unsigned value so that small magnitudes of either sign stay small.
+    static uint16_t zigzag_encode(int16_t value)
+    {
+        return static_cast<uint16_t>((static_cast<uint16_t>(value) << 1) ^ static_cast<uint16_t>(value >> 15));
+    }
+
+    static int16_t zigzag_decode(uint16_t value)
+    {
+        return static_cast<int16_t>((value >> 1) ^ static_cast<uint16_t>(-static_cast<int16_t>(value & 1)));
+    }
+
+    static size_type write_varint(uint16_t value, uint8_t *dest)
+    {
+        size_type size = 0;
+        while (value >= 0x80)
+        {
+            dest[size] = static_cast<uint8_t>(value | 0x80);
+            ++size;
+            value >>= 7;
+        }
+
+        dest[size] = static_cast<uint8_t>(value);
+        return size + 1;
+    }
+
+    /// @return Bytes consumed, or 0 if the varint is truncated or too long.
+    static size_type read_varint(const uint8_t *src, size_type size, uint16_t &value)
+    {
+        value = 0;
+        for (size_type i = 0; i < size && i < HISTORY_VARINT_MAX_SIZE; ++i)
+        {
+            value |= static_cast<uint16_t>(src[i] & 0x7F) << (7 * i);
+            if ((src[i] & 0x80) == 0)
+            {
+                return i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    size_type history_encode(const TemperatureVoteResult &prev, const TemperatureVoteResult &sample, uint8_t *dest)
+    {
+        // Deltas wrap in 16 bits, so any pair of temperatures can be encoded and the decoder wraps back.
+        uint16_t deltas[sensor_count];
+        uint16_t largest = 0;
+        for (size_type i = 0; i < sensor_count; ++i)
+        {
+            deltas[i] = zigzag_encode(static_cast<int16_t>(sample.temps[i] - prev.temps[i]));
+            largest |= deltas[i];
+        }
+
+        uint8_t header = 0;
+        if (sample.status < TemperatureVoteStatus::_Unknown)
+        {
+            header |= static_cast<uint8_t>(sample.status);
+        }
+        else
+        {
+            header |= static_cast<uint8_t>(TemperatureVoteStatus::_Unknown);
+        }
+
+        size_type size = 1;
+
+        if (has_agreement_byte)
+        {
+            dest[size] = sample.agreement_bits;
+            ++size;
+        }
+        else
+        {
+            header |= (sample.agreement_bits << HISTORY_AGREE_SHIFT) & HISTORY_AGREE_MASK;
+        }
+
+        if (largest == 0)
+        {
+            header |= HISTORY_MODE_UNCHANGED << HISTORY_MODE_SHIFT;
+        }
+        else if (largest < HISTORY_SMALL_LIMIT)
+        {
+            header |= HISTORY_MODE_SMALL << HISTORY_MODE_SHIFT;
+
+            uint16_t bits = 0;
+            uint8_t bit_count = 0;
+            for (size_type i = 0; i < sensor_count; ++i)
+            {
+                bits |= deltas[i] << bit_count;
+                bit_count += HISTORY_SMALL_BITS;
+
+                while (bit_count >= 8)
+                {
+                    dest[size] = static_cast<uint8_t>(bits);
+                    ++size;
+                    bits >>= 8;
+                    bit_count -= 8;
+                }
+            }
+
+            if (bit_count > 0)
+            {
+                dest[size] = static_cast<uint8_t>(bits);
+                ++size;
+            }
+        }
+        else
+        {
+            header |= HISTORY_MODE_VARINTS << HISTORY_MODE_SHIFT;
+            for (size_type i = 0; i < sensor_count; ++i)
+            {
+                size += write_varint(deltas[i], dest + size);
+            }
+        }
+
+        // The average is almost always what the vote engine would compute from the agreeing sensors.
+        int16_t average_residual =
+            static_cast<int16_t>(sample.average - TemperatureVoteEngine::agreeing_average(sample));
+        if (average_residual != 0)
+        {
+            header |= HISTORY_AVERAGE_FLAG;
+            size += write_varint(zigzag_encode(average_residual), dest + size);
+        }
+
+        dest[0] = header;
+        return size;
+    }
+
+    size_type history_decode(TemperatureVoteResult &prev, const uint8_t *src, size_type size)
+    {
+        if (size < 1)
+        {
+            return 0;
+        }
+
+        uint8_t header = src[0];
+        uint16_t deltas[sensor_count] = {};
+        size_type consumed = 1;
+
+        uint8_t agreement_bits = (header & HISTORY_AGREE_MASK) >> HISTORY_AGREE_SHIFT;
+        if (has_agreement_byte)
+        {
+            if (size < 2)
+            {
+                return 0;
+            }
+
+            agreement_bits = src[1];
+            ++consumed;
+        }
+
+        switch ((header & HISTORY_MODE_MASK) >> HISTORY_MODE_SHIFT)
+        {
+        case HISTORY_MODE_UNCHANGED:
+            break;
+        case HISTORY_MODE_SMALL:
+        {
+            if (size - consumed < small_size)
+            {
+                return 0;
+            }
+
+            uint16_t bits = 0;
+            uint8_t bit_count = 0;
+            for (size_type i = 0; i < sensor_count; ++i)
+            {
+                if (bit_count < HISTORY_SMALL_BITS)
+                {
+                    bits |= src[consumed] << bit_count;
+                    ++consumed;
+                    bit_count += 8;
+                }
+
+                deltas[i] = bits & (HISTORY_SMALL_LIMIT - 1);
+                bits >>= HISTORY_SMALL_BITS;
+                bit_count -= HISTORY_SMALL_BITS;
+            }
+            break;
+        }
+        case HISTORY_MODE_VARINTS:
+            for (size_type i = 0; i < sensor_count; ++i)
+            {
+                size_type n = read_varint(src + consumed, size - consumed, deltas[i]);
+                if (n == 0)
+                {
+                    return 0;
+                }
+
+                consumed += n;
+            }
+            break;
+        default:
+            return 0;
+        }
+
+        uint16_t average_residual = 0;
+        if ((header & HISTORY_AVERAGE_FLAG) != 0)
+        {
+            size_type n = read_varint(src + consumed, size - consumed, average_residual);
+            if (n == 0)
+            {
+                return 0;
+            }
+
+            consumed += n;
+        }
+
+        prev.status = static_cast<TemperatureVoteStatus>(header & HISTORY_STATUS_MASK);
+        prev.agreement_bits = agreement_bits;
+
+        for (size_type i = 0; i < sensor_count; ++i)
+        {
+            prev.temps[i] = static_cast<temperature_type>(prev.temps[i] + zigzag_decode(deltas[i]));
+        }
+
+        prev.average = static_cast<temperature_type>(
+            TemperatureVoteEngine::agreeing_average(prev) + zigzag_decode(average_residual));
+
+        return consumed;
+    }
+
+    HistoryBuffer::HistoryBuffer(uint8_t *storage, size_type capacity)
+        : m_storage(storage), m_capacity(capacity), m_head(0), m_size(0), m_record_count(0), m_start_offset(0),
+          m_base{}, m_last{}, m_cursor_offset(0), m_cursor_base{}, m_has_cursor(false)
+    {
+        // Nothing has been recorded, so the base must not report a good reading.
+        m_base.status = TemperatureVoteStatus::SensorError;
+        m_last = m_base;
+    }
+
+    void HistoryBuffer::push(const TemperatureVoteResult &sample)
+    {
+        uint8_t record[HISTORY_RECORD_MAX_SIZE];
+        size_type record_size = history_encode(m_last, sample, record);
+
+        while (m_capacity - m_size < record_size && m_record_count > 0)
+        {
+            drop_oldest();
+        }
+
+        if (m_capacity - m_size < record_size)
+        {
+            return;
+        }
+
+        size_type tail = m_head + m_size;
+        for (size_type i = 0; i < record_size; ++i)
+        {
+            if (tail >= m_capacity)
+            {
+                tail -= m_capacity;
+            }
+
+            m_storage[tail] = record[i];
+            ++tail;
+        }
+
+        m_size += record_size;
+        ++m_record_count;
+
+        // Keep the decoded sample rather than the input so that fields outside of the encoding cannot drift.
+        history_decode(m_last, record, record_size);
+    }
+
+    size_type HistoryBuffer::read(uint16_t &offset, uint8_t *dest, size_type max_size, TemperatureVoteResult &base)
+    {
+        uint16_t relative = static_cast<uint16_t>(offset - m_start_offset);
+        if (offset == HISTORY_OFFSET_OLDEST || relative > m_size)
+        {
+            relative = 0;
+        }
+
+        uint8_t record[HISTORY_RECORD_MAX_SIZE];
+        base = m_base;
+        size_type position = 0;
+
+        // A read that continues from the last one starts at the cursor, unless the cursor's record has been dropped.
+        uint16_t cursor_relative = static_cast<uint16_t>(m_cursor_offset - m_start_offset);
+        if (m_has_cursor && offset != HISTORY_OFFSET_OLDEST && offset == m_cursor_offset && cursor_relative <= m_size)
+        {
+            base = m_cursor_base;
+            position = relative;
+        }
+
+        // Otherwise walk from the oldest record to find the sample state at the requested offset. If the offset lands
+        // inside of a record, it is stale, so start from the oldest record instead.
+        while (position < relative)
+        {
+            size_type record_size = copy_record(position, record);
+            if (position + record_size > relative)
+            {
+                base = m_base;
+                position = 0;
+                break;
+            }
+
+            history_decode(base, record, record_size);
+            position += record_size;
+        }
+
+        offset = static_cast<uint16_t>(m_start_offset + position);
+        m_cursor_base = base;
+
+        size_type copied = 0;
+        while (position < m_size)
+        {
+            size_type record_size = copy_record(position, record);
+            if (copied + record_size > max_size)
+            {
+                break;
+            }
+
+            for (size_type i = 0; i < record_size; ++i)
+            {
+                dest[copied + i] = record[i];
+            }
+
+            history_decode(m_cursor_base, record, record_size);
+            copied += record_size;
+            position += record_size;
+        }
+
+        m_cursor_offset = static_cast<uint16_t>(m_start_offset + position);
+        m_has_cursor = true;
+        return copied;
+    }
+
+    uint8_t HistoryBuffer::at(size_type index) const
+    {
+        size_type i = m_head + index;
+        if (i >= m_capacity)
+        {
+            i -= m_capacity;
+        }
+
+        return m_storage[i];
+    }
+
+    size_type HistoryBuffer::copy_record(size_type index, uint8_t *dest) const
+    {
+        uint8_t header = at(index);
+        dest[0] = header;
+
+        size_type size = 1;
+        size_type varint_count = 0;
+
+        if (has_agreement_byte)
+        {
+            dest[size] = at(index + size);
+            ++size;
+        }
+
+        switch ((header & HISTORY_MODE_MASK) >> HISTORY_MODE_SHIFT)
+        {
+        case HISTORY_MODE_SMALL:
+            for (size_type i = 0; i < small_size; ++i)
+            {
+                dest[size] = at(index + size);
+                ++size;
+            }
+            break;
+        case HISTORY_MODE_VARINTS:
+            varint_count = sensor_count;
+            break;
+        default:
+            break;
+        }
+
+        if ((header & HISTORY_AVERAGE_FLAG) != 0)
+        {
+            ++varint_count;
+        }
+
+        // Records in the buffer were written by history_encode, so the varints are well formed.
+        for (size_type i = 0; i < varint_count; ++i)
+        {
+            uint8_t b;
+            do
+            {
+                b = at(index + size);
+                dest[size] = b;
+                ++size;
+            } while ((b & 0x80) != 0);
+        }
+
+        return size;
+    }
+
+    void HistoryBuffer::drop_oldest()
+    {
+        uint8_t record[HISTORY_RECORD_MAX_SIZE];
+        size_type record_size = copy_record(0, record);
+
+        history_decode(m_base, record, record_size);
+
+        m_head += record_size;
+        if (m_head >= m_capacity)
+        {
+            m_head -= m_capacity;
+        }
+
+        m_size -= record_size;
+        m_start_offset += record_size;
+        --m_record_count;
+    }
+} // namespace temperature
+} // namespace scottz0r
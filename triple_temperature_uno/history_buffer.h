@@ -0,0 +1,123 @@
+///
+/// @file
+///
+/// History of recent temperature samples, delta encoded into a byte ring buffer.
+///
+/// Each sample is one record, followed by one agreement byte when there are more than three sensors. The header byte
+/// holds the vote status (bits 0-1), the agreement bits for up to three sensors (bits 2-4) and the encoding of the
+/// sensor temperatures that follow (bits 5-6). Sensor temperatures are stored as zig-zag encoded deltas from the
+/// previous record, in sensor order:
+/// - Unchanged (0): No bytes follow. All sensor temperatures equal the previous record.
+/// - Small (1): Each delta fits in five bits. The deltas are packed little endian, sensor 0 in the lowest bits, into
+///   as many bytes as needed. Two bytes for three sensors.
+/// - Varints (2): One variable length integer per sensor, seven bits per byte with the high bit set on all but the
+///   last.
+///
+/// The average is predicted from the agreeing sensor temperatures, the same way the vote engine computes it. When the
+/// average differs from the prediction, header bit 7 is set and the zig-zag encoded difference follows as a varint.
+#ifndef _SCOTTZ0R_TEMPERATURE_HISTORY_BUFFER_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_HISTORY_BUFFER_INCLUDE_GUARD
+
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    /// @brief Largest encoded record: header, agreement byte, and a three byte varint for each sensor and the average.
+    static constexpr size_type HISTORY_RECORD_MAX_SIZE = 2 + 3 * (TemperatureVoteResult::sensor_count + 1);
+
+    /// @brief Offset that requests a read from the oldest record.
+    static constexpr uint16_t HISTORY_OFFSET_OLDEST = 0xFFFF;
+
+    /// @brief Encode a sample as a record relative to the previous sample.
+    /// @param prev Previous sample. Use a zero initialized result for the first record.
+    /// @param sample Sample to encode.
+    /// @param dest Destination. Must hold at least HISTORY_RECORD_MAX_SIZE bytes.
+    /// @return Number of bytes written.
+    size_type history_encode(const TemperatureVoteResult &prev, const TemperatureVoteResult &sample, uint8_t *dest);
+
+    /// @brief Decode one record.
+    /// @param prev Previous sample. Updated in place to the decoded sample.
+    /// @param src Encoded bytes.
+    /// @param size Number of bytes available at src.
+    /// @return Number of bytes consumed, or 0 if the record is malformed or truncated.
+    size_type history_decode(TemperatureVoteResult &prev, const uint8_t *src, size_type size);
+
+    /// @brief Ring buffer of delta encoded samples. When full, the oldest records are dropped to make room.
+    ///
+    /// Bytes are addressed by a 16-bit logical offset that keeps counting as records are added and dropped. This lets
+    /// a reader resume where it left off, and tells it if records were dropped in the meantime.
+    class HistoryBuffer
+    {
+    public:
+        /// @param storage Byte storage for records. Must outlive this object.
+        /// @param capacity Size of storage. Must be at least HISTORY_RECORD_MAX_SIZE.
+        HistoryBuffer(uint8_t *storage, size_type capacity);
+
+        void push(const TemperatureVoteResult &sample);
+
+        /// @brief Copy whole records into dest.
+        ///
+        /// Finding the sample before a record means decoding every record before it. The end of each read is kept, so
+        /// a read that continues where the last one stopped, like a download, starts there instead of at the oldest
+        /// record.
+        /// @param offset Logical offset of the first record to copy. Replaced with the oldest record's offset if it is
+        /// HISTORY_OFFSET_OLDEST or does not point at a record in the buffer.
+        /// @param dest Destination for the record bytes.
+        /// @param max_size Size of dest.
+        /// @param base Set to the sample before the first copied record. Decoding starts from this sample.
+        /// @return Number of bytes copied. Zero when offset is the end of the buffer.
+        size_type read(uint16_t &offset, uint8_t *dest, size_type max_size, TemperatureVoteResult &base);
+
+        /// @brief Logical offset of the oldest record.
+        uint16_t start_offset() const
+        {
+            return m_start_offset;
+        }
+
+        /// @brief Logical offset one past the newest record.
+        uint16_t end_offset() const
+        {
+            return m_start_offset + m_size;
+        }
+
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        size_type record_count() const
+        {
+            return m_record_count;
+        }
+
+    private:
+        uint8_t at(size_type index) const;
+
+        size_type copy_record(size_type index, uint8_t *dest) const;
+
+        void drop_oldest();
+
+        uint8_t *m_storage;
+        size_type m_capacity;
+
+        size_type m_head;
+        size_type m_size;
+        size_type m_record_count;
+        uint16_t m_start_offset;
+
+        // Sample before the oldest record, and the newest sample.
+        TemperatureVoteResult m_base;
+        TemperatureVoteResult m_last;
+
+        // Offset where the last read stopped, and the sample before it. Only records before it are dropped, so it
+        // stays a record boundary while it is in the buffer.
+        uint16_t m_cursor_offset;
+        TemperatureVoteResult m_cursor_base;
+        bool m_has_cursor;
+    };
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_HISTORY_BUFFER_INCLUDE_GUARD
@@ -0,0 +1,30 @@
+#include "interval_timer.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    IntervalTimer::IntervalTimer(time_type interval) : m_interval(interval), m_last_fired(0)
+    {
+    }
+
+    bool IntervalTimer::is_due(time_type now)
+    {
+        time_type elapsed = now - m_last_fired;
+        if (elapsed < m_interval)
+        {
+            return false;
+        }
+
+        // Re-arm from the current time instead of the previous deadline. If the loop falls behind, this skips missed
+        // intervals instead of firing several times back to back.
+        m_last_fired = now;
+        return true;
+    }
+
+    void IntervalTimer::reset(time_type now)
+    {
+        m_last_fired = now;
+    }
+} // namespace temperature
+} // namespace scottz0r
@@ -0,0 +1,40 @@
+#ifndef _SCOTTZ0R_TEMPERATURE_INTERVAL_TIMER_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_INTERVAL_TIMER_INCLUDE_GUARD
+
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    /// @brief Non-blocking timer that fires once per interval. Intended to be polled from the main loop with the
+    /// current millis() value. Elapsed time is computed with unsigned subtraction, so millis() rollover is handled.
+    class IntervalTimer
+    {
+    public:
+        IntervalTimer(time_type interval);
+
+        /// @brief Check if the interval has elapsed since the timer last fired. Re-arms the timer when true.
+        bool is_due(time_type now);
+
+        /// @brief Restart the interval from the given time.
+        void reset(time_type now);
+
+        time_type interval() const
+        {
+            return m_interval;
+        }
+
+        void set_interval(time_type interval)
+        {
+            m_interval = interval;
+        }
+
+    private:
+        time_type m_interval;
+        time_type m_last_fired;
+    };
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_INTERVAL_TIMER_INCLUDE_GUARD
@@ -1,9 +1,5 @@
 #include "message_format.h"
 
-#define TEMPERATURE_MSG_SIZE 12
-#define SYSTEM_STATUS_MSG_SIZE 4
-#define REQUEST_ERROR_MSG_SIZE 3
-
 namespace scottz0r
 {
 namespace temperature
@@ -13,140 +9,209 @@ namespace temperature
         uint8_t split[2];
     };
 
-    void format_msg_temperature(MessageBuffer &dest, const TemperatureVoteResult &data)
+    static constexpr size_type sensor_count = TemperatureVoteResult::sensor_count;
+
+    /// @brief Write a 16 bit value, little endian.
+    /// @return Index after the written value.
+    static size_type write_uint16(MessageBuffer &dest, size_type index, uint16_t value)
     {
         Uint16Splitter splitter;
+        splitter.num = value;
+        dest.buffer[index] = splitter.split[0];
+        dest.buffer[index + 1] = splitter.split[1];
+        return index + 2;
+    }
 
-        dest.buffer[0] = static_cast<uint8_t>(MessageIdentifier::Temperature);
+    /// @brief Frame the payload that ends before index, and set the message size.
+    static void write_frame(MessageBuffer &dest, size_type index)
+    {
+        dest.message_size = frame_seal(dest.buffer, index - FRAME_PAYLOAD_INDEX);
+    }
+
+    /// @brief Write the temperature fields shared by the temperature and temperature stream messages, from the sensor
+    /// count through the sample age.
+    /// @return Index after the sample age.
+    static size_type format_temperature_fields(
+        MessageBuffer &dest, const TemperatureVoteResult &data, time_type sample_age)
+    {
+        size_type index = FRAME_PAYLOAD_INDEX;
+        dest.buffer[index] = static_cast<uint8_t>(sensor_count);
+        ++index;
 
         // Reading status
         if (data.status < TemperatureVoteStatus::_Unknown)
         {
-            dest.buffer[1] = static_cast<uint8_t>(data.status);
+            dest.buffer[index] = static_cast<uint8_t>(data.status);
         }
         else
         {
-            dest.buffer[1] = static_cast<uint8_t>(TemperatureVoteStatus::_Unknown);
+            dest.buffer[index] = static_cast<uint8_t>(TemperatureVoteStatus::_Unknown);
         }
 
-        // Temperature 0
-        splitter.num = data.temp0;
-        dest.buffer[2] = splitter.split[0];
-        dest.buffer[3] = splitter.split[1];
+        ++index;
+        for (size_type i = 0; i < sensor_count; ++i)
+        {
+            index = write_uint16(dest, index, data.temps[i]);
+        }
+
+        dest.buffer[index] = data.agreement_bits;
+        ++index;
+
+        index = write_uint16(dest, index, data.average);
+
+        // Sample age: Saturate at the largest value that fits in two bytes.
+        return write_uint16(dest, index, sample_age < 0xFFFF ? static_cast<uint16_t>(sample_age) : 0xFFFF);
+    }
+
+    void format_msg_temperature(MessageBuffer &dest, const TemperatureVoteResult &data, time_type sample_age)
+    {
+        dest.buffer[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageIdentifier::Temperature);
+
+        size_type index = format_temperature_fields(dest, data, sample_age);
 
-        // Temperature 1
-        splitter.num = data.temp1;
-        dest.buffer[4] = splitter.split[0];
-        dest.buffer[5] = splitter.split[1];
+        write_frame(dest, index);
+    }
 
-        // Temperature 2
-        splitter.num = data.temp2;
-        dest.buffer[6] = splitter.split[0];
-        dest.buffer[7] = splitter.split[1];
+    void format_msg_temperature_stream(
+        MessageBuffer &dest, const TemperatureVoteResult &data, time_type sample_age, uint8_t sequence)
+    {
+        dest.buffer[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageIdentifier::TemperatureStream);
 
-        // Agreement bits: Pack into a single byte.
-        uint8_t agreement_bits = 0;
+        size_type index = format_temperature_fields(dest, data, sample_age);
+
+        dest.buffer[index] = sequence;
+        ++index;
+
+        write_frame(dest, index);
+    }
 
-        if (data.is_temp0_agree)
+    void format_msg_history(
+        MessageBuffer &dest, uint16_t offset, uint16_t end_offset, const TemperatureVoteResult &base,
+        const uint8_t *data, size_type data_size)
+    {
+        if (data_size > HISTORY_MSG_MAX_DATA)
         {
-            agreement_bits |= 0x01;
+            data_size = HISTORY_MSG_MAX_DATA;
         }
 
-        if (data.is_temp1_agree)
+        dest.buffer[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageIdentifier::HistoryData);
+        dest.buffer[FRAME_PAYLOAD_INDEX] = static_cast<uint8_t>(sensor_count);
+
+        size_type index = write_uint16(dest, FRAME_PAYLOAD_INDEX + 1, offset);
+        index = write_uint16(dest, index, end_offset);
+
+        for (size_type i = 0; i < sensor_count; ++i)
         {
-            agreement_bits |= 0x02;
+            index = write_uint16(dest, index, base.temps[i]);
         }
 
-        if (data.is_temp2_agree)
+        index = write_uint16(dest, index, base.average);
+
+        dest.buffer[index] = static_cast<uint8_t>(data_size);
+        ++index;
+
+        for (size_type i = 0; i < data_size; ++i)
         {
-            agreement_bits |= 0x04;
+            dest.buffer[index + i] = data[i];
         }
 
-        dest.buffer[8] = agreement_bits;
-
-        // Average Temperature
-        splitter.num = data.average;
-        dest.buffer[9] = splitter.split[0];
-        dest.buffer[10] = splitter.split[1];
-
-        // Checksum: XOR all bytes. Unwind loop because message is constant size known at compile time.
-        uint8_t checksum = 0;
-        checksum ^= dest.buffer[0];
-        checksum ^= dest.buffer[1];
-        checksum ^= dest.buffer[2];
-        checksum ^= dest.buffer[3];
-        checksum ^= dest.buffer[4];
-        checksum ^= dest.buffer[5];
-        checksum ^= dest.buffer[6];
-        checksum ^= dest.buffer[7];
-        checksum ^= dest.buffer[8];
-        checksum ^= dest.buffer[9];
-        checksum ^= dest.buffer[10];
-
-        dest.buffer[11] = checksum;
-        dest.message_size = TEMPERATURE_MSG_SIZE;
+        write_frame(dest, index + data_size);
     }
 
     void format_msg_system_status(MessageBuffer &dest, const SystemSensorStatus &status)
     {
-        dest.buffer[0] = static_cast<uint8_t>(MessageIdentifier::SystemStatus);
+        uint8_t *payload = dest.buffer + FRAME_PAYLOAD_INDEX;
+
+        dest.buffer[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageIdentifier::SystemStatus);
+        payload[0] = static_cast<uint8_t>(sensor_count);
 
         if (status.system_status < SystemStatus::_Unknown)
         {
-            dest.buffer[1] = static_cast<uint8_t>(status.system_status);
+            payload[1] = static_cast<uint8_t>(status.system_status);
         }
         else
         {
-            dest.buffer[1] = static_cast<uint8_t>(SystemStatus::_Unknown);
+            payload[1] = static_cast<uint8_t>(SystemStatus::_Unknown);
         }
 
-        // Combine three sensor flags into a single byte for communication.
-        uint8_t sensor_status_byte = 0;
-        if (status.is_sensor_0_good)
-        {
-            sensor_status_byte |= 0x01;
-        }
+        payload[2] = status.sensor_good_bits;
+        payload[3] = status.tx_queue_size;
+        payload[4] = status.tx_queue_peak;
+
+        dest.message_size = frame_seal(dest.buffer, SYSTEM_STATUS_PAYLOAD_SIZE);
+    }
+
+    void format_msg_error(MessageBuffer &dest, ErrorCode error_code)
+    {
+        uint8_t *payload = dest.buffer + FRAME_PAYLOAD_INDEX;
+
+        dest.buffer[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageIdentifier::Error);
 
-        if (status.is_sensor_1_good)
+        if (error_code < ErrorCode::_Unknown)
         {
-            sensor_status_byte |= 0x02;
+            payload[0] = static_cast<uint8_t>(error_code);
         }
-
-        if (status.is_sensor_2_good)
+        else
         {
-            sensor_status_byte |= 0x04;
+            payload[0] = static_cast<uint8_t>(ErrorCode::_Unknown);
         }
 
-        dest.buffer[2] = sensor_status_byte;
+        dest.message_size = frame_seal(dest.buffer, ERROR_PAYLOAD_SIZE);
+    }
 
-        uint8_t checksum = 0;
-        checksum ^= dest.buffer[0];
-        checksum ^= dest.buffer[1];
-        checksum ^= dest.buffer[2];
+    void format_msg_baud_rate(MessageBuffer &dest, unsigned long baud)
+    {
+        dest.buffer[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageIdentifier::BaudRate);
+        size_type index = write_uint16(dest, FRAME_PAYLOAD_INDEX, static_cast<uint16_t>(baud / 100));
+        write_frame(dest, index);
+    }
 
-        dest.buffer[3] = checksum;
-        dest.message_size = SYSTEM_STATUS_MSG_SIZE;
+#if CFG_DIAGNOSTICS
+    /// @brief Write a TimeStats as three 16 bit values.
+    /// @return Index after the written values.
+    static size_type write_time_stats(MessageBuffer &dest, size_type index, const TimeStats &stats)
+    {
+        index = write_uint16(dest, index, stats.min);
+        index = write_uint16(dest, index, stats.average);
+        return write_uint16(dest, index, stats.max);
     }
 
-    void format_msg_error(MessageBuffer &dest, ErrorCode error_code)
+    void format_msg_diagnostics(MessageBuffer &dest, const DiagnosticsReport &report)
     {
-        dest.buffer[0] = static_cast<uint8_t>(MessageIdentifier::Error);
+        dest.buffer[FRAME_TYPE_INDEX] = static_cast<uint8_t>(MessageIdentifier::Diagnostics);
 
-        if (error_code < ErrorCode::_Unknown)
-        {
-            dest.buffer[1] = static_cast<uint8_t>(error_code);
-        }
-        else
+        size_type index = FRAME_PAYLOAD_INDEX;
+        dest.buffer[index] = static_cast<uint8_t>(sensor_count);
+        ++index;
+
+        index = write_uint16(dest, index, report.loop_rate);
+        index = write_uint16(dest, index, report.loop_time_max);
+
+        for (size_type i = 0; i < sensor_count; ++i)
         {
-            dest.buffer[1] = static_cast<uint8_t>(ErrorCode::_Unknown);
+            index = write_time_stats(dest, index, report.sensor_times[i]);
         }
 
-        uint8_t checksum = 0;
-        checksum ^= dest.buffer[0];
-        checksum ^= dest.buffer[1];
+        index = write_time_stats(dest, index, report.reply_latency);
+
+        index = write_uint16(dest, index, static_cast<uint16_t>(report.bytes_received));
+        index = write_uint16(dest, index, static_cast<uint16_t>(report.bytes_received >> 16));
+        index = write_uint16(dest, index, report.bytes_discarded);
+        index = write_uint16(dest, index, report.crc_failures);
+
+        write_frame(dest, index);
+    }
+#endif
+
+    void format_msg_request_id(MessageBuffer &dest, uint8_t request_id)
+    {
+        // The ID goes where the CRC was, and the frame is sealed again with one more payload byte.
+        size_type index = dest.message_size - 1;
+
+        dest.buffer[FRAME_TYPE_INDEX] |= MESSAGE_REQUEST_ID_FLAG;
+        dest.buffer[index] = request_id;
 
-        dest.buffer[2] = checksum;
-        dest.message_size = REQUEST_ERROR_MSG_SIZE;
+        write_frame(dest, index + 1);
     }
 } // namespace temperature
 } // namespace scottz0r
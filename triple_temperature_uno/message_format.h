@@ -1,23 +1,93 @@
 #ifndef _SCOTTZ0R_TEMPERATURE_MESSAGE_FORMAT_INCLUDE_GUARD
 #define _SCOTTZ0R_TEMPERATURE_MESSAGE_FORMAT_INCLUDE_GUARD
 
+#include "history_buffer.h"
+#include "message_frame.h"
 #include "temperature_types.h"
 
 namespace scottz0r
 {
 namespace temperature
 {
+    /// @brief Payload sizes for the sensor count this project is built for. Messages that carry temperatures have the
+    /// sensor count in the first payload byte, followed by two bytes per sensor.
+    static constexpr size_type TEMPERATURE_PAYLOAD_SIZE = 7 + 2 * TemperatureVoteResult::sensor_count;
+    static constexpr size_type TEMPERATURE_STREAM_PAYLOAD_SIZE = TEMPERATURE_PAYLOAD_SIZE + 1;
+    static constexpr size_type HISTORY_PAYLOAD_HEADER_SIZE = 8 + 2 * TemperatureVoteResult::sensor_count;
+    static constexpr size_type SYSTEM_STATUS_PAYLOAD_SIZE = 5;
+    static constexpr size_type ERROR_PAYLOAD_SIZE = 1;
+    static constexpr size_type BAUD_RATE_PAYLOAD_SIZE = 2;
+
+#if CFG_DIAGNOSTICS
+    static constexpr size_type DIAGNOSTICS_PAYLOAD_SIZE = 19 + 6 * TemperatureVoteResult::sensor_count;
+#else
+    static constexpr size_type DIAGNOSTICS_PAYLOAD_SIZE = 0;
+#endif
+
+    /// @brief Most history record bytes carried by one history data message. At least one whole record, or a download
+    /// could never get past a large record.
+    static constexpr size_type HISTORY_MSG_MAX_DATA = HISTORY_RECORD_MAX_SIZE > 16 ? HISTORY_RECORD_MAX_SIZE : 16;
+
+    static_assert(HISTORY_RECORD_MAX_SIZE <= HISTORY_MSG_MAX_DATA, "A history data message must hold any record");
+
+    /// @brief Largest payload this project sends, without a request ID. History data, or diagnostics with more than two
+    /// sensors.
+    static constexpr size_type MAX_PAYLOAD_SIZE =
+        HISTORY_PAYLOAD_HEADER_SIZE + HISTORY_MSG_MAX_DATA > DIAGNOSTICS_PAYLOAD_SIZE
+            ? HISTORY_PAYLOAD_HEADER_SIZE + HISTORY_MSG_MAX_DATA
+            : DIAGNOSTICS_PAYLOAD_SIZE;
+
+    /// @brief A framed message, described in message_frame.h.
     struct MessageBuffer
     {
-        uint8_t buffer[12];
+        // One more byte for a request ID.
+        uint8_t buffer[FRAME_OVERHEAD + MAX_PAYLOAD_SIZE + 1];
         unsigned message_size;
     };
 
-    void format_msg_temperature(MessageBuffer &dest, const TemperatureVoteResult &data);
+    static_assert(
+        sizeof(MessageBuffer::buffer) <= FRAME_OVERHEAD + FRAME_MAX_PAYLOAD, "Messages must fit the frame payload");
+
+    /// @brief Format a temperature message.
+    /// @param dest Buffer to write the message into.
+    /// @param data Vote result to send.
+    /// @param sample_age Milliseconds since the sensors were read. Saturates at 65535.
+    void format_msg_temperature(MessageBuffer &dest, const TemperatureVoteResult &data, time_type sample_age);
+
+    /// @brief Format an unsolicited temperature stream message. Same fields as the temperature message, plus a
+    /// sequence number that increments with every stream message so the host can detect drops.
+    void format_msg_temperature_stream(
+        MessageBuffer &dest, const TemperatureVoteResult &data, time_type sample_age, uint8_t sequence);
+
+    /// @brief Format a history data message.
+    /// @param dest Buffer to write the message into.
+    /// @param offset Logical offset of the first record in data.
+    /// @param end_offset Logical offset one past the newest record in the history buffer.
+    /// @param base Sample to decode the first record against.
+    /// @param data Encoded history records.
+    /// @param data_size Number of bytes in data. Truncated to HISTORY_MSG_MAX_DATA.
+    void format_msg_history(
+        MessageBuffer &dest, uint16_t offset, uint16_t end_offset, const TemperatureVoteResult &base,
+        const uint8_t *data, size_type data_size);
 
     void format_msg_system_status(MessageBuffer &dest, const SystemSensorStatus &status);
 
     void format_msg_error(MessageBuffer &dest, ErrorCode error_code);
+
+    /// @brief Format the acknowledgement of a baud rate change.
+    /// @param baud New baud rate. Sent in hundreds of baud, the unit of the request argument.
+    void format_msg_baud_rate(MessageBuffer &dest, unsigned long baud);
+
+#if CFG_DIAGNOSTICS
+    /// @brief Format a diagnostics message.
+    void format_msg_diagnostics(MessageBuffer &dest, const DiagnosticsReport &report);
+#endif
+
+    /// @brief Mark a formatted message as the reply to a request with a request ID. The ID is appended to the payload
+    /// and MESSAGE_REQUEST_ID_FLAG is set in the type byte.
+    /// @param dest Buffer holding a message written by one of the format functions.
+    /// @param request_id ID from the request.
+    void format_msg_request_id(MessageBuffer &dest, uint8_t request_id);
 } // namespace temperature
 } // namespace scottz0r
 
@@ -0,0 +1,58 @@
+#ifndef _SCOTTZ0R_TEMPERATURE_MESSAGE_FRAME_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_MESSAGE_FRAME_INCLUDE_GUARD
+
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    /// @brief Framing shared by every message in both directions:
+    ///
+    ///     [start] [length] [type] [payload: length bytes] [CRC-8]
+    ///
+    /// Length counts payload bytes only. The CRC covers the length, type and payload, and uses the polynomial 0x07
+    /// with an initial value of zero (CRC-8/SMBUS).
+    static constexpr uint8_t FRAME_START = 0xA5;
+
+    static constexpr size_type FRAME_LENGTH_INDEX = 1;
+    static constexpr size_type FRAME_TYPE_INDEX = 2;
+    static constexpr size_type FRAME_PAYLOAD_INDEX = 3;
+
+    /// @brief Frame bytes other than the payload: start, length, type and CRC.
+    static constexpr size_type FRAME_OVERHEAD = 4;
+
+    /// @brief Largest payload of any message: diagnostics with the most sensors and a request ID.
+    static constexpr size_type FRAME_MAX_PAYLOAD = 19 + 6 * MAX_SENSOR_COUNT + 1;
+
+    enum class FrameStatus : uint8_t
+    {
+        Complete,
+        Incomplete,
+        BadStart,
+        BadLength,
+        BadCrc
+    };
+
+    /// @brief CRC-8 of a block of bytes.
+    /// @param crc CRC of the bytes before data, to continue a CRC over several blocks.
+    uint8_t crc8(const uint8_t *data, size_type size, uint8_t crc = 0);
+
+    /// @brief Write the start byte, length and CRC of a frame whose type and payload are already in place.
+    /// @param frame Frame with the type at FRAME_TYPE_INDEX and the payload from FRAME_PAYLOAD_INDEX.
+    /// @param payload_size Number of payload bytes.
+    /// @return Frame size.
+    size_type frame_seal(uint8_t *frame, size_type payload_size);
+
+    /// @brief Check the frame at the start of the bytes.
+    /// @param data Received bytes, starting with a candidate start byte.
+    /// @param size Number of bytes.
+    /// @param max_payload Largest payload accepted. A larger length is taken as a corrupt length byte.
+    /// @param frame_size Set to the frame size when Complete, or to the fewest bytes still needed when Incomplete.
+    /// @return Complete if a whole frame with a good CRC is at the start of data. Any of the Bad values means this is not
+    /// the start of a frame.
+    FrameStatus frame_parse(const uint8_t *data, size_type size, size_type max_payload, size_type &frame_size);
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_MESSAGE_FRAME_INCLUDE_GUARD
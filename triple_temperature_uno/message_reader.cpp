@@ -2,120 +2,280 @@
 
 #include <Arduino.h>
 
-static constexpr auto REQUEST_MESSAGE_ID = 4; // TODO: Should probably have this in one place for all messages.
-static constexpr auto REQUEST_MESSAGE_SIZE = 3;
+static constexpr auto REQUEST_PAYLOAD_SIZE = 1;
+static constexpr auto REQUEST_ARGUMENT_PAYLOAD_SIZE = 3;
+
+/// @brief True if requests of this type, without the request ID flag, carry a two byte argument.
+static bool has_argument(uint8_t request_type)
+{
+    using scottz0r::temperature::RequestType;
+
+    return request_type == static_cast<uint8_t>(RequestType::HistoryDownload) ||
+           request_type == static_cast<uint8_t>(RequestType::SetBaudRate);
+}
 
 namespace scottz0r
 {
 namespace temperature
 {
     MessageReader::MessageReader(time_type receive_timeout)
-        : m_receive_timeout(receive_timeout), m_buffer_index(0), m_start_receive(0), m_state(State::Start)
+        : m_buffer_index(0), m_bytes_needed(0), m_start_receive(0), m_receive_timeout(receive_timeout),
+          m_state(State::Start), m_queue_head(0), m_queue_count(0)
     {
+#if CFG_DIAGNOSTICS
+        m_bytes_received = 0;
+        m_bytes_discarded = 0;
+        m_crc_failures = 0;
+#endif
     }
 
     bool MessageReader::process(int c)
+    {
+        time_type now = millis();
+        check_timeout(now);
+
+#if CFG_DIAGNOSTICS
+        ++m_bytes_received;
+#endif
+
+        FrameStatus status;
+        if (!collect((uint8_t)c, now, status))
+        {
+            return false;
+        }
+
+        return enqueue(status);
+    }
+
+    size_type MessageReader::process(const uint8_t *data, size_type n)
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        // Every byte of the block has already arrived, so one clock read serves them all.
+        time_type now = millis();
+        check_timeout(now);
+
+        for (size_type i = 0; i < n; ++i)
+        {
+            // The request would be dropped, so its last byte is left for the caller to give again.
+            if (is_full() && is_last_byte())
+            {
+#if CFG_DIAGNOSTICS
+                m_bytes_received += i;
+#endif
+                return i;
+            }
+
+            FrameStatus status;
+            if (collect(data[i], now, status))
+            {
+                enqueue(status);
+            }
+        }
+
+#if CFG_DIAGNOSTICS
+        m_bytes_received += n;
+#endif
+        return n;
+    }
+
+    void MessageReader::check_timeout(time_type now)
     {
         // Message timeout from previous collect. Reset collection state and assume this is a new message.
         if (m_state == State::Collect)
         {
-            time_type elapsed = millis() - m_start_receive;
+            time_type elapsed = now - m_start_receive;
             if (elapsed >= m_receive_timeout)
             {
+#if CFG_DIAGNOSTICS
+                m_bytes_discarded += m_buffer_index;
+#endif
                 m_state = State::Start;
             }
         }
+    }
 
-        if (m_state == State::Done || m_state == State::Start)
+    bool MessageReader::collect(uint8_t c, time_type now, FrameStatus &status)
+    {
+        if (m_state == State::Start)
         {
+            // Bytes outside of a frame are skipped, so collection restarts at the next start byte after noise.
+            if (c != FRAME_START)
+            {
+#if CFG_DIAGNOSTICS
+                ++m_bytes_discarded;
+#endif
+                return false;
+            }
+
             m_buffer_index = 0;
             m_state = State::Collect;
 
-            m_start_receive = millis();
+            m_start_receive = now;
+        }
 
-            // When starting to collect, if the first byte is not the correct message identifier, do not go to
-            // collection state. This means that following bytes could trigger a collect if it contains the start
-            // byte.
-            if (c != REQUEST_MESSAGE_ID)
-            {
-                return false;
-            }
+        // The length byte is checked against the buffer size before the rest of the frame is collected.
+        m_buffer[m_buffer_index] = c;
+        ++m_buffer_index;
+
+        status = frame_parse(m_buffer, m_buffer_index, buffer_size - FRAME_OVERHEAD, m_bytes_needed);
+        if (status == FrameStatus::Incomplete)
+        {
+            return false;
         }
 
-        // Assert buffer collection state before adding byte.
-        if (m_buffer_index < buffer_size)
+        m_state = State::Start;
+
+#if CFG_DIAGNOSTICS
+        if (status != FrameStatus::Complete)
         {
-            m_buffer[m_buffer_index] = (uint8_t)c;
-            ++m_buffer_index;
+            m_bytes_discarded += m_buffer_index;
         }
-        else
+
+        if (status == FrameStatus::BadCrc)
         {
-            // Buffer overflow. Restart collection.
-            m_state = State::Start;
+            ++m_crc_failures;
+        }
+#endif
+
+        // Too long to be a request, so the length byte is probably noise. There is nothing to answer.
+        return status != FrameStatus::BadLength;
+    }
+
+    bool MessageReader::enqueue(FrameStatus status)
+    {
+        if (is_full())
+        {
+#if CFG_DIAGNOSTICS
+            m_bytes_discarded += m_buffer_index;
+#endif
             return false;
         }
 
-        if (m_buffer_index == REQUEST_MESSAGE_SIZE)
+        size_type tail = m_queue_head + m_queue_count;
+        if (tail >= queue_size)
         {
-            m_state = State::Done;
-            return true;
+            tail -= queue_size;
         }
 
-        return false;
+        m_queue[tail].is_valid = decode_request_message(status, m_queue[tail].message);
+        ++m_queue_count;
+
+        return true;
     }
 
     void MessageReader::reset()
     {
         m_buffer_index = 0;
         m_state = State::Start;
+        m_queue_head = 0;
+        m_queue_count = 0;
     }
 
     bool MessageReader::get_data(RequestType &dest)
     {
-        if (m_state != State::Done)
+        RequestMessage message;
+        bool result = get_data(message);
+        dest = message.type;
+        return result;
+    }
+
+    bool MessageReader::get_data(RequestMessage &dest)
+    {
+        if (m_queue_count == 0)
         {
+            dest.type = RequestType::_Unknown;
+            dest.argument = 0;
+            dest.has_request_id = false;
+            dest.request_id = 0;
             return false;
         }
 
-        return decode_request_message(dest);
+        const QueueEntry &entry = m_queue[m_queue_head];
+        dest = entry.message;
+
+        ++m_queue_head;
+        if (m_queue_head >= queue_size)
+        {
+            m_queue_head = 0;
+        }
+
+        --m_queue_count;
+
+        return entry.is_valid;
     }
 
-    bool MessageReader::decode_request_message(RequestType &dest)
+    bool MessageReader::decode_request_message(FrameStatus status, RequestMessage &dest)
     {
         // Set output parameter to a default state.
-        dest = RequestType::_Unknown;
+        dest.type = RequestType::_Unknown;
+        dest.argument = 0;
+        dest.has_request_id = false;
+        dest.request_id = 0;
 
-        // Assert buffer size is expected size.
-        if (m_buffer_index != REQUEST_MESSAGE_SIZE)
+        // Do not attempt to decode data if the CRC is bad.
+        if (status != FrameStatus::Complete)
         {
             return false;
         }
 
         // Assert this really is a request message type.
-        if (m_buffer[0] != REQUEST_MESSAGE_ID)
+        if (m_buffer[FRAME_TYPE_INDEX] != static_cast<uint8_t>(MessageIdentifier::Request))
         {
             return false;
         }
 
-        // Checksum. Return false if checksums do not match. Do not attempt to decode data if checksum is bad.
-        uint8_t checksum = 0;
-        checksum ^= m_buffer[0];
-        checksum ^= m_buffer[1];
-
-        if (checksum != m_buffer[2])
+        // The request type byte determines the payload size.
+        const uint8_t *payload = m_buffer + FRAME_PAYLOAD_INDEX;
+        size_type payload_size = m_buffer[FRAME_LENGTH_INDEX];
+        if (payload_size < REQUEST_PAYLOAD_SIZE || payload_size != request_payload_size(payload[0]))
         {
             return false;
         }
 
+        // The request ID follows the request type, before any argument.
+        size_type index = 1;
+        if ((payload[0] & MESSAGE_REQUEST_ID_FLAG) != 0)
+        {
+            dest.has_request_id = true;
+            dest.request_id = payload[index];
+            ++index;
+        }
+
         // Assert message enumeration type is within bounds.
-        if (m_buffer[1] >= static_cast<uint8_t>(RequestType::_Unknown))
+        uint8_t request_type = payload[0] & ~MESSAGE_REQUEST_ID_FLAG;
+        if (request_type >= static_cast<uint8_t>(RequestType::_Unknown))
         {
             return false;
         }
 
-        dest = static_cast<RequestType>(m_buffer[1]);
+        dest.type = static_cast<RequestType>(request_type);
+
+        if (has_argument(request_type))
+        {
+            dest.argument = static_cast<uint16_t>(payload[index] | (payload[index + 1] << 8));
+        }
 
         return true;
     }
+
+    size_type MessageReader::request_payload_size(uint8_t request_type)
+    {
+        size_type size = REQUEST_PAYLOAD_SIZE;
+        if (has_argument(request_type & ~MESSAGE_REQUEST_ID_FLAG))
+        {
+            size = REQUEST_ARGUMENT_PAYLOAD_SIZE;
+        }
+
+        if ((request_type & MESSAGE_REQUEST_ID_FLAG) != 0)
+        {
+            ++size;
+        }
+
+        return size;
+    }
 } // namespace temperature
 } // namespace scottz0r
@@ -1,6 +1,7 @@
 #ifndef _SCOTTZ0R_TEMPERATURE_MESSAGE_READER_INCLUDE_GUARD
 #define _SCOTTZ0R_TEMPERATURE_MESSAGE_READER_INCLUDE_GUARD
 
+#include "message_frame.h"
 #include "temperature_types.h"
 
 namespace scottz0r
@@ -11,38 +12,151 @@ namespace temperature
     {
         Temperature = 0,
         SystemStatus = 1,
-        _Unknown = 2
+        StreamStart = 2,
+        StreamStop = 3,
+        Subscribe = 4,
+        HistoryDownload = 5,
+        SetBaudRate = 6,
+        Diagnostics = 7,
+        _Unknown = 8
     };
 
+    /// @brief Decoded request. Argument is only used by requests that carry one, and is zero otherwise. The request ID
+    /// is only set when has_request_id is true, and is echoed in the reply so a host can match pipelined replies.
+    struct RequestMessage
+    {
+        RequestType type;
+        uint16_t argument;
+        bool has_request_id;
+        uint8_t request_id;
+    };
+
+    /// @brief Collects request bytes into request messages. Complete requests are queued until they are read with
+    /// get_data, oldest first, so a host can send several requests back to back.
     class MessageReader
     {
         enum class State
         {
             Start,
-            Collect,
-            Done
+            Collect
+        };
+
+        struct QueueEntry
+        {
+            RequestMessage message;
+            bool is_valid;
         };
 
     public:
         MessageReader(time_type receive_timeout);
 
-        static constexpr size_type buffer_size = 8;
+        /// @brief Largest request frame: request type, request ID and a two byte argument.
+        static constexpr size_type buffer_size = FRAME_OVERHEAD + 4;
 
+        static constexpr size_type queue_size = CFG_REQUEST_QUEUE_SIZE;
+
+        /// @brief Add a received byte. Bytes are skipped until a frame start byte, and a frame with a length too large
+        /// for a request is dropped.
+        /// @return True if the byte completed a request, which is now queued. Requests that fail to decode, including
+        /// frames with a bad CRC, are queued too, and get_data returns false for them. If the queue is full, a
+        /// completed request is dropped and false is returned, so stop calling this while is_full() is true.
         bool process(int c);
 
+        /// @brief Add a block of received bytes. The clock is read once for the block, for the timeout of a request
+        /// started in an earlier block and the start time of any request in this one.
+        /// @return Number of bytes used. Every request completed by them is queued. Processing stops before a byte that
+        /// would complete a request while the queue is full, so no request is dropped.
+        size_type process(const uint8_t *data, size_type n);
+
+        /// @brief Bytes that process is sure to use. Only the request being collected can complete in fewer bytes than
+        /// a frame, so each free queue entry covers FRAME_OVERHEAD bytes.
+        size_type batch_capacity() const
+        {
+            return (queue_size - m_queue_count) * FRAME_OVERHEAD;
+        }
+
+        /// @brief Clear the request being collected and all queued requests.
         void reset();
 
+        /// @brief Number of queued requests.
+        size_type pending() const
+        {
+            return m_queue_count;
+        }
+
+        bool is_full() const
+        {
+            return m_queue_count >= queue_size;
+        }
+
         bool get_data(RequestType &dest);
 
+#if CFG_DIAGNOSTICS
+        /// @brief Bytes used by process since boot.
+        uint32_t bytes_received() const
+        {
+            return m_bytes_received;
+        }
+
+        /// @brief Bytes skipped outside of a frame, and bytes of frames that timed out, had a bad length or CRC, or
+        /// were dropped because the queue was full.
+        uint16_t bytes_discarded() const
+        {
+            return m_bytes_discarded;
+        }
+
+        /// @brief Frames with a bad CRC.
+        uint16_t crc_failures() const
+        {
+            return m_crc_failures;
+        }
+#endif
+
+        /// @brief Remove the oldest queued request.
+        /// @param dest Decoded request. Type is RequestType::_Unknown if nothing is queued or the request is bad. The
+        /// request ID is kept for a bad request when its CRC is good.
+        /// @return True if a request was queued and decoded.
+        bool get_data(RequestMessage &dest);
+
     private:
-        bool decode_request_message(RequestType &dest);
+        /// @brief Drop a partly received request if it was started too long ago.
+        void check_timeout(time_type now);
+
+        /// @brief Add a byte to the request being collected.
+        /// @return True if the byte completed a frame, with status set to its FrameStatus.
+        bool collect(uint8_t c, time_type now, FrameStatus &status);
+
+        /// @brief True if the next byte completes the frame being collected.
+        bool is_last_byte() const
+        {
+            return m_state == State::Collect && m_buffer_index > FRAME_LENGTH_INDEX && m_bytes_needed == 1;
+        }
+
+        /// @brief Queue the collected frame.
+        /// @return False if the queue is full and the request was dropped.
+        bool enqueue(FrameStatus status);
+
+        bool decode_request_message(FrameStatus status, RequestMessage &dest);
+
+        static size_type request_payload_size(uint8_t request_type);
 
         uint8_t m_buffer[buffer_size];
         size_type m_buffer_index;
+        size_type m_bytes_needed;
 
         time_type m_start_receive;
         time_type m_receive_timeout;
         State m_state;
+
+        QueueEntry m_queue[queue_size];
+        size_type m_queue_head;
+        size_type m_queue_count;
+
+#if CFG_DIAGNOSTICS
+        uint32_t m_bytes_received;
+        uint16_t m_bytes_discarded;
+        uint16_t m_crc_failures;
+#endif
     };
 } // namespace temperature
 } // namespace scottz0r
@@ -4,15 +4,57 @@
 // Timeout for a single message received over serial communication. Milliseconds.
 #define CFG_SERIAL_MESSAGE_TIMEOUT 10
 
+// Number of complete requests the message reader holds until they are handled. Requests sent back to back wait here,
+// and further bytes wait in the serial receive buffer while it is full.
+#define CFG_REQUEST_QUEUE_SIZE 4
+
 // Tolerance to use when voting on temperature agreement. In 100s of Celsius (100 = 1.00 C).
 #define CFG_TEMPERATURE_TOLERANCE 50
 
-// I2C addresses for MCP 9808 sensors.
-#define CFG_SENSOR_0_ADDR 0x18
-#define CFG_SENSOR_1_ADDR 0x19
-#define CFG_SENSOR_2_ADDR 0x1A
+// Minimum period between background sensor samples. Temperature requests are answered from the most recent sample.
+// The effective period is never shorter than the sensor conversion time, so the same conversion is not read twice.
+// Zero samples as fast as the sensors convert. Milliseconds.
+#define CFG_SAMPLE_PERIOD 0
+
+// MCP 9808 resolution register value.
+// 0 = 0.5 C (30ms conversion), 1 = 0.25 C (65ms), 2 = 0.125 C (130ms), 3 = 0.0625 C (250ms).
+#define CFG_SENSOR_RESOLUTION 3
+
+// While streaming, send a temperature stream message for every N-th background sample.
+#define CFG_STREAM_SAMPLE_DIVIDER 1
+
+// While subscribed, send a temperature stream message only when the average moves more than the deadband, the status
+// or agreement bits change, or the heartbeat interval passes. Deadband in 100s of Celsius, heartbeat in milliseconds.
+#define CFG_REPORT_DEADBAND 10
+#define CFG_REPORT_HEARTBEAT 60000
+
+// Bytes of SRAM given to the sample history. Most records take one or three bytes, so 384 bytes holds a few hundred
+// samples.
+#define CFG_HISTORY_SIZE 384
+
+// Minimum period between background samples recorded in the history. Milliseconds.
+#define CFG_HISTORY_PERIOD 10000
 
-// Serial baud rate for message communication.
+// Number of MCP 9808 sensors that vote on the temperature. Between 1 and 8, though voting needs at least 2.
+#define CFG_SENSOR_COUNT 3
+
+// I2C addresses for MCP 9808 sensors, one per sensor in sensor order. The MCP 9808 can use 0x18 through 0x1F.
+#define CFG_SENSOR_ADDRESSES {0x18, 0x19, 0x1A}
+
+// Bytes of SRAM for messages waiting to be written to serial. Messages are written as the serial transmit buffer has
+// room, so the main loop never blocks on output. Requests are only answered while the largest message fits. At most
+// 255.
+#define CFG_TX_QUEUE_SIZE 128
+
+// 1 to keep performance counters for the Diagnostics request: loop rate and time, sensor read times, reply latency and
+// request reader byte counts. 0 compiles them out, and Diagnostics requests are answered with a Bad Request error.
+#define CFG_DIAGNOSTICS 1
+
+// Serial baud rate for message communication. The host can switch to a faster rate with a Set Baud Rate request.
 #define CFG_SERIAL_BAUD_RATE 115200
 
+// Time the host has to send a valid request at a new baud rate before the device falls back to CFG_SERIAL_BAUD_RATE.
+// Milliseconds.
+#define CFG_BAUD_CONFIRM_TIMEOUT 500
+
 #endif // _SCOTTZ0R_TEMPERATURE_PRJ_CONFIG_INCLUDE_GUARD
@@ -5,30 +5,68 @@
 #include <Wire.h>
 #include <avr/wdt.h>
 
+#include "baud_switch.h"
+#include "diagnostics.h"
+#include "history_buffer.h"
+#include "interval_timer.h"
 #include "message_format.h"
 #include "message_reader.h"
 #include "prj_config.h"
+#include "sample_cache.h"
 #include "sensor_mcp_9808.h"
+#include "stream_scheduler.h"
 #include "temperature_engine.h"
+#include "temperature_sampler.h"
+#include "tx_queue.h"
 
 using namespace scottz0r::temperature;
 
 SystemStatus system_status;
 
-SensorMcp9808 temp_0;
-SensorMcp9808 temp_1;
-SensorMcp9808 temp_2;
+static const uint8_t sensor_addresses[] = CFG_SENSOR_ADDRESSES;
+static_assert(sizeof(sensor_addresses) == CFG_SENSOR_COUNT, "CFG_SENSOR_ADDRESSES must have CFG_SENSOR_COUNT entries");
+
+SensorMcp9808 sensors[CFG_SENSOR_COUNT];
 
 TemperatureVoteEngine temperature_vote_engine(CFG_TEMPERATURE_TOLERANCE);
-TemperatureVoteResult temp_vote_result;
+SampleCache sample_cache;
+IntervalTimer sample_timer(CFG_SAMPLE_PERIOD);
+TemperatureSampler temperature_sampler(sensors, temperature_vote_engine, sample_cache);
+StreamScheduler stream_scheduler(CFG_STREAM_SAMPLE_DIVIDER, CFG_REPORT_DEADBAND, CFG_REPORT_HEARTBEAT);
+
+uint8_t history_storage[CFG_HISTORY_SIZE];
+HistoryBuffer history_buffer(history_storage, CFG_HISTORY_SIZE);
+IntervalTimer history_timer(CFG_HISTORY_PERIOD);
+bool is_history_download = false;
+uint16_t history_download_offset = 0;
+RequestMessage history_download_request;
 
 MessageReader message_reader(CFG_SERIAL_MESSAGE_TIMEOUT);
 MessageBuffer message_buffer;
 
-void collect_send_temperature();
-void collect_send_system_status();
+static_assert(CFG_TX_QUEUE_SIZE >= sizeof(MessageBuffer::buffer), "CFG_TX_QUEUE_SIZE must hold the largest message");
+static_assert(CFG_TX_QUEUE_SIZE <= 255, "CFG_TX_QUEUE_SIZE is reported in one byte");
+uint8_t tx_storage[CFG_TX_QUEUE_SIZE];
+TxQueue tx_queue(tx_storage, CFG_TX_QUEUE_SIZE);
+
+BaudSwitch baud_switch(CFG_SERIAL_BAUD_RATE, CFG_BAUD_CONFIRM_TIMEOUT);
+
+Diagnostics diagnostics;
+
+void collect_send_system_status(const RequestMessage &request);
 void handle_request();
-void send_error(ErrorCode error_code);
+void poll_baud_switch();
+void poll_history_download();
+void poll_sampler();
+void poll_transmit();
+void send_diagnostics(const RequestMessage &request);
+void send_error(ErrorCode error_code, const RequestMessage &request);
+bool send_ready();
+void send_reply(const RequestMessage &request);
+void send_temperature(const RequestMessage &request);
+void send_temperature_stream(time_type now);
+void set_baud_rate(const RequestMessage &request);
+void start_stream(StreamMode mode, const RequestMessage &request);
 
 /// @brief Main program setup function.
 void setup()
@@ -39,9 +77,37 @@ void setup()
     Wire.begin();
 
     // Initialize sensors.
-    temp_0.begin(CFG_SENSOR_0_ADDR);
-    temp_1.begin(CFG_SENSOR_1_ADDR);
-    temp_2.begin(CFG_SENSOR_2_ADDR);
+    const Mcp9808Resolution resolution = static_cast<Mcp9808Resolution>(CFG_SENSOR_RESOLUTION);
+    for (size_type i = 0; i < CFG_SENSOR_COUNT; ++i)
+    {
+        sensors[i].begin(sensor_addresses[i], resolution);
+    }
+
+    // Sample no faster than the sensors convert, so every sample is a new conversion.
+    time_type conversion_time = SensorMcp9808::conversion_time(resolution);
+    time_type sample_period = conversion_time;
+#if CFG_SAMPLE_PERIOD > 0
+    if (CFG_SAMPLE_PERIOD > conversion_time)
+    {
+        sample_period = CFG_SAMPLE_PERIOD;
+    }
+#endif
+    sample_timer.set_interval(sample_period);
+
+    // The first conversion at the new resolution completes one conversion time after it is written.
+    delay(conversion_time);
+
+    // Take the first sample before accepting requests so the cache is never empty.
+    temperature_sampler.start();
+    while (temperature_sampler.busy())
+    {
+        temperature_sampler.poll(millis());
+    }
+
+    sample_timer.reset(millis());
+
+    history_buffer.push(sample_cache.front());
+    history_timer.reset(millis());
 
     system_status = SystemStatus::OK;
 
@@ -51,83 +117,323 @@ void setup()
 /// @brief Main program loop.
 void loop()
 {
-    if (Serial.available())
+    diagnostics.on_loop();
+
+    // Take every byte that has arrived, so requests sent back to back are queued instead of waiting for later passes.
+    // Blocks are no larger than the queue is sure to take, and while it is full, bytes wait in the serial receive
+    // buffer.
+    uint8_t batch[MessageReader::queue_size * FRAME_OVERHEAD];
+    for (;;)
     {
-        int c = Serial.read();
-        bool has_request = message_reader.process(c);
+        size_type n = message_reader.batch_capacity();
+        int available = Serial.available();
+        if (available < (int)n)
+        {
+            n = available;
+        }
+
+        if (n == 0)
+        {
+            break;
+        }
 
-        if (has_request)
+        for (size_type i = 0; i < n; ++i)
         {
-            handle_request();
+            batch[i] = (uint8_t)Serial.read();
         }
+
+        size_type pending = message_reader.pending();
+        message_reader.process(batch, n);
+        diagnostics.on_requests_received(message_reader.pending() - pending);
+    }
+
+    // One request per pass keeps the time between watchdog resets short. While the reply would not fit in the
+    // transmit queue, requests wait in the request queue.
+    if (message_reader.pending() > 0 && send_ready())
+    {
+        size_type queued = tx_queue.size();
+        handle_request();
+        diagnostics.on_request_handled(queued, tx_queue.size());
     }
 
+    poll_sampler();
+    poll_history_download();
+    poll_transmit();
+    poll_baud_switch();
+
     wdt_reset();
 }
 
-void collect_send_temperature()
+/// @brief Start a sample cycle when one is due and advance it by one I2C transaction per loop pass, so serial
+/// requests are serviced between sensor reads.
+void poll_sampler()
+{
+    time_type now = millis();
+
+    if (!temperature_sampler.busy() && sample_timer.is_due(now))
+    {
+        temperature_sampler.start();
+    }
+
+    // A poll while busy is one step of the sensor the sampler is on.
+    size_type sensor = temperature_sampler.sensor_index();
+    bool is_step = temperature_sampler.busy();
+    if (is_step)
+    {
+        diagnostics.begin_sampler_step();
+    }
+
+    bool is_published = temperature_sampler.poll(now);
+
+    if (is_step)
+    {
+        diagnostics.end_sampler_step(sensor);
+    }
+
+    if (is_published)
+    {
+        if (history_timer.is_due(now))
+        {
+            history_buffer.push(sample_cache.front());
+        }
+
+        if (stream_scheduler.on_sample(sample_cache.front(), now))
+        {
+            send_temperature_stream(now);
+        }
+    }
+}
+
+/// @brief Send the next history data message of a download in progress. One message goes out per loop pass so the
+/// rest of the loop keeps running. The download ends with the message that reaches the newest record, or with an error
+/// if a read makes no progress before it.
+void poll_history_download()
+{
+    if (!is_history_download || !send_ready())
+    {
+        return;
+    }
+
+    uint8_t data[HISTORY_MSG_MAX_DATA];
+    TemperatureVoteResult base;
+    size_type data_size = history_buffer.read(history_download_offset, data, HISTORY_MSG_MAX_DATA, base);
+
+    if (data_size == 0 && history_download_offset != history_buffer.end_offset())
+    {
+        is_history_download = false;
+        send_error(ErrorCode::SystemFailure, history_download_request);
+        return;
+    }
+
+    format_msg_history(message_buffer, history_download_offset, history_buffer.end_offset(), base, data, data_size);
+    send_reply(history_download_request);
+
+    history_download_offset += data_size;
+    if (history_download_offset == history_buffer.end_offset())
+    {
+        is_history_download = false;
+    }
+}
+
+/// @brief Send the message in the message buffer as the reply to a request, echoing the request ID if it has one.
+void send_reply(const RequestMessage &request)
+{
+    if (request.has_request_id)
+    {
+        format_msg_request_id(message_buffer, request.request_id);
+    }
+
+    tx_queue.push(message_buffer.buffer, message_buffer.message_size);
+}
+
+/// @brief True if the transmit queue has room for the largest message.
+bool send_ready()
+{
+    return tx_queue.free_space() >= sizeof(MessageBuffer::buffer);
+}
+
+/// @brief Write as much of the transmit queue as the serial transmit buffer has room for, so Serial.write never
+/// blocks. The rest is written on later passes.
+void poll_transmit()
+{
+    int room = Serial.availableForWrite();
+    while (room > 0 && !tx_queue.empty())
+    {
+        const uint8_t *data;
+        size_type size = tx_queue.front(data);
+        if ((int)size > room)
+        {
+            size = room;
+        }
+
+        Serial.write(data, size);
+        tx_queue.pop(size);
+        diagnostics.on_bytes_written(size);
+        room -= size;
+    }
+}
+
+/// @brief Restart the serial port when a baud rate change is due. The change waits until the transmit queue is empty,
+/// and flush waits for the rest of the serial transmit buffer, at most 64 bytes of wire time, so the acknowledgement
+/// goes out whole at the old rate.
+void poll_baud_switch()
+{
+    unsigned long baud = baud_switch.poll(millis(), tx_queue.empty());
+    if (baud != 0)
+    {
+        Serial.flush();
+        Serial.begin(baud);
+    }
+}
+
+/// @brief Acknowledge a baud rate change at the current rate. The port switches once the acknowledgement is written.
+void set_baud_rate(const RequestMessage &request)
+{
+    unsigned long baud = request.argument * 100UL;
+    if (!baud_switch.request(baud))
+    {
+        send_error(ErrorCode::BadRequest, request);
+        return;
+    }
+
+    format_msg_baud_rate(message_buffer, baud);
+    send_reply(request);
+}
+
+/// @brief Send the most recent cached sample. Does not touch the I2C bus.
+void send_temperature(const RequestMessage &request)
 {
-    TemperatureReading temp_0_value;
-    TemperatureReading temp_1_value;
-    TemperatureReading temp_2_value;
+    format_msg_temperature(message_buffer, sample_cache.front(), sample_cache.age(millis()));
+    send_reply(request);
+}
 
-    temp_0_value.is_valid = temp_0.read_temp(temp_0_value.temperature);
-    temp_1_value.is_valid = temp_1.read_temp(temp_1_value.temperature);
-    temp_2_value.is_valid = temp_2.read_temp(temp_2_value.temperature);
+/// @brief Send the most recent cached sample as an unsolicited stream message.
+void send_temperature_stream(time_type now)
+{
+    const TemperatureVoteResult &sample = sample_cache.front();
+    format_msg_temperature_stream(message_buffer, sample, sample_cache.age(millis()), stream_scheduler.next_sequence());
 
-    temperature_vote_engine.vote_temperature(temp_0_value, temp_1_value, temp_2_value, temp_vote_result);
+    // Dropped when the host reads too slowly to keep up. The sequence number tells the host, and an unsent change
+    // stays due, so it goes out with a later sample.
+    if (tx_queue.push(message_buffer.buffer, message_buffer.message_size))
+    {
+        stream_scheduler.on_sent(sample, now);
+    }
+}
 
-    format_msg_temperature(message_buffer, temp_vote_result);
+/// @brief Start streaming in the given mode. The current sample is sent right away, which also acknowledges the
+/// request.
+void start_stream(StreamMode mode, const RequestMessage &request)
+{
+    stream_scheduler.start(mode, sample_cache.front(), millis());
 
-    // TODO: Serial available so not blocking wdt if full.
-    Serial.write(message_buffer.buffer, message_buffer.message_size);
+    format_msg_temperature_stream(
+        message_buffer, sample_cache.front(), sample_cache.age(millis()), stream_scheduler.next_sequence());
+    send_reply(request);
 }
 
-void collect_send_system_status()
+void collect_send_system_status(const RequestMessage &request)
 {
     SystemSensorStatus status;
-    status.is_sensor_0_good = temp_0.good();
-    status.is_sensor_1_good = temp_1.good();
-    status.is_sensor_2_good = temp_2.good();
+    status.sensor_good_bits = 0;
     status.system_status = system_status;
+    status.tx_queue_size = static_cast<uint8_t>(tx_queue.size());
+    status.tx_queue_peak = static_cast<uint8_t>(tx_queue.peak());
+
+    for (size_type i = 0; i < CFG_SENSOR_COUNT; ++i)
+    {
+        if (sensors[i].good())
+        {
+            status.sensor_good_bits |= 1 << i;
+        }
+    }
 
     format_msg_system_status(message_buffer, status);
+    send_reply(request);
+}
+
+/// @brief Send the performance counters. Without CFG_DIAGNOSTICS the request is answered with an error.
+void send_diagnostics(const RequestMessage &request)
+{
+#if CFG_DIAGNOSTICS
+    DiagnosticsReport report;
+    diagnostics.report(report);
+    report.bytes_received = message_reader.bytes_received();
+    report.bytes_discarded = message_reader.bytes_discarded();
+    report.crc_failures = message_reader.crc_failures();
 
-    Serial.write(message_buffer.buffer, message_buffer.message_size);
+    format_msg_diagnostics(message_buffer, report);
+    send_reply(request);
+#else
+    send_error(ErrorCode::BadRequest, request);
+#endif
 }
 
-void send_error(ErrorCode error_code)
+void send_error(ErrorCode error_code, const RequestMessage &request)
 {
     format_msg_error(message_buffer, error_code);
-    Serial.write(message_buffer.buffer, message_buffer.message_size);
+    send_reply(request);
 }
 
+/// @brief Handle the oldest queued request. Requests are answered in the order they were received.
 void handle_request()
 {
+    RequestMessage request;
+    bool is_valid = message_reader.get_data(request);
+
     // Do not try to do anything with request if system is not OK.
     if (system_status != SystemStatus::OK)
     {
-        send_error(ErrorCode::SystemFailure);
+        send_error(ErrorCode::SystemFailure, request);
         return;
     }
 
-    RequestType request_type;
-    if (!message_reader.get_data(request_type))
+    if (!is_valid)
     {
-        send_error(ErrorCode::BadRequest);
+        send_error(ErrorCode::BadRequest, request);
         return;
     }
 
-    switch (request_type)
+    // A valid request after a baud rate change shows the host switched too.
+    baud_switch.confirm();
+
+    switch (request.type)
     {
     case RequestType::Temperature:
-        collect_send_temperature();
+        send_temperature(request);
         break;
     case RequestType::SystemStatus:
-        collect_send_system_status();
+        collect_send_system_status(request);
+        break;
+    case RequestType::StreamStart:
+        start_stream(StreamMode::Periodic, request);
+        break;
+    case RequestType::Subscribe:
+        start_stream(StreamMode::OnChange, request);
+        break;
+    case RequestType::StreamStop:
+        // A request with an ID is acknowledged with a status message, so a host matching replies to requests is not
+        // left waiting. Every stream message is queued before it.
+        stream_scheduler.stop();
+        if (request.has_request_id)
+        {
+            collect_send_system_status(request);
+        }
+        break;
+    case RequestType::HistoryDownload:
+        // Replies are sent from the main loop. A new request restarts any download in progress.
+        is_history_download = true;
+        history_download_offset = request.argument;
+        history_download_request = request;
+        break;
+    case RequestType::SetBaudRate:
+        set_baud_rate(request);
+        break;
+    case RequestType::Diagnostics:
+        send_diagnostics(request);
         break;
     default:
-        send_error(ErrorCode::BadRequest);
+        send_error(ErrorCode::BadRequest, request);
         break;
     }
 }
@@ -0,0 +1,40 @@
+#include "report_filter.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    ReportFilter::ReportFilter(temperature_type deadband, time_type heartbeat_interval)
+        : m_deadband(deadband), m_heartbeat_interval(heartbeat_interval), m_last_report_time(0), m_last_average(0),
+          m_last_status(TemperatureVoteStatus::_Unknown), m_last_agreement_bits(0), m_has_report(false)
+    {
+    }
+
+    bool ReportFilter::is_due(const TemperatureVoteResult &sample, time_type now) const
+    {
+        if (!m_has_report)
+        {
+            return true;
+        }
+
+        // Compute in 32 bits so the difference of two extreme temperatures cannot overflow.
+        int32_t diff = (int32_t)sample.average - (int32_t)m_last_average;
+        if (diff < 0)
+        {
+            diff = -diff;
+        }
+
+        return diff > m_deadband || sample.status != m_last_status || sample.agreement_bits != m_last_agreement_bits ||
+               (now - m_last_report_time) >= m_heartbeat_interval;
+    }
+
+    void ReportFilter::mark_reported(const TemperatureVoteResult &sample, time_type now)
+    {
+        m_last_report_time = now;
+        m_last_average = sample.average;
+        m_last_status = sample.status;
+        m_last_agreement_bits = sample.agreement_bits;
+        m_has_report = true;
+    }
+} // namespace temperature
+} // namespace scottz0r
@@ -0,0 +1,39 @@
+#ifndef _SCOTTZ0R_TEMPERATURE_REPORT_FILTER_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_REPORT_FILTER_INCLUDE_GUARD
+
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    /// @brief Decides if a sample is different enough from the last reported sample to be worth sending. A sample is
+    /// reported when the voted average moves more than the deadband, when the status or agreement bits change, or when
+    /// the heartbeat interval has passed since the last report.
+    class ReportFilter
+    {
+    public:
+        /// @param deadband Largest change in average that is not reported. In 100s of Celsius.
+        /// @param heartbeat_interval Report at least this often, even if nothing changed. Milliseconds.
+        ReportFilter(temperature_type deadband, time_type heartbeat_interval);
+
+        /// @brief Check a sample against the last report, without recording it.
+        bool is_due(const TemperatureVoteResult &sample, time_type now) const;
+
+        /// @brief Record a sample as reported. Call once it has been sent.
+        void mark_reported(const TemperatureVoteResult &sample, time_type now);
+
+    private:
+        temperature_type m_deadband;
+        time_type m_heartbeat_interval;
+
+        time_type m_last_report_time;
+        temperature_type m_last_average;
+        TemperatureVoteStatus m_last_status;
+        uint8_t m_last_agreement_bits;
+        bool m_has_report;
+    };
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_REPORT_FILTER_INCLUDE_GUARD
@@ -0,0 +1,41 @@
+#include "sample_cache.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    SampleCache::SampleCache() : m_buffers{}, m_sample_time(0), m_front_index(0), m_has_sample(false)
+    {
+        // Nothing has been sampled yet, so the front buffer must not report a good reading.
+        m_buffers[0].status = TemperatureVoteStatus::SensorError;
+        m_buffers[1].status = TemperatureVoteStatus::SensorError;
+    }
+
+    TemperatureVoteResult &SampleCache::back()
+    {
+        return m_buffers[m_front_index ^ 1];
+    }
+
+    void SampleCache::publish(time_type sample_time)
+    {
+        m_front_index ^= 1;
+        m_sample_time = sample_time;
+        m_has_sample = true;
+    }
+
+    const TemperatureVoteResult &SampleCache::front() const
+    {
+        return m_buffers[m_front_index];
+    }
+
+    time_type SampleCache::age(time_type now) const
+    {
+        if (!m_has_sample)
+        {
+            return 0;
+        }
+
+        return now - m_sample_time;
+    }
+} // namespace temperature
+} // namespace scottz0r
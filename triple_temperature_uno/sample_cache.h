@@ -0,0 +1,43 @@
+#ifndef _SCOTTZ0R_TEMPERATURE_SAMPLE_CACHE_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_SAMPLE_CACHE_INCLUDE_GUARD
+
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    /// @brief Double buffered cache of the most recent temperature vote result. New samples are written into the back
+    /// buffer and made visible with publish(), so readers of front() always see a complete result.
+    class SampleCache
+    {
+    public:
+        SampleCache();
+
+        /// @brief Buffer to write the next sample into. Not visible to readers until publish() is called.
+        TemperatureVoteResult &back();
+
+        /// @brief Swap the back buffer to the front and record the time the sample was taken.
+        void publish(time_type sample_time);
+
+        /// @brief Most recently published sample. Reports a sensor error if nothing has been published.
+        const TemperatureVoteResult &front() const;
+
+        /// @brief Milliseconds since the front sample was published.
+        time_type age(time_type now) const;
+
+        bool has_sample() const
+        {
+            return m_has_sample;
+        }
+
+    private:
+        TemperatureVoteResult m_buffers[2];
+        time_type m_sample_time;
+        uint8_t m_front_index;
+        bool m_has_sample;
+    };
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_SAMPLE_CACHE_INCLUDE_GUARD
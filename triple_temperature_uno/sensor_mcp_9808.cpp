@@ -5,11 +5,13 @@ namespace scottz0r
 {
 namespace temperature
 {
-    SensorMcp9808::SensorMcp9808() : m_addr(0), m_good(false)
+    SensorMcp9808::SensorMcp9808()
+        : m_addr(0), m_good(false), m_resolution(Mcp9808Resolution::Sixteenth), m_read_step(ReadStep::Idle),
+          m_reg_pointer(MCP9808_REG_POINTER_UNKNOWN)
     {
     }
 
-    bool SensorMcp9808::begin(uint8_t addr)
+    bool SensorMcp9808::begin(uint8_t addr, Mcp9808Resolution resolution)
     {
         // Do not allow begin to be called multiple times.
         if (m_good)
@@ -27,6 +29,7 @@ namespace temperature
         }
 
         m_addr = addr;
+        m_reg_pointer = MCP9808_REG_POINTER_UNKNOWN;
 
         // Read device info to ensure this is the right I2C device.
         uint16_t dev_info;
@@ -43,19 +46,38 @@ namespace temperature
         }
 
         // Write zero/default settings to device.
-        Wire.beginTransmission(m_addr);
-        Wire.write(MCP9808_REG_CONFIG);
-        Wire.write(0);
-        Wire.write(0);
-        if (Wire.endTransmission() != 0)
+        if (!write_register16(MCP9808_REG_CONFIG, 0))
+        {
+            return false;
+        }
+
+        // Resolution is kept by the device across MCU resets, so always write it.
+        if (!write_register8(MCP9808_REG_RESOLUTION, static_cast<uint8_t>(resolution) & 0x03))
         {
             return false;
         }
 
+        m_resolution = resolution;
         m_good = true;
         return true;
     }
 
+    time_type SensorMcp9808::conversion_time(Mcp9808Resolution resolution)
+    {
+        // Typical conversion times from the datasheet.
+        switch (resolution)
+        {
+        case Mcp9808Resolution::Half:
+            return 30;
+        case Mcp9808Resolution::Quarter:
+            return 65;
+        case Mcp9808Resolution::Eighth:
+            return 130;
+        default:
+            return 250;
+        }
+    }
+
     bool SensorMcp9808::read_temp(int16_t &result)
     {
         // Do not attempt to read if sensor is in a failed initialization state.
@@ -68,38 +90,149 @@ namespace temperature
         uint16_t temp_raw;
         if (read16(MCP9808_REG_AMBIENT_TEMP, temp_raw))
         {
-            // Need at least 4 bytes for larger computation.
-            int32_t temp_signed = temp_raw & 0x0FFF;
+            result = convert_temp(temp_raw);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool SensorMcp9808::start_read_temp()
+    {
+        if (!m_good || m_read_step != ReadStep::Idle)
+        {
+            return false;
+        }
+
+        m_read_step = (m_reg_pointer == MCP9808_REG_AMBIENT_TEMP) ? ReadStep::ReadData : ReadStep::WritePointer;
+        return true;
+    }
+
+    SensorReadStatus SensorMcp9808::poll(int16_t &result)
+    {
+        result = 0;
+
+        switch (m_read_step)
+        {
+        case ReadStep::WritePointer:
+            if (!write_pointer(MCP9808_REG_AMBIENT_TEMP))
+            {
+                m_read_step = ReadStep::Idle;
+                return SensorReadStatus::Error;
+            }
+
+            m_read_step = ReadStep::ReadData;
+            return SensorReadStatus::Busy;
 
-            // If raw high bit set, then number is negative. Subtract number from 2^12 to make into a negative number
-            if (temp_raw & 0x1000)
+        case ReadStep::ReadData: {
+            m_read_step = ReadStep::Idle;
+
+            uint16_t temp_raw;
+            if (!read_data16(temp_raw))
             {
-                temp_signed = -1 * (0x1000L - temp_signed);
+                return SensorReadStatus::Error;
             }
 
-            // Convert raw number into degrees in Celsius. The result will be a number of XXX.XX, but with the decimal
-            // suppressed. Narrow after conversion. This should be in range of -4,000, 12,500 (-40.00, 125.00)
-            // Spec examples have / 16, but right shift 4 is same result as integer division of 16.
-            result = (int16_t)((temp_signed * 100L) >> 4L);
-            return true;
+            result = convert_temp(temp_raw);
+            return SensorReadStatus::Done;
         }
 
-        return false;
+        default:
+            // No read was started.
+            return SensorReadStatus::Error;
+        }
+    }
+
+    int16_t SensorMcp9808::convert_temp(uint16_t temp_raw)
+    {
+        // Need at least 4 bytes for larger computation.
+        int32_t temp_signed = temp_raw & 0x0FFF;
+
+        // If raw high bit set, then number is negative. Subtract number from 2^12 to make into a negative number
+        if (temp_raw & 0x1000)
+        {
+            temp_signed = -1 * (0x1000L - temp_signed);
+        }
+
+        // Convert raw number into degrees in Celsius. The result will be a number of XXX.XX, but with the decimal
+        // suppressed. Narrow after conversion. This should be in range of -4,000, 12,500 (-40.00, 125.00)
+        // Spec examples have / 16, but right shift 4 is same result as integer division of 16.
+        return (int16_t)((temp_signed * 100L) >> 4L);
     }
 
     bool SensorMcp9808::read16(uint8_t reg, uint16_t &result)
     {
         result = 0;
 
+        if (!write_pointer(reg))
+        {
+            return false;
+        }
+
+        return read_data16(result);
+    }
+
+    bool SensorMcp9808::write_pointer(uint8_t reg)
+    {
+        if (m_reg_pointer == reg)
+        {
+            return true;
+        }
+
         Wire.beginTransmission(m_addr);
         Wire.write(reg);
         uint8_t xmit_status = Wire.endTransmission();
 
         if (xmit_status != 0)
         {
+            // NACK or bus error. The device pointer is unknown until it is written again.
+            m_reg_pointer = MCP9808_REG_POINTER_UNKNOWN;
+            return false;
+        }
+
+        m_reg_pointer = reg;
+        return true;
+    }
+
+    bool SensorMcp9808::write_register8(uint8_t reg, uint8_t value)
+    {
+        Wire.beginTransmission(m_addr);
+        Wire.write(reg);
+        Wire.write(value);
+
+        if (Wire.endTransmission() != 0)
+        {
+            m_reg_pointer = MCP9808_REG_POINTER_UNKNOWN;
             return false;
         }
 
+        // A register write leaves the device pointer at that register.
+        m_reg_pointer = reg;
+        return true;
+    }
+
+    bool SensorMcp9808::write_register16(uint8_t reg, uint16_t value)
+    {
+        // MCP9808 takes data in big endian.
+        Wire.beginTransmission(m_addr);
+        Wire.write(reg);
+        Wire.write((uint8_t)(value >> 8));
+        Wire.write((uint8_t)(value & 0xFF));
+
+        if (Wire.endTransmission() != 0)
+        {
+            m_reg_pointer = MCP9808_REG_POINTER_UNKNOWN;
+            return false;
+        }
+
+        m_reg_pointer = reg;
+        return true;
+    }
+
+    bool SensorMcp9808::read_data16(uint16_t &result)
+    {
+        result = 0;
+
         Wire.requestFrom(m_addr, (uint8_t)2);
         if (Wire.available() == 2)
         {
@@ -113,6 +246,8 @@ namespace temperature
         }
         else
         {
+            // Short read. Do not trust the pointer until it is written again.
+            m_reg_pointer = MCP9808_REG_POINTER_UNKNOWN;
             return false;
         }
     }
@@ -4,12 +4,29 @@
 #ifndef _SCOTTZ0R_TEMPERATURE_SENSOR_MCP9808_INCLUDE_GUARD
 #define _SCOTTZ0R_TEMPERATURE_SENSOR_MCP9808_INCLUDE_GUARD
 
+#include "temperature_types.h"
 #include <inttypes.h>
 
 namespace scottz0r
 {
 namespace temperature
 {
+    /// @brief Result of advancing a non-blocking sensor read.
+    enum class SensorReadStatus : uint8_t
+    {
+        Busy = 0,
+        Done = 1,
+        Error = 2
+    };
+
+    /// @brief Temperature resolution, as written to the resolution register. Finer resolutions take longer to convert.
+    enum class Mcp9808Resolution : uint8_t
+    {
+        Half = 0,     // 0.5 C, 30ms conversion.
+        Quarter = 1,  // 0.25 C, 65ms conversion.
+        Eighth = 2,   // 0.125 C, 130ms conversion.
+        Sixteenth = 3 // 0.0625 C, 250ms conversion. Power-up default.
+    };
 
     /// @brief This class interfaces with a MCP9808 temperature sensor. This device communicates over I2C.
     class SensorMcp9808
@@ -22,17 +39,56 @@ namespace temperature
         static constexpr uint8_t MCP9808_REG_MANUF_ID = 0x06;
         static constexpr uint8_t MCP9808_REG_DEVICE_ID = 0x07;
         static constexpr uint8_t MCP9808_REG_CONFIG = 0x01;
+        static constexpr uint8_t MCP9808_REG_RESOLUTION = 0x08;
+
+        // Not a device register. Marks the cached register pointer as unknown.
+        static constexpr uint8_t MCP9808_REG_POINTER_UNKNOWN = 0xFF;
 
         static constexpr uint16_t MCP9808_MANUFACTURER_ID = 0x0054;
         static constexpr uint16_t MCP9808_DEVICE_ID = 0x0400;
 
+        enum class ReadStep : uint8_t
+        {
+            Idle,
+            WritePointer,
+            ReadData
+        };
+
     public:
         SensorMcp9808();
 
-        bool begin(uint8_t addr);
+        bool begin(uint8_t addr, Mcp9808Resolution resolution = Mcp9808Resolution::Sixteenth);
 
         bool read_temp(int16_t &result);
 
+        /// @brief Start a non-blocking temperature read. The read is advanced by calling poll() until it no longer
+        /// returns Busy. Returns false if the sensor is not good or a read is already in progress.
+        bool start_read_temp();
+
+        /// @brief Advance a read started with start_read_temp(). Each call performs at most one I2C transaction, so
+        /// the caller can service serial and the watchdog between steps.
+        /// @param result Temperature in 100s of Celsius when Done is returned. Set to 0 on error.
+        SensorReadStatus poll(int16_t &result);
+
+        bool is_reading() const
+        {
+            return m_read_step != ReadStep::Idle;
+        }
+
+        /// @brief Time for the device to complete one conversion at the given resolution. Milliseconds. Reading more
+        /// often than this returns the same conversion again.
+        static time_type conversion_time(Mcp9808Resolution resolution);
+
+        time_type conversion_time() const
+        {
+            return conversion_time(m_resolution);
+        }
+
+        Mcp9808Resolution resolution() const
+        {
+            return m_resolution;
+        }
+
         bool good() const
         {
             return m_good;
@@ -46,8 +102,24 @@ namespace temperature
     private:
         bool read16(uint8_t reg, uint16_t &result);
 
+        bool write_pointer(uint8_t reg);
+
+        bool read_data16(uint16_t &result);
+
+        static int16_t convert_temp(uint16_t temp_raw);
+
+        bool write_register8(uint8_t reg, uint8_t value);
+
+        bool write_register16(uint8_t reg, uint16_t value);
+
         uint8_t m_addr;
         bool m_good;
+        Mcp9808Resolution m_resolution;
+        ReadStep m_read_step;
+
+        // Register the device pointer is known to be at. The MCP9808 keeps its pointer between reads, so the pointer
+        // write can be skipped when it already points at the register being read.
+        uint8_t m_reg_pointer;
     };
 
 } // namespace temperature
@@ -0,0 +1,62 @@
+#include "stream_scheduler.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    StreamScheduler::StreamScheduler(uint8_t sample_divider, temperature_type deadband, time_type heartbeat_interval)
+        : m_report_filter(deadband, heartbeat_interval), m_sample_divider(sample_divider > 0 ? sample_divider : 1),
+          m_sample_count(0), m_sequence(0), m_mode(StreamMode::Periodic), m_active(false)
+    {
+    }
+
+    void StreamScheduler::start(StreamMode mode, const TemperatureVoteResult &current, time_type now)
+    {
+        m_mode = mode;
+        m_sample_count = 0;
+        m_sequence = 0;
+        m_report_filter.mark_reported(current, now);
+        m_active = true;
+    }
+
+    void StreamScheduler::stop()
+    {
+        m_active = false;
+    }
+
+    bool StreamScheduler::on_sample(const TemperatureVoteResult &sample, time_type now)
+    {
+        if (!m_active)
+        {
+            return false;
+        }
+
+        if (m_mode == StreamMode::OnChange)
+        {
+            return m_report_filter.is_due(sample, now);
+        }
+
+        ++m_sample_count;
+        if (m_sample_count < m_sample_divider)
+        {
+            return false;
+        }
+
+        m_sample_count = 0;
+        return true;
+    }
+
+    void StreamScheduler::on_sent(const TemperatureVoteResult &sample, time_type now)
+    {
+        if (m_mode == StreamMode::OnChange)
+        {
+            m_report_filter.mark_reported(sample, now);
+        }
+    }
+
+    uint8_t StreamScheduler::next_sequence()
+    {
+        return m_sequence++;
+    }
+} // namespace temperature
+} // namespace scottz0r
@@ -0,0 +1,70 @@
+#ifndef _SCOTTZ0R_TEMPERATURE_STREAM_SCHEDULER_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_STREAM_SCHEDULER_INCLUDE_GUARD
+
+#include "report_filter.h"
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    enum class StreamMode : uint8_t
+    {
+        // Send every N-th sample.
+        Periodic,
+
+        // Send only samples that pass the report filter: a change larger than the deadband, a status or agreement
+        // change, or a heartbeat.
+        OnChange
+    };
+
+    /// @brief Decides when unsolicited temperature stream messages are sent, and numbers them so the host can detect
+    /// drops.
+    class StreamScheduler
+    {
+    public:
+        /// @param sample_divider Periodic mode sends a message every sample_divider samples. Zero is treated as one.
+        /// @param deadband Change in average that is not reported in OnChange mode. In 100s of Celsius.
+        /// @param heartbeat_interval Longest time without a message in OnChange mode. Milliseconds.
+        StreamScheduler(uint8_t sample_divider, temperature_type deadband, time_type heartbeat_interval);
+
+        /// @brief Start streaming. Restarts the sample count and sequence numbers. The current sample is treated as
+        /// sent, and the caller is expected to send it to acknowledge the start.
+        void start(StreamMode mode, const TemperatureVoteResult &current, time_type now);
+
+        void stop();
+
+        /// @brief Call once for each published sample.
+        /// @return True if a stream message should be sent for this sample. In OnChange mode, a change stays due on
+        /// later samples until a message for it is sent and on_sent is called.
+        bool on_sample(const TemperatureVoteResult &sample, time_type now);
+
+        /// @brief Call when a stream message for a sample has been queued. A message that could not be queued is
+        /// not reported, so the change is sent with a later sample.
+        void on_sent(const TemperatureVoteResult &sample, time_type now);
+
+        /// @brief Sequence number for the next stream message. Increments and wraps on every call.
+        uint8_t next_sequence();
+
+        bool is_active() const
+        {
+            return m_active;
+        }
+
+        StreamMode mode() const
+        {
+            return m_mode;
+        }
+
+    private:
+        ReportFilter m_report_filter;
+        uint8_t m_sample_divider;
+        uint8_t m_sample_count;
+        uint8_t m_sequence;
+        StreamMode m_mode;
+        bool m_active;
+    };
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_STREAM_SCHEDULER_INCLUDE_GUARD
@@ -1,7 +1,10 @@
 ///
 /// @file
 ///
-/// Temperature agreement engine. Takes three measurements of temperatures and votes on agreement.
+/// Temperature agreement engine. Takes N measurements of temperatures and votes on agreement.
+///
+/// The engine is a template over the sensor count. The per-sensor steps are expanded by recursive templates, so every
+/// sensor index is a compile time constant and there are no loops left in the generated code.
 #ifndef _SCOTTZ0R_TEMPERATURE_TEMPERATURE_ENGINE_INCLUDE_GUARD
 #define _SCOTTZ0R_TEMPERATURE_TEMPERATURE_ENGINE_INCLUDE_GUARD
 
@@ -11,21 +14,197 @@ namespace scottz0r
 {
 namespace temperature
 {
-    class TemperatureVoteEngine
+    namespace detail
+    {
+        template <class T> inline T t_abs(const T &x)
+        {
+            return (x < 0) ? -x : x;
+        }
+
+        /// @brief Sum type for the average. Three or fewer sensors sum in 16 bits, as the engine always has. More
+        /// sensors sum in 32 bits so high temperatures cannot overflow.
+        template <bool IsWide> struct VoteSum
+        {
+            using type = int16_t;
+        };
+
+        template <> struct VoteSum<true>
+        {
+            using type = int32_t;
+        };
+
+        /// @brief Copy valid readings into the result and count them. Invalid readings are set to 0.
+        template <size_type I, size_type N> struct VoteCopy
+        {
+            static inline short run(const TemperatureReading (&readings)[N], BasicTemperatureVoteResult<N> &out_result)
+            {
+                out_result.temps[I] = readings[I].is_valid ? readings[I].temperature : 0;
+                return (readings[I].is_valid ? 1 : 0) + VoteCopy<I + 1, N>::run(readings, out_result);
+            }
+        };
+
+        template <size_type N> struct VoteCopy<N, N>
+        {
+            static inline short run(const TemperatureReading (&)[N], BasicTemperatureVoteResult<N> &)
+            {
+                return 0;
+            }
+        };
+
+        /// @brief True if sensor I is within tolerance of any valid sensor J or later, other than itself.
+        template <size_type I, size_type J, size_type N> struct VoteAgreeWith
+        {
+            static inline bool run(const TemperatureReading (&readings)[N], int16_t tolerance)
+            {
+                if (I != J && readings[J].is_valid)
+                {
+                    short diff = t_abs(readings[I].temperature - readings[J].temperature);
+                    if (diff <= tolerance)
+                    {
+                        return true;
+                    }
+                }
+
+                return VoteAgreeWith<I, J + 1, N>::run(readings, tolerance);
+            }
+        };
+
+        template <size_type I, size_type N> struct VoteAgreeWith<I, N, N>
+        {
+            static inline bool run(const TemperatureReading (&)[N], int16_t)
+            {
+                return false;
+            }
+        };
+
+        /// @brief Agreement bits for sensor I and later. A sensor agrees if it is valid and within tolerance of at
+        /// least one other valid sensor.
+        template <size_type I, size_type N> struct VoteAgree
+        {
+            static inline uint8_t run(const TemperatureReading (&readings)[N], int16_t tolerance)
+            {
+                uint8_t bits = VoteAgree<I + 1, N>::run(readings, tolerance);
+
+                if (readings[I].is_valid && VoteAgreeWith<I, 0, N>::run(readings, tolerance))
+                {
+                    bits |= 1 << I;
+                }
+
+                return bits;
+            }
+        };
+
+        template <size_type N> struct VoteAgree<N, N>
+        {
+            static inline uint8_t run(const TemperatureReading (&)[N], int16_t)
+            {
+                return 0;
+            }
+        };
+
+        /// @brief Sum and count the temperatures of agreeing sensors I and later.
+        template <size_type I, size_type N> struct VoteSumAgree
+        {
+            using sum_type = typename VoteSum<(N > 3)>::type;
+
+            static inline void run(const BasicTemperatureVoteResult<N> &result, sum_type &sum, short &count)
+            {
+                if (result.agreement_bits & (1 << I))
+                {
+                    sum += result.temps[I];
+                    ++count;
+                }
+
+                VoteSumAgree<I + 1, N>::run(result, sum, count);
+            }
+        };
+
+        template <size_type N> struct VoteSumAgree<N, N>
+        {
+            using sum_type = typename VoteSum<(N > 3)>::type;
+
+            static inline void run(const BasicTemperatureVoteResult<N> &, sum_type &, short &)
+            {
+            }
+        };
+    } // namespace detail
+
+    template <size_type N> class BasicTemperatureVoteEngine
     {
     public:
-        TemperatureVoteEngine(int16_t temperature_tolerance);
+        static constexpr size_type sensor_count = N;
+
+        using result_type = BasicTemperatureVoteResult<N>;
+
+        BasicTemperatureVoteEngine(int16_t temperature_tolerance) : m_temperature_tolerance(temperature_tolerance)
+        {
+        }
+
+        /// @brief Vote on a set of readings.
+        /// @param readings One reading per sensor, in sensor order.
+        /// @param out_result Vote result.
+        void vote_temperature(const TemperatureReading (&readings)[N], result_type &out_result) const
+        {
+            // Requirement X.XX: Invalid temperature readings must be set to 0.
+            out_result.status = TemperatureVoteStatus::SensorError;
+            out_result.agreement_bits = 0;
+            out_result.average = 0;
+
+            short count_valid = detail::VoteCopy<0, N>::run(readings, out_result);
 
-        void vote_temperature(
-            const TemperatureReading &temp0, const TemperatureReading &temp1, const TemperatureReading &temp2,
-            TemperatureVoteResult &out_result);
+            // Requirement X.XX: At least two sensors must be valid to do voting.
+            if (count_valid < 2)
+            {
+                return;
+            }
+
+            // Requirement X.XX: Valid values must be within a tolerance of each other.
+            out_result.agreement_bits = detail::VoteAgree<0, N>::run(readings, m_temperature_tolerance);
+
+            // Requirement X.XX: At least two sensors must be within tolerance to find the average, and to return a
+            // "good" state.
+            short count_agree = 0;
+            out_result.average = agreeing_average(out_result, count_agree);
+
+            if (count_agree >= 2)
+            {
+                out_result.status = TemperatureVoteStatus::OK;
+            }
+            else
+            {
+                out_result.status = TemperatureVoteStatus::Disagree;
+            }
+        }
+
+        /// @brief Average of the sensors flagged as agreeing in a result, computed the same way as a vote.
+        /// @return The average, or 0 if fewer than two sensors agree.
+        static temperature_type agreeing_average(const result_type &result)
+        {
+            short count_agree = 0;
+            return agreeing_average(result, count_agree);
+        }
 
     private:
-        bool is_within_tolerance(const TemperatureReading &a, const TemperatureReading &b, const TemperatureReading &c);
+        static temperature_type agreeing_average(const result_type &result, short &count_agree)
+        {
+            typename detail::VoteSum<(N > 3)>::type sum_agree = 0;
+            count_agree = 0;
+
+            detail::VoteSumAgree<0, N>::run(result, sum_agree, count_agree);
+
+            if (count_agree < 2)
+            {
+                return 0;
+            }
+
+            return static_cast<temperature_type>(sum_agree / count_agree);
+        }
 
         int16_t m_temperature_tolerance;
     };
 
+    /// @brief Vote engine for the number of sensors this project is built for.
+    using TemperatureVoteEngine = BasicTemperatureVoteEngine<TemperatureVoteResult::sensor_count>;
 } // namespace temperature
 } // namespace scottz0r
 
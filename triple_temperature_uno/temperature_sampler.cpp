@@ -0,0 +1,67 @@
+#include "temperature_sampler.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    TemperatureSampler::TemperatureSampler(SensorMcp9808 *sensors, TemperatureVoteEngine &engine, SampleCache &cache)
+        : m_sensors(sensors), m_readings{}, m_engine(engine), m_cache(cache), m_sensor_index(0), m_busy(false)
+    {
+    }
+
+    bool TemperatureSampler::start()
+    {
+        if (m_busy)
+        {
+            return false;
+        }
+
+        m_sensor_index = 0;
+        m_busy = true;
+        return true;
+    }
+
+    bool TemperatureSampler::poll(time_type now)
+    {
+        if (!m_busy)
+        {
+            return false;
+        }
+
+        SensorMcp9808 &sensor = m_sensors[m_sensor_index];
+
+        if (!sensor.is_reading() && !sensor.start_read_temp())
+        {
+            // A sensor that failed setup is recorded as invalid without touching the bus.
+            finish_sensor(false, 0);
+        }
+        else
+        {
+            int16_t temperature;
+            SensorReadStatus status = sensor.poll(temperature);
+
+            if (status != SensorReadStatus::Busy)
+            {
+                finish_sensor(status == SensorReadStatus::Done, temperature);
+            }
+        }
+
+        if (m_sensor_index < sensor_count)
+        {
+            return false;
+        }
+
+        m_engine.vote_temperature(m_readings, m_cache.back());
+        m_cache.publish(now);
+        m_busy = false;
+        return true;
+    }
+
+    void TemperatureSampler::finish_sensor(bool is_valid, int16_t temperature)
+    {
+        m_readings[m_sensor_index].is_valid = is_valid;
+        m_readings[m_sensor_index].temperature = is_valid ? temperature : 0;
+        ++m_sensor_index;
+    }
+} // namespace temperature
+} // namespace scottz0r
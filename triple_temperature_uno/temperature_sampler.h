@@ -0,0 +1,64 @@
+#ifndef _SCOTTZ0R_TEMPERATURE_TEMPERATURE_SAMPLER_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_TEMPERATURE_SAMPLER_INCLUDE_GUARD
+
+#include "sample_cache.h"
+#include "sensor_mcp_9808.h"
+#include "temperature_engine.h"
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    /// @brief Reads all sensors without blocking, votes, and publishes the result to a SampleCache. A sample cycle is
+    /// started with start() and advanced by poll(), which performs at most one I2C transaction per call.
+    class TemperatureSampler
+    {
+    public:
+        static constexpr size_type sensor_count = TemperatureVoteResult::sensor_count;
+
+        using Readings = TemperatureReading[sensor_count];
+
+        /// @param sensors Array of sensor_count sensors, in sensor order. Must outlive this object.
+        TemperatureSampler(SensorMcp9808 *sensors, TemperatureVoteEngine &engine, SampleCache &cache);
+
+        /// @brief Start a new sample cycle. Returns false if a cycle is already in progress.
+        bool start();
+
+        /// @brief Advance the current sample cycle by one step.
+        /// @param now Current time in milliseconds. Used as the sample time when the result is published.
+        /// @return True if this call completed the cycle and published a new sample.
+        bool poll(time_type now);
+
+        bool busy() const
+        {
+            return m_busy;
+        }
+
+        /// @brief Index of the sensor the next poll works on while busy.
+        size_type sensor_index() const
+        {
+            return m_sensor_index;
+        }
+
+        /// @brief Readings the last published sample was voted from, in sensor order. While a cycle is running, the
+        /// sensors before sensor_index() hold this cycle's readings.
+        const Readings &readings() const
+        {
+            return m_readings;
+        }
+
+    private:
+        void finish_sensor(bool is_valid, int16_t temperature);
+
+        SensorMcp9808 *m_sensors;
+        Readings m_readings;
+        TemperatureVoteEngine &m_engine;
+        SampleCache &m_cache;
+        uint8_t m_sensor_index;
+        bool m_busy;
+    };
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_TEMPERATURE_SAMPLER_INCLUDE_GUARD
@@ -3,6 +3,8 @@
 
 #include <inttypes.h>
 
+#include "prj_config.h"
+
 namespace scottz0r
 {
 namespace temperature
@@ -32,9 +34,17 @@ namespace temperature
         SystemStatus = 2,
         Error = 3,
         Request = 4,
-        _Unknown = 5
+        TemperatureStream = 5,
+        HistoryData = 6,
+        BaudRate = 7,
+        Diagnostics = 8,
+        _Unknown = 9
     };
 
+    /// @brief Set in the request type byte of a request that carries a request ID, and in the type byte of the reply.
+    /// The reply echoes the ID in the last payload byte.
+    static constexpr uint8_t MESSAGE_REQUEST_ID_FLAG = 0x80;
+
     struct TemperatureReading
     {
         bool is_valid;
@@ -49,25 +59,74 @@ namespace temperature
         _Unknown = 3
     };
 
-    struct TemperatureVoteResult
+    /// @brief Largest supported number of sensors. Agreement and sensor status bits are packed into one byte, and the
+    /// MCP 9808 address range has room for eight sensors.
+    static constexpr size_type MAX_SENSOR_COUNT = 8;
+
+    /// @brief Vote result for N sensors.
+    template <size_type N> struct BasicTemperatureVoteResult
     {
+        static_assert(N >= 1 && N <= MAX_SENSOR_COUNT, "Sensor count must be between 1 and MAX_SENSOR_COUNT");
+
+        static constexpr size_type sensor_count = N;
+
         TemperatureVoteStatus status;
-        bool is_temp0_agree;
-        bool is_temp1_agree;
-        bool is_temp2_agree;
 
-        temperature_type temp0;
-        temperature_type temp1;
-        temperature_type temp2;
+        /// @brief Bit i is set when sensor i agrees with at least one other sensor.
+        uint8_t agreement_bits;
+
+        temperature_type temps[N];
         temperature_type average;
+
+        bool is_agree(size_type index) const
+        {
+            return (agreement_bits & (1 << index)) != 0;
+        }
     };
 
+    /// @brief Vote result for the number of sensors this project is built for.
+    using TemperatureVoteResult = BasicTemperatureVoteResult<CFG_SENSOR_COUNT>;
+
     struct SystemSensorStatus
     {
-        bool is_sensor_0_good;
-        bool is_sensor_1_good;
-        bool is_sensor_2_good;
+        /// @brief Bit i is set when sensor i was set up successfully.
+        uint8_t sensor_good_bits;
         SystemStatus system_status;
+
+        /// @brief Bytes waiting in the transmit queue, and the most there have been since boot.
+        uint8_t tx_queue_size;
+        uint8_t tx_queue_peak;
+    };
+
+    /// @brief Minimum, moving average and maximum of a time in microseconds. Zero until the first time is recorded.
+    struct TimeStats
+    {
+        uint16_t min;
+        uint16_t average;
+        uint16_t max;
+    };
+
+    /// @brief Performance counters reported by the Diagnostics request. Times saturate at 65535 microseconds, and
+    /// counts wrap.
+    struct DiagnosticsReport
+    {
+        /// @brief Loop passes in the last whole second.
+        uint16_t loop_rate;
+
+        /// @brief Longest loop pass since boot. Microseconds.
+        uint16_t loop_time_max;
+
+        /// @brief Time of each sampler step, one I2C transaction, per sensor.
+        TimeStats sensor_times[CFG_SENSOR_COUNT];
+
+        /// @brief Time from reading the last byte of a request to writing the first byte of its reply.
+        TimeStats reply_latency;
+
+        /// @brief Bytes given to the request reader, bytes it dropped outside of a good request, and requests with a
+        /// bad CRC.
+        uint32_t bytes_received;
+        uint16_t bytes_discarded;
+        uint16_t crc_failures;
     };
 } // namespace temperature
 } // namespace scottz0r
@@ -0,0 +1,71 @@
+#include "tx_queue.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    TxQueue::TxQueue(uint8_t *storage, size_type capacity)
+        : m_storage(storage), m_capacity(capacity), m_head(0), m_size(0), m_peak(0), m_dropped(0)
+    {
+    }
+
+    bool TxQueue::push(const uint8_t *data, size_type size)
+    {
+        // Part of a message is worse than none, because the host would drop the bytes around it as noise.
+        if (size > free_space())
+        {
+            ++m_dropped;
+            return false;
+        }
+
+        size_type tail = m_head + m_size;
+        if (tail >= m_capacity)
+        {
+            tail -= m_capacity;
+        }
+
+        for (size_type i = 0; i < size; ++i)
+        {
+            m_storage[tail] = data[i];
+
+            ++tail;
+            if (tail == m_capacity)
+            {
+                tail = 0;
+            }
+        }
+
+        m_size += size;
+        if (m_size > m_peak)
+        {
+            m_peak = m_size;
+        }
+
+        return true;
+    }
+
+    size_type TxQueue::front(const uint8_t *&data) const
+    {
+        data = m_storage + m_head;
+
+        size_type contiguous = m_capacity - m_head;
+        return m_size < contiguous ? m_size : contiguous;
+    }
+
+    void TxQueue::pop(size_type size)
+    {
+        if (size > m_size)
+        {
+            size = m_size;
+        }
+
+        m_head += size;
+        if (m_head >= m_capacity)
+        {
+            m_head -= m_capacity;
+        }
+
+        m_size -= size;
+    }
+} // namespace temperature
+} // namespace scottz0r
@@ -0,0 +1,83 @@
+///
+/// @file
+///
+/// Outbound byte queue between the message formatter and the serial port.
+///
+/// Serial.write blocks while the serial transmit buffer is full, which can hold the main loop past the watchdog
+/// timeout when replies and stream messages back up. Messages are queued whole instead, and the main loop writes only
+/// as many bytes each pass as the transmit buffer has room for.
+#ifndef _SCOTTZ0R_TEMPERATURE_TX_QUEUE_INCLUDE_GUARD
+#define _SCOTTZ0R_TEMPERATURE_TX_QUEUE_INCLUDE_GUARD
+
+#include "temperature_types.h"
+
+namespace scottz0r
+{
+namespace temperature
+{
+    /// @brief Ring buffer of whole messages waiting to be written.
+    class TxQueue
+    {
+    public:
+        /// @param storage Byte storage for queued messages. Must outlive this object.
+        /// @param capacity Size of storage.
+        TxQueue(uint8_t *storage, size_type capacity);
+
+        /// @brief Queue a whole message.
+        /// @return False if there is not room for all of it, in which case nothing is queued and the message is counted
+        /// as dropped.
+        bool push(const uint8_t *data, size_type size);
+
+        /// @brief Oldest queued bytes that are contiguous in storage. There may be more after these when the queue wraps.
+        /// @param data Set to the first queued byte.
+        /// @return Number of contiguous bytes, or zero if the queue is empty.
+        size_type front(const uint8_t *&data) const;
+
+        /// @brief Remove the oldest queued bytes once they are written.
+        void pop(size_type size);
+
+        /// @brief Number of queued bytes.
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        size_type capacity() const
+        {
+            return m_capacity;
+        }
+
+        size_type free_space() const
+        {
+            return m_capacity - m_size;
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        /// @brief Most bytes queued at once since the queue was created.
+        size_type peak() const
+        {
+            return m_peak;
+        }
+
+        /// @brief Messages dropped because the queue was full.
+        size_type dropped() const
+        {
+            return m_dropped;
+        }
+
+    private:
+        uint8_t *m_storage;
+        size_type m_capacity;
+        size_type m_head;
+        size_type m_size;
+        size_type m_peak;
+        size_type m_dropped;
+    };
+} // namespace temperature
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_TEMPERATURE_TX_QUEUE_INCLUDE_GUARD